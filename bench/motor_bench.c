@@ -0,0 +1,432 @@
+/**
+ * @file motor_bench.c
+ * @brief Micro-benchmarks for the motor control hot path
+ *
+ * Runs the commutation update, speed estimator, PI regulator (one bank
+ * slot), FOC current loop and full control tick for 1 to MOTOR_MAX_INSTANCES
+ * motors against mock GPIO, PWM and Hall backends, so the numbers reflect the library code alone,
+ * then the control tick closed around the simulated plant (SimMotor.h). Each
+ * benchmark is timed in batches; the per-batch ns/op values give the jitter
+ * percentiles, the mean gives throughput.
+ *
+ * Usage: motor_bench [--json] [--samples N]
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "MotorControl.h"
+#include "MotorInternal.h"
+#include "SpeedController.h"
+#include "SpeedEstimator.h"
+#include "ControlLoop.h"
+#include "MotorClock.h"
+#include "SimMotor.h"
+#include "MotorCalibration.h"
+
+/** @brief Default number of timed batches per benchmark */
+#define BENCH_DEFAULT_SAMPLES 2000
+
+/** @brief Untimed batches run before measuring */
+#define BENCH_WARMUP_SAMPLES 100
+
+/** @brief Mock pin assignment, four GPIOs per motor */
+#define BENCH_PHASE_PIN(m) (4 * (m))
+#define BENCH_HALL_PIN(m) (32 + 4 * (m))
+
+/** @brief Forward Hall sequence */
+static const uint8_t hallSequence[6] = { 1, 3, 2, 6, 4, 5 };
+
+static int benchHallStep[64];          ///< Sequence position per Hall pin A
+static volatile int benchPwmSink;      ///< Keeps mock PWM writes observable
+static uint64_t benchPwmWrites;        ///< Writes that reached the mock PWM backend
+static uint64_t benchClock;            ///< Virtual time of the control tick benchmarks
+
+/**
+ * @brief Result of one benchmark
+ */
+typedef struct {
+    const char *name;     ///< Benchmark name
+    int motors;           ///< Motors exercised per op
+    int samples;          ///< Timed batches
+    int batch;            ///< Ops per batch
+    double meanNs;        ///< Mean ns per op
+    double minNs;         ///< Fastest batch, ns per op
+    double p50Ns;         ///< Median batch, ns per op
+    double p99Ns;         ///< 99th percentile batch, ns per op
+    double p999Ns;        ///< 99.9th percentile batch, ns per op
+    double maxNs;         ///< Slowest batch, ns per op
+    double opsPerSec;     ///< Throughput from the mean
+    double writesPerOp;   ///< PWM backend writes per op
+} BenchResult;
+
+typedef void (*BenchFn)(void *ctx, int count);
+
+/* ---------------------------------------------------------------------------
+ * Mock backends
+ * ------------------------------------------------------------------------- */
+
+static int mockPwmSetup(int pin, int range) {
+    (void) pin;
+    (void) range;
+    return 0;
+}
+
+static void mockPwmWrite(int pin, int value) {
+    benchPwmSink = pin + value;
+    benchPwmWrites++;
+}
+
+static void mockPwmRelease(int pin) {
+    (void) pin;
+}
+
+static const PwmBackend mockPwmBackend = {
+    .name = "mock",
+    .setup = mockPwmSetup,
+    .write = mockPwmWrite,
+    .release = mockPwmRelease,
+};
+
+static int mockHallSetup(int pinA, int pinB, int pinC) {
+    (void) pinB;
+    (void) pinC;
+    benchHallStep[pinA] = 0;
+    return 0;
+}
+
+static uint8_t mockHallRead(int pinA, int pinB, int pinC) {
+    (void) pinB;
+    (void) pinC;
+    return hallSequence[benchHallStep[pinA]];
+}
+
+static const HallBackend mockHallBackend = {
+    .name = "mock",
+    .setup = mockHallSetup,
+    .read = mockHallRead,
+};
+
+/** @brief Move every mocked rotor to the next Hall sector */
+static void advanceHall(void) {
+    for (int m = 0; m < MOTOR_MAX_INSTANCES; m++) {
+        int *step = &benchHallStep[BENCH_HALL_PIN(m)];
+        *step = *step == 5 ? 0 : *step + 1;
+    }
+}
+
+/**
+ * @brief Create running motors on the mock backends
+ * @details Polled commutation, so no edge handlers are installed. The mocked
+ * rotors step a sector every call, far inside the Hall debounce window, so
+ * the window is disabled and each step commutates.
+ * @return 0 on success, -1 on failure
+ */
+static int createMotors(Motor **motors, int count) {
+    for (int m = 0; m < count; m++) {
+        MotorConfig config;
+        motorDefaultConfig(&config);
+        for (int p = 0; p < 3; p++) {
+            config.phasePins[p] = BENCH_PHASE_PIN(m) + p;
+            config.hallPins[p] = BENCH_HALL_PIN(m) + p;
+        }
+        config.pwm = &mockPwmBackend;
+        config.hall = &mockHallBackend;
+        config.commutationMode = COMMUTATION_POLLED;
+        config.hallDebounceNs = 0;
+        motors[m] = motorCreate(&config);
+        if (motors[m] == NULL) {
+            printf("Failed to create mock motor %d\n", m);
+            return -1;
+        }
+        motorInstanceSetSpeed(motors[m], MOTOR_MAX_RPM / 2);
+        motorInstanceStart(motors[m]);
+    }
+    return 0;
+}
+
+static void destroyMotors(Motor **motors, int count) {
+    for (int m = 0; m < count; m++) motorDestroy(motors[m]);
+}
+
+/* ---------------------------------------------------------------------------
+ * Measurement
+ * ------------------------------------------------------------------------- */
+
+static uint64_t benchNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+    int index = (int) (p / 100.0 * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+static BenchResult runBench(const char *name, int motors, BenchFn fn, void *ctx,
+                            int samples, int batch) {
+    double *perOp = malloc(sizeof(double) * (size_t) samples);
+    if (perOp == NULL) {
+        printf("Out of memory\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < BENCH_WARMUP_SAMPLES; i++) fn(ctx, batch);
+
+    double total = 0.0;
+    uint64_t writes = benchPwmWrites;
+    for (int i = 0; i < samples; i++) {
+        uint64_t start = benchNowNs();
+        fn(ctx, batch);
+        uint64_t end = benchNowNs();
+        perOp[i] = (double) (end - start) / batch;
+        total += perOp[i];
+    }
+    qsort(perOp, (size_t) samples, sizeof(double), compareDouble);
+
+    BenchResult result = {
+        .name = name,
+        .motors = motors,
+        .samples = samples,
+        .batch = batch,
+        .meanNs = total / samples,
+        .minNs = perOp[0],
+        .p50Ns = percentile(perOp, samples, 50.0),
+        .p99Ns = percentile(perOp, samples, 99.0),
+        .p999Ns = percentile(perOp, samples, 99.9),
+        .maxNs = perOp[samples - 1],
+    };
+    result.opsPerSec = result.meanNs > 0.0 ? 1e9 / result.meanNs : 0.0;
+    result.writesPerOp = (double) (benchPwmWrites - writes) / ((double) samples * batch);
+    free(perOp);
+    return result;
+}
+
+/* ---------------------------------------------------------------------------
+ * Benchmarks
+ * ------------------------------------------------------------------------- */
+
+static void benchCommutation(void *ctx, int count) {
+    Motor *motor = ctx;
+    for (int i = 0; i < count; i++) {
+        advanceHall();
+        motorInstanceUpdateCommutation(motor);
+    }
+}
+
+static void benchEstimator(void *ctx, int count) {
+    static uint64_t now = 0;
+    static int step = 0;
+    SpeedEstimator *est = ctx;
+    for (int i = 0; i < count; i++) {
+        now += 250000;  // 250us sectors, 10000 RPM with 8 poles
+        step = step == 5 ? 0 : step + 1;
+        speedEstimatorSample(est, hallSequence[step], now);
+        speedEstimatorUpdate(est, now);
+    }
+}
+
+/** @brief Regulator pass for a single slot, fed back through its own output */
+static void benchRegulate(void *ctx, int count) {
+    MotorHotState *hot = ctx;
+    for (int i = 0; i < count; i++) {
+        motorBankRegulate(hot, 1);
+        hot->measured[0] = (hot->measured[0] + hot->duty[0]) & 0x1FFF;
+    }
+}
+
+/** @brief One current loop iteration: angle interpolation, transforms, PI, SVPWM */
+static void benchFoc(void *ctx, int count) {
+    FocController *foc = ctx;
+    SpeedEstimator est;
+    speedEstimatorInit(&est, NUM_POLES, SPEED_ZERO_TIMEOUT_NS);
+    speedEstimatorSample(&est, 1, 0);
+    speedEstimatorSample(&est, 3, 500000);
+    MotorCalibration cal;
+    calibrationDefaults(&cal);
+    uint64_t now = 500000;
+    int32_t ia = 0;
+    for (int i = 0; i < count; i++) {
+        now += 50000;
+        uint16_t angle = rotorAngleInterpolate(&est, 1, cal.hallAngles, now);
+        const uint16_t *duty = focControllerStep(foc, ia, 300 - ia, angle, 0, 3000);
+        ia = (duty[0] - PWM_RANGE / 2) * 4;
+    }
+}
+
+static void benchBank(void *ctx, int count) {
+    (void) ctx;
+    for (int i = 0; i < count; i++) {
+        motorHot.measured[i % MOTOR_MAX_INSTANCES] += 1;
+        motorBankRegulate(&motorHot, MOTOR_MAX_INSTANCES);
+        motorBankCommutate(&motorHot, MOTOR_MAX_INSTANCES);
+    }
+}
+
+static void benchSim(void *ctx, int count) {
+    (void) ctx;
+    simRun((uint64_t) count * (1000000000U / CONTROL_LOOP_RATE_HZ), 1000000000U / CONTROL_LOOP_RATE_HZ);
+}
+
+/** @brief Clock source of the control tick benchmarks */
+static uint64_t benchClockNs(void) {
+    return benchClock;
+}
+
+/**
+ * @brief Control ticks on virtual time, one Hall sector every two ticks
+ * @details At CONTROL_LOOP_RATE_HZ that is MOTOR_MAX_RPM / 2 with NUM_POLES
+ * poles, the speed the motors are set to, so the regulator holds a real
+ * duty and every sector change reaches the phases.
+ */
+static void benchTick(void *ctx, int count) {
+    static unsigned ticks;
+    (void) ctx;
+    for (int i = 0; i < count; i++) {
+        benchClock += 1000000000U / CONTROL_LOOP_RATE_HZ;
+        if (ticks++ & 1) advanceHall();
+        motorControlTick();
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Reporting
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Check that a commutating benchmark reached the PWM backend
+ * @return 0 if it wrote, -1 if every sample was rejected before the phases
+ */
+static int requireWrites(const BenchResult *r) {
+    if (r->writesPerOp > 0.0) return 0;
+    printf("%s made no PWM writes; Hall samples never reached the phases\n", r->name);
+    return -1;
+}
+
+static void printTable(const BenchResult *results, int count) {
+    printf("%-22s %6s %10s %10s %10s %10s %10s %14s %10s\n",
+           "benchmark", "motors", "mean ns", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "ops/sec",
+           "writes/op");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        printf("%-22s %6d %10.1f %10.1f %10.1f %10.1f %10.1f %14.0f %10.2f\n",
+               r->name, r->motors, r->meanNs, r->p50Ns, r->p99Ns, r->p999Ns, r->maxNs, r->opsPerSec,
+               r->writesPerOp);
+    }
+}
+
+static void printJson(const BenchResult *results, int count) {
+    printf("{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        printf("    {\"name\": \"%s\", \"motors\": %d, \"samples\": %d, \"batch\": %d, "
+               "\"mean_ns\": %.2f, \"min_ns\": %.2f, \"p50_ns\": %.2f, \"p99_ns\": %.2f, "
+               "\"p999_ns\": %.2f, \"max_ns\": %.2f, \"ops_per_sec\": %.0f, \"pwm_writes_per_op\": %.2f}%s\n",
+               r->name, r->motors, r->samples, r->batch, r->meanNs, r->minNs, r->p50Ns,
+               r->p99Ns, r->p999Ns, r->maxNs, r->opsPerSec, r->writesPerOp, i + 1 < count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+/**
+ * @brief Benchmark entry point
+ * @return 0 on success, 1 on error or if a commutating benchmark made no PWM writes
+ */
+int main(int argc, char **argv) {
+    int json = 0;
+    int samples = BENCH_DEFAULT_SAMPLES;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = atoi(argv[++i]);
+        } else {
+            printf("Usage: %s [--json] [--samples N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (samples < 1) samples = 1;
+
+    enum { MAX_RESULTS = 6 + MOTOR_MAX_INSTANCES };
+    static char tickNames[MOTOR_MAX_INSTANCES][24];
+    BenchResult results[MAX_RESULTS];
+    Motor *motors[MOTOR_MAX_INSTANCES];
+    int count = 0;
+
+    if (createMotors(motors, 1) != 0) return 1;
+    results[count++] = runBench("update_commutation", 1, benchCommutation, motors[0], samples, 64);
+    int status = requireWrites(&results[count - 1]);
+    destroyMotors(motors, 1);
+
+    SpeedEstimator est;
+    speedEstimatorInit(&est, NUM_POLES, SPEED_ZERO_TIMEOUT_NS);
+    results[count++] = runBench("speed_estimator", 1, benchEstimator, &est, samples, 64);
+
+    static MotorHotState regulated;
+    regulated.active[0] = -1;
+    regulated.setpoint[0] = 3000;
+    regulated.feedforward[0] = 300;
+    regulated.kp[0] = SPEED_KP_Q16;
+    regulated.ki[0] = SPEED_KI_Q16;
+    regulated.outMax[0] = PWM_RANGE;
+    results[count++] = runBench("pi_regulator", 1, benchRegulate, &regulated, samples, 64);
+
+    FocController foc;
+    focControllerInit(&foc, FOC_KP_Q16, FOC_KI_Q16, PWM_RANGE);
+    results[count++] = runBench("foc_current_loop", 1, benchFoc, &foc, samples, 64);
+
+    if (createMotors(motors, MOTOR_MAX_INSTANCES) != 0) return 1;
+    motorControlTick();  // Fill the hot state once
+    results[count++] = runBench("bank_regulate_commutate", MOTOR_MAX_INSTANCES, benchBank, NULL, samples, 64);
+    destroyMotors(motors, MOTOR_MAX_INSTANCES);
+
+    // Full tick as seen by the control loop, scaling the number of motors
+    motorClockSetSource(benchClockNs);
+    for (int n = 1; n <= MOTOR_MAX_INSTANCES; n++) {
+        if (createMotors(motors, n) != 0) return 1;
+        snprintf(tickNames[n - 1], sizeof(tickNames[n - 1]), "control_tick_%d", n);
+        results[count++] = runBench(tickNames[n - 1], n, benchTick, NULL, samples, 16);
+        status |= requireWrites(&results[count - 1]);
+        destroyMotors(motors, n);
+    }
+    motorClockSetSource(NULL);
+
+    // Control tick plus plant model; ops/sec over CONTROL_LOOP_RATE_HZ is the
+    // speed-up over real time
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    Motor *simulated = motorCreate(&config);
+    if (sim == NULL || simulated == NULL) {
+        printf("Failed to create simulated motor\n");
+        return 1;
+    }
+    simMotorAttach(sim, simulated);
+    motorClockSetSource(simClockNs);
+    motorInstanceStart(simulated);
+    motorInstanceSetSpeed(simulated, MOTOR_MAX_RPM / 2);
+    results[count++] = runBench("sim_closed_loop_tick", 1, benchSim, NULL, samples, 16);
+    motorDestroy(simulated);
+    simMotorDestroy(sim);
+    motorClockSetSource(NULL);
+
+    if (json) {
+        printJson(results, count);
+    } else {
+        printTable(results, count);
+    }
+    return status != 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file AdcBackend.h
+ * @brief Pluggable analog input backends for back-EMF sensing
+ *
+ * Sensorless commutation samples the phase terminal voltages through an
+ * external ADC behind a resistor divider. One implementation is provided:
+ * - mcp3008AdcBackend: 10-bit MCP3008 on the Pi SPI bus (WiringPi SPI)
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef ADC_BACKEND_H
+#define ADC_BACKEND_H
+
+#include <stdint.h>
+
+/** @brief SPI chip select the ADC is wired to */
+#ifndef ADC_SPI_CHANNEL
+#define ADC_SPI_CHANNEL 0
+#endif
+
+/** @brief SPI clock in Hz (MCP3008 maximum at 5V) */
+#ifndef ADC_SPI_SPEED
+#define ADC_SPI_SPEED 3600000
+#endif
+
+/**
+ * @brief ADC backend operations
+ */
+typedef struct {
+    const char *name;                 ///< Human readable backend name
+    int (*setup)(void);               ///< Open the converter; 0 on success, -1 on failure
+    int (*read)(int channel);         ///< Single-ended conversion in counts, -1 on failure
+    int fullScale;                    ///< Counts at the reference voltage
+} AdcBackend;
+
+/** @brief MCP3008 on ADC_SPI_CHANNEL */
+extern const AdcBackend mcp3008AdcBackend;
+
+#endif // ADC_BACKEND_H
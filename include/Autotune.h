@@ -0,0 +1,188 @@
+/**
+ * @file Autotune.h
+ * @brief Speed loop gain identification by open-loop step response
+ *
+ * motorInstanceAutotune() runs a step experiment on a motor through the
+ * regular control tick:
+ * - the PI gains are set to zero, so the duty is the open-loop feedforward
+ *   of the setpoint (rpm * pwmRange / maxRpm), the same path as
+ *   motorSetSpeed() without a control loop
+ * - settle: the setpoint holds AUTOTUNE_BASE_PCT of maxRpm for
+ *   AUTOTUNE_SETTLE_MS; the last quarter gives the baseline speed
+ * - step: the setpoint jumps by AUTOTUNE_STEP_PCT and the Hall-derived
+ *   speed is recorded for AUTOTUNE_STEP_MS
+ *
+ * The response is fitted as a first-order plant with dead time by the
+ * two-point method: the gain is the speed change per duty count, the time
+ * constant 1.5 times the interval between 28.3% and 63.2% of the change,
+ * and whatever remains of the 63.2% time is dead time (mostly the speed
+ * estimator's averaging lag). The PI gains follow from SIMC/lambda tuning
+ * with a closed-loop time constant lambda of AUTOTUNE_LAMBDA_PCT of the
+ * plant's, but no shorter than the dead time:
+ *   kp = tau / (gain * (lambda + theta)),  ki = kp * tick / min(tau, 4 (lambda + theta))
+ * The estimator lag grows as the speed drops, so the default leaves margin
+ * for running well below the identification speed.
+ * They are installed when the experiment completes; the previous gains
+ * come back if it fails or the motor is stopped. autotuneSaveGains()
+ * writes them as text for the calibration file.
+ *
+ * The experiment advances in motorControlTick(), so the control loop (or
+ * an external tick such as simRun()) must be running.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/** @brief Baseline speed of the experiment, percent of maxRpm */
+#ifndef AUTOTUNE_BASE_PCT
+#define AUTOTUNE_BASE_PCT 30
+#endif
+
+/** @brief Setpoint step, percent of maxRpm */
+#ifndef AUTOTUNE_STEP_PCT
+#define AUTOTUNE_STEP_PCT 20
+#endif
+
+/** @brief Time to settle at the baseline speed */
+#ifndef AUTOTUNE_SETTLE_MS
+#define AUTOTUNE_SETTLE_MS 1000
+#endif
+
+/** @brief Time the step response is recorded */
+#ifndef AUTOTUNE_STEP_MS
+#define AUTOTUNE_STEP_MS 1000
+#endif
+
+/** @brief Closed-loop time constant requested, percent of the plant's */
+#ifndef AUTOTUNE_LAMBDA_PCT
+#define AUTOTUNE_LAMBDA_PCT 200
+#endif
+
+/** @brief Speed samples kept of the step response */
+#define AUTOTUNE_SAMPLES 200
+
+/**
+ * @brief Experiment progress
+ */
+typedef enum {
+    AUTOTUNE_IDLE = 0,    ///< Never run
+    AUTOTUNE_SETTLE,      ///< Holding the baseline speed
+    AUTOTUNE_STEP,        ///< Recording the step response
+    AUTOTUNE_DONE,        ///< Gains identified and installed
+    AUTOTUNE_FAILED       ///< Aborted; previous gains restored
+} AutotuneState;
+
+/**
+ * @brief Identified plant and gains
+ */
+typedef struct {
+    int32_t plantGainQ16;      ///< Speed change per duty count (RPM), Q16.16
+    uint32_t timeConstantUs;   ///< First-order time constant
+    uint32_t deadTimeUs;       ///< Apparent delay, including the speed estimator lag
+    int32_t kp;                ///< Proportional gain, Q16.16
+    int32_t ki;                ///< Integral gain per tick, Q16.16
+} AutotuneResult;
+
+/**
+ * @brief Step experiment state of one motor
+ */
+typedef struct {
+    AutotuneState state;                 ///< Progress
+    uint16_t baseRpm;                    ///< Baseline setpoint
+    uint16_t stepRpm;                    ///< Setpoint step
+    uint16_t pwmRange;                   ///< Duty full scale of the motor
+    uint16_t maxRpm;                     ///< Speed at full duty
+    uint64_t phaseStartNs;               ///< Entry time of the current phase
+    int64_t baselineSum;                 ///< Speed sum over the end of the settle phase
+    uint32_t baselineCount;              ///< Samples in baselineSum
+    int32_t baseline;                    ///< Settled speed before the step
+    uint16_t samples[AUTOTUNE_SAMPLES];  ///< Step response, AUTOTUNE_STEP_MS / AUTOTUNE_SAMPLES apart
+    uint16_t count;                      ///< Valid entries in samples
+    int32_t savedKp;                     ///< Gains to restore on failure
+    int32_t savedKi;                     ///< Gains to restore on failure
+    AutotuneResult result;               ///< Outcome once AUTOTUNE_DONE
+} Autotuner;
+
+/**
+ * @brief Begin a step experiment
+ * @param tuner Experiment state
+ * @param baseRpm Baseline setpoint
+ * @param stepRpm Setpoint step
+ * @param pwmRange Duty full scale
+ * @param maxRpm Speed at full duty
+ * @param nowNs Current time from motorClockNs()
+ */
+void autotuneBegin(Autotuner *tuner, uint16_t baseRpm, uint16_t stepRpm,
+                   uint16_t pwmRange, uint16_t maxRpm, uint64_t nowNs);
+
+/**
+ * @brief Advance the experiment by one control tick
+ * @param tuner Experiment state
+ * @param nowNs Tick timestamp
+ * @param measured Measured speed (RPM)
+ * @return Setpoint to apply this tick
+ * @details Leaves AUTOTUNE_STEP for AUTOTUNE_DONE or AUTOTUNE_FAILED once
+ * the response is recorded
+ */
+uint16_t autotuneUpdate(Autotuner *tuner, uint64_t nowNs, int32_t measured);
+
+/**
+ * @brief Check whether an experiment is in progress
+ * @param tuner Experiment state
+ * @return 1 while settling or recording, 0 otherwise
+ */
+int autotuneActive(const Autotuner *tuner);
+
+/**
+ * @brief Identify the gains of a motor instance
+ * @param motor Motor handle (COMMUTATION_POLLED, INTERRUPT or FOC)
+ * @return 0 if the experiment was queued, -1 if the motor cannot be tuned,
+ *         no control tick runs or the command queue is full
+ * @note Starts the motor; the target speed applies again afterwards
+ */
+int motorInstanceAutotune(Motor *motor);
+
+/**
+ * @brief Get the experiment progress of a motor instance
+ * @param motor Motor handle
+ * @return Current state
+ */
+AutotuneState motorInstanceGetAutotuneState(const Motor *motor);
+
+/**
+ * @brief Get the identified plant and gains of a motor instance
+ * @param motor Motor handle
+ * @param result Receives the result
+ * @return 0 on success, -1 unless the last experiment completed
+ */
+int motorInstanceGetAutotuneResult(const Motor *motor, AutotuneResult *result);
+
+/**
+ * @brief Identify the gains of the default motor
+ * @return 0 if the experiment was queued, -1 otherwise
+ * @see motorInstanceAutotune()
+ */
+int motorAutotune(void);
+
+/**
+ * @brief Get the experiment progress of the default motor
+ * @return Current state, AUTOTUNE_IDLE before motorInit()
+ */
+AutotuneState motorGetAutotuneState(void);
+
+/**
+ * @brief Write identified gains as calibration text
+ * @param result Completed experiment result
+ * @param path Output file
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int autotuneSaveGains(const AutotuneResult *result, const char *path);
+
+#endif // AUTOTUNE_H
@@ -0,0 +1,119 @@
+/**
+ * @file Brake.h
+ * @brief Controlled deceleration to standstill
+ *
+ * motorInstanceStop() de-energizes the phases and the rotor coasts down on
+ * friction alone. motorInstanceBrake() stops it actively instead:
+ * - BRAKE_SHORT switches every low side on and the high sides off. The
+ *   back-EMF drives current through the windings, which dissipate the
+ *   energy; braking torque is highest at speed and fades towards rest.
+ * - BRAKE_REGEN keeps commutating and has the ramp generator take the
+ *   setpoint to zero at brakeDecel with no jerk limit. The regulator
+ *   lowers the duty below the back-EMF, the bridge runs as a synchronous
+ *   rectifier and the kinetic energy returns to the supply. Once the
+ *   profile reaches zero the last few RPM, where the back-EMF is too low
+ *   to recover anything, are taken out by a short brake.
+ *
+ * Regenerated energy raises the bus voltage unless the supply can absorb
+ * it. With a bus voltage channel the deceleration folds back linearly over
+ * the BRAKE_VOLTAGE_BAND_MV below busVoltageLimitMv. Once it has folded
+ * back below a quarter of brakeDecel the bus is not recovering, and
+ * braking continues as a short brake, which does not feed the bus.
+ *
+ * Both modes need low-side control (BRIDGE_3PWM or BRIDGE_6PWM) and Hall
+ * commutation, and advance in motorControlTick(), so the control loop (or
+ * an external tick) must be running. Short brake current is limited only
+ * by the winding impedance and does not pass the bus shunt; keep the
+ * speed at which it engages within what the bridge can carry.
+ *
+ * Once the rotor is at rest the motor is stopped exactly as by
+ * motorInstanceStop() and MOTOR_EVENT_STOPPED is raised. A start, a stop,
+ * a speed change or a protection trip ends braking early.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef BRAKE_H
+#define BRAKE_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/** @brief Default deceleration limit of regenerative braking in RPM per second */
+#ifndef BRAKE_DECEL_RPM_PER_S
+#define BRAKE_DECEL_RPM_PER_S 20000
+#endif
+
+/** @brief ADC channel of the bus voltage divider, -1 if not fitted */
+#ifndef BUS_VOLTAGE_ADC_CHANNEL
+#define BUS_VOLTAGE_ADC_CHANNEL -1
+#endif
+
+/** @brief Bus voltage scale per ADC count (1023 counts = 32.7 V) */
+#ifndef BUS_VOLTAGE_MV_PER_LSB
+#define BUS_VOLTAGE_MV_PER_LSB 32
+#endif
+
+/** @brief Default bus voltage at which regenerative braking stops decelerating */
+#ifndef BUS_VOLTAGE_LIMIT_MV
+#define BUS_VOLTAGE_LIMIT_MV (MOTOR_VOLTAGE * 1000 * 115 / 100)
+#endif
+
+/** @brief Bus voltage span over which the deceleration folds back */
+#ifndef BRAKE_VOLTAGE_BAND_MV
+#define BRAKE_VOLTAGE_BAND_MV 1000
+#endif
+
+/**
+ * @brief Braking modes
+ */
+typedef enum {
+    BRAKE_COAST = 0,   ///< De-energize the phases, same as motorInstanceStop()
+    BRAKE_SHORT,       ///< Low sides on until the rotor is at rest
+    BRAKE_REGEN        ///< Regenerative ramp to zero, then short brake
+} BrakeMode;
+
+/**
+ * @brief Deceleration limit of regenerative braking at a bus voltage
+ * @param decel Deceleration limit with the bus at or below limitMv - BRAKE_VOLTAGE_BAND_MV (RPM/s)
+ * @param busMv Measured bus voltage
+ * @param limitMv Bus voltage at which the deceleration reaches zero
+ * @return Deceleration limit (RPM/s), falling linearly to 0 at limitMv
+ */
+uint32_t brakeRegenDecel(uint32_t decel, int32_t busMv, uint32_t limitMv);
+
+/**
+ * @brief Brake a motor instance to standstill
+ * @param motor Motor handle
+ * @param mode Braking mode
+ * @return 0 if braking was queued, -1 if the mode is not supported by the
+ *         motor's bridge or commutation, no control tick runs or the
+ *         command queue is full
+ * @note BRAKE_COAST is always accepted and behaves like motorInstanceStop()
+ */
+int motorInstanceBrake(Motor *motor, BrakeMode mode);
+
+/**
+ * @brief Check whether a motor instance is braking
+ * @param motor Motor handle
+ * @return Active BrakeMode, BRAKE_COAST once stopped or while driving
+ */
+BrakeMode motorInstanceGetBrakeMode(const Motor *motor);
+
+/**
+ * @brief Brake the default motor to standstill
+ * @param mode Braking mode
+ * @return 0 if braking was queued, -1 otherwise
+ * @see motorInstanceBrake()
+ */
+int motorBrake(BrakeMode mode);
+
+/**
+ * @brief Check whether the default motor is braking
+ * @return Active BrakeMode, BRAKE_COAST before motorInit()
+ */
+BrakeMode motorGetBrakeMode(void);
+
+#endif // BRAKE_H
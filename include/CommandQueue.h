@@ -0,0 +1,107 @@
+/**
+ * @file CommandQueue.h
+ * @brief Lock-free single-producer/single-consumer motor command queue
+ *
+ * Motor API calls are turned into fixed-size commands and pushed onto a
+ * queue that the control loop drains at the start of every tick. Push and
+ * pop are O(1), never block and never take a lock, so the caller does not
+ * pay GPIO latency and the real-time thread never waits on the caller.
+ *
+ * Each queue has exactly one producer thread. Additional producers (for
+ * example a network front end) attach their own queue with
+ * motorAttachCommandQueue() rather than sharing one.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/** @brief Queue capacity in commands (power of two) */
+#ifndef COMMAND_QUEUE_SIZE
+#define COMMAND_QUEUE_SIZE 64
+#endif
+
+_Static_assert((COMMAND_QUEUE_SIZE & (COMMAND_QUEUE_SIZE - 1)) == 0,
+               "COMMAND_QUEUE_SIZE must be a power of two");
+
+/**
+ * @brief Command types understood by the control loop
+ */
+typedef enum {
+    MOTOR_CMD_SET_SPEED = 0,   ///< arg0 = target RPM
+    MOTOR_CMD_START,           ///< Enable commutation
+    MOTOR_CMD_STOP,            ///< De-energize all phases
+    MOTOR_CMD_SET_GAINS,       ///< arg0 = kp, arg1 = ki (Q16.16)
+    MOTOR_CMD_SET_RAMP,        ///< arg0 = accel (RPM/s, 0 ignores the command), arg1 = jerk (RPM/s^2)
+    MOTOR_CMD_AUTOTUNE,        ///< arg0 = baseline RPM, arg1 = step (RPM)
+    MOTOR_CMD_SET_SPEED_AT,    ///< arg0 = target RPM, arg1 = tick index (low 32 bits) to apply it on
+    MOTOR_CMD_BRAKE            ///< arg0 = BrakeMode
+} MotorCommandType;
+
+/**
+ * @brief Motor command
+ */
+typedef struct {
+    uint8_t type;     ///< MotorCommandType
+    uint8_t motor;    ///< Target motor pool index (motorInstanceGetIndex())
+    uint16_t flags;   ///< Reserved, 0
+    int32_t arg0;     ///< First argument
+    int32_t arg1;     ///< Second argument
+} MotorCommand;
+
+/**
+ * @brief SPSC ring buffer of commands
+ * @details head and tail are free-running counters on separate cache lines
+ * so producer and consumer never write the same line.
+ */
+typedef struct {
+    _Alignas(64) atomic_uint head;              ///< Next slot to write (producer)
+    _Alignas(64) atomic_uint tail;              ///< Next slot to read (consumer)
+    _Alignas(64) MotorCommand slots[COMMAND_QUEUE_SIZE]; ///< Command storage
+} CommandQueue;
+
+/**
+ * @brief Initialize an empty queue
+ * @param queue Queue to initialize
+ */
+void commandQueueInit(CommandQueue *queue);
+
+/**
+ * @brief Push a command (producer side)
+ * @param queue Queue
+ * @param command Command to copy into the queue
+ * @return 0 on success, -1 if the queue is full
+ */
+int commandQueuePush(CommandQueue *queue, const MotorCommand *command);
+
+/**
+ * @brief Pop the oldest command (consumer side)
+ * @param queue Queue
+ * @param command Destination for the command
+ * @return 1 if a command was popped, 0 if the queue is empty
+ */
+int commandQueuePop(CommandQueue *queue, MotorCommand *command);
+
+/**
+ * @brief Read the oldest command without removing it (consumer side)
+ * @param queue Queue
+ * @param command Destination for the command
+ * @return 1 if a command was read, 0 if the queue is empty
+ * @note The slot stays occupied until commandQueuePop()
+ */
+int commandQueuePeek(CommandQueue *queue, MotorCommand *command);
+
+/**
+ * @brief Check whether a queue holds no command (consumer side)
+ * @param queue Queue
+ * @return 1 if empty, 0 otherwise
+ */
+int commandQueueIsEmpty(CommandQueue *queue);
+
+#endif // COMMAND_QUEUE_H
@@ -0,0 +1,187 @@
+/**
+ * @file ControlLoop.h
+ * @brief Real-time periodic control loop
+ *
+ * Runs motorControlTick() from a dedicated SCHED_FIFO thread pinned to one
+ * CPU. The thread sleeps on absolute CLOCK_MONOTONIC deadlines so the period
+ * does not drift, with memory locked and its stack pre-faulted so no page
+ * faults occur once the loop is running.
+ *
+ * Several nodes can align their tick phase to a shared time base so that
+ * tick N happens at the same instant everywhere and motorInstanceSetSpeedAt()
+ * changes coordinated setpoints on the same tick:
+ * - CONTROL_SYNC_TAI schedules deadlines on whole multiples of the period in
+ *   CLOCK_TAI, which ptp4l/phc2sys keep aligned across the network. Tick N
+ *   is due at TAI N * period, so nodes agree on indices with no exchange.
+ * - CONTROL_SYNC_GPIO phase-locks CLOCK_MONOTONIC deadlines to a sync pulse
+ *   that a master drives to every node, one rising edge every syncPulseTicks
+ *   ticks. A pulse within a quarter period of the expected tick is absorbed
+ *   by slewing at most CONTROL_SYNC_SLEW_NS per tick; a larger error steps
+ *   the phase once. The pulse lands on a multiple of syncPulseTicks; which
+ *   one is taken from CLOCK_REALTIME rounded to the pulse period, so NTP
+ *   accuracy well within half a pulse period is enough for agreement.
+ *
+ * Without sync, indices count ticks since the loop started.
+ *
+ * Once motorControlIsIdle() has held for idleDelayMs (every motor stopped
+ * and at standstill, nothing queued or scheduled) the loop drops to
+ * idleRateHz, or with idleRateHz 0 sleeps until woken. controlLoopWake()
+ * ends the idle sleep; the motor API and Hall edge handlers call it, and
+ * so must any other command queue producer after pushing. The next tick
+ * then runs on the following deadline of the full-rate schedule, so the
+ * loop is back at full rate within one period and keeps its tick phase
+ * and indices.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef CONTROL_LOOP_H
+#define CONTROL_LOOP_H
+
+#include <stdint.h>
+
+/** @brief Default control loop rate in Hz */
+#ifndef CONTROL_LOOP_RATE_HZ
+#define CONTROL_LOOP_RATE_HZ 2000
+#endif
+
+/** @brief Default CPU the control thread is pinned to (-1 to disable pinning) */
+#ifndef CONTROL_LOOP_CPU
+#define CONTROL_LOOP_CPU 3
+#endif
+
+/** @brief Default SCHED_FIFO priority of the control thread */
+#ifndef CONTROL_LOOP_PRIORITY
+#define CONTROL_LOOP_PRIORITY 80
+#endif
+
+/** @brief Default ticks between two GPIO sync pulses */
+#ifndef CONTROL_SYNC_PULSE_TICKS
+#define CONTROL_SYNC_PULSE_TICKS CONTROL_LOOP_RATE_HZ  // 1 Hz
+#endif
+
+/** @brief Largest phase correction applied per tick while locked to the sync pulse */
+#ifndef CONTROL_SYNC_SLEW_NS
+#define CONTROL_SYNC_SLEW_NS 2000
+#endif
+
+/** @brief Missing pulses after which the loop reports itself unsynchronized */
+#define CONTROL_SYNC_LOST_PULSES 3
+
+/** @brief Default tick rate while every motor is idle, 0 to sleep until woken */
+#ifndef CONTROL_LOOP_IDLE_RATE_HZ
+#define CONTROL_LOOP_IDLE_RATE_HZ 10
+#endif
+
+/** @brief Default time the motors must stay idle before the rate drops, 0 to never drop it */
+#ifndef CONTROL_LOOP_IDLE_DELAY_MS
+#define CONTROL_LOOP_IDLE_DELAY_MS 200
+#endif
+
+/**
+ * @brief Shared time base the tick phase is aligned to
+ */
+typedef enum {
+    CONTROL_SYNC_NONE = 0,     ///< Free running; tick indices are local
+    CONTROL_SYNC_TAI,          ///< Deadlines on multiples of the period in CLOCK_TAI
+    CONTROL_SYNC_GPIO          ///< Phase locked to a sync pulse on syncPin
+} ControlLoopSync;
+
+/**
+ * @brief Control loop configuration
+ */
+typedef struct {
+    uint32_t rateHz;   ///< Tick rate in Hz
+    int cpu;           ///< CPU to pin the thread to, -1 for no affinity
+    int priority;      ///< SCHED_FIFO priority (1-99)
+    ControlLoopSync sync;      ///< Time base the ticks are aligned to
+    int syncPin;               ///< Sync pulse input (CONTROL_SYNC_GPIO), -1 if none
+    uint32_t syncPulseTicks;   ///< Ticks between sync pulses (CONTROL_SYNC_GPIO)
+    uint32_t idleRateHz;       ///< Tick rate while idle (at most rateHz), 0 to sleep until woken
+    uint32_t idleDelayMs;      ///< Idle time before the rate drops, 0 to always run at rateHz
+} ControlLoopConfig;
+
+/**
+ * @brief Control loop timing statistics
+ * @details Latency is measured from the scheduled deadline to the moment the
+ * thread starts the tick; compute time covers motorControlTick() itself.
+ */
+typedef struct {
+    uint64_t ticks;            ///< Ticks executed since start
+    uint64_t overruns;         ///< Ticks that finished after the next deadline
+    uint32_t periodNs;         ///< Configured tick period
+    uint32_t lastLatencyNs;    ///< Wake-up latency of the latest tick
+    uint32_t maxLatencyNs;     ///< Worst wake-up latency since start
+    uint32_t lastComputeNs;    ///< Tick compute time of the latest tick
+    uint32_t maxComputeNs;     ///< Worst tick compute time since start
+    uint8_t realtime;          ///< 1 if running under SCHED_FIFO
+    uint8_t synced;            ///< 1 while aligned to the configured time base
+    int32_t syncErrorNs;       ///< Latest sync pulse arrival minus its tick deadline
+    uint64_t syncSteps;        ///< Times the phase was stepped rather than slewed
+    uint64_t tickIndex;        ///< Index of the latest tick
+    uint8_t idle;              ///< 1 while running at the idle rate
+    uint64_t idlePeriods;      ///< Times the loop entered the idle rate
+    uint64_t wakeups;          ///< Idle sleeps ended by controlLoopWake()
+} ControlLoopStats;
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ */
+void controlLoopDefaultConfig(ControlLoopConfig *config);
+
+/**
+ * @brief Start the control loop thread
+ * @param config Loop configuration, or NULL for defaults
+ * @return 0 on success, -1 on failure or if already running
+ * @note Falls back to normal scheduling if SCHED_FIFO is not permitted
+ * @warning Requires root privileges (or CAP_SYS_NICE) for real-time scheduling
+ */
+int controlLoopStart(const ControlLoopConfig *config);
+
+/**
+ * @brief Stop the control loop thread and wait for it to exit
+ */
+void controlLoopStop(void);
+
+/**
+ * @brief Check whether the control loop is running
+ * @return 1 if running, 0 otherwise
+ */
+int controlLoopIsRunning(void);
+
+/**
+ * @brief Return the loop to its full rate if it is idling
+ * @note Cheap when the loop is not idle; safe from any thread, including
+ *       interrupt handlers
+ */
+void controlLoopWake(void);
+
+/**
+ * @brief Get a consistent snapshot of the loop timing statistics
+ * @param stats Destination for the snapshot
+ */
+void controlLoopGetStats(ControlLoopStats *stats);
+
+/**
+ * @brief Phase error of a sync pulse against the tick schedule
+ * @param pulseNs Pulse timestamp
+ * @param deadlineNs Any tick deadline on the same clock
+ * @param periodNs Tick period
+ * @param ticks Receives the offset of the tick nearest the pulse from deadlineNs, may be NULL
+ * @return Pulse time minus the nearest deadline, in (-periodNs/2, periodNs/2]
+ */
+int64_t controlSyncPhaseError(int64_t pulseNs, int64_t deadlineNs, int64_t periodNs, int64_t *ticks);
+
+/**
+ * @brief Tick index a sync pulse marks
+ * @param realtimeNs CLOCK_REALTIME at the pulse
+ * @param periodNs Tick period
+ * @param pulseTicks Ticks between pulses
+ * @return Multiple of pulseTicks whose nominal time is nearest realtimeNs
+ */
+uint64_t controlSyncPulseIndex(uint64_t realtimeNs, uint32_t periodNs, uint32_t pulseTicks);
+
+#endif // CONTROL_LOOP_H
@@ -0,0 +1,212 @@
+/**
+ * @file Foc.h
+ * @brief Field-oriented control with space-vector PWM
+ *
+ * Motors created with COMMUTATION_FOC replace the 60° commutation table with
+ * sinusoidal current control:
+ * - phase A/B currents are sampled through the motor's AdcBackend
+ * - Clarke and Park transforms give the rotor-frame currents id/iq
+ * - two PI loops drive id to zero and iq to the torque reference
+ * - the inverse Park transform and min/max-injection SVPWM produce the three
+ *   phase duties
+ * The rotor angle is interpolated between Hall edges from the averaged
+ * sector period, including any phase advance (see RotorAngle.h). The speed regulator keeps running in the control tick;
+ * its output duty becomes the iq reference (pwmRange = FOC_MAX_CURRENT_MA).
+ *
+ * All math is fixed point: angles are 16-bit turns (65536 = 360°
+ * electrical), sin/cos come from a Q15 lookup table, currents are in mA and
+ * voltages in PWM duty counts, so the bus voltage equals pwmRange. A
+ * dedicated service thread runs the current loop of every FOC motor at
+ * FOC_RATE_HZ.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef FOC_H
+#define FOC_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+#include "SpeedController.h"
+#include "SpeedEstimator.h"
+#include "RotorAngle.h"
+
+/** @brief Current loop rate in Hz */
+#ifndef FOC_RATE_HZ
+#define FOC_RATE_HZ 20000
+#endif
+
+/** @brief SCHED_FIFO priority of the current loop thread (above the control loop) */
+#ifndef FOC_PRIORITY
+#define FOC_PRIORITY 85
+#endif
+
+/** @brief CPU the current loop thread is pinned to (-1 to disable pinning) */
+#ifndef FOC_CPU
+#define FOC_CPU 3
+#endif
+
+/** @brief iq reference at full speed regulator output */
+#ifndef FOC_MAX_CURRENT_MA
+#define FOC_MAX_CURRENT_MA 10000
+#endif
+
+/** @brief Current sense scale per ADC count; mid-scale reads 0 A */
+#ifndef FOC_CURRENT_MA_PER_LSB
+#define FOC_CURRENT_MA_PER_LSB 32
+#endif
+
+/** @brief Current loop proportional gain (duty counts per mA) */
+#ifndef FOC_KP_Q16
+#define FOC_KP_Q16 Q16(0.01)
+#endif
+
+/** @brief Current loop integral gain (duty counts per mA per current loop period) */
+#ifndef FOC_KI_Q16
+#define FOC_KI_Q16 Q16(0.001)
+#endif
+
+/**
+ * @brief Rotor d-axis angle at the start of the first Hall sector (code 1)
+ * @details The default matches the Hall alignment commutationTable assumes
+ */
+#ifndef FOC_HALL_OFFSET_DEG
+#define FOC_HALL_OFFSET_DEG 240
+#endif
+
+/** @brief ADC channels of the phase A/B current sense amplifiers */
+#ifndef CURRENT_A_ADC_CHANNEL
+#define CURRENT_A_ADC_CHANNEL 3
+#endif
+#ifndef CURRENT_B_ADC_CHANNEL
+#define CURRENT_B_ADC_CHANNEL 4
+#endif
+
+/** @brief Phase current sense reading at 0 A, -1 for mid-scale of the ADC */
+#ifndef CURRENT_ZERO_OFFSET
+#define CURRENT_ZERO_OFFSET -1
+#endif
+
+/** @brief Convert degrees to a 16-bit electrical angle */
+#define FOC_ANGLE_DEG(deg) ROTOR_ANGLE_DEG(deg)
+
+/** @brief Fixed-point one in Q15 */
+#define FOC_Q15_ONE 32767
+
+/**
+ * @brief Current loop state of one motor
+ */
+typedef struct {
+    int32_t kp;            ///< Proportional gain, Q16.16
+    int32_t ki;            ///< Integral gain per current loop period, Q16.16
+    int32_t integD;        ///< d-axis integral term, Q16.16 duty counts
+    int32_t integQ;        ///< q-axis integral term, Q16.16 duty counts
+    int32_t vMax;          ///< Voltage vector limit (linear SVPWM range)
+    int32_t id;            ///< Latest d-axis current (mA)
+    int32_t iq;            ///< Latest q-axis current (mA)
+    int32_t vd;            ///< Latest d-axis voltage (duty counts)
+    int32_t vq;            ///< Latest q-axis voltage (duty counts)
+    uint16_t pwmRange;     ///< Duty full scale (bus voltage)
+    uint16_t duty[3];      ///< Latest phase A/B/C duties
+    uint8_t active;        ///< Phases are being driven
+} FocController;
+
+/**
+ * @brief Q15 sine
+ * @param angle 16-bit electrical angle
+ * @return sin(angle) in Q15
+ */
+int16_t focSin(uint16_t angle);
+
+/**
+ * @brief Q15 cosine
+ * @param angle 16-bit electrical angle
+ * @return cos(angle) in Q15
+ */
+int16_t focCos(uint16_t angle);
+
+/**
+ * @brief Clarke transform for a star-connected motor (ia + ib + ic = 0)
+ * @param ia Phase A current
+ * @param ib Phase B current
+ * @param alpha Stator alpha component
+ * @param beta Stator beta component
+ */
+void focClarke(int32_t ia, int32_t ib, int32_t *alpha, int32_t *beta);
+
+/**
+ * @brief Park transform into the rotor frame
+ * @param alpha Stator alpha component
+ * @param beta Stator beta component
+ * @param angle Rotor d-axis angle
+ * @param d Direct component
+ * @param q Quadrature component
+ */
+void focPark(int32_t alpha, int32_t beta, uint16_t angle, int32_t *d, int32_t *q);
+
+/**
+ * @brief Inverse Park transform into the stator frame
+ * @param d Direct component
+ * @param q Quadrature component
+ * @param angle Rotor d-axis angle
+ * @param alpha Stator alpha component
+ * @param beta Stator beta component
+ */
+void focInversePark(int32_t d, int32_t q, uint16_t angle, int32_t *alpha, int32_t *beta);
+
+/**
+ * @brief Space-vector PWM by min/max injection
+ * @param alpha Stator voltage alpha component (duty counts)
+ * @param beta Stator voltage beta component (duty counts)
+ * @param pwmRange Duty full scale
+ * @param duty Phase A/B/C duties (0-pwmRange)
+ * @details Linear up to a vector length of pwmRange / sqrt(3)
+ */
+void focSvpwm(int32_t alpha, int32_t beta, uint16_t pwmRange, uint16_t duty[3]);
+
+/**
+ * @brief Initialize a current loop
+ * @param foc Controller
+ * @param kp Proportional gain, Q16.16
+ * @param ki Integral gain per current loop period, Q16.16
+ * @param pwmRange Duty full scale
+ */
+void focControllerInit(FocController *foc, int32_t kp, int32_t ki, uint16_t pwmRange);
+
+/**
+ * @brief Clear the integrators and outputs of a current loop
+ * @param foc Controller
+ */
+void focControllerReset(FocController *foc);
+
+/**
+ * @brief Run one current loop iteration
+ * @param foc Controller
+ * @param ia Phase A current (mA)
+ * @param ib Phase B current (mA)
+ * @param angle Rotor d-axis angle
+ * @param idRef d-axis current reference (mA)
+ * @param iqRef q-axis current reference (mA)
+ * @return Phase A/B/C duties, also kept in foc->duty
+ */
+const uint16_t *focControllerStep(FocController *foc, int32_t ia, int32_t ib, uint16_t angle,
+                                  int32_t idRef, int32_t iqRef);
+
+/**
+ * @brief Start the current loop of a motor
+ * @param motor Motor created with COMMUTATION_FOC
+ * @return 0 on success, -1 if the service thread could not be started
+ * @note Used by motorCreate()
+ */
+int focAttach(Motor *motor);
+
+/**
+ * @brief Stop the current loop of a motor
+ * @param motor Motor handle
+ * @note Used by motorDestroy(); stops the service thread with the last motor
+ */
+void focDetach(Motor *motor);
+
+#endif // FOC_H
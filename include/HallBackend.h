@@ -0,0 +1,49 @@
+/**
+ * @file HallBackend.h
+ * @brief Pluggable Hall sensor input backends
+ *
+ * The motor driver samples the three Hall sensors through a HallBackend,
+ * which returns the packed 3-bit state (A << 2 | B << 1 | C) used to index
+ * the commutation table. Two implementations are provided:
+ * - gpiomemHallBackend: single load of the GPLEV0 register through a
+ *   /dev/gpiomem mapping; all three pins are sampled at the same instant
+ * - digitalReadHallBackend: three WiringPi digitalRead() calls (portable)
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef HALL_BACKEND_H
+#define HALL_BACKEND_H
+
+#include <stdint.h>
+
+/**
+ * @brief Hall sensor backend operations
+ * @note Pins are BCM GPIO numbers; pin mode and pull-ups are configured by
+ *       motorInit() before setup() is called
+ */
+typedef struct {
+    const char *name;                               ///< Human readable backend name
+    int (*setup)(int pinA, int pinB, int pinC);     ///< Prepare access; 0 on success, -1 on failure
+    uint8_t (*read)(int pinA, int pinB, int pinC);  ///< Packed Hall state (A << 2 | B << 1 | C)
+} HallBackend;
+
+/** @brief WiringPi digitalRead() backend */
+extern const HallBackend digitalReadHallBackend;
+
+/**
+ * @brief Memory-mapped GPIO register backend
+ * @note BCM2835/6/7/BCM2711 only, Hall pins must be in bank 0 (GPIO0-31).
+ *       Setup fails on other SoCs, including the Pi 5, and motorCreate()
+ *       falls back to digitalReadHallBackend.
+ */
+extern const HallBackend gpiomemHallBackend;
+
+/** @brief GPIO register window exposed without root by the kernel */
+#ifndef GPIOMEM_DEVICE
+#define GPIOMEM_DEVICE "/dev/gpiomem"
+#endif
+
+#endif // HALL_BACKEND_H
@@ -0,0 +1,141 @@
+/**
+ * @file HallValidator.h
+ * @brief Hall sequence validation and glitch filtering
+ *
+ * Every Hall sample passes through a validator before it reaches the speed
+ * estimator or the commutation table. A sample is accepted when it is the
+ * current sector or one of its two neighbours in the 6-step sequence
+ * (1-3-2-6-4-5 forward). Everything else is rejected and counted:
+ * - invalid codes (0 and 7), e.g. a broken wire or a missing pull-up
+ * - illegal jumps that skip a sector, which a rotating rotor cannot produce
+ * - glitch pulses: a neighbouring code that does not persist for the
+ *   debounce window after its edge
+ *
+ * A neighbouring code read by a Hall edge handler (hallValidatorEdge()) is
+ * accepted at once: the handler runs well after the edge, so a code still
+ * present by then has outlasted any glitch, and commutation keeps its edge
+ * latency from standstill on. For periodic samples (hallValidatorSample()),
+ * an edge in the direction of travel that arrives once it is due
+ * (HALL_EDGE_DUE_PCT of the averaged sector period after the last one) is
+ * accepted at once. Any other neighbouring code becomes a candidate that a
+ * later sample, at least the debounce window after it, confirms; the sector
+ * is then entered with the candidate's timestamp, so the speed estimate
+ * does not see the confirmation delay.
+ *
+ * A rejected sample keeps the last valid sector, so isolated noise never
+ * reaches the phases. While the rotor is turning, a rejected sample that
+ * arrives once the next edge is due (one averaged sector period after the
+ * last one) advances the sector in the direction of travel instead, so a
+ * single lost edge does not stall commutation. HALL_MAX_BAD_SAMPLES
+ * rejected samples in a row mean the sensors are lost; the motor then
+ * latches MOTOR_FAULT_HALL.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef HALL_VALIDATOR_H
+#define HALL_VALIDATOR_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/**
+ * @brief Time a new Hall code must persist before it is accepted, 0 to disable
+ * @details Applies to periodically sampled codes that arrive before their
+ * edge is due. Nothing waits for the window: the next Hall edge or control
+ * tick decides.
+ */
+#ifndef HALL_DEBOUNCE_NS
+#define HALL_DEBOUNCE_NS 2000
+#endif
+
+/** @brief Longest debounce window accepted by motorCreate() */
+#define HALL_DEBOUNCE_MAX_NS 50000
+
+/** @brief Share of the averaged sector period after which the next edge is due (percent) */
+#ifndef HALL_EDGE_DUE_PCT
+#define HALL_EDGE_DUE_PCT 75
+#endif
+
+/** @brief Consecutive rejected samples after which the Hall sensors count as lost */
+#ifndef HALL_MAX_BAD_SAMPLES
+#define HALL_MAX_BAD_SAMPLES 8
+#endif
+
+/**
+ * @brief Hall fault counters since the motor was created
+ */
+typedef struct {
+    uint32_t invalid;        ///< Samples reading 0 or 7
+    uint32_t illegal;        ///< Samples skipping one or more sectors
+    uint32_t glitches;       ///< New codes that did not last the debounce window
+    uint32_t extrapolated;   ///< Sectors advanced from speed over a rejected sample
+} HallFaultCounts;
+
+/**
+ * @brief Hall validator state
+ */
+typedef struct {
+    uint8_t state;           ///< Last accepted Hall code, 0 until the first valid sample
+    int8_t direction;        ///< 1 forward, -1 reverse, 0 unknown
+    uint8_t candidate;       ///< Neighbouring code awaiting the debounce window, 0 if none
+    uint8_t badRun;          ///< Consecutive rejected samples
+    uint32_t debounceNs;     ///< Debounce window
+    uint64_t lastEdgeNs;     ///< Time the current sector was entered
+    uint64_t candidateNs;    ///< Time the candidate code was first seen
+    HallFaultCounts counts;  ///< Fault counters
+} HallValidator;
+
+/**
+ * @brief Initialize a Hall validator
+ * @param v Validator
+ * @param debounceNs Debounce window, 0 to accept neighbouring codes at once
+ */
+void hallValidatorInit(HallValidator *v, uint32_t debounceNs);
+
+/**
+ * @brief Feed a raw Hall sample
+ * @param v Validator
+ * @param raw Packed Hall state from the backend
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param sectorPeriodNs Averaged sector period, 0 if not rotating
+ * @return Validated Hall code (1-6), 0 until a valid sample was seen
+ */
+uint8_t hallValidatorSample(HallValidator *v, uint8_t raw, uint64_t nowNs, uint32_t sectorPeriodNs);
+
+/**
+ * @brief Feed a Hall sample read in a Hall edge handler
+ * @param v Validator
+ * @param raw Packed Hall state from the backend
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param sectorPeriodNs Averaged sector period, 0 if not rotating
+ * @return Validated Hall code (1-6), 0 until a valid sample was seen
+ * @details Same checks as hallValidatorSample(), except that a neighbouring
+ * code is accepted without waiting for the debounce window.
+ */
+uint8_t hallValidatorEdge(HallValidator *v, uint8_t raw, uint64_t nowNs, uint32_t sectorPeriodNs);
+
+/**
+ * @brief Check whether a new code is waiting for the debounce window
+ * @param v Validator
+ * @return 1 if a sample at or after candidateNs + debounceNs decides it, 0 otherwise
+ */
+int hallValidatorPending(const HallValidator *v);
+
+/**
+ * @brief Check whether the Hall sensors count as lost
+ * @param v Validator
+ * @return 1 after HALL_MAX_BAD_SAMPLES rejected samples in a row, 0 otherwise
+ */
+int hallValidatorLost(const HallValidator *v);
+
+/**
+ * @brief Get the Hall fault counters of a motor instance
+ * @param motor Motor handle
+ * @param counts Receives the counters
+ */
+void motorInstanceGetHallFaults(const Motor *motor, HallFaultCounts *counts);
+
+#endif // HALL_VALIDATOR_H
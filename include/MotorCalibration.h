@@ -0,0 +1,133 @@
+/**
+ * @file MotorCalibration.h
+ * @brief Binary motor configuration and calibration file
+ *
+ * Pins, limits, gains and sensor calibration of a motor variant live in a
+ * fixed-layout binary file instead of the compile-time defaults, so one
+ * build serves every variant. motorInit() maps the file read-only and
+ * validates it in place: no parsing and no copy beyond the final
+ * MotorConfig, so loading costs a few microseconds. A missing file leaves
+ * the defaults in place; a file that is present but fails validation makes
+ * motorInit() fail rather than drive the wrong pins.
+ *
+ * The file is a single MotorCalibration record, all fields native endian
+ * and fixed width with no padding. A CRC-32 over everything after the
+ * header guards against truncation and corruption; the layout version is
+ * bumped on any incompatible change. The host tool motor_calibrate compiles
+ * it from "key = value" text (see tools/motor_calibrate.c), and
+ * autotuneSaveGains() writes that same text.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_CALIBRATION_H
+#define MOTOR_CALIBRATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "MotorControl.h"
+
+/** @brief File loaded by motorInit() unless motorSetCalibrationPath() is called */
+#ifndef CALIBRATION_PATH
+#define CALIBRATION_PATH "/etc/motorcontrol/calibration.bin"
+#endif
+
+/** @brief Header magic, "MCAL" */
+#define CALIBRATION_MAGIC 0x4C41434DU
+
+/** @brief Layout version, bumped on any incompatible change */
+#define CALIBRATION_VERSION 2
+
+/** @brief Header fields preceding the CRC-protected payload */
+#define CALIBRATION_HEADER_SIZE 16
+
+/**
+ * @brief Calibration file layout
+ * @details Pin fields use -1 for "not connected"
+ */
+typedef struct {
+    uint32_t magic;              ///< CALIBRATION_MAGIC
+    uint16_t version;            ///< CALIBRATION_VERSION
+    uint16_t reserved;           ///< 0
+    uint32_t size;               ///< sizeof(MotorCalibration)
+    uint32_t crc;                ///< CRC-32 of the bytes after this field
+
+    int16_t phasePins[3];        ///< Phase A/B/C output pins
+    int16_t hallPins[3];         ///< Hall A/B/C input pins
+    int16_t lowSidePins[3];      ///< Low-side inputs (BRIDGE_6PWM)
+    int16_t enablePins[3];       ///< Driver enable pins (BRIDGE_3PWM, sensorless)
+    int16_t faultPin;            ///< Overcurrent comparator input
+    uint16_t maxRpm;             ///< Speed limit (RPM)
+    uint16_t pwmRange;           ///< PWM resolution
+    uint8_t numPoles;            ///< Motor pole count
+    uint8_t bridge;              ///< BridgeMode
+    uint32_t deadTimeNs;         ///< Commutation dead time
+    uint32_t hallDebounceNs;     ///< Hall debounce window
+    uint32_t currentLimitMa;     ///< ADC overcurrent trip level
+    int32_t kp;                  ///< Speed loop proportional gain, Q16.16
+    int32_t ki;                  ///< Speed loop integral gain per tick, Q16.16
+    uint32_t rampAccel;          ///< Ramp acceleration limit (RPM/s, at least 1)
+    uint32_t rampJerk;           ///< Ramp jerk limit (RPM/s^2)
+    uint16_t hallAngles[6];      ///< Measured rotor angle at each forward Hall sector start
+    int16_t currentOffsets[2];   ///< Phase A/B current sense reading at 0 A, -1 for mid-scale
+    uint16_t phaseAdvance;       ///< Rotor angle advance at maxRpm
+    uint16_t reserved2;          ///< 0
+} MotorCalibration;
+
+_Static_assert(offsetof(MotorCalibration, phasePins) == CALIBRATION_HEADER_SIZE,
+               "calibration header size changed");
+_Static_assert(sizeof(MotorCalibration) == 96, "calibration layout changed; bump CALIBRATION_VERSION");
+
+/**
+ * @brief Fill a record with the compile-time defaults
+ * @param cal Record to initialize (sealed)
+ */
+void calibrationDefaults(MotorCalibration *cal);
+
+/**
+ * @brief Set the header fields and checksum of a record
+ * @param cal Record to seal
+ */
+void calibrationSeal(MotorCalibration *cal);
+
+/**
+ * @brief Check a record in memory
+ * @param data Record bytes
+ * @param size Number of bytes available
+ * @return 0 if magic, version, size and CRC match, -1 otherwise
+ */
+int calibrationValidate(const void *data, size_t size);
+
+/**
+ * @brief Map and validate a calibration file
+ * @param path File to map
+ * @param cal Receives the read-only mapping on success
+ * @return 0 on success, 1 if the file does not exist, -1 if it is invalid
+ * @note Release with calibrationUnmap()
+ */
+int calibrationMap(const char *path, const MotorCalibration **cal);
+
+/**
+ * @brief Release a mapping from calibrationMap()
+ * @param cal Mapped record
+ */
+void calibrationUnmap(const MotorCalibration *cal);
+
+/**
+ * @brief Apply a record to a motor configuration
+ * @param cal Validated record
+ * @param config Configuration to update; backends and modes are kept
+ */
+void calibrationApply(const MotorCalibration *cal, MotorConfig *config);
+
+/**
+ * @brief Select the calibration file loaded by motorInit()
+ * @param path File path, or NULL to load none
+ * @return 0 on success, -1 if the default motor already exists
+ * @note Must be called before motorInit()
+ */
+int motorSetCalibrationPath(const char *path);
+
+#endif // MOTOR_CALIBRATION_H
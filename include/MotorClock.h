@@ -0,0 +1,37 @@
+/**
+ * @file MotorClock.h
+ * @brief Monotonic time base shared by the motor control modules
+ *
+ * Normally CLOCK_MONOTONIC. A simulation can install its own source with
+ * motorClockSetSource() so the controller runs on simulated time, faster
+ * or slower than the wall clock.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_CLOCK_H
+#define MOTOR_CLOCK_H
+
+#include <stdint.h>
+
+/** @brief Replacement time source, returning nanoseconds */
+typedef uint64_t (*MotorClockSource)(void);
+
+/**
+ * @brief Current monotonic time
+ * @return Nanoseconds since an arbitrary fixed point (CLOCK_MONOTONIC)
+ * @note Served from the vDSO, safe to call from the control loop and ISRs
+ */
+uint64_t motorClockNs(void);
+
+/**
+ * @brief Replace the time source used by motorClockNs()
+ * @param source Time source, or NULL to restore CLOCK_MONOTONIC
+ * @note Set it before any motor is created; the real-time control loop
+ *       thread always schedules on CLOCK_MONOTONIC
+ */
+void motorClockSetSource(MotorClockSource source);
+
+#endif // MOTOR_CLOCK_H
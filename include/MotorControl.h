@@ -16,6 +16,10 @@
 #define MOTOR_CONTROL_H
 
 #include <stdint.h>
+#include "PwmBackend.h"
+#include "HallBackend.h"
+#include "AdcBackend.h"
+#include "CommandQueue.h"
 
 /** @brief Motor voltage in volts */
 #define MOTOR_VOLTAGE 24
@@ -32,14 +36,22 @@
 /** @brief PWM resolution */
 #define PWM_RANGE 1024  // PWM resolution
 
+/*
+ * Pin numbers below are BCM GPIO numbers. The default pinout and
+ * PWM_SYSFS_CHANNEL_MAP target the Raspberry Pi 5 (BCM2712 with RP1). The
+ * /dev/gpiomem register paths (gpiomemHallBackend, the overcurrent trip
+ * store) exist on BCM2835-BCM2711 boards only; they detect the SoC at setup
+ * and fall back to digitalRead()/digitalWrite() elsewhere (see MotorSoc.h).
+ */
+
 /** @brief GPIO pin for Phase A (PWM capable) */
-#define PHASE_A_PIN 18  // PWM0
+#define PHASE_A_PIN 18  // PWM0 channel 2 on RP1
 
 /** @brief GPIO pin for Phase B (PWM capable) */
-#define PHASE_B_PIN 19  // PWM1
+#define PHASE_B_PIN 19  // PWM0 channel 3 on RP1
 
 /** @brief GPIO pin for Phase C (PWM capable) */
-#define PHASE_C_PIN 20  // PWM2
+#define PHASE_C_PIN 12  // PWM0 channel 0 on RP1
 
 /** @brief GPIO pin for Hall sensor A */
 #define HALL_A_PIN 23
@@ -50,6 +62,286 @@
 /** @brief GPIO pin for Hall sensor C */
 #define HALL_C_PIN 25
 
+/**
+ * @brief Commutation trigger modes
+ * @details Selects what drives updateCommutation()
+ */
+typedef enum {
+    COMMUTATION_POLLED = 0,   ///< Commutation runs only when called (motorSetSpeed/motorStart)
+    COMMUTATION_INTERRUPT,    ///< Commutation runs on every Hall sensor edge
+    COMMUTATION_SENSORLESS,   ///< Commutation follows back-EMF zero crossings (see Sensorless.h)
+    COMMUTATION_FOC           ///< Sinusoidal field-oriented current control (see Foc.h)
+} CommutationMode;
+
+/**
+ * @brief Power stage wiring
+ * @details Selects how commutation states map onto the gate driver inputs
+ */
+typedef enum {
+    BRIDGE_HIGH_SIDE = 0,     ///< One PWM input per phase, commutationTable patterns (no low-side control)
+    BRIDGE_3PWM,              ///< PWM + enable per phase; the driver switches both sides with its own dead time (DRV8302 M_PWM=1)
+    BRIDGE_6PWM               ///< Separate high-side PWM and low-side enable per phase (IR2101 HIN/LIN)
+} BridgeMode;
+
+/** @brief Maximum number of motors driven by one process */
+#ifndef MOTOR_MAX_INSTANCES
+#define MOTOR_MAX_INSTANCES 4  // One Hall and one fault edge trampoline per slot
+#endif
+
+/**
+ * @brief Specialize the hot path for the compile-time motor configuration
+ * @details Set by the MOTOR_FIXED_CONFIG CMake option for single-variant
+ * builds. Every motor must then run with PWM_RANGE and MOTOR_MAX_RPM, which
+ * motorCreate() enforces, so duty scaling compiles to constant multiplies
+ * and the 6-step pass extracts phase patterns from packed constants instead
+ * of loading the commutation tables. Pins, gains and calibration stay
+ * configurable.
+ */
+#ifndef MOTOR_FIXED_CONFIG
+#define MOTOR_FIXED_CONFIG 0
+#endif
+
+/** @brief Maximum number of command queues drained by the control loop */
+#ifndef MOTOR_MAX_COMMAND_QUEUES
+#define MOTOR_MAX_COMMAND_QUEUES 4
+#endif
+
+/** @brief PWM backend used unless motorSetPwmBackend() is called */
+#ifndef DEFAULT_PWM_BACKEND
+#define DEFAULT_PWM_BACKEND softPwmBackend
+#endif
+
+/** @brief Hall backend used unless motorSetHallBackend() is called */
+#ifndef DEFAULT_HALL_BACKEND
+#define DEFAULT_HALL_BACKEND gpiomemHallBackend
+#endif
+
+/** @brief Power stage wiring used by motorDefaultConfig() */
+#ifndef DEFAULT_BRIDGE_MODE
+#define DEFAULT_BRIDGE_MODE BRIDGE_HIGH_SIDE
+#endif
+
+/** @brief Delay between switching a bridge leg off and the next one on at commutation */
+#ifndef BRIDGE_DEAD_TIME_NS
+#define BRIDGE_DEAD_TIME_NS 500
+#endif
+
+/** @brief Low-side input pins (BCM) for BRIDGE_6PWM, -1 if unused */
+#ifndef PHASE_A_LOW_PIN
+#define PHASE_A_LOW_PIN -1
+#endif
+#ifndef PHASE_B_LOW_PIN
+#define PHASE_B_LOW_PIN -1
+#endif
+#ifndef PHASE_C_LOW_PIN
+#define PHASE_C_LOW_PIN -1
+#endif
+
+/** @brief Back-EMF ADC backend used by sensorless motors */
+#ifndef DEFAULT_ADC_BACKEND
+#define DEFAULT_ADC_BACKEND mcp3008AdcBackend
+#endif
+
+/** @brief Commutation mode used by motorInit() */
+#ifndef DEFAULT_COMMUTATION_MODE
+#define DEFAULT_COMMUTATION_MODE COMMUTATION_INTERRUPT
+#endif
+
+/**
+ * @brief Per-motor hardware and tuning configuration
+ * @details motorDefaultConfig() fills it from the compile-time defaults above
+ */
+typedef struct {
+    int phasePins[3];                 ///< Phase A/B/C output pins
+    int hallPins[3];                  ///< Hall A/B/C input pins
+    uint16_t maxRpm;                  ///< Speed limit (RPM)
+    uint8_t numPoles;                 ///< Motor pole count
+    uint16_t pwmRange;                ///< PWM resolution
+    CommutationMode commutationMode;  ///< Commutation trigger
+    const PwmBackend *pwm;            ///< Phase output backend
+    const HallBackend *hall;          ///< Hall sensor backend
+    uint32_t hallDebounceNs;          ///< Time a new Hall code must persist, 0 to disable
+    BridgeMode bridge;                ///< Power stage wiring
+    uint32_t deadTimeNs;              ///< Commutation dead time (BRIDGE_3PWM/BRIDGE_6PWM)
+    int lowSidePins[3];               ///< Phase A/B/C low-side inputs (BRIDGE_6PWM)
+    int enablePins[3];                ///< Phase A/B/C driver enable pins (BRIDGE_3PWM, sensorless)
+    int adcChannels[3];               ///< Phase A/B/C back-EMF ADC channels (sensorless only)
+    int currentChannels[2];           ///< Phase A/B current sense ADC channels (FOC only)
+    int currentOffsets[2];            ///< Phase A/B current sense reading at 0 A, -1 for mid-scale (FOC only)
+    uint16_t hallAngles[6];           ///< Rotor angle at each forward Hall sector start (see RotorAngle.h)
+    uint16_t phaseAdvance;            ///< Rotor angle advance at maxRpm, 16-bit angle (see RotorAngle.h)
+    const AdcBackend *adc;            ///< Back-EMF or current sampling backend (sensorless/FOC only)
+    int faultPin;                     ///< Overcurrent comparator input (active low), -1 if none
+    int busCurrentChannel;            ///< Bus current ADC channel, -1 if none
+    uint32_t currentLimitMa;          ///< ADC overcurrent trip level, 0 to disable
+    int32_t kp;                       ///< Speed loop proportional gain, Q16.16
+    int32_t ki;                       ///< Speed loop integral gain per tick, Q16.16
+    uint32_t rampAccel;               ///< Ramp acceleration limit (RPM/s, at least 1)
+    uint32_t rampJerk;                ///< Ramp jerk limit (RPM/s^2), 0 for trapezoidal
+    uint32_t brakeDecel;              ///< Regenerative braking deceleration limit (RPM/s, at least 1, see Brake.h)
+    int busVoltageChannel;            ///< Bus voltage ADC channel, -1 if none
+    uint32_t busVoltageLimitMv;       ///< Bus voltage at which regenerative braking stops
+} MotorConfig;
+
+/**
+ * @brief Motor instance handle
+ * @details Instances live in a fixed, contiguous pool of MOTOR_MAX_INSTANCES
+ * entries which the control loop services in one pass per tick.
+ */
+typedef struct Motor Motor;
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ * @note Uses the backends selected with motorSetPwmBackend()/motorSetHallBackend()
+ */
+void motorDefaultConfig(MotorConfig *config);
+
+/**
+ * @brief Create and initialize a motor instance
+ * @param config Hardware and tuning configuration
+ * @return Motor handle, or NULL on failure or if the pool is exhausted
+ * @note The motor starts stopped
+ * @warning Requires root privileges for GPIO access
+ */
+Motor *motorCreate(const MotorConfig *config);
+
+/**
+ * @brief Stop a motor, release its pins and return its slot to the pool
+ * @param motor Motor handle
+ * @note Hall edge handlers cannot be removed in WiringPi; they become no-ops
+ * @note While the control loop runs, the stop is applied by the loop thread
+ *       and this call waits until it has been
+ */
+void motorDestroy(Motor *motor);
+
+/*
+ * Commands (set speed, start, stop, gains, ramp limits) are queued to the
+ * control loop while it runs and return immediately; otherwise they take
+ * effect on the caller's thread. All calls must come from a single thread;
+ * other threads use their own queue via motorAttachCommandQueue().
+ */
+
+/**
+ * @brief Set the speed of a motor instance
+ * @param motor Motor handle
+ * @param rpm Desired speed (0-maxRpm)
+ * @return 0 on success, -1 if the command queue is full
+ * @see motorSetSpeed()
+ */
+int motorInstanceSetSpeed(Motor *motor, uint16_t rpm);
+
+/**
+ * @brief Set the speed of a motor instance on a given control tick
+ * @param motor Motor handle
+ * @param rpm Desired speed (0-maxRpm)
+ * @param tickIndex Tick on which the new target takes effect (see motorControlGetTickIndex())
+ * @return 0 on success, -1 if the command queue is full
+ * @details With a synchronized control loop (ControlLoopConfig::sync) tick
+ * indices agree across nodes, so ramps scheduled for the same index start
+ * together. One change per motor can be pending: a later call replaces it,
+ * and an immediate motorInstanceSetSpeed() or a stop cancels it. A tick
+ * index already past applies on the next tick.
+ */
+int motorInstanceSetSpeedAt(Motor *motor, uint16_t rpm, uint64_t tickIndex);
+
+/**
+ * @brief Start a motor instance
+ * @param motor Motor handle
+ * @return 0 on success, -1 if a fault is latched or the command queue is full
+ * @see motorStart()
+ */
+int motorInstanceStart(Motor *motor);
+
+/**
+ * @brief Stop a motor instance
+ * @param motor Motor handle
+ * @return 0 (a stop is never dropped)
+ * @see motorStop()
+ */
+int motorInstanceStop(Motor *motor);
+
+/**
+ * @brief Get the measured speed of a motor instance
+ * @param motor Motor handle
+ * @return Measured speed in RPM
+ */
+uint16_t motorInstanceGetSpeed(const Motor *motor);
+
+/**
+ * @brief Get the requested speed of a motor instance
+ * @param motor Motor handle
+ * @return Last speed passed to motorInstanceSetSpeed() while it is queued,
+ *         otherwise the target the control loop applied last (RPM)
+ */
+uint16_t motorInstanceGetTargetSpeed(const Motor *motor);
+
+/**
+ * @brief Get the ramp profile speed of a motor instance
+ * @param motor Motor handle
+ * @return Profile speed in RPM
+ */
+uint16_t motorInstanceGetRampSpeed(const Motor *motor);
+
+/**
+ * @brief Check whether a motor instance is still ramping
+ * @param motor Motor handle
+ * @return 1 while ramping, 0 once the target is reached
+ */
+int motorInstanceIsRamping(const Motor *motor);
+
+/**
+ * @brief Set the speed regulator gains of a motor instance
+ * @param motor Motor handle
+ * @param kp Proportional gain, Q16.16 duty counts per RPM
+ * @param ki Integral gain, Q16.16 duty counts per RPM per control tick
+ * @return 0 on success, -1 if the command queue is full
+ */
+int motorInstanceSetSpeedGains(Motor *motor, int32_t kp, int32_t ki);
+
+/**
+ * @brief Set the speed ramp limits of a motor instance
+ * @param motor Motor handle
+ * @param accelRpmPerSec Acceleration limit in RPM/s, at least 1
+ * @param jerkRpmPerSec2 Jerk limit in RPM/s^2, 0 for a trapezoidal profile
+ * @return 0 on success, -1 if accelRpmPerSec is 0 or the command queue is full
+ */
+int motorInstanceSetRampLimits(Motor *motor, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2);
+
+/**
+ * @brief Get the pool index of a motor instance
+ * @param motor Motor handle
+ * @return Index used in MotorCommand::motor
+ */
+int motorInstanceGetIndex(const Motor *motor);
+
+/**
+ * @brief Attach an additional command queue drained by the control loop
+ * @param queue Initialized queue owned by a single producer thread
+ * @return 0 on success, -1 if MOTOR_MAX_COMMAND_QUEUES are already attached
+ * @note Queues cannot be detached; keep them alive for the process lifetime
+ * @note Call controlLoopWake() after pushing so an idle loop reacts within a tick
+ */
+int motorAttachCommandQueue(CommandQueue *queue);
+
+/**
+ * @brief Update phase commutation of a motor instance
+ * @param motor Motor handle
+ * @see updateCommutation()
+ */
+void motorInstanceUpdateCommutation(Motor *motor);
+
+/**
+ * @brief Get the motor created by motorInit()
+ * @return Default motor handle, or NULL before motorInit()
+ */
+Motor *motorGetDefault(void);
+
+/*
+ * Single-motor API. These functions operate on the motor created by
+ * motorInit() from the compile-time pin and limit #defines.
+ */
+
 /**
  * @brief Initialize motor control hardware
  * @return 0 on success, -1 on failure
@@ -58,14 +350,73 @@
  */
 int motorInit(void);
 
+/**
+ * @brief Initialize motor control hardware with a specific commutation mode
+ * @param mode COMMUTATION_POLLED or COMMUTATION_INTERRUPT
+ * @return 0 on success, -1 on failure
+ * @note In interrupt mode, edge handlers are registered on all three Hall pins
+ * @note Pins, limits and gains come from CALIBRATION_PATH when that file
+ *       exists; an invalid file fails initialization (see MotorCalibration.h)
+ * @warning Requires root privileges for GPIO access
+ */
+int motorInitWithMode(CommutationMode mode);
+
+/**
+ * @brief Get the active commutation mode
+ * @return Mode selected at initialization
+ */
+CommutationMode motorGetCommutationMode(void);
+
+/**
+ * @brief Select the PWM backend driving the phase pins
+ * @param backend Backend to use (e.g. &softPwmBackend, &sysfsPwmBackend)
+ * @return 0 on success, -1 if backend is NULL or the pins are already claimed
+ * @note Must be called before motorInit()
+ */
+int motorSetPwmBackend(const PwmBackend *backend);
+
+/**
+ * @brief Select the backend sampling the Hall sensors
+ * @param backend Backend to use (e.g. &gpiomemHallBackend, &digitalReadHallBackend)
+ * @return 0 on success, -1 if backend is NULL
+ * @note Must be called before motorInit(). If the backend cannot be set up,
+ *       motorInit() falls back to digitalReadHallBackend.
+ */
+int motorSetHallBackend(const HallBackend *backend);
+
+/**
+ * @brief Set the speed regulator gains
+ * @param kp Proportional gain, Q16.16 duty counts per RPM
+ * @param ki Integral gain, Q16.16 duty counts per RPM per control tick
+ * @note Defaults are SPEED_KP_Q16 and SPEED_KI_Q16
+ */
+void motorSetSpeedGains(int32_t kp, int32_t ki);
+
+/**
+ * @brief Set the speed ramp limits
+ * @param accelRpmPerSec Acceleration limit in RPM/s, at least 1 (0 is ignored)
+ * @param jerkRpmPerSec2 Jerk limit in RPM/s^2, 0 for a trapezoidal profile
+ * @note Defaults are RAMP_ACCEL_RPM_PER_S and RAMP_JERK_RPM_PER_S2
+ */
+void motorSetRampLimits(uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2);
+
 /**
  * @brief Set motor speed with safety constraints
  * @param rpm Desired speed (0-MOTOR_MAX_RPM)
- * @note Implements soft ramping for speed changes
- * @warning Speed changes are rate-limited
+ * @note Implements soft ramping for speed changes: while the control loop
+ *       runs, returns immediately and the loop follows a jerk-limited profile
+ * @warning Speed changes are rate-limited (see motorSetRampLimits())
  */
 void motorSetSpeed(uint16_t rpm);
 
+/**
+ * @brief Set motor speed on a given control tick
+ * @param rpm Desired speed (0-MOTOR_MAX_RPM)
+ * @param tickIndex Tick on which the new target takes effect
+ * @see motorInstanceSetSpeedAt()
+ */
+void motorSetSpeedAt(uint16_t rpm, uint64_t tickIndex);
+
 /**
  * @brief Stop the motor
  * @details Immediately stops motor by de-energizing all phases
@@ -80,15 +431,78 @@ void motorStart(void);
 
 /**
  * @brief Get current motor speed
- * @return Current speed in RPM
+ * @return Measured speed in RPM, derived from Hall edge timing
  */
 uint16_t motorGetSpeed(void);
 
+/**
+ * @brief Get the requested motor speed
+ * @return Last speed passed to motorSetSpeed() in RPM
+ */
+uint16_t motorGetTargetSpeed(void);
+
+/**
+ * @brief Get the speed the ramp generator is currently commanding
+ * @return Profile speed in RPM
+ */
+uint16_t motorGetRampSpeed(void);
+
+/**
+ * @brief Check whether a speed change is still being ramped
+ * @return 1 while the profile has not reached motorGetTargetSpeed(), 0 otherwise
+ */
+int motorIsRamping(void);
+
 /**
  * @brief Update motor phase commutation
  * @details Reads Hall sensors and applies appropriate phase pattern
- * @note Only operates when motor is running (isRunning == 1)
+ * @note Only drives the phases when motor is running (isRunning == 1); Hall
+ *       edges are still timestamped while stopped so coasting speed is tracked
+ * @note In COMMUTATION_INTERRUPT mode this also runs from the Hall edge handlers
  */
 void updateCommutation(void);
 
+/**
+ * @brief Declare that the application calls motorControlTick() itself
+ * @param enabled 1 if motorControlTick() is driven externally, 0 otherwise
+ * @details Speed changes then follow the ramp and speed regulator exactly as
+ * with the control loop thread, instead of applying the open-loop duty
+ * directly. Commands still execute on the calling thread.
+ */
+void motorSetExternalTick(int enabled);
+
+/**
+ * @brief Run one control loop iteration for every motor instance
+ * @details Called by the control loop thread at CONTROL_LOOP_RATE_HZ.
+ * Drains the command queues, then gathers every motor's Hall state, speed
+ * estimate and ramp setpoint into the structure-of-arrays hot state, runs the PI regulator and commutation
+ * as single batched passes over all slots, then writes the phase outputs.
+ * Running every tick also catches any edge the interrupt path may have
+ * missed.
+ */
+void motorControlTick(void);
+
+/**
+ * @brief Set the index of the next control tick
+ * @param index Index motorControlTick() runs as; it counts up by one per tick
+ * @note Called by the control loop thread before every tick, so indices
+ *       follow its time base and skip ticks it missed
+ */
+void motorControlSetTickIndex(uint64_t index);
+
+/**
+ * @brief Get the index of the next control tick
+ * @return Tick index, see motorInstanceSetSpeedAt()
+ */
+uint64_t motorControlGetTickIndex(void);
+
+/**
+ * @brief Check whether the control loop has nothing to do
+ * @return 1 if the last tick found every motor stopped, not braking and at standstill,
+ *         with no autotune or scheduled speed change pending, and no command is queued
+ * @details The control loop thread drops to its idle rate while this holds
+ * (see ControlLoopConfig::idleRateHz)
+ */
+int motorControlIsIdle(void);
+
 #endif // MOTOR_CONTROL_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+/**
+ * @file MotorCrc.h
+ * @brief CRC-32 shared by the on-disk formats
+ *
+ * IEEE 802.3 polynomial, as zlib's crc32(), so files can be checked with
+ * standard tools.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_CRC_H
+#define MOTOR_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief CRC-32 of a buffer
+ * @param data Bytes to check
+ * @param size Number of bytes
+ * @return CRC-32 (reflected 0xEDB88320, initial and final XOR 0xFFFFFFFF)
+ */
+uint32_t motorCrc32(const void *data, size_t size);
+
+#endif // MOTOR_CRC_H
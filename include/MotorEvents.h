@@ -0,0 +1,168 @@
+/**
+ * @file MotorEvents.h
+ * @brief Event file descriptors for event-loop integration
+ *
+ * A supervising process can wait on motor events with epoll/poll instead of
+ * polling the motor API on a timer:
+ * - motorInstanceEventFd() returns an eventfd that becomes readable when
+ *   the motor latches a fault or reaches its target speed
+ * - motorInstanceTakeEvents() returns and clears the pending MOTOR_EVENT_*
+ *   bits and rearms the descriptor; it never blocks
+ * - motorTelemetryEventFd() becomes readable when the control loop has
+ *   pushed telemetry samples, at most every MOTOR_EVENT_TELEMETRY_MS, so a
+ *   reader drains the ring in batches
+ * - motorInstanceGetStatus() is a non-blocking snapshot for the handler
+ *
+ * Descriptors are non-blocking and close-on-exec; one thread can register
+ * any number of motors in one epoll set, with the Motor handle as the
+ * event data. Events are raised from the control tick and the protection
+ * trip path with a single write() on a state change, never more than once
+ * before the events are taken.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_EVENTS_H
+#define MOTOR_EVENTS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "MotorControl.h"
+#include "Protection.h"
+
+/** @brief Event bits returned by motorInstanceTakeEvents() */
+#define MOTOR_EVENT_FAULT          0x0001  ///< A fault was latched (see motorInstanceGetFault())
+#define MOTOR_EVENT_SPEED_REACHED  0x0002  ///< The ramp finished and the speed is within tolerance
+#define MOTOR_EVENT_STOPPED        0x0004  ///< Braking brought the rotor to rest (see Brake.h)
+
+/** @brief Measured speed error within which the target counts as reached */
+#ifndef MOTOR_EVENT_SPEED_TOLERANCE_RPM
+#define MOTOR_EVENT_SPEED_TOLERANCE_RPM 50
+#endif
+
+/** @brief Shortest interval between two telemetry-available signals */
+#ifndef MOTOR_EVENT_TELEMETRY_MS
+#define MOTOR_EVENT_TELEMETRY_MS 10
+#endif
+
+/**
+ * @brief Event state of one motor
+ */
+typedef struct {
+    atomic_int fd;            ///< eventfd, -1 until motorInstanceEventFd() is called
+    atomic_uint pending;      ///< MOTOR_EVENT_* bits not yet taken
+    uint16_t armedTarget;     ///< Target speed the speed-reached event is armed for
+    uint8_t armed;            ///< Speed-reached not yet raised for armedTarget
+} MotorEventState;
+
+/**
+ * @brief Non-blocking motor status snapshot
+ */
+typedef struct {
+    uint8_t running;          ///< Motor is energized
+    uint8_t ramping;          ///< Setpoint still moving towards the target
+    MotorFault fault;         ///< Latched fault, MOTOR_FAULT_NONE if none
+    uint16_t targetRpm;       ///< Requested speed
+    uint16_t setpointRpm;     ///< Current ramp setpoint
+    uint16_t measuredRpm;     ///< Hall-derived speed
+    uint32_t events;          ///< MOTOR_EVENT_* bits pending (not cleared)
+} MotorStatus;
+
+/**
+ * @brief Initialize the event state of a new motor
+ * @param events Event state
+ */
+void motorEventsInit(MotorEventState *events);
+
+/**
+ * @brief Close the descriptor of a destroyed motor
+ * @param events Event state
+ */
+void motorEventsClose(MotorEventState *events);
+
+/**
+ * @brief Raise events on a motor
+ * @param events Event state
+ * @param bits MOTOR_EVENT_* bits
+ * @note Signals the descriptor only if a bit was not already pending
+ */
+void motorEventsRaise(MotorEventState *events, uint32_t bits);
+
+/**
+ * @brief Raise MOTOR_EVENT_SPEED_REACHED once per target
+ * @param events Event state
+ * @param running Motor is energized
+ * @param ramping Setpoint still moving towards the target
+ * @param target Requested speed
+ * @param measured Measured speed
+ * @note Called every control tick
+ */
+void motorEventsCheckSpeed(MotorEventState *events, int running, int ramping,
+                           uint16_t target, uint16_t measured);
+
+/**
+ * @brief Note telemetry samples pushed this tick
+ * @param nowNs Tick timestamp
+ * @note Signals the telemetry descriptor at most every MOTOR_EVENT_TELEMETRY_MS
+ */
+void motorEventsTelemetryPushed(uint64_t nowNs);
+
+/**
+ * @brief Get the event descriptor of a motor instance
+ * @param motor Motor handle
+ * @return Readable-when-pending eventfd, or -1 on failure
+ * @note Created on first use and owned by the library; closed by motorDestroy()
+ */
+int motorInstanceEventFd(Motor *motor);
+
+/**
+ * @brief Take the pending events of a motor instance
+ * @param motor Motor handle
+ * @return MOTOR_EVENT_* bits raised since the last call, 0 if none
+ * @note Never blocks; also drains the descriptor
+ */
+uint32_t motorInstanceTakeEvents(Motor *motor);
+
+/**
+ * @brief Get a status snapshot of a motor instance
+ * @param motor Motor handle
+ * @param status Receives the snapshot
+ * @note Never blocks; pending events are reported but not taken
+ */
+void motorInstanceGetStatus(const Motor *motor, MotorStatus *status);
+
+/**
+ * @brief Get the telemetry-available descriptor
+ * @return eventfd readable once samples were pushed, or -1 on failure
+ * @note Read it (or call motorTakeTelemetryEvent()) before draining the ring
+ */
+int motorTelemetryEventFd(void);
+
+/**
+ * @brief Drain the telemetry-available descriptor
+ * @return 1 if samples were signalled since the last call, 0 otherwise
+ */
+int motorTakeTelemetryEvent(void);
+
+/**
+ * @brief Get the event descriptor of the default motor
+ * @return eventfd, or -1 before motorInit()
+ */
+int motorEventFd(void);
+
+/**
+ * @brief Take the pending events of the default motor
+ * @return MOTOR_EVENT_* bits, 0 before motorInit()
+ */
+uint32_t motorTakeEvents(void);
+
+/**
+ * @brief Get a status snapshot of the default motor
+ * @param status Receives the snapshot
+ * @return 0 on success, -1 before motorInit()
+ */
+int motorGetStatus(MotorStatus *status);
+
+#endif // MOTOR_EVENTS_H
@@ -0,0 +1,254 @@
+/**
+ * @file MotorLog.h
+ * @brief Compressed, seekable on-disk format for telemetry samples
+ *
+ * A log is a sequence of fixed-size blocks, MOTOR_LOG_BLOCK_SIZE bytes each
+ * and aligned to it, so the writer only issues large aligned writes (and
+ * can use O_DIRECT) and block n always lives at offset n * block size.
+ * Every block starts with a MotorLogBlockHeader and carries a CRC-32 of its
+ * payload, so a block torn by a power cut is detected and skipped.
+ *
+ * - Block 0 is the file block: a MotorLogFileInfo with the clock origins.
+ * - Data blocks store samples column by column: all motor indices, then all
+ *   timestamps, then all speeds and so on. Each value is stored as the
+ *   zigzag varint of its difference to the previous sample of the same
+ *   motor (timestamps as the difference of that difference), so a steady
+ *   2 kHz stream costs about one byte per column instead of the 40-byte
+ *   ring slot.
+ * - After every MOTOR_LOG_INDEX_INTERVAL data blocks comes an index block
+ *   listing their time ranges. Index blocks sit at fixed positions, so a
+ *   reader finds a time by binary search over index blocks and then reads a
+ *   single data block, never scanning the file.
+ *
+ * All fields are native endian (little endian on every supported target).
+ * The encoder only fills buffers handed to it; where and when they are
+ * written is up to the MotorLogSink, see MotorLogger.h.
+ *
+ * Has no WiringPi dependency; the host decoder links it directly.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_LOG_H
+#define MOTOR_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Telemetry.h"
+
+/** @brief Block size: the unit of every write and read */
+#define MOTOR_LOG_BLOCK_SIZE 65536
+
+/** @brief Buffer alignment needed for O_DIRECT */
+#define MOTOR_LOG_ALIGN 4096
+
+/** @brief Block magic, "MLOG" */
+#define MOTOR_LOG_MAGIC 0x474F4C4DU
+
+/** @brief Format version, bumped on any incompatible change */
+#define MOTOR_LOG_VERSION 1
+
+/** @brief Data blocks between two index blocks */
+#define MOTOR_LOG_INDEX_INTERVAL 63
+
+/** @brief Columns of a data block */
+#define MOTOR_LOG_COLUMN_COUNT 10
+
+/** @brief Largest encoded size of one sample, summed over all columns */
+#define MOTOR_LOG_MAX_SAMPLE_SIZE 32
+
+/**
+ * @brief Block kinds
+ */
+typedef enum {
+    MOTOR_LOG_BLOCK_FILE = 1,  ///< Block 0: MotorLogFileInfo
+    MOTOR_LOG_BLOCK_DATA,      ///< Column-encoded samples
+    MOTOR_LOG_BLOCK_INDEX      ///< MotorLogIndexEntry per preceding data block
+} MotorLogBlockKind;
+
+/**
+ * @brief Header at the start of every block
+ */
+typedef struct {
+    uint32_t magic;          ///< MOTOR_LOG_MAGIC
+    uint16_t version;        ///< MOTOR_LOG_VERSION
+    uint16_t kind;           ///< MotorLogBlockKind
+    uint32_t sequence;       ///< Block number, offset / MOTOR_LOG_BLOCK_SIZE
+    uint32_t count;          ///< Samples (data) or entries (index)
+    uint64_t firstNs;        ///< Earliest sample timestamp covered
+    uint64_t lastNs;         ///< Latest sample timestamp covered
+    uint32_t payloadSize;    ///< Bytes used after the header
+    uint32_t lost;           ///< Samples lost just before this block (data)
+    uint32_t crc;            ///< CRC-32 of the payload
+    uint32_t reserved;       ///< 0
+} MotorLogBlockHeader;
+
+_Static_assert(sizeof(MotorLogBlockHeader) == 48, "log block header layout changed");
+
+/** @brief Payload bytes available in one block */
+#define MOTOR_LOG_PAYLOAD_SIZE (MOTOR_LOG_BLOCK_SIZE - (int) sizeof(MotorLogBlockHeader))
+
+/**
+ * @brief Payload of the file block
+ */
+typedef struct {
+    uint64_t startMonotonicNs;  ///< motorClockNs() when logging started
+    uint64_t startRealtimeNs;   ///< CLOCK_REALTIME at the same instant
+    uint32_t blockSize;         ///< MOTOR_LOG_BLOCK_SIZE
+    uint32_t indexInterval;     ///< MOTOR_LOG_INDEX_INTERVAL
+    uint32_t columns;           ///< MOTOR_LOG_COLUMN_COUNT
+    uint32_t reserved;          ///< 0
+} MotorLogFileInfo;
+
+/**
+ * @brief Index block entry
+ */
+typedef struct {
+    uint64_t firstNs;        ///< First sample timestamp of the data block
+    uint64_t lastNs;         ///< Last sample timestamp of the data block
+    uint32_t block;          ///< Data block number
+    uint32_t count;          ///< Samples in the data block
+} MotorLogIndexEntry;
+
+/**
+ * @brief Destination of encoded blocks
+ */
+typedef struct {
+    uint8_t *(*acquire)(void *context);          ///< Buffer of MOTOR_LOG_BLOCK_SIZE bytes, NULL if none is free
+    void (*submit)(void *context, uint8_t *block, uint32_t sequence); ///< Store a filled buffer
+    void *context;                                ///< Passed to both callbacks
+} MotorLogSink;
+
+/**
+ * @brief Per-motor delta state
+ */
+typedef struct {
+    TelemetrySample previous;  ///< Last sample of this motor in the block
+    int64_t previousDeltaNs;   ///< Last timestamp difference
+} MotorLogDeltaState;
+
+/**
+ * @brief Block encoder
+ * @details Columns are built side by side in scratch buffers and packed
+ * into one block when it is full or flushed.
+ */
+typedef struct {
+    MotorLogSink sink;                              ///< Block destination
+    uint8_t *columns[MOTOR_LOG_COLUMN_COUNT];       ///< Column scratch buffers
+    uint32_t columnSize[MOTOR_LOG_COLUMN_COUNT];    ///< Bytes used per column
+    uint32_t payloadSize;                           ///< Packed payload size so far
+    uint32_t count;                                 ///< Samples in the open block
+    uint64_t firstNs;                               ///< First timestamp of the open block
+    uint64_t lastNs;                                ///< Last timestamp of the open block
+    MotorLogDeltaState motors[256];                 ///< Delta state by motor index
+    MotorLogIndexEntry index[MOTOR_LOG_INDEX_INTERVAL]; ///< Data blocks since the last index block
+    uint32_t indexCount;                            ///< Entries in index
+    uint32_t sequence;                              ///< Next block number
+    uint32_t lost;                                  ///< Samples lost since the last data block
+    uint64_t samples;                               ///< Samples stored
+    uint64_t blocks;                                ///< Blocks submitted
+    uint64_t droppedBlocks;                         ///< Data blocks dropped for lack of a buffer
+} MotorLogEncoder;
+
+/**
+ * @brief Reader of a log file
+ */
+typedef struct {
+    int fd;                  ///< Open log file
+    uint32_t blocks;         ///< Whole blocks in the file
+    MotorLogFileInfo info;   ///< File block payload
+    uint8_t *block;          ///< Buffer holding the last block read
+} MotorLogReader;
+
+/**
+ * @brief Initialize an encoder and submit the file block
+ * @param encoder Encoder to initialize
+ * @param sink Block destination
+ * @param startMonotonicNs motorClockNs() at the start of logging
+ * @param startRealtimeNs CLOCK_REALTIME at the same instant
+ * @return 0 on success, -1 on allocation failure or if the sink has no buffer
+ */
+int motorLogEncoderInit(MotorLogEncoder *encoder, const MotorLogSink *sink,
+                        uint64_t startMonotonicNs, uint64_t startRealtimeNs);
+
+/**
+ * @brief Release the scratch buffers of an encoder
+ * @param encoder Encoder
+ * @note Flush first; samples still in the open block are discarded
+ */
+void motorLogEncoderFree(MotorLogEncoder *encoder);
+
+/**
+ * @brief Append a sample
+ * @param encoder Encoder
+ * @param sample Sample to store; submits the block first if it is full
+ */
+void motorLogEncoderAdd(MotorLogEncoder *encoder, const TelemetrySample *sample);
+
+/**
+ * @brief Record samples that never reached the encoder
+ * @param encoder Encoder
+ * @param samples Number of samples lost (reported in the next data block)
+ */
+void motorLogEncoderLost(MotorLogEncoder *encoder, uint32_t samples);
+
+/**
+ * @brief Submit the open block, even if it is not full
+ * @param encoder Encoder
+ */
+void motorLogEncoderFlush(MotorLogEncoder *encoder);
+
+/**
+ * @brief Decode a data block
+ * @param block Block of MOTOR_LOG_BLOCK_SIZE bytes
+ * @param samples Receives the samples
+ * @param max Capacity of samples
+ * @return Number of samples, or -1 if the block is not a valid data block
+ *         or holds more than max samples
+ */
+int motorLogDecodeBlock(const uint8_t *block, TelemetrySample *samples, uint32_t max);
+
+/**
+ * @brief Check a block header and payload CRC
+ * @param block Block of MOTOR_LOG_BLOCK_SIZE bytes
+ * @param header Receives the header
+ * @return 0 if valid, -1 otherwise
+ */
+int motorLogCheckBlock(const uint8_t *block, MotorLogBlockHeader *header);
+
+/**
+ * @brief Open a log file and read its file block
+ * @param reader Reader to initialize
+ * @param path Log file
+ * @return 0 on success, -1 on failure
+ */
+int motorLogReaderOpen(MotorLogReader *reader, const char *path);
+
+/**
+ * @brief Read and check one block
+ * @param reader Reader
+ * @param block Block number
+ * @param header Receives the header
+ * @return 0 if the block is valid, -1 if it is missing or corrupt
+ * @note The block stays in reader->block until the next read
+ */
+int motorLogReaderRead(MotorLogReader *reader, uint32_t block, MotorLogBlockHeader *header);
+
+/**
+ * @brief Find the first data block extending to or past a time
+ * @param reader Reader
+ * @param timeNs Sample timestamp (motorClockNs() timebase)
+ * @return Block number, or reader->blocks if no sample is that late
+ * @note Reads O(log n) index blocks plus at most one group of data block headers
+ */
+uint32_t motorLogReaderSeek(MotorLogReader *reader, uint64_t timeNs);
+
+/**
+ * @brief Close a reader
+ * @param reader Reader
+ */
+void motorLogReaderClose(MotorLogReader *reader);
+
+#endif // MOTOR_LOG_H
@@ -0,0 +1,88 @@
+/**
+ * @file MotorLogger.h
+ * @brief Background recorder of every telemetry sample to a MotorLog file
+ *
+ * Two ordinary (non real-time) threads keep storage latency away from the
+ * control loop and from each other:
+ * - the encoder follows the shared memory telemetry ring, woken by the
+ *   telemetry-available descriptor, and packs samples into blocks
+ * - the writer stores finished blocks with aligned, block-sized writes,
+ *   through O_DIRECT where the file system supports it
+ *
+ * They share a pool of MOTOR_LOGGER_BUFFERS blocks. The ring absorbs short
+ * scheduling delays of the encoder; the pool absorbs slow writes (an SD
+ * card stalling for seconds). If the pool runs dry the open block is
+ * dropped and counted, and the next block records how many samples are
+ * missing. A partly filled block is written at least every flushMs, which
+ * bounds what a power cut can take.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_LOGGER_H
+#define MOTOR_LOGGER_H
+
+#include <stdint.h>
+#include "MotorLog.h"
+
+/** @brief Blocks buffered between the encoder and the writer */
+#ifndef MOTOR_LOGGER_BUFFERS
+#define MOTOR_LOGGER_BUFFERS 32
+#endif
+
+/** @brief Default longest time a sample waits in a partly filled block */
+#ifndef MOTOR_LOGGER_FLUSH_MS
+#define MOTOR_LOGGER_FLUSH_MS 1000
+#endif
+
+/**
+ * @brief Logger configuration
+ */
+typedef struct {
+    const char *path;          ///< Log file, replaced if it exists
+    const char *telemetryName; ///< Telemetry ring to record, NULL for TELEMETRY_SHM_NAME
+    uint32_t flushMs;          ///< Longest delay before a partly filled block is written
+} MotorLoggerConfig;
+
+/**
+ * @brief Logger counters
+ */
+typedef struct {
+    uint64_t samples;          ///< Samples stored in blocks
+    uint64_t lostSamples;      ///< Samples overwritten in the ring before they were read
+    uint64_t blocks;           ///< Blocks written
+    uint64_t droppedBlocks;    ///< Data blocks dropped because every buffer was waiting for the writer
+    uint64_t writeErrors;      ///< Failed block writes
+    uint8_t direct;            ///< 1 if the file is written with O_DIRECT
+} MotorLoggerStats;
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ * @param path Log file
+ */
+void motorLoggerDefaultConfig(MotorLoggerConfig *config, const char *path);
+
+/**
+ * @brief Create the log file and start recording
+ * @param config Logger configuration
+ * @return 0 on success, -1 on failure or if already recording
+ * @note The telemetry ring must exist (telemetryOpen()); recording starts
+ *       with the next sample pushed
+ */
+int motorLoggerStart(const MotorLoggerConfig *config);
+
+/**
+ * @brief Record the samples already pushed, write everything and close the file
+ */
+void motorLoggerStop(void);
+
+/**
+ * @brief Get a snapshot of the logger counters
+ * @param stats Destination for the snapshot
+ */
+void motorLoggerGetStats(MotorLoggerStats *stats);
+
+#endif // MOTOR_LOGGER_H
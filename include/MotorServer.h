@@ -0,0 +1,204 @@
+/**
+ * @file MotorServer.h
+ * @brief UDP command and telemetry server with a batched binary protocol
+ *
+ * A central controller drives the motors of many nodes over the network
+ * instead of a local shell. The server runs on an ordinary (non real-time)
+ * thread. It reaches the control loop only through its own command queue,
+ * attached with motorAttachCommandQueue(), and the shared memory telemetry
+ * ring, so network traffic never delays a tick.
+ *
+ * Every datagram starts with a MotorNetHeader and carries one message:
+ * - MOTOR_NET_COMMANDS: count MotorCommand records for any motors, queued
+ *   in order and applied on the next tick. Answered with MOTOR_NET_ACK,
+ *   whose count is the number of commands accepted (the rest did not fit
+ *   the queue) and whose seq echoes the request.
+ * - MOTOR_NET_SUBSCRIBE: count 1 subscribes the sender to telemetry, 0
+ *   unsubscribes it. Any datagram from a subscriber refreshes it; one that
+ *   stays silent for MOTOR_SERVER_SUBSCRIBER_TIMEOUT_MS is dropped.
+ * - MOTOR_NET_TELEMETRY: server to subscribers. A base timestamp and loss
+ *   counter followed by count samples of all motors, 16 bytes each. The
+ *   ring is drained whenever the control loop signals new samples (see
+ *   motorTelemetryEventFd()), so each datagram coalesces several ticks.
+ *
+ * All fields are little endian. Datagrams never exceed MOTOR_NET_MAX_PACKET
+ * bytes, so they are not fragmented on an Ethernet link.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_SERVER_H
+#define MOTOR_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "CommandQueue.h"
+#include "Telemetry.h"
+
+/** @brief Default UDP port */
+#ifndef MOTOR_SERVER_PORT
+#define MOTOR_SERVER_PORT 5700
+#endif
+
+/** @brief Telemetry subscribers served at once */
+#ifndef MOTOR_SERVER_MAX_SUBSCRIBERS
+#define MOTOR_SERVER_MAX_SUBSCRIBERS 4
+#endif
+
+/** @brief Silence after which a subscriber is dropped */
+#ifndef MOTOR_SERVER_SUBSCRIBER_TIMEOUT_MS
+#define MOTOR_SERVER_SUBSCRIBER_TIMEOUT_MS 2000
+#endif
+
+/** @brief Header magic, "MNET" */
+#define MOTOR_NET_MAGIC 0x54454E4DU
+
+/** @brief Protocol version, bumped on any incompatible change */
+#define MOTOR_NET_VERSION 1
+
+/** @brief Largest datagram sent or accepted (1500-byte MTU minus IP and UDP headers) */
+#define MOTOR_NET_MAX_PACKET 1472
+
+/** @brief Encoded sizes */
+#define MOTOR_NET_HEADER_SIZE 12                  ///< MotorNetHeader
+#define MOTOR_NET_COMMAND_SIZE 12                 ///< One MotorCommand
+#define MOTOR_NET_TELEMETRY_PREFIX_SIZE 12        ///< Base timestamp and loss counter
+#define MOTOR_NET_SAMPLE_SIZE 16                  ///< One telemetry sample
+
+/** @brief Commands that fit one datagram */
+#define MOTOR_NET_MAX_COMMANDS \
+    ((MOTOR_NET_MAX_PACKET - MOTOR_NET_HEADER_SIZE) / MOTOR_NET_COMMAND_SIZE)
+
+/** @brief Telemetry samples that fit one datagram */
+#define MOTOR_NET_MAX_SAMPLES \
+    ((MOTOR_NET_MAX_PACKET - MOTOR_NET_HEADER_SIZE - MOTOR_NET_TELEMETRY_PREFIX_SIZE) / \
+     MOTOR_NET_SAMPLE_SIZE)
+
+/**
+ * @brief Message types
+ */
+typedef enum {
+    MOTOR_NET_COMMANDS = 1,    ///< Client to server: batched motor commands
+    MOTOR_NET_ACK,             ///< Server to client: count = commands accepted
+    MOTOR_NET_SUBSCRIBE,       ///< Client to server: count 1 subscribe, 0 unsubscribe
+    MOTOR_NET_TELEMETRY        ///< Server to subscribers: batched samples
+} MotorNetType;
+
+/**
+ * @brief Datagram header (decoded)
+ * @details Wire layout: magic u32, version u8, type u8, count u16, seq u32
+ */
+typedef struct {
+    uint32_t magic;            ///< MOTOR_NET_MAGIC
+    uint8_t version;           ///< MOTOR_NET_VERSION
+    uint8_t type;              ///< MotorNetType
+    uint16_t count;            ///< Records following the header
+    uint32_t seq;              ///< Sender's sequence number
+} MotorNetHeader;
+
+/**
+ * @brief Server configuration
+ */
+typedef struct {
+    uint16_t port;             ///< UDP port, 0 for an ephemeral one
+    const char *telemetryName; ///< Telemetry ring to stream, NULL for TELEMETRY_SHM_NAME
+} MotorServerConfig;
+
+/**
+ * @brief Server counters
+ */
+typedef struct {
+    uint64_t packets;          ///< Datagrams received
+    uint64_t badPackets;       ///< Datagrams dropped as malformed
+    uint64_t commands;         ///< Commands queued
+    uint64_t rejected;         ///< Commands dropped because the queue was full
+    uint64_t telemetryPackets; ///< Telemetry datagrams sent (per subscriber)
+    uint64_t samples;          ///< Telemetry samples read from the ring
+    uint64_t lostSamples;      ///< Samples the ring overwrote before they were read
+} MotorServerStats;
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ */
+void motorServerDefaultConfig(MotorServerConfig *config);
+
+/**
+ * @brief Bind the socket and start the server thread
+ * @param config Server configuration, or NULL for defaults
+ * @return 0 on success, -1 on failure or if already running
+ * @note Commands are applied by the control loop; start it (or drive
+ *       motorControlTick()) for them to take effect. Telemetry needs
+ *       telemetryOpen() with the same name; without it only commands are served.
+ */
+int motorServerStart(const MotorServerConfig *config);
+
+/**
+ * @brief Stop the server thread and close the socket
+ */
+void motorServerStop(void);
+
+/**
+ * @brief Get the bound UDP port
+ * @return Port number, or 0 if the server is not running
+ */
+uint16_t motorServerGetPort(void);
+
+/**
+ * @brief Get a snapshot of the server counters
+ * @param stats Destination for the snapshot
+ */
+void motorServerGetStats(MotorServerStats *stats);
+
+/**
+ * @brief Encode a command datagram
+ * @param buf Destination buffer
+ * @param size Buffer size
+ * @param seq Sequence number echoed by the acknowledgement
+ * @param commands Commands to send
+ * @param count Number of commands (at most MOTOR_NET_MAX_COMMANDS)
+ * @return Datagram length, or 0 if it does not fit
+ */
+size_t motorNetEncodeCommands(uint8_t *buf, size_t size, uint32_t seq,
+                              const MotorCommand *commands, uint16_t count);
+
+/**
+ * @brief Encode a header-only datagram (subscribe, acknowledgement)
+ * @param buf Destination buffer of at least MOTOR_NET_HEADER_SIZE bytes
+ * @param type MotorNetType
+ * @param count Header count field
+ * @param seq Sequence number
+ * @return MOTOR_NET_HEADER_SIZE
+ */
+size_t motorNetEncodeHeader(uint8_t *buf, MotorNetType type, uint16_t count, uint32_t seq);
+
+/**
+ * @brief Decode and check a datagram header
+ * @param buf Datagram
+ * @param len Datagram length
+ * @param header Receives the header
+ * @return 0 if magic, version and length match the type, -1 otherwise
+ */
+int motorNetDecodeHeader(const uint8_t *buf, size_t len, MotorNetHeader *header);
+
+/**
+ * @brief Decode the commands of a MOTOR_NET_COMMANDS datagram
+ * @param buf Datagram checked by motorNetDecodeHeader()
+ * @param index Command index (below the header count)
+ * @param command Receives the command
+ */
+void motorNetDecodeCommand(const uint8_t *buf, uint16_t index, MotorCommand *command);
+
+/**
+ * @brief Decode the samples of a MOTOR_NET_TELEMETRY datagram
+ * @param buf Datagram checked by motorNetDecodeHeader()
+ * @param samples Receives the samples (header count entries)
+ * @param lost Receives the server's lost sample counter, may be NULL
+ * @return Number of samples decoded
+ * @note Timestamps are restored to microsecond resolution
+ */
+int motorNetDecodeTelemetry(const uint8_t *buf, TelemetrySample *samples, uint32_t *lost);
+
+#endif // MOTOR_SERVER_H
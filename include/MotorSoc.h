@@ -0,0 +1,45 @@
+/**
+ * @file MotorSoc.h
+ * @brief Identification of the SoC the library runs on
+ *
+ * Backends that depend on one SoC's register layout or pin routing check
+ * the device tree compatible list before touching the hardware, so a build
+ * configured for another board fails its setup with an error instead of
+ * reading or writing unrelated registers. Boards without a device tree
+ * report an unknown SoC and are not refused.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_SOC_H
+#define MOTOR_SOC_H
+
+/** @brief NUL-separated device tree compatible list of the board */
+#ifndef MOTOR_SOC_COMPATIBLE_PATH
+#define MOTOR_SOC_COMPATIBLE_PATH "/proc/device-tree/compatible"
+#endif
+
+/**
+ * @brief Check whether the board lists a device tree compatible string
+ * @param compatible Compatible string, e.g. "brcm,bcm2712"
+ * @return 1 if listed, 0 if not, -1 if the list cannot be read
+ */
+int motorSocIs(const char *compatible);
+
+/**
+ * @brief Check whether the SoC has the BCM2835-style GPIO register block
+ * @return 1 on BCM2835/6/7 and BCM2711, 0 on any other SoC (e.g. BCM2712
+ *         with RP1), -1 if the SoC cannot be identified
+ * @note /dev/gpiomem register offsets (GPLEV0, GPCLR0) are only valid when 1
+ */
+int motorSocHasBcm2835Gpio(void);
+
+/**
+ * @brief Name the SoC for error messages
+ * @return Last device tree compatible string (the SoC), "unknown" if none
+ */
+const char *motorSocName(void);
+
+#endif // MOTOR_SOC_H
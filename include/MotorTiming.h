@@ -0,0 +1,120 @@
+/**
+ * @file MotorTiming.h
+ * @brief Control path timing instrumentation
+ *
+ * Records control loop wake-up latency, tick compute time, commutation
+ * update time and Hall-edge-to-PWM-update latency into fixed-bucket
+ * log-linear histograms (8 sub-buckets per power of two, so every value is
+ * resolved to within 12.5%), plus a deadline miss counter. Recording never
+ * allocates, never locks and is safe from the control loop and the Hall
+ * edge handlers at the same time.
+ *
+ * Intervals are taken from the ARM PMU cycle counter when the library is
+ * built with MOTOR_TIMING_PMU on AArch64 (the kernel must enable user
+ * access to PMCCNTR_EL0, otherwise reads fault), and from
+ * CLOCK_MONOTONIC_RAW otherwise.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_TIMING_H
+#define MOTOR_TIMING_H
+
+#include <stdint.h>
+
+/** @brief Number of histogram buckets, covering 0 ns to 2^32 - 1 ns */
+#define TIMING_HISTOGRAM_BUCKETS 240
+
+/**
+ * @brief Instrumented intervals
+ */
+typedef enum {
+    TIMING_WAKE_LATENCY = 0,  ///< Scheduled deadline to start of the control tick
+    TIMING_TICK_COMPUTE,      ///< Duration of motorControlTick()
+    TIMING_COMMUTATION,       ///< Duration of updateCommutation() while running
+    TIMING_EDGE_TO_PWM,       ///< Hall edge detection to phase outputs updated
+    TIMING_FAULT_TRIP,        ///< Overcurrent trip handler entry to outputs cleared
+    TIMING_CHANNEL_COUNT
+} TimingChannel;
+
+/**
+ * @brief Latency histogram snapshot
+ */
+typedef struct {
+    uint64_t count;                              ///< Recorded samples
+    uint64_t sumNs;                              ///< Sum of all samples
+    uint32_t minNs;                              ///< Smallest sample (0 if count is 0)
+    uint32_t maxNs;                              ///< Largest sample
+    uint32_t buckets[TIMING_HISTOGRAM_BUCKETS];  ///< Sample count per bucket
+} TimingHistogram;
+
+/**
+ * @brief Timing statistics snapshot
+ */
+typedef struct {
+    TimingHistogram channel[TIMING_CHANNEL_COUNT]; ///< Indexed by TimingChannel
+    uint64_t deadlineMisses;                       ///< Control ticks that overran their slot
+    uint8_t cycleCounter;                          ///< 1 if measured with the PMU cycle counter
+} MotorTimingStats;
+
+/**
+ * @brief Take a snapshot of the timing statistics
+ * @param stats Destination for the snapshot
+ * @note Channels are copied one after the other, so counts of different
+ *       channels may be a few samples apart
+ */
+void motorGetTimingStats(MotorTimingStats *stats);
+
+/**
+ * @brief Clear all histograms and counters
+ */
+void motorResetTimingStats(void);
+
+/**
+ * @brief Estimate a percentile from a histogram
+ * @param hist Histogram snapshot
+ * @param percentile Percentile in the range 0-100
+ * @return Upper bound of the bucket holding the percentile, in ns
+ */
+uint32_t timingHistogramPercentile(const TimingHistogram *hist, double percentile);
+
+/**
+ * @brief Calibrate the timing clock
+ * @details With MOTOR_TIMING_PMU the cycle counter is measured against
+ * CLOCK_MONOTONIC_RAW, busy-waiting 10 ms on the first call; later calls
+ * return immediately. motorCreate() and controlLoopStart() call it before
+ * any real-time thread reads the clock.
+ * @note timingElapsedNs() returns 0 until it has run
+ */
+void timingInit(void);
+
+/**
+ * @brief Read the timing clock
+ * @return Opaque timestamp, only meaningful to timingElapsedNs()
+ * @note Used by the library to instrument the control path
+ */
+uint64_t timingNow(void);
+
+/**
+ * @brief Convert the difference of two timingNow() readings to nanoseconds
+ * @param start Earlier reading
+ * @param end Later reading
+ * @return Elapsed nanoseconds, saturated to UINT32_MAX
+ */
+uint32_t timingElapsedNs(uint64_t start, uint64_t end);
+
+/**
+ * @brief Add a sample to a channel histogram
+ * @param channel Channel to record into
+ * @param ns Interval in nanoseconds
+ */
+void timingRecord(TimingChannel channel, uint32_t ns);
+
+/**
+ * @brief Count a control tick that missed its deadline
+ */
+void timingRecordDeadlineMiss(void);
+
+#endif // MOTOR_TIMING_H
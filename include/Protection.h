@@ -0,0 +1,126 @@
+/**
+ * @file Protection.h
+ * @brief Overcurrent protection with a latched fault
+ *
+ * Two trip sources are supported per motor:
+ * - a comparator or gate driver fault output on MotorConfig::faultPin
+ *   (active low, e.g. DRV8302 nOCTW), handled by an edge interrupt
+ * - a bus current shunt on MotorConfig::busCurrentChannel of the motor's
+ *   AdcBackend, compared against currentLimitMa every control tick (and
+ *   the phase currents every FOC current loop iteration)
+ *
+ * A trip first clears every bank 0 output of the motor (phase and gate
+ * pins) with a single store to the GPCLR0 register through /dev/gpiomem,
+ * without waiting for the phase lock, then latches the fault and stops the
+ * motor through the regular path. The store takes well under a
+ * microsecond; TIMING_FAULT_TRIP records handler entry to outputs cleared.
+ * GPCLR only reaches pins in GPIO mode: with hardware PWM phase outputs,
+ * and with softPwm (whose thread may raise a pin again until the end of
+ * its period), the enable or low-side pins of BRIDGE_3PWM/BRIDGE_6PWM are
+ * what de-energizes the bridge immediately. Where the register block is
+ * not mapped (no /dev/gpiomem, or a SoC without the BCM2835 GPIO layout
+ * such as the Pi 5) every phase and gate pin is driven low with
+ * digitalWrite() instead.
+ *
+ * The same latch holds MOTOR_FAULT_HALL when the Hall validator loses the
+ * sensors (see HallValidator.h).
+ *
+ * While a fault is latched the motor refuses to start; the application
+ * reads it with motorInstanceGetFault() and acknowledges it with
+ * motorInstanceClearFault().
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef PROTECTION_H
+#define PROTECTION_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/** @brief Overcurrent comparator input (BCM, active low), -1 if not fitted */
+#ifndef FAULT_PIN
+#define FAULT_PIN -1
+#endif
+
+/** @brief ADC channel of the bus current shunt amplifier, -1 if not fitted */
+#ifndef BUS_CURRENT_ADC_CHANNEL
+#define BUS_CURRENT_ADC_CHANNEL -1
+#endif
+
+/** @brief Bus current scale per ADC count (unipolar, 0 counts = 0 A) */
+#ifndef BUS_CURRENT_MA_PER_LSB
+#define BUS_CURRENT_MA_PER_LSB 32
+#endif
+
+/** @brief Current above which the ADC checks trip, 0 to disable them */
+#ifndef OVERCURRENT_LIMIT_MA
+#define OVERCURRENT_LIMIT_MA 15000
+#endif
+
+/**
+ * @brief Latched fault codes
+ */
+typedef enum {
+    MOTOR_FAULT_NONE = 0,         ///< No fault
+    MOTOR_FAULT_OVERCURRENT_PIN,  ///< Fault input asserted
+    MOTOR_FAULT_OVERCURRENT_ADC,  ///< Measured current above currentLimitMa
+    MOTOR_FAULT_HALL              ///< Hall sensors lost (see HallValidator.h)
+} MotorFault;
+
+/**
+ * @brief Get the latched fault of a motor instance
+ * @param motor Motor handle
+ * @return First fault since the last motorInstanceClearFault()
+ */
+MotorFault motorInstanceGetFault(const Motor *motor);
+
+/**
+ * @brief Acknowledge the latched fault of a motor instance
+ * @param motor Motor handle
+ * @return 0 on success, -1 while the fault input is still asserted
+ * @note The motor stays stopped; call motorInstanceStart() to resume
+ */
+int motorInstanceClearFault(Motor *motor);
+
+/**
+ * @brief Get the latched fault of the default motor
+ * @return Fault code, MOTOR_FAULT_NONE before motorInit()
+ */
+MotorFault motorGetFault(void);
+
+/**
+ * @brief Prepare the trip path of a motor
+ * @param motor Motor whose pins are configured
+ * @return 0 on success, -1 if the fault input cannot be registered
+ * @note Used by motorCreate()
+ */
+int protectionAttach(Motor *motor);
+
+/**
+ * @brief Trip a motor: clear its outputs, latch the fault and stop it
+ * @param motor Motor handle
+ * @param fault Fault code to latch
+ * @note Never waits for the motor's phase lock; if another context holds
+ *       it, the stop completes when that context releases it
+ */
+void protectionTrip(Motor *motor, MotorFault fault);
+
+/**
+ * @brief Trip from a context that already holds the phase lock
+ * @param motor Motor handle
+ * @param fault Fault code to latch
+ */
+void protectionTripLocked(Motor *motor, MotorFault fault);
+
+/**
+ * @brief Check a current against the motor's limit and trip if exceeded
+ * @param motor Motor handle (phase lock held)
+ * @param currentMa Measured current magnitude
+ * @return 1 if the motor tripped, 0 otherwise
+ */
+int protectionCheckCurrent(Motor *motor, int32_t currentMa);
+
+#endif // PROTECTION_H
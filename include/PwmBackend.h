@@ -0,0 +1,86 @@
+/**
+ * @file PwmBackend.h
+ * @brief Pluggable PWM output backends for the motor phase pins
+ *
+ * The motor driver writes phase duty cycles through a PwmBackend instead of
+ * calling WiringPi softPwm directly. Two implementations are provided:
+ * - softPwmBackend: WiringPi softPwm threads (portable, CPU bound, jittery)
+ * - sysfsPwmBackend: hardware PWM peripheral via /sys/class/pwm, running at
+ *   PWM_FREQUENCY with PWM_RANGE steps and no CPU cost per cycle
+ *
+ * A stopped motor has its outputs suspended: softPwm threads exit and
+ * hardware channels are disabled, so an idle motor costs neither CPU time
+ * nor wake-ups. Starting the motor resumes them at duty 0.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef PWM_BACKEND_H
+#define PWM_BACKEND_H
+
+/**
+ * @brief PWM backend operations
+ * @details All values are in the range 0-PWM_RANGE
+ */
+typedef struct {
+    const char *name;                  ///< Human readable backend name
+    int (*setup)(int pin, int range);  ///< Claim a pin, output 0; 0 on success, -1 on failure
+    void (*write)(int pin, int value); ///< Set duty cycle of a claimed pin
+    void (*release)(int pin);          ///< Stop output and release a pin
+    void (*suspend)(int pin);          ///< Stop generating the waveform, output low; NULL if not supported
+    int (*resume)(int pin, int range); ///< Restart a suspended pin at duty 0; 0 on success, -1 on failure
+} PwmBackend;
+
+/** @brief WiringPi softPwm backend (one thread per pin) */
+extern const PwmBackend softPwmBackend;
+
+/**
+ * @brief Hardware PWM backend using the kernel PWM class
+ * @note Requires the phase pins in their PWM function (e.g. a pwm overlay) and
+ *       one channel per phase; see PWM_SYSFS_CHANNEL_MAP
+ */
+extern const PwmBackend sysfsPwmBackend;
+
+/** @brief sysfs PWM chip used by sysfsPwmBackend */
+#ifndef PWM_SYSFS_CHIP
+#define PWM_SYSFS_CHIP "/sys/class/pwm/pwmchip0"
+#endif
+
+/**
+ * @brief RP1 (Pi 5) PWM0 routing: four channels, enough for three phases
+ * @details GPIO12/13/14/15 carry channels 0-3 and GPIO18/19 channels 2/3
+ */
+#define PWM_SYSFS_RP1_MAP { {12, 0}, {13, 1}, {14, 2}, {15, 3}, {18, 2}, {19, 3} }
+
+/** @brief Device tree compatible string of the SoC PWM_SYSFS_RP1_MAP is for */
+#define PWM_SYSFS_RP1_SOC "brcm,bcm2712"
+
+/**
+ * @brief BCM2711 (Pi 4) PWM0 routing: two channels on the header
+ * @details GPIO12/18 share channel 0 and GPIO13/19 channel 1, so at most two
+ *          phases can be driven in hardware; three-phase motors on a Pi 4
+ *          need softPwmBackend
+ */
+#define PWM_SYSFS_BCM2711_MAP { {12, 0}, {13, 1}, {18, 0}, {19, 1} }
+
+/** @brief Device tree compatible string of the SoC PWM_SYSFS_BCM2711_MAP is for */
+#define PWM_SYSFS_BCM2711_SOC "brcm,bcm2711"
+
+/**
+ * @brief GPIO to PWM channel assignment for sysfsPwmBackend
+ * @details Each channel can be claimed by one pin; a second pin routed to
+ *          a claimed channel is refused rather than sharing its duty cycle.
+ *          The default pinout (PHASE_A_PIN..PHASE_C_PIN) maps to three
+ *          distinct RP1 channels. PWM_SYSFS_CHANNEL_MAP_SOC names the SoC
+ *          the map is for; setup fails with an error on any other SoC.
+ *          A Pi 4 build defines both, e.g. PWM_SYSFS_BCM2711_MAP and
+ *          PWM_SYSFS_BCM2711_SOC.
+ */
+#ifndef PWM_SYSFS_CHANNEL_MAP
+#define PWM_SYSFS_CHANNEL_MAP PWM_SYSFS_RP1_MAP
+#define PWM_SYSFS_CHANNEL_MAP_SOC PWM_SYSFS_RP1_SOC
+#endif
+
+#endif // PWM_BACKEND_H
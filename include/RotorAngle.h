@@ -0,0 +1,88 @@
+/**
+ * @file RotorAngle.h
+ * @brief Sub-sector rotor angle from Hall edges, with phase advance
+ *
+ * Hall sensors resolve the rotor to one of six 60° electrical sectors. The
+ * estimator places the rotor at the sector boundary it crossed at the last
+ * edge and moves it across the sector at the averaged sector period, in
+ * the direction of travel the Hall validator observed. It stops at the far
+ * boundary if the next edge is late, so a decelerating rotor is never
+ * placed beyond a sector it has not reached. Sector boundaries come from
+ * MotorConfig::hallAngles, which absorbs uneven sensor placement.
+ *
+ * Phase advance shifts the angle ahead in the direction of travel, in
+ * proportion to speed: MotorConfig::phaseAdvance at maxRpm. It offsets the
+ * current lag of the winding inductance and the sampling delay, which
+ * both grow with speed, so the top speed is reached at a lower current.
+ * The FOC current loop drives the advanced angle. The 6-step path
+ * switches to the next sector's pattern once the advanced angle has
+ * crossed the boundary. It does so on control ticks, so the effective
+ * advance is quantized to the tick period (CONTROL_LOOP_RATE_HZ).
+ *
+ * Angles are 16-bit turns: 65536 = 360° electrical.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef ROTOR_ANGLE_H
+#define ROTOR_ANGLE_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+#include "SpeedEstimator.h"
+
+/** @brief Convert degrees to a 16-bit electrical angle */
+#define ROTOR_ANGLE_DEG(deg) ((uint16_t) (((deg) % 360) * 65536 / 360))
+
+/** @brief Phase advance at maxRpm used by motorDefaultConfig(), in degrees electrical */
+#ifndef ROTOR_PHASE_ADVANCE_DEG
+#define ROTOR_PHASE_ADVANCE_DEG 0
+#endif
+
+/** @brief Largest phase advance accepted by motorCreate(), in degrees electrical */
+#define ROTOR_PHASE_ADVANCE_MAX_DEG 45
+
+/**
+ * @brief Rotor angle interpolated within the current Hall sector
+ * @param est Speed estimator fed with the motor's Hall edges
+ * @param direction Direction of travel: 1 forward, -1 reverse, 0 unknown (forward)
+ * @param angles Start angle of each forward sector (Hall codes 1, 3, 2, 6, 4, 5),
+ *               see MotorConfig::hallAngles
+ * @param nowNs Current time from motorClockNs()
+ * @return 16-bit electrical angle; the sector centre while stationary
+ */
+uint16_t rotorAngleInterpolate(const SpeedEstimator *est, int8_t direction,
+                               const uint16_t angles[6], uint64_t nowNs);
+
+/**
+ * @brief Phase advance for a speed
+ * @param phaseAdvance Advance at maxRpm (16-bit angle)
+ * @param rpm Measured speed
+ * @param maxRpm Speed limit of the motor
+ * @return Advance angle, proportional to speed and capped at phaseAdvance
+ */
+uint16_t rotorAngleAdvance(uint16_t phaseAdvance, uint16_t rpm, uint16_t maxRpm);
+
+/**
+ * @brief Hall code whose 6-step pattern to drive with phase advance
+ * @param est Speed estimator fed with the motor's Hall edges
+ * @param direction Direction of travel: 1 forward, -1 reverse, 0 unknown (forward)
+ * @param angles Start angle of each forward sector, see MotorConfig::hallAngles
+ * @param advance Advance angle from rotorAngleAdvance()
+ * @param nowNs Current time from motorClockNs()
+ * @return The sensed Hall code, or the next one in the direction of travel
+ *         once the advanced angle has left the current sector
+ */
+uint8_t rotorAngleDriveState(const SpeedEstimator *est, int8_t direction,
+                             const uint16_t angles[6], uint16_t advance, uint64_t nowNs);
+
+/**
+ * @brief Get the advanced rotor angle of a motor instance
+ * @param motor Motor handle (Hall commutation or FOC)
+ * @return 16-bit electrical angle including phase advance
+ */
+uint16_t motorInstanceGetRotorAngle(const Motor *motor);
+
+#endif // ROTOR_ANGLE_H
@@ -0,0 +1,173 @@
+/**
+ * @file Sensorless.h
+ * @brief Sensorless back-EMF zero-crossing commutation
+ *
+ * Motors created with COMMUTATION_SENSORLESS are driven with classic
+ * two-phase 6-step commutation: one phase PWM high, one low and the third
+ * floating (its driver disabled through the phase enable pin). The floating
+ * terminal is sampled through an AdcBackend together with the driven phase,
+ * and its crossing of the virtual neutral (half the driven phase voltage)
+ * marks the rotor 30° electrical before the next commutation point.
+ *
+ * Startup runs open loop, since there is no back-EMF at standstill:
+ * - align: energize step 0 at SENSORLESS_ALIGN_DUTY_PCT for SENSORLESS_ALIGN_MS
+ * - ramp: forced commutation from SENSORLESS_START_RPM upwards at
+ *   SENSORLESS_RAMP_RPM_PER_S with voltage proportional to speed
+ * - run: once SENSORLESS_HANDOVER_RPM is reached and zero crossings were seen
+ *   in SENSORLESS_CONFIRM_STEPS consecutive steps, commutation is scheduled
+ *   half a step period after each zero crossing and the speed regulator
+ *   takes over the duty cycle
+ * Losing SENSORLESS_MAX_MISSES zero crossings in a row restarts the startup
+ * sequence.
+ *
+ * A dedicated service thread samples every sensorless motor at
+ * SENSORLESS_SAMPLE_HZ and doubles as the commutation timer. Each step also
+ * produces a virtual Hall code, so the speed estimator, telemetry and
+ * regulator work unchanged.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef SENSORLESS_H
+#define SENSORLESS_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/** @brief Back-EMF sampling and commutation timer rate in Hz */
+#ifndef SENSORLESS_SAMPLE_HZ
+#define SENSORLESS_SAMPLE_HZ 10000
+#endif
+
+/** @brief SCHED_FIFO priority of the service thread (above the control loop) */
+#ifndef SENSORLESS_PRIORITY
+#define SENSORLESS_PRIORITY 85
+#endif
+
+/** @brief CPU the service thread is pinned to (-1 to disable pinning) */
+#ifndef SENSORLESS_CPU
+#define SENSORLESS_CPU 3
+#endif
+
+/** @brief Rotor alignment time before the open-loop ramp */
+#ifndef SENSORLESS_ALIGN_MS
+#define SENSORLESS_ALIGN_MS 200
+#endif
+
+/** @brief Duty cycle used for alignment, and the ramp voltage offset, in percent */
+#ifndef SENSORLESS_ALIGN_DUTY_PCT
+#define SENSORLESS_ALIGN_DUTY_PCT 10
+#endif
+
+/** @brief First forced commutation rate */
+#ifndef SENSORLESS_START_RPM
+#define SENSORLESS_START_RPM 200
+#endif
+
+/** @brief Open-loop ramp acceleration */
+#ifndef SENSORLESS_RAMP_RPM_PER_S
+#define SENSORLESS_RAMP_RPM_PER_S 1000
+#endif
+
+/** @brief Speed at which zero-crossing commutation may take over */
+#ifndef SENSORLESS_HANDOVER_RPM
+#define SENSORLESS_HANDOVER_RPM 800
+#endif
+
+/** @brief Consecutive steps with a zero crossing required for handover */
+#ifndef SENSORLESS_CONFIRM_STEPS
+#define SENSORLESS_CONFIRM_STEPS 6
+#endif
+
+/** @brief Consecutive missed zero crossings that restart the startup sequence */
+#ifndef SENSORLESS_MAX_MISSES
+#define SENSORLESS_MAX_MISSES 6
+#endif
+
+/** @brief Part of each step ignored after commutation (demagnetization), in percent */
+#ifndef SENSORLESS_BLANKING_PCT
+#define SENSORLESS_BLANKING_PCT 25
+#endif
+
+/** @brief Phase enable pins (BCM), -1 if the driver has none */
+#ifndef PHASE_A_ENABLE_PIN
+#define PHASE_A_ENABLE_PIN -1
+#endif
+#ifndef PHASE_B_ENABLE_PIN
+#define PHASE_B_ENABLE_PIN -1
+#endif
+#ifndef PHASE_C_ENABLE_PIN
+#define PHASE_C_ENABLE_PIN -1
+#endif
+
+/** @brief ADC channels of the phase A/B/C terminal voltage dividers */
+#ifndef BEMF_A_ADC_CHANNEL
+#define BEMF_A_ADC_CHANNEL 0
+#endif
+#ifndef BEMF_B_ADC_CHANNEL
+#define BEMF_B_ADC_CHANNEL 1
+#endif
+#ifndef BEMF_C_ADC_CHANNEL
+#define BEMF_C_ADC_CHANNEL 2
+#endif
+
+/**
+ * @brief Sensorless commutation phase
+ */
+typedef enum {
+    SENSORLESS_IDLE = 0,   ///< Motor stopped, all phases off
+    SENSORLESS_ALIGN,      ///< Holding step 0 to park the rotor
+    SENSORLESS_RAMP,       ///< Open-loop forced commutation
+    SENSORLESS_RUN         ///< Zero-crossing commutation, speed regulated
+} SensorlessState;
+
+/**
+ * @brief Per-motor sensorless commutation state
+ */
+typedef struct {
+    SensorlessState state;        ///< Current phase
+    uint8_t step;                 ///< Commutation step (0-5)
+    int8_t lastSign;              ///< Floating phase above (1) or below (-1) neutral, 0 unknown
+    uint8_t zcSeen;               ///< Zero crossing found in the current step
+    uint8_t confirmed;            ///< Consecutive ramp steps with a zero crossing
+    uint8_t misses;               ///< Consecutive run steps without a zero crossing
+    uint64_t stateStartNs;        ///< Entry time of the current phase
+    uint64_t lastCommutationNs;   ///< Time of the latest commutation
+    uint64_t lastZeroCrossNs;     ///< Time of the latest zero crossing
+    uint64_t nextCommutationNs;   ///< Scheduled commutation, 0 if none
+    uint32_t stepPeriodNs;        ///< Current step (60° electrical) period
+    uint32_t rampRpm;             ///< Forced commutation speed during the ramp
+} SensorlessEngine;
+
+/**
+ * @brief Get the sensorless commutation phase of a motor instance
+ * @param motor Motor handle
+ * @return Current phase, SENSORLESS_IDLE for Hall-commutated motors
+ */
+SensorlessState motorInstanceGetSensorlessState(const Motor *motor);
+
+/**
+ * @brief Start servicing a sensorless motor
+ * @param motor Motor created with COMMUTATION_SENSORLESS
+ * @return 0 on success, -1 if the service thread could not be started
+ * @note Used by motorCreate()
+ */
+int sensorlessAttach(Motor *motor);
+
+/**
+ * @brief Stop servicing a sensorless motor
+ * @param motor Motor handle
+ * @note Used by motorDestroy(); stops the service thread with the last motor
+ */
+void sensorlessDetach(Motor *motor);
+
+/**
+ * @brief Virtual Hall code of the current commutation step
+ * @param motor Motor handle
+ * @return Hall code (1-6) following the forward Hall sequence
+ */
+uint8_t sensorlessHallState(const Motor *motor);
+
+#endif // SENSORLESS_H
@@ -0,0 +1,150 @@
+/**
+ * @file SimMotor.h
+ * @brief Simulated BLDC motor plant for off-target testing
+ *
+ * Models a three-phase permanent magnet motor with sinusoidal back-EMF:
+ * phase currents from the applied terminal voltages (R-L plus back-EMF),
+ * electromagnetic torque, rotor inertia, viscous friction and a constant
+ * load torque. PWM is treated as its average voltage. Legs the bridge
+ * leaves floating carry no current, and an optional bus capacitor shows
+ * the voltage rise from regenerative braking. Hall codes are
+ * derived from the rotor electrical angle, aligned so that the library's
+ * commutation table drives the rotor forward.
+ *
+ * The plant plugs into the existing extension points: simPwmBackend
+ * receives the phase duty, simHallBackend reports the Hall code and
+ * simClockNs() replaces the time base through motorClockSetSource(). Time
+ * only advances in simAdvance()/simRun(), so a simulation runs as fast as
+ * the host can compute it:
+ *
+ * @code
+ * MotorConfig config;
+ * motorDefaultConfig(&config);
+ * SimMotor *sim = simMotorCreate(NULL, &config);   // selects the sim backends
+ * Motor *motor = motorCreate(&config);
+ * simMotorAttach(sim, motor);
+ * motorClockSetSource(simClockNs);
+ * motorInstanceStart(motor);
+ * motorInstanceSetSpeed(motor, 3000);
+ * simRun(2000000000ULL, 500000);                   // 2 s of motor time
+ * @endcode
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef SIM_MOTOR_H
+#define SIM_MOTOR_H
+
+#include <stdint.h>
+#include "MotorControl.h"
+
+/** @brief Integration step shared by all simulated motors */
+#ifndef SIM_STEP_NS
+#define SIM_STEP_NS 10000U  // 10us
+#endif
+
+/**
+ * @brief Electrical and mechanical plant parameters (SI units)
+ */
+typedef struct {
+    double resistance;       ///< Phase resistance (ohm)
+    double inductance;       ///< Phase inductance (H)
+    double fluxLinkage;      ///< Magnet flux linkage per phase (Wb)
+    double inertia;          ///< Rotor and load inertia (kg m^2)
+    double friction;         ///< Viscous friction (N m s/rad)
+    double loadTorque;       ///< Constant load torque opposing motion (N m)
+    double supplyVoltage;    ///< DC supply voltage (V)
+    double busCapacitance;   ///< Bus capacitor fed from the supply through a diode (F), 0 for a stiff bus
+} SimMotorParams;
+
+/** @brief Opaque simulated motor */
+typedef struct SimMotor SimMotor;
+
+/** @brief PWM backend feeding the simulated phases */
+extern const PwmBackend simPwmBackend;
+
+/** @brief Hall backend reading the simulated rotor */
+extern const HallBackend simHallBackend;
+
+/**
+ * @brief Fill parameters for a small 24V motor matching MOTOR_MAX_RPM
+ * @param params Parameters to initialize
+ */
+void simDefaultParams(SimMotorParams *params);
+
+/**
+ * @brief Create a simulated motor on the pins of a motor configuration
+ * @param params Plant parameters, or NULL for simDefaultParams()
+ * @param config Motor configuration; its pwm/hall backends are replaced
+ *               with simPwmBackend/simHallBackend
+ * @return Simulated motor, or NULL if all MOTOR_MAX_INSTANCES are in use
+ */
+SimMotor *simMotorCreate(const SimMotorParams *params, MotorConfig *config);
+
+/**
+ * @brief Release a simulated motor
+ * @param sim Simulated motor
+ */
+void simMotorDestroy(SimMotor *sim);
+
+/**
+ * @brief Connect the plant to the motor instance driving it
+ * @param sim Simulated motor
+ * @param motor Motor created from the configuration passed to simMotorCreate()
+ * @details In COMMUTATION_INTERRUPT mode every simulated Hall edge runs the
+ * commutation update immediately, as the edge handler would on hardware.
+ * Also enables motorSetExternalTick(), as simRun() drives the tick.
+ */
+void simMotorAttach(SimMotor *sim, Motor *motor);
+
+/**
+ * @brief Set the load torque
+ * @param sim Simulated motor
+ * @param torque Load torque opposing motion (N m)
+ */
+void simMotorSetLoadTorque(SimMotor *sim, double torque);
+
+/**
+ * @brief Get the simulated rotor speed
+ * @param sim Simulated motor
+ * @return Mechanical speed in RPM (negative when turning backwards)
+ */
+double simMotorGetRpm(const SimMotor *sim);
+
+/**
+ * @brief Get the simulated phase current magnitude
+ * @param sim Simulated motor
+ * @return Peak of the three phase currents (A)
+ */
+double simMotorGetCurrent(const SimMotor *sim);
+
+/**
+ * @brief Get the simulated bus voltage
+ * @param sim Simulated motor
+ * @return Voltage across the bus capacitor, or the supply voltage without one (V)
+ */
+double simMotorGetBusVoltage(const SimMotor *sim);
+
+/**
+ * @brief Simulated time
+ * @return Nanoseconds of simulated time, for motorClockSetSource()
+ */
+uint64_t simClockNs(void);
+
+/**
+ * @brief Advance every simulated motor
+ * @param durationNs Simulated time to advance
+ */
+void simAdvance(uint64_t durationNs);
+
+/**
+ * @brief Run the controller against the simulation
+ * @param durationNs Simulated time to run
+ * @param tickNs Control tick period; motorControlTick() runs after each
+ * @note Do not run the real-time control loop at the same time
+ */
+void simRun(uint64_t durationNs, uint32_t tickNs);
+
+#endif // SIM_MOTOR_H
@@ -0,0 +1,40 @@
+/**
+ * @file SpeedController.h
+ * @brief Fixed-point PI speed regulator gains
+ *
+ * The regulator runs once per control loop tick for every motor slot at
+ * once (motorBankRegulate(), MotorBank.c) and produces a PWM duty cycle
+ * from the speed error. All arithmetic is integer: gains are Q16.16 duty
+ * counts per RPM (integral gain per tick), products are formed in 64 bits
+ * and the integrator is kept in Q16.16 duty counts. This keeps the update to a few
+ * multiply-accumulates on ARMv6 cores without relying on the VFP.
+ *
+ * The open-loop duty (rpm * PWM_RANGE / MOTOR_MAX_RPM) is applied as
+ * feedforward, so the integrator only has to cover load and losses.
+ * Anti-windup uses conditional integration: the integrator stops moving
+ * while the output is saturated in the direction of the error.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef SPEED_CONTROLLER_H
+#define SPEED_CONTROLLER_H
+
+#include <stdint.h>
+
+/** @brief Convert a constant to Q16.16 (compile-time use only) */
+#define Q16(x) ((int32_t) ((x) * 65536.0))
+
+/** @brief Default proportional gain (duty counts per RPM) */
+#ifndef SPEED_KP_Q16
+#define SPEED_KP_Q16 Q16(0.05)
+#endif
+
+/** @brief Default integral gain (duty counts per RPM per control tick) */
+#ifndef SPEED_KI_Q16
+#define SPEED_KI_Q16 Q16(0.0005)
+#endif
+
+#endif // SPEED_CONTROLLER_H
@@ -0,0 +1,85 @@
+/**
+ * @file SpeedEstimator.h
+ * @brief Hall edge based rotor speed measurement
+ *
+ * Each Hall transition marks a 60° electrical sector. The estimator
+ * timestamps transitions, averages the sector periods over one electrical
+ * revolution (which cancels Hall sensor placement error) and converts the
+ * result to mechanical RPM using the motor pole count. Between edges the
+ * estimate is bounded by the time since the last edge, so deceleration is
+ * tracked without waiting for the next transition, and it drops to zero
+ * once no edge has been seen for the configured timeout.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef SPEED_ESTIMATOR_H
+#define SPEED_ESTIMATOR_H
+
+#include <stdint.h>
+
+/** @brief Sector periods averaged (6 = one electrical revolution) */
+#define SPEED_FILTER_SECTORS 6
+
+/** @brief Default time without Hall edges after which speed reads 0 */
+#ifndef SPEED_ZERO_TIMEOUT_NS
+#define SPEED_ZERO_TIMEOUT_NS 100000000U  // 100ms
+#endif
+
+/**
+ * @brief Speed estimator state
+ */
+typedef struct {
+    uint64_t lastEdgeNs;                        ///< Timestamp of the latest Hall edge
+    uint32_t periods[SPEED_FILTER_SECTORS];     ///< Recent sector periods (ns)
+    uint64_t periodSum;                         ///< Sum of valid entries in periods
+    uint8_t index;                              ///< Next slot in periods
+    uint8_t count;                              ///< Valid entries in periods
+    uint8_t lastHallState;                      ///< Hall state at the latest edge
+    uint8_t polePairs;                          ///< Motor pole pairs
+    uint32_t timeoutNs;                         ///< Zero-speed timeout
+    uint16_t rpm;                               ///< Latest mechanical speed estimate
+} SpeedEstimator;
+
+/**
+ * @brief Initialize a speed estimator
+ * @param est Estimator to initialize
+ * @param numPoles Number of motor poles (e.g. NUM_POLES)
+ * @param timeoutNs Time without edges after which speed is reported as 0
+ */
+void speedEstimatorInit(SpeedEstimator *est, uint8_t numPoles, uint32_t timeoutNs);
+
+/**
+ * @brief Feed a Hall sample
+ * @param est Estimator
+ * @param hallState Packed Hall state (1-6 valid)
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @details A change of state is recorded as an edge; invalid states are ignored
+ */
+void speedEstimatorSample(SpeedEstimator *est, uint8_t hallState, uint64_t nowNs);
+
+/**
+ * @brief Apply the zero-speed timeout and between-edge decay
+ * @param est Estimator
+ * @param nowNs Current time from motorClockNs()
+ * @note Call periodically (e.g. every control loop tick)
+ */
+void speedEstimatorUpdate(SpeedEstimator *est, uint64_t nowNs);
+
+/**
+ * @brief Get the latest speed estimate
+ * @param est Estimator
+ * @return Mechanical speed in RPM
+ */
+uint16_t speedEstimatorGetRpm(const SpeedEstimator *est);
+
+/**
+ * @brief Get the averaged electrical sector period
+ * @param est Estimator
+ * @return Average time per 60° electrical sector in ns, 0 if not rotating
+ */
+uint32_t speedEstimatorGetSectorPeriodNs(const SpeedEstimator *est);
+
+#endif // SPEED_ESTIMATOR_H
@@ -0,0 +1,98 @@
+/**
+ * @file SpeedRamp.h
+ * @brief Jerk-limited speed setpoint ramp
+ *
+ * Generates the speed profile the regulator follows when the requested
+ * speed changes. The acceleration is limited to a maximum and, when a jerk
+ * limit is set, itself slews at that rate, giving an S-curve; with a jerk
+ * limit of 0 the profile is trapezoidal. Advancing the profile is done from
+ * the control loop with the elapsed time, so callers never block.
+ *
+ * State is Q16.16 fixed point (RPM and RPM/s).
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef SPEED_RAMP_H
+#define SPEED_RAMP_H
+
+#include <stdint.h>
+
+/** @brief Default acceleration limit in RPM per second */
+#ifndef RAMP_ACCEL_RPM_PER_S
+#define RAMP_ACCEL_RPM_PER_S 5000
+#endif
+
+/** @brief Default jerk limit in RPM per second squared (0 = trapezoidal) */
+#ifndef RAMP_JERK_RPM_PER_S2
+#define RAMP_JERK_RPM_PER_S2 20000
+#endif
+
+/**
+ * @brief Ramp generator state
+ */
+typedef struct {
+    int64_t speed;       ///< Profile speed, Q16.16 RPM
+    int64_t accel;       ///< Profile acceleration, Q16.16 RPM/s
+    int64_t maxAccel;    ///< Acceleration limit, Q16.16 RPM/s
+    int64_t jerk;        ///< Jerk limit, Q16.16 RPM/s^2 (0 = unlimited)
+    int32_t target;      ///< Requested speed (RPM)
+} SpeedRamp;
+
+/**
+ * @brief Initialize a ramp at rest
+ * @param ramp Ramp to initialize
+ * @param accelRpmPerSec Acceleration limit, at least 1
+ * @param jerkRpmPerSec2 Jerk limit, 0 for a trapezoidal profile
+ */
+void speedRampInit(SpeedRamp *ramp, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2);
+
+/**
+ * @brief Change the ramp limits
+ * @param ramp Ramp
+ * @param accelRpmPerSec Acceleration limit, 1 to UINT32_MAX
+ * @param jerkRpmPerSec2 Jerk limit, 0 for a trapezoidal profile
+ * @return 0 on success, -1 if accelRpmPerSec is 0 (the limits are left unchanged)
+ * @note A zero acceleration limit would hold the profile where it is forever
+ */
+int speedRampSetLimits(SpeedRamp *ramp, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2);
+
+/**
+ * @brief Set the speed the profile should reach
+ * @param ramp Ramp
+ * @param rpm Target speed
+ */
+void speedRampSetTarget(SpeedRamp *ramp, int32_t rpm);
+
+/**
+ * @brief Jump the profile to a speed with zero acceleration
+ * @param ramp Ramp
+ * @param rpm Speed to continue from (also becomes the target)
+ */
+void speedRampReset(SpeedRamp *ramp, int32_t rpm);
+
+/**
+ * @brief Advance the profile
+ * @param ramp Ramp
+ * @param dtNs Time since the previous update
+ * @return Profile speed in RPM
+ */
+int32_t speedRampUpdate(SpeedRamp *ramp, uint32_t dtNs);
+
+/**
+ * @brief Get the current profile speed
+ * @param ramp Ramp
+ * @return Profile speed in RPM
+ */
+int32_t speedRampGetSpeed(const SpeedRamp *ramp);
+
+/**
+ * @brief Check whether the profile has reached its target
+ * @param ramp Ramp
+ * @return 1 if settled at the target, 0 while ramping
+ */
+int speedRampIsSettled(const SpeedRamp *ramp);
+
+#endif // SPEED_RAMP_H
@@ -0,0 +1,148 @@
+/**
+ * @file Telemetry.h
+ * @brief Lock-free telemetry ring exported through shared memory
+ *
+ * The control loop writes one fixed-size binary sample per motor per tick
+ * into a ring that lives in a POSIX shared memory object. Writing a sample
+ * is a handful of stores with no syscall and no copy beyond the sample
+ * itself; external tools map the same object read-only and follow the ring
+ * at full loop rate.
+ *
+ * There is one writer (the control loop) and any number of readers, each
+ * with its own cursor. The writer never waits for readers: a reader that
+ * falls more than one ring behind skips ahead and is told how many samples
+ * it lost. Each slot carries a sequence word (odd while being written,
+ * 2 * (index + 1) once complete) so readers detect torn or lapped slots.
+ *
+ * Shared memory layout: TelemetryHeader followed by capacity TelemetrySlot
+ * entries. All fields are native endian.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/** @brief Default shared memory object name */
+#ifndef TELEMETRY_SHM_NAME
+#define TELEMETRY_SHM_NAME "/motor_telemetry"
+#endif
+
+/** @brief Default ring capacity in samples (power of two) */
+#ifndef TELEMETRY_CAPACITY
+#define TELEMETRY_CAPACITY 4096
+#endif
+
+/** @brief Header magic, "MTLM" */
+#define TELEMETRY_MAGIC 0x4D544C4DU
+
+/** @brief Layout version, bumped on any incompatible change */
+#define TELEMETRY_VERSION 1
+
+/** @brief Fault bits carried in TelemetrySample::faults */
+#define TELEMETRY_FAULT_HALL_INVALID 0x0001  ///< Hall sample rejected by the validator
+#define TELEMETRY_FAULT_OVERCURRENT  0x0002  ///< Phase current above limit
+#define TELEMETRY_FAULT_HALL_LOST    0x0004  ///< MOTOR_FAULT_HALL latched
+
+/**
+ * @brief One control tick of one motor
+ */
+typedef struct {
+    uint64_t timestampNs;    ///< motorClockNs() at the start of the tick
+    uint16_t duty[3];        ///< Phase A/B/C duty written this tick
+    uint16_t rpm;            ///< Measured speed
+    uint16_t setpoint;       ///< Ramp setpoint
+    uint16_t faults;         ///< TELEMETRY_FAULT_* bits
+    uint8_t motor;           ///< Motor pool index
+    uint8_t hallState;       ///< Hall sensor state (0-7)
+    uint8_t overrun;         ///< 1 if the previous loop tick overran its deadline
+    uint8_t reserved;        ///< 0
+} TelemetrySample;
+
+/**
+ * @brief Ring slot
+ */
+typedef struct {
+    atomic_uint seq;         ///< Odd while being written, 2 * (index + 1) when valid
+    uint32_t reserved;       ///< 0
+    TelemetrySample sample;  ///< Sample payload
+} TelemetrySlot;
+
+/**
+ * @brief Shared memory header
+ */
+typedef struct {
+    uint32_t magic;          ///< TELEMETRY_MAGIC
+    uint16_t version;        ///< TELEMETRY_VERSION
+    uint16_t slotSize;       ///< sizeof(TelemetrySlot)
+    uint32_t capacity;       ///< Number of slots (power of two)
+    uint32_t reserved;       ///< 0
+    _Alignas(64) atomic_uint head; ///< Samples written since creation
+} TelemetryHeader;
+
+/**
+ * @brief Reader side handle
+ */
+typedef struct {
+    const TelemetryHeader *header;  ///< Mapped header
+    const TelemetrySlot *slots;     ///< Mapped ring
+    uint32_t cursor;                ///< Index of the next sample to read
+    uint32_t lost;                  ///< Samples skipped because the writer lapped us
+    uint32_t mapSize;               ///< Mapping length
+} TelemetryReader;
+
+/**
+ * @brief Create the shared memory ring and start recording
+ * @param name Shared memory object name, or NULL for TELEMETRY_SHM_NAME
+ * @param capacity Ring size in samples (power of two), or 0 for TELEMETRY_CAPACITY
+ * @return 0 on success, -1 on failure
+ */
+int telemetryOpen(const char *name, uint32_t capacity);
+
+/**
+ * @brief Stop recording and remove the shared memory object
+ */
+void telemetryClose(void);
+
+/**
+ * @brief Check whether telemetry is being recorded
+ * @return 1 if open, 0 otherwise
+ */
+int telemetryIsOpen(void);
+
+/**
+ * @brief Append a sample (control loop thread only)
+ * @param sample Sample to copy into the ring
+ * @note Never blocks; does nothing if telemetry is not open
+ */
+void telemetryPush(const TelemetrySample *sample);
+
+/**
+ * @brief Map an existing ring for reading
+ * @param reader Reader handle to initialize
+ * @param name Shared memory object name, or NULL for TELEMETRY_SHM_NAME
+ * @return 0 on success, -1 on failure
+ * @note The cursor starts at the newest sample; older ones are not replayed
+ */
+int telemetryReaderOpen(TelemetryReader *reader, const char *name);
+
+/**
+ * @brief Read the next sample
+ * @param reader Reader handle
+ * @param sample Destination for the sample
+ * @return 1 if a sample was read, 0 if none is available yet
+ */
+int telemetryReaderNext(TelemetryReader *reader, TelemetrySample *sample);
+
+/**
+ * @brief Unmap a reader
+ * @param reader Reader handle
+ */
+void telemetryReaderClose(TelemetryReader *reader);
+
+#endif // TELEMETRY_H
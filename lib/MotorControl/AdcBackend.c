@@ -0,0 +1,47 @@
+/**
+ * @file AdcBackend.c
+ * @brief Analog input backend implementations
+ *
+ * An MCP3008 conversion is one 3-byte full-duplex SPI transfer: start bit,
+ * single-ended channel select, then the 10-bit result clocked back in the
+ * last 10 bits.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <wiringPiSPI.h>
+#include "AdcBackend.h"
+
+/* ---------------------------------------------------------------------------
+ * MCP3008 backend
+ * ------------------------------------------------------------------------- */
+
+static int mcp3008Ready = 0;  ///< SPI channel opened
+
+static int mcp3008Setup(void) {
+    if (mcp3008Ready) return 0;
+    if (wiringPiSPISetup(ADC_SPI_CHANNEL, ADC_SPI_SPEED) < 0) {
+        printf("Failed to open SPI channel %d for MCP3008\n", ADC_SPI_CHANNEL);
+        return -1;
+    }
+    mcp3008Ready = 1;
+    return 0;
+}
+
+static int mcp3008Read(int channel) {
+    if (channel < 0 || channel > 7) return -1;
+
+    unsigned char data[3] = { 0x01, (unsigned char) ((0x08 | channel) << 4), 0x00 };
+    if (wiringPiSPIDataRW(ADC_SPI_CHANNEL, data, sizeof(data)) < 0) return -1;
+    return ((data[1] & 0x03) << 8) | data[2];
+}
+
+const AdcBackend mcp3008AdcBackend = {
+    .name = "mcp3008",
+    .setup = mcp3008Setup,
+    .read = mcp3008Read,
+    .fullScale = 1023,
+};
@@ -0,0 +1,222 @@
+/**
+ * @file Autotune.c
+ * @brief Speed loop gain identification by open-loop step response
+ *
+ * In duty counts u and speed y, the fitted plant is
+ *   y(s) / u(s) = K e^(-theta s) / (tau s + 1)
+ * K is kept in Q16.16 RPM per count; kp comes out in Q16.16 counts per RPM
+ * as the regulator expects, and ki is scaled to one control tick.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Autotune.h"
+#include "ControlLoop.h"
+#include "MotorInternal.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+
+/** @brief Spacing of the recorded step response samples */
+#define SAMPLE_INTERVAL_NS (AUTOTUNE_STEP_MS * NSEC_PER_MSEC / AUTOTUNE_SAMPLES)
+
+/** @brief Control tick period the integral gain is scaled to */
+#define TICK_NS (1000000000ULL / CONTROL_LOOP_RATE_HZ)
+
+/**
+ * @brief Begin a step experiment
+ * @param tuner Experiment state
+ * @param baseRpm Baseline setpoint
+ * @param stepRpm Setpoint step
+ * @param pwmRange Duty full scale
+ * @param maxRpm Speed at full duty
+ * @param nowNs Current time from motorClockNs()
+ */
+void autotuneBegin(Autotuner *tuner, uint16_t baseRpm, uint16_t stepRpm,
+                   uint16_t pwmRange, uint16_t maxRpm, uint64_t nowNs) {
+    AutotuneState previous = tuner->state;
+    AutotuneResult result = tuner->result;
+    memset(tuner, 0, sizeof(*tuner));
+    tuner->state = AUTOTUNE_SETTLE;
+    tuner->baseRpm = baseRpm;
+    tuner->stepRpm = stepRpm;
+    tuner->pwmRange = pwmRange;
+    tuner->maxRpm = maxRpm;
+    tuner->phaseStartNs = nowNs;
+    // Keep the last good result readable until this run completes
+    if (previous == AUTOTUNE_DONE) tuner->result = result;
+}
+
+/**
+ * @brief Time the recorded response first reaches a speed
+ * @return Crossing time after the step, interpolated between samples; 0 if
+ *         it is not reached before the final tail samples
+ */
+static uint64_t crossingNs(const Autotuner *tuner, int32_t threshold, int tail) {
+    int k = 0;
+    while (k < AUTOTUNE_SAMPLES - tail && tuner->samples[k] < threshold) k++;
+    if (k == AUTOTUNE_SAMPLES - tail) return 0;
+
+    uint64_t timeNs = (uint64_t) k * SAMPLE_INTERVAL_NS;
+    int32_t rise = k > 0 ? tuner->samples[k] - tuner->samples[k - 1] : 0;
+    if (rise > 0) timeNs -= (uint64_t) (tuner->samples[k] - threshold) * SAMPLE_INTERVAL_NS / rise;
+    return timeNs;
+}
+
+/** @brief Fit the recorded response and derive the gains */
+static AutotuneState identify(Autotuner *tuner) {
+    // Final speed: mean of the last eighth of the record
+    int tail = AUTOTUNE_SAMPLES / 8;
+    int64_t sum = 0;
+    for (int k = AUTOTUNE_SAMPLES - tail; k < AUTOTUNE_SAMPLES; k++) sum += tuner->samples[k];
+    int32_t change = (int32_t) (sum / tail) - tuner->baseline;
+    if (change <= 0) {
+        printf("Autotune: no speed response to the step\n");
+        return AUTOTUNE_FAILED;
+    }
+
+    // Two-point fit: tau = 1.5 (t63 - t28), dead time = t63 - tau
+    uint64_t t28 = crossingNs(tuner, tuner->baseline + change * 283 / 1000, tail);
+    uint64_t t63 = crossingNs(tuner, tuner->baseline + change * 632 / 1000, tail);
+    if (t63 == 0) {
+        printf("Autotune: response did not settle within %d ms\n", AUTOTUNE_STEP_MS);
+        return AUTOTUNE_FAILED;
+    }
+    uint64_t tauNs = (t63 - t28) * 3 / 2;
+    if (tauNs < SAMPLE_INTERVAL_NS) tauNs = SAMPLE_INTERVAL_NS;
+    uint64_t deadNs = t63 > tauNs ? t63 - tauNs : 0;
+
+    int64_t dutyStep = (int64_t) tuner->stepRpm * tuner->pwmRange / tuner->maxRpm;
+    if (dutyStep <= 0) return AUTOTUNE_FAILED;
+
+    // SIMC: kp = tau / (K (lambda + theta)), Ti = min(tau, 4 (lambda + theta))
+    uint64_t lambdaNs = tauNs * AUTOTUNE_LAMBDA_PCT / 100;
+    if (lambdaNs < deadNs) lambdaNs = deadNs;
+    uint64_t horizonNs = lambdaNs + deadNs;
+    uint64_t integralNs = tauNs < 4 * horizonNs ? tauNs : 4 * horizonNs;
+    int64_t kp = (int64_t) (((uint64_t) dutyStep * tauNs << 16) / ((uint64_t) change * horizonNs));
+    int64_t ki = kp * (int64_t) TICK_NS / (int64_t) integralNs;
+    if (kp > INT32_MAX) kp = INT32_MAX;
+
+    tuner->result.plantGainQ16 = (int32_t) (((int64_t) change << 16) / dutyStep);
+    tuner->result.timeConstantUs = (uint32_t) (tauNs / 1000);
+    tuner->result.deadTimeUs = (uint32_t) (deadNs / 1000);
+    tuner->result.kp = (int32_t) kp;
+    tuner->result.ki = (int32_t) (ki > INT32_MAX ? INT32_MAX : ki);
+    return AUTOTUNE_DONE;
+}
+
+/**
+ * @brief Advance the experiment by one control tick
+ * @param tuner Experiment state
+ * @param nowNs Tick timestamp
+ * @param measured Measured speed (RPM)
+ * @return Setpoint to apply this tick
+ */
+uint16_t autotuneUpdate(Autotuner *tuner, uint64_t nowNs, int32_t measured) {
+    uint64_t elapsed = nowNs - tuner->phaseStartNs;
+
+    if (tuner->state == AUTOTUNE_SETTLE) {
+        uint64_t settleNs = AUTOTUNE_SETTLE_MS * NSEC_PER_MSEC;
+        if (elapsed >= settleNs * 3 / 4) {
+            tuner->baselineSum += measured;
+            tuner->baselineCount++;
+        }
+        if (elapsed < settleNs) return tuner->baseRpm;
+
+        tuner->baseline = (int32_t) (tuner->baselineSum / tuner->baselineCount);
+        if (tuner->baseline == 0) {
+            printf("Autotune: motor not turning at %d RPM\n", tuner->baseRpm);
+            tuner->state = AUTOTUNE_FAILED;
+            return 0;
+        }
+        tuner->state = AUTOTUNE_STEP;
+        tuner->phaseStartNs = nowNs;
+        elapsed = 0;
+    }
+
+    if (tuner->state != AUTOTUNE_STEP) return 0;
+
+    uint16_t sample = (uint16_t) (measured < 0 ? 0 : measured > UINT16_MAX ? UINT16_MAX : measured);
+    while (tuner->count < AUTOTUNE_SAMPLES && elapsed >= tuner->count * SAMPLE_INTERVAL_NS) {
+        tuner->samples[tuner->count++] = sample;
+    }
+    if (tuner->count == AUTOTUNE_SAMPLES) tuner->state = identify(tuner);
+    return (uint16_t) (tuner->baseRpm + tuner->stepRpm);
+}
+
+/**
+ * @brief Check whether an experiment is in progress
+ * @param tuner Experiment state
+ * @return 1 while settling or recording, 0 otherwise
+ */
+int autotuneActive(const Autotuner *tuner) {
+    return tuner->state == AUTOTUNE_SETTLE || tuner->state == AUTOTUNE_STEP;
+}
+
+/**
+ * @brief Get the experiment progress of a motor instance
+ * @param motor Motor handle
+ * @return Current state
+ */
+AutotuneState motorInstanceGetAutotuneState(const Motor *motor) {
+    return motor->autotune.state;
+}
+
+/**
+ * @brief Get the identified plant and gains of a motor instance
+ * @param motor Motor handle
+ * @param result Receives the result
+ * @return 0 on success, -1 unless the last experiment completed
+ */
+int motorInstanceGetAutotuneResult(const Motor *motor, AutotuneResult *result) {
+    if (motor->autotune.state != AUTOTUNE_DONE) return -1;
+    *result = motor->autotune.result;
+    return 0;
+}
+
+/**
+ * @brief Identify the gains of the default motor
+ * @return 0 if the experiment was queued, -1 otherwise
+ */
+int motorAutotune(void) {
+    Motor *motor = motorGetDefault();
+    return motor != NULL ? motorInstanceAutotune(motor) : -1;
+}
+
+/**
+ * @brief Get the experiment progress of the default motor
+ * @return Current state, AUTOTUNE_IDLE before motorInit()
+ */
+AutotuneState motorGetAutotuneState(void) {
+    Motor *motor = motorGetDefault();
+    return motor != NULL ? motorInstanceGetAutotuneState(motor) : AUTOTUNE_IDLE;
+}
+
+/**
+ * @brief Write identified gains as calibration text
+ * @param result Completed experiment result
+ * @param path Output file
+ * @return 0 on success, -1 if the file cannot be written
+ */
+int autotuneSaveGains(const AutotuneResult *result, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Cannot write gains to %s\n", path);
+        return -1;
+    }
+    fprintf(file, "# Speed loop gains identified by motorInstanceAutotune()\n");
+    fprintf(file, "# plant gain %.3f RPM per duty count, time constant %u us\n",
+            result->plantGainQ16 / 65536.0, result->timeConstantUs);
+    fprintf(file, "speed_kp_q16 = %d\n", result->kp);
+    fprintf(file, "speed_ki_q16 = %d\n", result->ki);
+    int failed = ferror(file);
+    if (fclose(file) != 0 || failed) {
+        printf("Cannot write gains to %s\n", path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file Brake.c
+ * @brief Bus voltage foldback of regenerative braking
+ *
+ * The braking sequence itself runs in motorControlTick() (MotorControl.c),
+ * which owns the ramp and the bridge outputs; this file holds the limit
+ * law so it can be checked on its own.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include "Brake.h"
+
+/**
+ * @brief Deceleration limit of regenerative braking at a bus voltage
+ * @param decel Deceleration limit with the bus at or below limitMv - BRAKE_VOLTAGE_BAND_MV (RPM/s)
+ * @param busMv Measured bus voltage
+ * @param limitMv Bus voltage at which the deceleration reaches zero
+ * @return Deceleration limit (RPM/s), falling linearly to 0 at limitMv
+ */
+uint32_t brakeRegenDecel(uint32_t decel, int32_t busMv, uint32_t limitMv) {
+    int64_t headroom = (int64_t) limitMv - busMv;
+    if (headroom <= 0) return 0;
+    if (headroom >= BRAKE_VOLTAGE_BAND_MV) return decel;
+    return (uint32_t) ((uint64_t) decel * (uint64_t) headroom / BRAKE_VOLTAGE_BAND_MV);
+}
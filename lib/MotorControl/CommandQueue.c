@@ -0,0 +1,83 @@
+/**
+ * @file CommandQueue.c
+ * @brief Lock-free single-producer/single-consumer motor command queue
+ *
+ * The producer publishes a slot with a release store of head after writing
+ * it, and the consumer frees a slot with a release store of tail after
+ * reading it. Each side only reads the other side's counter with acquire
+ * ordering, which is all the synchronization an SPSC ring needs.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include "CommandQueue.h"
+
+#define COMMAND_QUEUE_MASK (COMMAND_QUEUE_SIZE - 1u)
+
+/**
+ * @brief Initialize an empty queue
+ * @param queue Queue to initialize
+ */
+void commandQueueInit(CommandQueue *queue) {
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+/**
+ * @brief Push a command (producer side)
+ * @param queue Queue
+ * @param command Command to copy into the queue
+ * @return 0 on success, -1 if the queue is full
+ */
+int commandQueuePush(CommandQueue *queue, const MotorCommand *command) {
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head - tail >= COMMAND_QUEUE_SIZE) return -1;
+
+    queue->slots[head & COMMAND_QUEUE_MASK] = *command;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Pop the oldest command (consumer side)
+ * @param queue Queue
+ * @param command Destination for the command
+ * @return 1 if a command was popped, 0 if the queue is empty
+ */
+int commandQueuePop(CommandQueue *queue, MotorCommand *command) {
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail == head) return 0;
+
+    *command = queue->slots[tail & COMMAND_QUEUE_MASK];
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief Read the oldest command without removing it (consumer side)
+ * @param queue Queue
+ * @param command Destination for the command
+ * @return 1 if a command was read, 0 if the queue is empty
+ */
+int commandQueuePeek(CommandQueue *queue, MotorCommand *command) {
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail == head) return 0;
+
+    *command = queue->slots[tail & COMMAND_QUEUE_MASK];
+    return 1;
+}
+
+/**
+ * @brief Check whether a queue holds no command (consumer side)
+ * @param queue Queue
+ * @return 1 if empty, 0 otherwise
+ */
+int commandQueueIsEmpty(CommandQueue *queue) {
+    unsigned tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    return tail == atomic_load_explicit(&queue->head, memory_order_acquire);
+}
@@ -0,0 +1,513 @@
+/**
+ * @file ControlLoop.c
+ * @brief Real-time periodic control loop implementation
+ *
+ * The loop thread computes each deadline as start + n * period and sleeps
+ * with clock_nanosleep(TIMER_ABSTIME), so latency in one tick never shifts
+ * the following ones. A tick that overruns its slot is counted and the loop
+ * skips to the next future deadline instead of running a burst of late
+ * ticks back to back.
+ *
+ * Statistics are published through a sequence counter: the loop thread
+ * never blocks on a reader, and readers retry if they raced with an update.
+ * The sync pulse handler hands its timestamps to the loop the same way.
+ *
+ * With CONTROL_SYNC_TAI the schedule lives on CLOCK_TAI and deadlines are
+ * exact multiples of the period, so a clock adjustment by the PTP daemon
+ * moves the ticks with it. With CONTROL_SYNC_GPIO each pulse relabels the
+ * tick indices and leaves a phase correction that is paid off a few
+ * nanoseconds per tick, so the period never changes abruptly.
+ *
+ * While idle the thread waits in ppoll() on an eventfd instead of sleeping
+ * on the next deadline. controlLoopWake() only writes the eventfd when the
+ * thread has announced it is about to wait, and the thread checks for work
+ * again after announcing, so a command can never be stranded in a queue
+ * for a whole idle period. On waking, the thread skips the full-rate
+ * deadlines that passed, exactly as after an overrun.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/timex.h>
+#include <wiringPi.h>
+#include "MotorControl.h"
+#include "ControlLoop.h"
+#include "MotorTiming.h"
+
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_MSEC 1000000LL
+
+/** @brief Control thread stack size */
+#define CONTROL_LOOP_STACK_SIZE (256 * 1024)
+
+/** @brief Portion of the stack touched up front so it is resident */
+#define CONTROL_LOOP_PREFAULT_SIZE (64 * 1024)
+
+static pthread_t loopThread;                 ///< Control thread handle
+static ControlLoopConfig loopConfig;         ///< Active configuration
+static atomic_int loopRunning = 0;           ///< Thread is alive
+static atomic_int loopStopRequested = 0;     ///< Ask the thread to exit
+
+static ControlLoopStats loopStats;           ///< Written by the loop thread only
+static atomic_uint statsSeq = 0;             ///< Odd while loopStats is being updated
+static clockid_t loopClock = CLOCK_MONOTONIC; ///< Clock the deadlines are scheduled on
+static int wakeFd = -1;                      ///< Ends an idle wait; created once, never closed
+static atomic_int loopWaiting = 0;           ///< The thread is (about to be) waiting on wakeFd
+
+static int64_t pulseMonotonicNs;             ///< CLOCK_MONOTONIC at the latest sync pulse
+static int64_t pulseRealtimeNs;              ///< CLOCK_REALTIME at the latest sync pulse
+static atomic_uint pulseSeq = 0;             ///< Odd while the pulse timestamps are being updated
+
+/**
+ * @brief Sync state of the loop thread
+ */
+typedef struct {
+    unsigned pulseSeq;       ///< pulseSeq of the latest pulse applied
+    int64_t lastPulseNs;     ///< Deadline clock time of that pulse
+    int64_t slewNs;          ///< Phase correction not applied yet
+    int32_t errorNs;         ///< Latest phase error
+    uint64_t steps;          ///< Phase steps
+    uint64_t checkIndex;     ///< Tick index of the latest TAI synchronization check
+    uint8_t synced;          ///< Aligned to the time base
+} SyncState;
+
+static int64_t timespecToNs(const struct timespec *ts) {
+    return (int64_t) ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static struct timespec nsToTimespec(int64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+static int64_t clockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return timespecToNs(&ts);
+}
+
+/**
+ * @brief Phase error of a sync pulse against the tick schedule
+ * @param pulseNs Pulse timestamp
+ * @param deadlineNs Any tick deadline on the same clock
+ * @param periodNs Tick period
+ * @param ticks Receives the offset of the tick nearest the pulse from deadlineNs, may be NULL
+ * @return Pulse time minus the nearest deadline, in (-periodNs/2, periodNs/2]
+ */
+int64_t controlSyncPhaseError(int64_t pulseNs, int64_t deadlineNs, int64_t periodNs, int64_t *ticks) {
+    int64_t offset = pulseNs - deadlineNs;
+    int64_t error = offset % periodNs;
+    if (error < 0) error += periodNs;
+    if (error > periodNs / 2) error -= periodNs;
+    if (ticks != NULL) *ticks = (offset - error) / periodNs;
+    return error;
+}
+
+/**
+ * @brief Tick index a sync pulse marks
+ * @param realtimeNs CLOCK_REALTIME at the pulse
+ * @param periodNs Tick period
+ * @param pulseTicks Ticks between pulses
+ * @return Multiple of pulseTicks whose nominal time is nearest realtimeNs
+ */
+uint64_t controlSyncPulseIndex(uint64_t realtimeNs, uint32_t periodNs, uint32_t pulseTicks) {
+    uint64_t pulsePeriodNs = (uint64_t) periodNs * pulseTicks;
+    return (realtimeNs + pulsePeriodNs / 2) / pulsePeriodNs * pulseTicks;
+}
+
+/** @brief Sync pulse edge handler: timestamp only */
+static void syncPulseIsr(void) {
+    int64_t monotonic = clockNs(CLOCK_MONOTONIC);
+    int64_t realtime = clockNs(CLOCK_REALTIME);
+    atomic_fetch_add_explicit(&pulseSeq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    pulseMonotonicNs = monotonic;
+    pulseRealtimeNs = realtime;
+    atomic_fetch_add_explicit(&pulseSeq, 1, memory_order_release);
+}
+
+/**
+ * @brief Fetch a sync pulse not applied yet
+ * @return 1 if a new pulse was read, 0 otherwise
+ */
+static int takePulse(SyncState *sync, int64_t *monotonic, int64_t *realtime) {
+    unsigned seq = atomic_load_explicit(&pulseSeq, memory_order_acquire);
+    if ((seq & 1u) || seq == sync->pulseSeq) return 0;
+    *monotonic = pulseMonotonicNs;
+    *realtime = pulseRealtimeNs;
+    atomic_thread_fence(memory_order_acquire);
+    if (seq != atomic_load_explicit(&pulseSeq, memory_order_relaxed)) return 0;  // retry next tick
+    sync->pulseSeq = seq;
+    return 1;
+}
+
+/**
+ * @brief Align the next deadline and tick index to the sync pulse
+ * @param deadline Next deadline (CLOCK_MONOTONIC)
+ * @param index Index of the tick due at *deadline
+ */
+static void followPulse(SyncState *sync, int64_t *deadline, uint64_t *index, int64_t periodNs) {
+    int64_t monotonic, realtime;
+    if (takePulse(sync, &monotonic, &realtime)) {
+        int64_t ticks;
+        int64_t error = controlSyncPhaseError(monotonic, *deadline, periodNs, &ticks);
+        // The tick nearest the pulse carries the index the pulse marks
+        *index = controlSyncPulseIndex((uint64_t) realtime, (uint32_t) periodNs,
+                                       loopConfig.syncPulseTicks) - (uint64_t) ticks;
+        if (!sync->synced || error > periodNs / 4 || error < -periodNs / 4) {
+            *deadline += error;
+            sync->slewNs = 0;
+            sync->steps++;
+        } else {
+            sync->slewNs = error;
+        }
+        sync->errorNs = (int32_t) error;
+        sync->lastPulseNs = monotonic;
+        sync->synced = 1;
+    }
+
+    int64_t step = sync->slewNs;
+    if (step > CONTROL_SYNC_SLEW_NS) step = CONTROL_SYNC_SLEW_NS;
+    if (step < -CONTROL_SYNC_SLEW_NS) step = -CONTROL_SYNC_SLEW_NS;
+    *deadline += step;
+    sync->slewNs -= step;
+
+    int64_t timeoutNs = (int64_t) CONTROL_SYNC_LOST_PULSES * loopConfig.syncPulseTicks * periodNs;
+    if (sync->synced && *deadline - sync->lastPulseNs > timeoutNs) sync->synced = 0;
+}
+
+/** @brief Whether the kernel considers CLOCK_TAI disciplined */
+static uint8_t taiSynchronized(void) {
+    struct timex tx;
+    memset(&tx, 0, sizeof(tx));
+    return adjtimex(&tx) != TIME_ERROR;
+}
+
+/** @brief Post a wake-up to the loop thread, whether or not it waits */
+static void signalWake(void) {
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void) written;  // Only fails if the counter is already saturated, i.e. already woken
+}
+
+/**
+ * @brief Wait while the motors are idle
+ * @param deadline Next full-rate deadline; moved to the first one after the wait
+ * @param index Index of the tick due at *deadline, moved with it
+ * @param idlePeriodNs Longest wait, 0 to wait until woken
+ * @return 1 if woken by controlLoopWake(), 0 if the wait timed out or was abandoned
+ */
+static int idleWait(int64_t *deadline, uint64_t *index, int64_t periodNs, int64_t idlePeriodNs) {
+    atomic_store(&loopWaiting, 1);
+    // Pairs with the fence in controlLoopWake(): either the producer sees
+    // loopWaiting and signals, or this check sees its command
+    atomic_thread_fence(memory_order_seq_cst);
+    int woken = 0;
+    if (motorControlIsIdle() && !atomic_load_explicit(&loopStopRequested, memory_order_relaxed)) {
+        int64_t until = *deadline - periodNs + idlePeriodNs;
+        struct pollfd pfd = { .fd = wakeFd, .events = POLLIN };
+        for (;;) {
+            int64_t remaining = until - clockNs(loopClock);
+            if (idlePeriodNs > 0 && remaining <= 0) break;
+            struct timespec timeout = nsToTimespec(remaining);
+            int ready = ppoll(&pfd, 1, idlePeriodNs > 0 ? &timeout : NULL, NULL);
+            if (ready >= 0 || errno != EINTR) break;
+        }
+        uint64_t count;
+        woken = read(wakeFd, &count, sizeof(count)) == (ssize_t) sizeof(count);
+    }
+    atomic_store(&loopWaiting, 0);
+
+    // Resume on the full-rate grid so the tick phase and indices are kept
+    int64_t now = clockNs(loopClock);
+    if (now >= *deadline) {
+        int64_t skipped = (now - *deadline) / periodNs + 1;
+        *deadline += skipped * periodNs;
+        *index += (uint64_t) skipped;
+    }
+    return woken;
+}
+
+/**
+ * @brief Touch the top of the stack so it is faulted in before the loop runs
+ */
+static void prefaultStack(void) {
+    volatile uint8_t stack[CONTROL_LOOP_PREFAULT_SIZE];
+    memset((void *) stack, 0, sizeof(stack));
+}
+
+static void publishTick(uint32_t latencyNs, uint32_t computeNs, int overrun,
+                        uint64_t index, const SyncState *sync, uint8_t idle) {
+    atomic_fetch_add_explicit(&statsSeq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    loopStats.ticks++;
+    loopStats.tickIndex = index;
+    if (idle && !loopStats.idle) loopStats.idlePeriods++;
+    loopStats.idle = idle;
+    loopStats.synced = sync->synced;
+    loopStats.syncErrorNs = sync->errorNs;
+    loopStats.syncSteps = sync->steps;
+    loopStats.overruns += overrun ? 1 : 0;
+    loopStats.lastLatencyNs = latencyNs;
+    loopStats.lastComputeNs = computeNs;
+    if (latencyNs > loopStats.maxLatencyNs) loopStats.maxLatencyNs = latencyNs;
+    if (computeNs > loopStats.maxComputeNs) loopStats.maxComputeNs = computeNs;
+
+    atomic_fetch_add_explicit(&statsSeq, 1, memory_order_release);
+}
+
+/** @brief Count an idle wait that controlLoopWake() ended */
+static void publishWakeup(void) {
+    atomic_fetch_add_explicit(&statsSeq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    loopStats.wakeups++;
+    atomic_fetch_add_explicit(&statsSeq, 1, memory_order_release);
+}
+
+static void *controlLoopThread(void *arg) {
+    (void) arg;
+    prefaultStack();
+
+    const int64_t periodNs = NSEC_PER_SEC / loopConfig.rateHz;
+    const int64_t idlePeriodNs = loopConfig.idleRateHz ? NSEC_PER_SEC / loopConfig.idleRateHz : 0;
+    const int64_t idleDelayNs = (int64_t) loopConfig.idleDelayMs * NSEC_PER_MSEC;
+    int64_t quietNs = 0;  // Time the motors have been idle
+    SyncState sync;
+    memset(&sync, 0, sizeof(sync));
+    sync.pulseSeq = atomic_load(&pulseSeq);
+
+    // TAI: tick N is due at N periods since the epoch on every node
+    uint64_t index = 0;
+    int64_t deadline = clockNs(loopClock) + periodNs;
+    if (loopConfig.sync == CONTROL_SYNC_TAI) {
+        index = (uint64_t) (deadline / periodNs) + 1;
+        deadline = (int64_t) index * periodNs;
+        sync.synced = taiSynchronized();
+        sync.checkIndex = index;
+    }
+    int64_t lastStart = deadline - periodNs;
+
+    while (!atomic_load_explicit(&loopStopRequested, memory_order_relaxed)) {
+        struct timespec wake = nsToTimespec(deadline);
+        while (clock_nanosleep(loopClock, TIMER_ABSTIME, &wake, NULL) != 0) {
+            // Interrupted by a signal, sleep again until the same deadline
+        }
+
+        int64_t start = clockNs(loopClock);
+        uint64_t computeStart = timingNow();
+        motorControlSetTickIndex(index);
+        motorControlTick();
+        uint64_t computeEnd = timingNow();
+        int64_t end = clockNs(loopClock);
+
+        uint32_t latencyNs = (uint32_t) (start - deadline);
+        timingRecord(TIMING_WAKE_LATENCY, latencyNs);
+        timingRecord(TIMING_TICK_COMPUTE, timingElapsedNs(computeStart, computeEnd));
+        uint64_t ticked = index++;
+        deadline += periodNs;
+
+        // Skip missed slots rather than running late ticks back to back
+        int overrun = end > deadline;
+        if (overrun) {
+            int64_t skipped = (end - deadline) / periodNs + 1;
+            deadline += skipped * periodNs;
+            index += (uint64_t) skipped;
+            timingRecordDeadlineMiss();
+        }
+
+        if (loopConfig.sync == CONTROL_SYNC_GPIO) {
+            followPulse(&sync, &deadline, &index, periodNs);
+        } else if (loopConfig.sync == CONTROL_SYNC_TAI && index - sync.checkIndex >= loopConfig.rateHz) {
+            // Once a second, however many slots an overrun or idle wait skipped
+            sync.synced = taiSynchronized();
+            sync.checkIndex = index;
+        }
+
+        // Idle once nothing has happened for idleDelayMs; any activity restores the rate
+        quietNs = motorControlIsIdle() ? quietNs + (start - lastStart) : 0;
+        lastStart = start;
+        uint8_t idle = wakeFd >= 0 && idleDelayNs > 0 && quietNs >= idleDelayNs;
+        publishTick(latencyNs, (uint32_t) (end - start), overrun, ticked, &sync, idle);
+        if (idle && idleWait(&deadline, &index, periodNs, idlePeriodNs)) {
+            quietNs = 0;
+            publishWakeup();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Create the control thread with real-time attributes
+ * @return 0 on success, pthread error code on failure
+ */
+static int createLoopThread(int realtime) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, CONTROL_LOOP_STACK_SIZE);
+
+    if (realtime) {
+        struct sched_param param = { .sched_priority = loopConfig.priority };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    if (loopConfig.cpu >= 0 && loopConfig.cpu < sysconf(_SC_NPROCESSORS_ONLN)) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(loopConfig.cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    int err = pthread_create(&loopThread, &attr, controlLoopThread, NULL);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ */
+void controlLoopDefaultConfig(ControlLoopConfig *config) {
+    config->rateHz = CONTROL_LOOP_RATE_HZ;
+    config->cpu = CONTROL_LOOP_CPU;
+    config->priority = CONTROL_LOOP_PRIORITY;
+    config->sync = CONTROL_SYNC_NONE;
+    config->syncPin = -1;
+    config->syncPulseTicks = CONTROL_SYNC_PULSE_TICKS;
+    config->idleRateHz = CONTROL_LOOP_IDLE_RATE_HZ;
+    config->idleDelayMs = CONTROL_LOOP_IDLE_DELAY_MS;
+}
+
+/**
+ * @brief Start the control loop thread
+ * @param config Loop configuration, or NULL for defaults
+ * @return 0 on success, -1 on failure or if already running
+ * @note Falls back to normal scheduling if SCHED_FIFO is not permitted
+ * @warning Requires root privileges (or CAP_SYS_NICE) for real-time scheduling
+ */
+int controlLoopStart(const ControlLoopConfig *config) {
+    if (atomic_load(&loopRunning)) return -1;
+
+    if (config != NULL) {
+        loopConfig = *config;
+    } else {
+        controlLoopDefaultConfig(&loopConfig);
+    }
+    if (loopConfig.rateHz == 0 || loopConfig.rateHz > NSEC_PER_SEC) {
+        printf("Invalid control loop rate %u Hz\n", loopConfig.rateHz);
+        return -1;
+    }
+    if (loopConfig.idleRateHz > loopConfig.rateHz) {
+        printf("Idle rate %u Hz above the control loop rate\n", loopConfig.idleRateHz);
+        return -1;
+    }
+    // Calibrated here, never on the first tick
+    timingInit();
+    if (wakeFd < 0 && loopConfig.idleDelayMs > 0) {
+        // Kept for the process lifetime so a late controlLoopWake() never hits a closed descriptor
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wakeFd < 0) printf("eventfd unavailable, control loop will not idle\n");
+    }
+
+    loopClock = CLOCK_MONOTONIC;
+    if (loopConfig.sync == CONTROL_SYNC_TAI) {
+        struct timespec ts;
+        if (clock_gettime(CLOCK_TAI, &ts) != 0) {
+            printf("CLOCK_TAI unavailable\n");
+            return -1;
+        }
+        loopClock = CLOCK_TAI;
+    } else if (loopConfig.sync == CONTROL_SYNC_GPIO) {
+        if (loopConfig.syncPin < 0 || loopConfig.syncPulseTicks == 0) {
+            printf("Invalid sync pulse pin %d or interval %u\n", loopConfig.syncPin,
+                   loopConfig.syncPulseTicks);
+            return -1;
+        }
+        // Handlers cannot be removed in WiringPi; a stale one only records timestamps
+        pinMode(loopConfig.syncPin, INPUT);
+        if (wiringPiISR(loopConfig.syncPin, INT_EDGE_RISING, syncPulseIsr) < 0) {
+            printf("Failed to attach sync pulse handler on pin %d\n", loopConfig.syncPin);
+            return -1;
+        }
+    }
+
+    // Keep every page resident so the loop never takes a page fault
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        printf("mlockall failed, control loop may page fault\n");
+    }
+
+    memset(&loopStats, 0, sizeof(loopStats));
+    loopStats.periodNs = (uint32_t) (NSEC_PER_SEC / loopConfig.rateHz);
+    loopStats.realtime = 1;
+    atomic_store(&loopStopRequested, 0);
+
+    if (createLoopThread(1) != 0) {
+        printf("SCHED_FIFO not permitted, control loop running without real-time priority\n");
+        loopStats.realtime = 0;
+        if (createLoopThread(0) != 0) {
+            printf("Failed to create control loop thread\n");
+            return -1;
+        }
+    }
+    atomic_store(&loopRunning, 1);
+    return 0;
+}
+
+/**
+ * @brief Stop the control loop thread and wait for it to exit
+ */
+void controlLoopStop(void) {
+    if (!atomic_load(&loopRunning)) return;
+
+    atomic_store(&loopStopRequested, 1);
+    if (atomic_load(&loopWaiting)) signalWake();
+    pthread_join(loopThread, NULL);
+    atomic_store(&loopRunning, 0);
+}
+
+/**
+ * @brief Check whether the control loop is running
+ * @return 1 if running, 0 otherwise
+ */
+int controlLoopIsRunning(void) {
+    return atomic_load(&loopRunning);
+}
+
+/**
+ * @brief Return the loop to its full rate if it is idling
+ */
+void controlLoopWake(void) {
+    // Pairs with the fence in idleWait(), after the caller's queue push
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&loopWaiting, memory_order_relaxed)) signalWake();
+}
+
+/**
+ * @brief Get a consistent snapshot of the loop timing statistics
+ * @param stats Destination for the snapshot
+ */
+void controlLoopGetStats(ControlLoopStats *stats) {
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&statsSeq, memory_order_acquire);
+        memcpy(stats, &loopStats, sizeof(*stats));
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1u) || seq != atomic_load_explicit(&statsSeq, memory_order_relaxed));
+}
@@ -0,0 +1,401 @@
+/**
+ * @file Foc.c
+ * @brief Field-oriented control and space-vector PWM implementation
+ *
+ * The current loop thread wakes on absolute CLOCK_MONOTONIC deadlines at
+ * FOC_RATE_HZ. For each FOC motor it samples the Hall state and the phase
+ * currents under the motor's phase lock, runs focControllerStep() and writes
+ * the three phase duties.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <wiringPi.h>
+#include "MotorInternal.h"
+#include "MotorClock.h"
+#include "MotorTiming.h"
+#include "Foc.h"
+
+#define NSEC_PER_SEC 1000000000LL
+
+/** @brief 1/sqrt(3) in Q15 */
+#define FOC_INV_SQRT3_Q15 18919
+
+/** @brief sqrt(3)/2 in Q15 */
+#define FOC_SQRT3_2_Q15 28378
+
+/** @brief One Hall sector (60° electrical) as a 16-bit angle */
+#define FOC_SECTOR_ANGLE 10923
+
+/** @brief First quadrant of sin() in Q15, 256 steps plus the end point */
+static const int16_t quarterSine[257] = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,
+     2410,  2611,  2811,  3012,  3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,  6393,  6590,  6786,  6983,
+     7179,  7375,  7571,  7767,  7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+     9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269, 15446, 15623, 15800, 15976,
+    16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000,
+    20159, 20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170, 23311, 23452, 23592,
+    23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674,
+    26790, 26905, 27019, 27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085, 29177,
+    29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050,
+    31113, 31176, 31237, 31297, 31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250,
+    32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752,
+    32757, 32761, 32765, 32766, 32767
+};
+
+static pthread_t serviceThread;              ///< Current loop thread
+static atomic_int serviceRunning = 0;        ///< Thread is alive
+static atomic_int serviceStopRequested = 0;  ///< Ask the thread to exit
+static int attachedMotors = 0;               ///< FOC motors in the pool
+
+/* ---------------------------------------------------------------------------
+ * Fixed-point math
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Q15 sine
+ * @param angle 16-bit electrical angle
+ * @return sin(angle) in Q15
+ */
+int16_t focSin(uint16_t angle) {
+    uint16_t index = angle >> 6;  // 1024 steps per turn
+    uint16_t offset = index & 0xFF;
+    switch (index >> 8) {
+        case 0:  return quarterSine[offset];
+        case 1:  return quarterSine[256 - offset];
+        case 2:  return (int16_t) -quarterSine[offset];
+        default: return (int16_t) -quarterSine[256 - offset];
+    }
+}
+
+/**
+ * @brief Q15 cosine
+ * @param angle 16-bit electrical angle
+ * @return cos(angle) in Q15
+ */
+int16_t focCos(uint16_t angle) {
+    return focSin((uint16_t) (angle + 16384));
+}
+
+/**
+ * @brief Clarke transform for a star-connected motor (ia + ib + ic = 0)
+ */
+void focClarke(int32_t ia, int32_t ib, int32_t *alpha, int32_t *beta) {
+    *alpha = ia;
+    *beta = (int32_t) (((int64_t) ia + 2 * (int64_t) ib) * FOC_INV_SQRT3_Q15 >> 15);
+}
+
+/**
+ * @brief Park transform into the rotor frame
+ */
+void focPark(int32_t alpha, int32_t beta, uint16_t angle, int32_t *d, int32_t *q) {
+    int64_t s = focSin(angle);
+    int64_t c = focCos(angle);
+    *d = (int32_t) ((alpha * c + beta * s) >> 15);
+    *q = (int32_t) ((beta * c - alpha * s) >> 15);
+}
+
+/**
+ * @brief Inverse Park transform into the stator frame
+ */
+void focInversePark(int32_t d, int32_t q, uint16_t angle, int32_t *alpha, int32_t *beta) {
+    int64_t s = focSin(angle);
+    int64_t c = focCos(angle);
+    *alpha = (int32_t) ((d * c - q * s) >> 15);
+    *beta = (int32_t) ((d * s + q * c) >> 15);
+}
+
+static uint16_t clampDuty(int32_t value, uint16_t pwmRange) {
+    if (value < 0) return 0;
+    return (uint16_t) (value > pwmRange ? pwmRange : value);
+}
+
+/**
+ * @brief Space-vector PWM by min/max injection
+ * @details Shifting the three sinusoidal phase voltages by the midpoint of
+ * their extremes centres the pattern in the PWM range, which is equivalent
+ * to symmetric SVPWM and extends the linear range by 15%.
+ */
+void focSvpwm(int32_t alpha, int32_t beta, uint16_t pwmRange, uint16_t duty[3]) {
+    int32_t betaScaled = (int32_t) ((int64_t) beta * FOC_SQRT3_2_Q15 >> 15);
+    int32_t va = alpha;
+    int32_t vb = -alpha / 2 + betaScaled;
+    int32_t vc = -alpha / 2 - betaScaled;
+
+    int32_t max = va > vb ? va : vb;
+    int32_t min = va < vb ? va : vb;
+    if (vc > max) max = vc;
+    if (vc < min) min = vc;
+    int32_t centre = pwmRange / 2 - (max + min) / 2;
+
+    duty[0] = clampDuty(va + centre, pwmRange);
+    duty[1] = clampDuty(vb + centre, pwmRange);
+    duty[2] = clampDuty(vc + centre, pwmRange);
+}
+
+/** @brief Integer square root (floor) */
+static uint32_t isqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > value) bit >>= 2;
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief PI step with output clamp and integrator anti-windup
+ * @return Output in duty counts (-limit..limit)
+ */
+static int32_t currentPi(const FocController *foc, int32_t *integ, int32_t error, int32_t limit) {
+    int64_t limitQ16 = (int64_t) limit << 16;
+    int64_t i = *integ + (int64_t) foc->ki * error;
+    if (i > limitQ16) i = limitQ16;
+    if (i < -limitQ16) i = -limitQ16;
+    *integ = (int32_t) i;
+
+    int64_t out = ((int64_t) foc->kp * error + i) >> 16;
+    if (out > limit) out = limit;
+    if (out < -limit) out = -limit;
+    return (int32_t) out;
+}
+
+/**
+ * @brief Initialize a current loop
+ */
+void focControllerInit(FocController *foc, int32_t kp, int32_t ki, uint16_t pwmRange) {
+    foc->kp = kp;
+    foc->ki = ki;
+    foc->pwmRange = pwmRange;
+    foc->vMax = (int32_t) ((uint32_t) pwmRange * FOC_INV_SQRT3_Q15 >> 15);
+    focControllerReset(foc);
+}
+
+/**
+ * @brief Clear the integrators and outputs of a current loop
+ */
+void focControllerReset(FocController *foc) {
+    foc->integD = 0;
+    foc->integQ = 0;
+    foc->id = 0;
+    foc->iq = 0;
+    foc->vd = 0;
+    foc->vq = 0;
+    foc->duty[0] = foc->duty[1] = foc->duty[2] = 0;
+}
+
+/**
+ * @brief Run one current loop iteration
+ * @details The d axis has priority on the voltage vector; q gets what is
+ * left of the circle of radius vMax.
+ */
+const uint16_t *focControllerStep(FocController *foc, int32_t ia, int32_t ib, uint16_t angle,
+                                  int32_t idRef, int32_t iqRef) {
+    int32_t alpha, beta;
+    focClarke(ia, ib, &alpha, &beta);
+    focPark(alpha, beta, angle, &foc->id, &foc->iq);
+
+    foc->vd = currentPi(foc, &foc->integD, idRef - foc->id, foc->vMax);
+    int32_t vqMax = (int32_t) isqrt((uint32_t) (foc->vMax * foc->vMax - foc->vd * foc->vd));
+    foc->vq = currentPi(foc, &foc->integQ, iqRef - foc->iq, vqMax);
+
+    focInversePark(foc->vd, foc->vq, angle, &alpha, &beta);
+    focSvpwm(alpha, beta, foc->pwmRange, foc->duty);
+    return foc->duty;
+}
+
+/* ---------------------------------------------------------------------------
+ * Current loop thread
+ * ------------------------------------------------------------------------- */
+
+static void writePhases(const Motor *motor, const uint16_t duty[3]) {
+    const PwmBackend *pwm = motor->config.pwm;
+    pwm->write(motor->config.phasePins[0], duty[0]);
+    pwm->write(motor->config.phasePins[1], duty[1]);
+    pwm->write(motor->config.phasePins[2], duty[2]);
+}
+
+/** @brief Enable or float every leg of a BRIDGE_3PWM power stage */
+static void enableBridge(const Motor *motor, int level) {
+    if (motor->config.bridge != BRIDGE_3PWM) return;
+    for (int i = 0; i < 3; i++) digitalWrite(motor->config.enablePins[i], level);
+}
+
+static int32_t magnitude(int32_t value) {
+    return value < 0 ? -value : value;
+}
+
+/** @brief Phase current in mA from a bipolar current sense reading and its zero offset */
+static int32_t readCurrent(const Motor *motor, int phase) {
+    const AdcBackend *adc = motor->config.adc;
+    int raw = adc->read(motor->config.currentChannels[phase]);
+    if (raw < 0) return 0;
+    int zero = motor->config.currentOffsets[phase];
+    if (zero < 0) zero = (adc->fullScale + 1) / 2;
+    return (raw - zero) * FOC_CURRENT_MA_PER_LSB;
+}
+
+static void serviceMotor(Motor *motor, uint64_t nowNs) {
+    FocController *foc = &motor->foc;
+
+    // Keep the estimator current at the loop rate; the interpolation needs the edge time
+    motorSampleHall(motor, nowNs, 0);
+
+    if (!motor->isRunning) {
+        if (foc->active) {
+            static const uint16_t off[3] = { 0, 0, 0 };
+            writePhases(motor, off);
+            enableBridge(motor, LOW);
+            focControllerReset(foc);
+            foc->active = 0;
+        }
+        return;
+    }
+
+    uint64_t start = timingNow();
+    uint16_t angle = motorRotorAngle(motor, nowNs);
+    int32_t iqRef = (int32_t) motorHot.duty[motor->index] * FOC_MAX_CURRENT_MA / motor->config.pwmRange;
+    int32_t ia = readCurrent(motor, 0);
+    int32_t ib = readCurrent(motor, 1);
+    int32_t peak = magnitude(ia);
+    if (magnitude(ib) > peak) peak = magnitude(ib);
+    if (magnitude(ia + ib) > peak) peak = magnitude(ia + ib);  // |ic|
+    if (protectionCheckCurrent(motor, peak)) {
+        focControllerReset(foc);
+        foc->active = 0;
+        return;
+    }
+    const uint16_t *duty = focControllerStep(foc, ia, ib, angle, 0, iqRef);
+    writePhases(motor, duty);
+    if (!foc->active) enableBridge(motor, HIGH);
+    foc->active = 1;
+    timingRecord(TIMING_COMMUTATION, timingElapsedNs(start, timingNow()));
+}
+
+static struct timespec nsToTimespec(int64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+static int64_t monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void *focThread(void *arg) {
+    (void) arg;
+    const int64_t periodNs = NSEC_PER_SEC / FOC_RATE_HZ;
+    int64_t deadline = monotonicNs() + periodNs;
+
+    while (!atomic_load_explicit(&serviceStopRequested, memory_order_relaxed)) {
+        struct timespec wake = nsToTimespec(deadline);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) != 0) {
+            // Interrupted by a signal, sleep again until the same deadline
+        }
+
+        uint64_t now = motorClockNs();
+        for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+            Motor *motor = &motorPool[i];
+            if (!motor->inUse || motor->config.commutationMode != COMMUTATION_FOC) continue;
+            // Held by the control tick: skip this period rather than wait
+            if (!motorPhaseTryLock(motor)) continue;
+            if (motor->inUse) serviceMotor(motor, now);
+            motorPhaseUnlock(motor);
+        }
+
+        // Skip missed periods rather than running late back to back
+        deadline += periodNs;
+        int64_t end = monotonicNs();
+        if (end > deadline) deadline += ((end - deadline) / periodNs + 1) * periodNs;
+    }
+    return NULL;
+}
+
+static int createServiceThread(int realtime) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if (realtime) {
+        struct sched_param param = { .sched_priority = FOC_PRIORITY };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    if (FOC_CPU >= 0 && FOC_CPU < sysconf(_SC_NPROCESSORS_ONLN)) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(FOC_CPU, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    int err = pthread_create(&serviceThread, &attr, focThread, NULL);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+/**
+ * @brief Start the current loop of a motor
+ * @param motor Motor created with COMMUTATION_FOC
+ * @return 0 on success, -1 if the service thread could not be started
+ */
+int focAttach(Motor *motor) {
+    focControllerInit(&motor->foc, FOC_KP_Q16, FOC_KI_Q16, motor->config.pwmRange);
+
+    if (!atomic_load(&serviceRunning)) {
+        atomic_store(&serviceStopRequested, 0);
+        if (createServiceThread(1) != 0) {
+            printf("SCHED_FIFO not permitted, FOC current loop running without real-time priority\n");
+            if (createServiceThread(0) != 0) {
+                printf("Failed to create FOC current loop thread\n");
+                return -1;
+            }
+        }
+        atomic_store(&serviceRunning, 1);
+    }
+    attachedMotors++;
+    return 0;
+}
+
+/**
+ * @brief Stop the current loop of a motor
+ * @param motor Motor handle
+ */
+void focDetach(Motor *motor) {
+    focControllerReset(&motor->foc);
+    motor->foc.active = 0;
+    enableBridge(motor, LOW);
+    if (attachedMotors > 0 && --attachedMotors == 0 && atomic_load(&serviceRunning)) {
+        atomic_store(&serviceStopRequested, 1);
+        pthread_join(serviceThread, NULL);
+        atomic_store(&serviceRunning, 0);
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file HallBackend.c
+ * @brief Hall sensor input backend implementations
+ *
+ * gpiomemHallBackend maps the GPIO register block once at setup and reads
+ * the pin level register directly, so a sample is a single 32-bit load with
+ * no library dispatch and no chance of tearing across a transition.
+ * digitalReadHallBackend keeps the original WiringPi path as a fallback.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <wiringPi.h>
+#include "HallBackend.h"
+#include "MotorInternal.h"
+#include "MotorSoc.h"
+
+/* ---------------------------------------------------------------------------
+ * WiringPi digitalRead backend
+ * ------------------------------------------------------------------------- */
+
+static int digitalReadSetup(int pinA, int pinB, int pinC) {
+    (void) pinA;
+    (void) pinB;
+    (void) pinC;
+    return 0;
+}
+
+static uint8_t digitalReadHall(int pinA, int pinB, int pinC) {
+    uint8_t hallState = 0;
+    hallState |= digitalRead(pinA) << 2;
+    hallState |= digitalRead(pinB) << 1;
+    hallState |= digitalRead(pinC);
+    return hallState;
+}
+
+const HallBackend digitalReadHallBackend = {
+    .name = "digitalread",
+    .setup = digitalReadSetup,
+    .read = digitalReadHall,
+};
+
+/* ---------------------------------------------------------------------------
+ * Memory-mapped GPIO register backend
+ * ------------------------------------------------------------------------- */
+
+/** @brief Size of the mapped GPIO register block */
+#define GPIO_BLOCK_SIZE 4096
+
+/** @brief GPLEV0 (pin level, GPIO0-31) word offset in the register block */
+#define GPLEV0 (0x34 / 4)
+
+static volatile uint32_t *gpioRegs = NULL; ///< Mapped GPIO register block
+
+/**
+ * @brief Map the GPIO register block
+ * @return Register block, or NULL if GPIOMEM_DEVICE is unavailable or the
+ *         SoC does not have the BCM2835 register layout
+ * @note Mapped once and shared with the overcurrent trip path
+ */
+volatile uint32_t *gpiomemRegisters(void) {
+    if (gpioRegs != NULL) return gpioRegs;
+
+    // On other SoCs (RP1 on the Pi 5) GPLEV0 and GPCLR0 are unrelated registers
+    if (motorSocHasBcm2835Gpio() == 0) {
+        printf("%s has no BCM2835 GPIO registers on %s\n", GPIOMEM_DEVICE, motorSocName());
+        return NULL;
+    }
+
+    int fd = open(GPIOMEM_DEVICE, O_RDWR | O_SYNC);
+    if (fd < 0) {
+        printf("Failed to open %s\n", GPIOMEM_DEVICE);
+        return NULL;
+    }
+    void *map = mmap(NULL, GPIO_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map %s\n", GPIOMEM_DEVICE);
+        return NULL;
+    }
+    gpioRegs = (volatile uint32_t *) map;
+    return gpioRegs;
+}
+
+static int gpiomemSetup(int pinA, int pinB, int pinC) {
+    if (pinA < 0 || pinA > 31 || pinB < 0 || pinB > 31 || pinC < 0 || pinC > 31) {
+        printf("Hall pins must be in GPIO bank 0 for %s\n", GPIOMEM_DEVICE);
+        return -1;
+    }
+    return gpiomemRegisters() != NULL ? 0 : -1;
+}
+
+static uint8_t gpiomemReadHall(int pinA, int pinB, int pinC) {
+    // One load samples all three sensors at the same instant
+    uint32_t level = gpioRegs[GPLEV0];
+    return (uint8_t) ((((level >> pinA) & 1u) << 2) |
+                      (((level >> pinB) & 1u) << 1) |
+                      ((level >> pinC) & 1u));
+}
+
+const HallBackend gpiomemHallBackend = {
+    .name = "gpiomem",
+    .setup = gpiomemSetup,
+    .read = gpiomemReadHall,
+};
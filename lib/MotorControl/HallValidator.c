@@ -0,0 +1,164 @@
+/**
+ * @file HallValidator.c
+ * @brief Hall sequence validation and glitch filtering
+ *
+ * Codes are compared by their position in the forward sequence
+ * 1-3-2-6-4-5, so a legal transition is a position step of +1 or -1
+ * (mod 6) and anything else skipped at least one sector.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <string.h>
+#include "HallValidator.h"
+#include "MotorInternal.h"
+
+/** @brief Forward sequence position of each Hall code, -1 for invalid codes */
+static const int8_t sequencePosition[8] = { -1, 0, 2, 1, 4, 5, 3, -1 };
+
+/** @brief Hall code at each forward sequence position */
+static const uint8_t sequenceCode[6] = { 1, 3, 2, 6, 4, 5 };
+
+/**
+ * @brief Initialize a Hall validator
+ * @param v Validator
+ * @param debounceNs Debounce window, 0 to accept neighbouring codes at once
+ */
+void hallValidatorInit(HallValidator *v, uint32_t debounceNs) {
+    memset(v, 0, sizeof(*v));
+    v->debounceNs = debounceNs;
+}
+
+static void enterSector(HallValidator *v, uint8_t code, int8_t direction, uint64_t nowNs) {
+    v->state = code;
+    v->direction = direction;
+    v->lastEdgeNs = nowNs;
+    v->candidate = 0;
+}
+
+/** @brief Check whether a step in a direction is the edge the rotor is due to produce */
+static int edgeDue(const HallValidator *v, int8_t direction, uint64_t nowNs, uint32_t sectorPeriodNs) {
+    return direction == v->direction && sectorPeriodNs > 0 &&
+           (nowNs - v->lastEdgeNs) * 100 >= (uint64_t) sectorPeriodNs * HALL_EDGE_DUE_PCT;
+}
+
+/** @brief Keep or extrapolate the sector over a rejected sample */
+static uint8_t reject(HallValidator *v, uint64_t nowNs, uint32_t sectorPeriodNs) {
+    if (v->badRun < UINT8_MAX) v->badRun++;
+    if (v->candidate != 0) {
+        v->counts.glitches++;
+        v->candidate = 0;
+    }
+
+    // The next edge is due: assume it is the one that was lost
+    if (v->direction != 0 && sectorPeriodNs > 0 && nowNs - v->lastEdgeNs >= sectorPeriodNs) {
+        int next = (sequencePosition[v->state] + v->direction + 6) % 6;
+        enterSector(v, sequenceCode[next], v->direction, nowNs);
+        v->counts.extrapolated++;
+    }
+    return v->state;
+}
+
+/** @brief Validate a sample; edge is set for reads from a Hall edge handler */
+static uint8_t sample(HallValidator *v, uint8_t raw, uint64_t nowNs, uint32_t sectorPeriodNs, int edge) {
+    int position = sequencePosition[raw & 7];
+    if (position < 0) {
+        v->counts.invalid++;
+        return reject(v, nowNs, sectorPeriodNs);
+    }
+
+    // Nothing to compare against yet
+    if (v->state == 0) {
+        enterSector(v, raw, 0, nowNs);
+        v->badRun = 0;
+        return v->state;
+    }
+
+    if (raw == v->state) {
+        if (v->candidate != 0) {
+            v->counts.glitches++;
+            v->candidate = 0;
+        }
+        v->badRun = 0;
+        return v->state;
+    }
+
+    int step = (position - sequencePosition[v->state] + 6) % 6;
+    if (step != 1 && step != 5) {
+        v->counts.illegal++;
+        return reject(v, nowNs, sectorPeriodNs);
+    }
+
+    v->badRun = 0;
+    int8_t direction = step == 1 ? 1 : -1;
+    uint64_t edgeNs = nowNs;
+    if (edge) {
+        // A code still present when the handler reads it outlasted a glitch
+        if (v->candidate == raw) edgeNs = v->candidateNs;
+    } else if (v->debounceNs > 0 && !edgeDue(v, direction, nowNs, sectorPeriodNs)) {
+        if (v->candidate != raw) {
+            if (v->candidate != 0) v->counts.glitches++;
+            v->candidate = raw;
+            v->candidateNs = nowNs;
+            return v->state;
+        }
+        if (nowNs - v->candidateNs < v->debounceNs) return v->state;
+        // Confirmed: the edge happened when the candidate was first seen
+        edgeNs = v->candidateNs;
+    }
+    enterSector(v, raw, direction, edgeNs);
+    return v->state;
+}
+
+/**
+ * @brief Feed a raw Hall sample
+ * @param v Validator
+ * @param raw Packed Hall state from the backend
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param sectorPeriodNs Averaged sector period, 0 if not rotating
+ * @return Validated Hall code (1-6), 0 until a valid sample was seen
+ */
+uint8_t hallValidatorSample(HallValidator *v, uint8_t raw, uint64_t nowNs, uint32_t sectorPeriodNs) {
+    return sample(v, raw, nowNs, sectorPeriodNs, 0);
+}
+
+/**
+ * @brief Feed a Hall sample read in a Hall edge handler
+ * @param v Validator
+ * @param raw Packed Hall state from the backend
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param sectorPeriodNs Averaged sector period, 0 if not rotating
+ * @return Validated Hall code (1-6), 0 until a valid sample was seen
+ */
+uint8_t hallValidatorEdge(HallValidator *v, uint8_t raw, uint64_t nowNs, uint32_t sectorPeriodNs) {
+    return sample(v, raw, nowNs, sectorPeriodNs, 1);
+}
+
+/**
+ * @brief Check whether a new code is waiting for the debounce window
+ * @param v Validator
+ * @return 1 if a sample at or after candidateNs + debounceNs decides it, 0 otherwise
+ */
+int hallValidatorPending(const HallValidator *v) {
+    return v->candidate != 0;
+}
+
+/**
+ * @brief Check whether the Hall sensors count as lost
+ * @param v Validator
+ * @return 1 after HALL_MAX_BAD_SAMPLES rejected samples in a row, 0 otherwise
+ */
+int hallValidatorLost(const HallValidator *v) {
+    return v->badRun >= HALL_MAX_BAD_SAMPLES;
+}
+
+/**
+ * @brief Get the Hall fault counters of a motor instance
+ * @param motor Motor handle
+ * @param counts Receives the counters
+ */
+void motorInstanceGetHallFaults(const Motor *motor, HallFaultCounts *counts) {
+    *counts = motor->hallValidator.counts;
+}
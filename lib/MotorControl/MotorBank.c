@@ -0,0 +1,89 @@
+/**
+ * @file MotorBank.c
+ * @brief Batched regulation and commutation over all motor slots
+ *
+ * Both passes walk the structure-of-arrays hot state once per tick with no
+ * data-dependent branches: saturation and anti-windup decisions are
+ * conditional selects, and the commutation step turns each entry of the
+ * slot's drive table into a 0/0xFFFF mask that is ANDed with the duty. With the pool
+ * size known at compile time both loops unroll into straight-line code, so
+ * per-tick cost is fixed regardless of which motors are running. The loop
+ * bodies are independent across slots and read contiguous arrays, leaving
+ * the compiler free to vectorize the element-wise parts where the target
+ * supports it.
+ *
+ * MOTOR_FIXED_CONFIG builds clamp to the constant PWM_RANGE and take the
+ * phase pattern from the packed COMMUTATION_PWM_BITS/BRIDGE_PWM_BITS words,
+ * so commutation is shifts and masks with no table load.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include "MotorInternal.h"
+
+#if MOTOR_FIXED_CONFIG
+#define OUT_MAX(hot, i) PWM_RANGE
+#else
+#define OUT_MAX(hot, i) ((hot)->outMax[i])
+#endif
+
+/**
+ * @brief Run the PI speed regulator for every slot
+ * @param hot Hot state; reads setpoint/measured/feedforward/active, writes duty
+ * @param count Number of slots to process
+ * @details Feedforward plus PI (gains from SpeedController.h), conditional
+ * integration while saturated, output clamped to 0..outMax.
+ * Inactive slots have their integrator and duty forced to zero. The
+ * integrator and all intermediates are 64-bit, since outMax << 16 exceeds
+ * int32 for PWM ranges of 32768 and up.
+ */
+void motorBankRegulate(MotorHotState *hot, int count) {
+    for (int i = 0; i < count; i++) {
+        int32_t error = hot->setpoint[i] - hot->measured[i];
+        int64_t max = (int64_t) OUT_MAX(hot, i) << 16;
+        int64_t base = ((int64_t) hot->feedforward[i] << 16) + (int64_t) hot->kp[i] * error;
+        int64_t candidate = hot->integrator[i] + (int64_t) hot->ki[i] * error;
+        int64_t output = base + candidate;
+
+        // Hold the integrator while saturated in the direction of the error
+        int hold = ((output > max) & (error > 0)) | ((output < 0) & (error < 0));
+        int64_t integrator = hold ? hot->integrator[i] : candidate;
+        integrator = integrator > max ? max : integrator;
+        integrator = integrator < -max ? -max : integrator;
+        integrator &= hot->active[i];
+
+        output = (base + integrator) >> 16;
+        output = output > OUT_MAX(hot, i) ? OUT_MAX(hot, i) : output;
+        output = output < 0 ? 0 : output;
+
+        hot->integrator[i] = integrator;
+        hot->duty[i] = (uint16_t) (output & hot->active[i]);
+    }
+}
+
+/**
+ * @brief Compute per-phase outputs for every slot from Hall state and duty
+ * @param hot Hot state; reads hallState/duty/active, writes phaseDuty
+ * @param count Number of slots to process
+ */
+void motorBankCommutate(MotorHotState *hot, int count) {
+    for (int i = 0; i < count; i++) {
+        uint16_t duty = (uint16_t) (hot->duty[i] & hot->active[i]);
+#if MOTOR_FIXED_CONFIG
+        uint32_t packed = hot->driveTable[i] ? BRIDGE_PWM_BITS : COMMUTATION_PWM_BITS;
+        uint32_t pattern = packed >> (3 * (hot->hallState[i] & 7));
+
+        hot->phaseDuty[0][i] = duty & (uint16_t) -(pattern & 1);
+        hot->phaseDuty[1][i] = duty & (uint16_t) -((pattern >> 1) & 1);
+        hot->phaseDuty[2][i] = duty & (uint16_t) -((pattern >> 2) & 1);
+#else
+        const uint8_t *pattern = motorDriveTables[hot->driveTable[i] & 1][hot->hallState[i] & 7];
+
+        hot->phaseDuty[0][i] = duty & (uint16_t) -(pattern[0] == PHASE_PWM);
+        hot->phaseDuty[1][i] = duty & (uint16_t) -(pattern[1] == PHASE_PWM);
+        hot->phaseDuty[2][i] = duty & (uint16_t) -(pattern[2] == PHASE_PWM);
+#endif
+    }
+}
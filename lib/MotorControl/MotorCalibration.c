@@ -0,0 +1,167 @@
+/**
+ * @file MotorCalibration.c
+ * @brief Binary motor configuration and calibration file
+ *
+ * Validation checks the header against the mapped size before touching the
+ * payload, so a truncated or foreign file is rejected without reading past
+ * its end. The CRC is the IEEE 802.3 polynomial (as zlib's crc32()).
+ *
+ * Has no WiringPi dependency; the host tool links it directly.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MotorCalibration.h"
+#include "MotorCrc.h"
+#include "SpeedController.h"
+#include "SpeedRamp.h"
+#include "Sensorless.h"
+#include "Foc.h"
+#include "Protection.h"
+#include "HallValidator.h"
+
+/** @brief CRC of everything after the header */
+static uint32_t payloadCrc(const MotorCalibration *cal) {
+    return motorCrc32((const uint8_t *) cal + CALIBRATION_HEADER_SIZE, sizeof(*cal) - CALIBRATION_HEADER_SIZE);
+}
+
+/**
+ * @brief Fill a record with the compile-time defaults
+ * @param cal Record to initialize (sealed)
+ */
+void calibrationDefaults(MotorCalibration *cal) {
+    memset(cal, 0, sizeof(*cal));
+    const int16_t phasePins[3] = { PHASE_A_PIN, PHASE_B_PIN, PHASE_C_PIN };
+    const int16_t hallPins[3] = { HALL_A_PIN, HALL_B_PIN, HALL_C_PIN };
+    const int16_t lowSidePins[3] = { PHASE_A_LOW_PIN, PHASE_B_LOW_PIN, PHASE_C_LOW_PIN };
+    const int16_t enablePins[3] = { PHASE_A_ENABLE_PIN, PHASE_B_ENABLE_PIN, PHASE_C_ENABLE_PIN };
+    memcpy(cal->phasePins, phasePins, sizeof(phasePins));
+    memcpy(cal->hallPins, hallPins, sizeof(hallPins));
+    memcpy(cal->lowSidePins, lowSidePins, sizeof(lowSidePins));
+    memcpy(cal->enablePins, enablePins, sizeof(enablePins));
+    cal->faultPin = FAULT_PIN;
+    cal->maxRpm = MOTOR_MAX_RPM;
+    cal->pwmRange = PWM_RANGE;
+    cal->numPoles = NUM_POLES;
+    cal->bridge = DEFAULT_BRIDGE_MODE;
+    cal->deadTimeNs = BRIDGE_DEAD_TIME_NS;
+    cal->hallDebounceNs = HALL_DEBOUNCE_NS;
+    cal->currentLimitMa = OVERCURRENT_LIMIT_MA;
+    cal->kp = SPEED_KP_Q16;
+    cal->ki = SPEED_KI_Q16;
+    cal->rampAccel = RAMP_ACCEL_RPM_PER_S;
+    cal->rampJerk = RAMP_JERK_RPM_PER_S2;
+    for (int k = 0; k < 6; k++) cal->hallAngles[k] = FOC_ANGLE_DEG(FOC_HALL_OFFSET_DEG + 60 * k);
+    cal->currentOffsets[0] = CURRENT_ZERO_OFFSET;
+    cal->currentOffsets[1] = CURRENT_ZERO_OFFSET;
+    cal->phaseAdvance = ROTOR_ANGLE_DEG(ROTOR_PHASE_ADVANCE_DEG);
+    calibrationSeal(cal);
+}
+
+/**
+ * @brief Set the header fields and checksum of a record
+ * @param cal Record to seal
+ */
+void calibrationSeal(MotorCalibration *cal) {
+    cal->magic = CALIBRATION_MAGIC;
+    cal->version = CALIBRATION_VERSION;
+    cal->reserved = 0;
+    cal->size = sizeof(*cal);
+    cal->crc = payloadCrc(cal);
+}
+
+/**
+ * @brief Check a record in memory
+ * @param data Record bytes
+ * @param size Number of bytes available
+ * @return 0 if magic, version, size and CRC match, -1 otherwise
+ */
+int calibrationValidate(const void *data, size_t size) {
+    const MotorCalibration *cal = data;
+    if (size != sizeof(*cal) || cal->magic != CALIBRATION_MAGIC) return -1;
+    if (cal->version != CALIBRATION_VERSION || cal->size != sizeof(*cal)) return -1;
+    return cal->crc == payloadCrc(cal) ? 0 : -1;
+}
+
+/**
+ * @brief Map and validate a calibration file
+ * @param path File to map
+ * @param cal Receives the read-only mapping on success
+ * @return 0 on success, 1 if the file does not exist, -1 if it is invalid
+ */
+int calibrationMap(const char *path, const MotorCalibration **cal) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return 1;
+        printf("Failed to open calibration %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t) sizeof(MotorCalibration)) {
+        printf("Calibration %s has the wrong size\n", path);
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, sizeof(MotorCalibration), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map calibration %s\n", path);
+        return -1;
+    }
+
+    if (calibrationValidate(map, sizeof(MotorCalibration)) != 0) {
+        printf("Calibration %s is corrupt or from another layout version\n", path);
+        munmap(map, sizeof(MotorCalibration));
+        return -1;
+    }
+    *cal = map;
+    return 0;
+}
+
+/**
+ * @brief Release a mapping from calibrationMap()
+ * @param cal Mapped record
+ */
+void calibrationUnmap(const MotorCalibration *cal) {
+    if (cal != NULL) munmap((void *) cal, sizeof(*cal));
+}
+
+/**
+ * @brief Apply a record to a motor configuration
+ * @param cal Validated record
+ * @param config Configuration to update; backends and modes are kept
+ */
+void calibrationApply(const MotorCalibration *cal, MotorConfig *config) {
+    for (int i = 0; i < 3; i++) {
+        config->phasePins[i] = cal->phasePins[i];
+        config->hallPins[i] = cal->hallPins[i];
+        config->lowSidePins[i] = cal->lowSidePins[i];
+        config->enablePins[i] = cal->enablePins[i];
+    }
+    config->faultPin = cal->faultPin;
+    config->maxRpm = cal->maxRpm;
+    config->pwmRange = cal->pwmRange;
+    config->numPoles = cal->numPoles;
+    config->bridge = (BridgeMode) cal->bridge;
+    config->deadTimeNs = cal->deadTimeNs;
+    config->hallDebounceNs = cal->hallDebounceNs;
+    config->currentLimitMa = cal->currentLimitMa;
+    config->kp = cal->kp;
+    config->ki = cal->ki;
+    config->rampAccel = cal->rampAccel;
+    config->rampJerk = cal->rampJerk;
+    memcpy(config->hallAngles, cal->hallAngles, sizeof(config->hallAngles));
+    config->currentOffsets[0] = cal->currentOffsets[0];
+    config->currentOffsets[1] = cal->currentOffsets[1];
+    config->phaseAdvance = cal->phaseAdvance;
+}
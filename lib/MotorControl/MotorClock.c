@@ -0,0 +1,26 @@
+/**
+ * @file MotorClock.c
+ * @brief Monotonic time base implementation
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stddef.h>
+#include <time.h>
+#include "MotorClock.h"
+
+static MotorClockSource clockSource = NULL;  ///< Override, NULL for CLOCK_MONOTONIC
+
+uint64_t motorClockNs(void) {
+    if (clockSource != NULL) return clockSource();
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+void motorClockSetSource(MotorClockSource source) {
+    clockSource = source;
+}
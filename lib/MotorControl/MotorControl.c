@@ -22,14 +22,15 @@
  * - Speed Range: 0-${MOTOR_MAX_RPM} RPM
  * - PWM Frequency: 20kHz
  * - Control Loop Rate: 2kHz
- * - Position Resolution: 60° electrical
+ * - Position Resolution: 60° electrical (6-step), interpolated with COMMUTATION_FOC
+ * - Current Loop Rate: 20kHz (COMMUTATION_FOC)
  *
  * Pin Configuration:
  * ----------------
  * Phase Outputs:
  *   - Phase A: GPIO18 (PWM capable)
  *   - Phase B: GPIO19 (PWM capable)
- *   - Phase C: GPIO20 (PWM capable)
+ *   - Phase C: GPIO12 (PWM capable)
  * Hall Sensors:
  *   - Hall A: GPIO21 (Pull-up enabled)
  *   - Hall B: GPIO22 (Pull-up enabled)
@@ -46,8 +47,7 @@
  * @see https://github.com/WiringPi/WiringPi
  * @see https://www.raspberrypi.org/documentation/
  * 
- * @todo Implement overcurrent protection
- * @bug PWM jitter observed at low speeds
+ * @bug PWM jitter observed at low speeds with softPwmBackend (use sysfsPwmBackend)
  * 
  * @par Change Log:
  * - v1.0: Initial release
@@ -65,19 +65,31 @@
  * }
  * @endcode
  */
-
 #include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sched.h>
 #include <wiringPi.h>
-#include <softPwm.h>
 #include "MotorControl.h"
+#include "MotorInternal.h"
+#include "PwmBackend.h"
+#include "HallBackend.h"
+#include "MotorClock.h"
+#include "SpeedController.h"
+#include "ControlLoop.h"
+#include "CommandQueue.h"
+#include "Telemetry.h"
+#include "MotorTiming.h"
+#include "MotorCalibration.h"
 
 /** 
  * @brief Commutation sequence lookup table
  * @details 6-step commutation sequence indexed by Hall sensor states
- * Invalid states (0,7) trigger emergency stop
+ * Invalid states (0,7) drive no phase; the Hall validator keeps them from
+ * reaching the table and latches MOTOR_FAULT_HALL once they persist
  * Format: {Phase_A, Phase_B, Phase_C}
  */
-static const uint8_t commutationTable[8][3] = {
+const uint8_t commutationTable[8][3] = {
     {0, 0, 0}, // 0 - Invalid state
     {1, 0, 0}, // 1 - Phase A ON
     {0, 1, 0}, // 2 - Phase B ON
@@ -88,81 +100,1259 @@ static const uint8_t commutationTable[8][3] = {
     {0, 0, 0}  // 7 - Invalid state
 };
 
+/**
+ * @brief Two-phase 6-step sequence for bridges with low-side control
+ * @details One leg switches PWM, one holds its low side on and the third
+ * floats. Each vector leads the commutationTable vector for the same Hall
+ * state by 30° electrical, and every leg passes through the floating state
+ * between PWM and low, so no leg switches directly from one side to the
+ * other.
+ * Format: {Phase_A, Phase_B, Phase_C} as PhaseDrive
+ */
+const uint8_t bridgeTable[8][3] = {
+    {PHASE_OFF, PHASE_OFF, PHASE_OFF}, // 0 - Invalid state
+    {PHASE_PWM, PHASE_OFF, PHASE_LOW}, // 1 - A+ C-
+    {PHASE_LOW, PHASE_PWM, PHASE_OFF}, // 2 - B+ A-
+    {PHASE_OFF, PHASE_PWM, PHASE_LOW}, // 3 - B+ C-
+    {PHASE_OFF, PHASE_LOW, PHASE_PWM}, // 4 - C+ B-
+    {PHASE_PWM, PHASE_LOW, PHASE_OFF}, // 5 - A+ B-
+    {PHASE_LOW, PHASE_OFF, PHASE_PWM}, // 6 - C+ A-
+    {PHASE_OFF, PHASE_OFF, PHASE_OFF}  // 7 - Invalid state
+};
+
+const uint8_t (*const motorDriveTables[2])[3] = { commutationTable, bridgeTable };
+
+/** @brief Contiguous pool of motor instances serviced by the control loop */
+Motor motorPool[MOTOR_MAX_INSTANCES];
+
+/** @brief Hot state of every pool slot (structure-of-arrays) */
+MotorHotState motorHot;
+
 /** 
  * @brief System state and control variables
- * @note All variables are volatile for ISR safety
  */
-static volatile uint16_t currentSpeed = 0;    ///< Current motor speed (RPM)
-static volatile uint8_t isRunning = 0;        ///< Motor operational state
-static volatile uint16_t pwmDutyCycle = 0;    ///< Active PWM duty cycle
+static Motor *defaultMotor = NULL;            ///< Motor driven by the single-motor API
+static uint8_t wiringPiReady = 0;             ///< wiringPiSetupGpio() has succeeded
+static const PwmBackend *defaultPwm = &DEFAULT_PWM_BACKEND;   ///< Backend for motorDefaultConfig()
+static const HallBackend *defaultHall = &DEFAULT_HALL_BACKEND; ///< Backend for motorDefaultConfig()
+static const AdcBackend *defaultAdc = &DEFAULT_ADC_BACKEND;    ///< Backend for motorDefaultConfig()
+static const char *calibrationPath = CALIBRATION_PATH;          ///< File applied by motorInit()
+static uint64_t lastTickNs = 0;               ///< Timestamp of the previous control tick
+
+static CommandQueue apiQueue;                 ///< Commands from the motor API caller
+static CommandQueue *commandQueues[MOTOR_MAX_COMMAND_QUEUES] = { &apiQueue }; ///< Drained every tick
+static atomic_int commandQueueCount = 1;      ///< Attached entries in commandQueues
+static uint64_t lastOverruns = 0;             ///< Loop overrun count seen by the previous tick
+static uint8_t externalTick = 0;              ///< Application drives motorControlTick() itself
+static _Atomic uint64_t tickIndex = 0;        ///< Index of the next motorControlTick()
+static atomic_int tickQuiet = 0;              ///< The last tick found every motor idle
+
+/** @brief Longest tick interval fed to the ramp, so a stalled loop cannot jump the profile */
+#define MAX_TICK_INTERVAL_NS 10000000U  // 10ms
 
 /**
- * @brief Initialize motor control hardware
+ * @brief Open-loop duty cycle for a speed
+ * @param motor Motor instance
+ * @param rpm Speed in RPM (0-maxRpm)
+ * @return Duty cycle (0-pwmRange)
+ */
+static uint16_t openLoopDuty(const Motor *motor, uint16_t rpm) {
+    return (uint16_t) (((uint32_t) rpm * MOTOR_PWM_RANGE(motor)) / MOTOR_SPEED_LIMIT(motor));
+}
+
+/**
+ * @brief Take the phase lock of a motor if it is free
+ * @details The lock serializes the control tick, the Hall edge handlers
+ * (wiringPiISR runs one thread per pin), the sensorless and FOC service
+ * threads, the fault input handler and commands applied on the caller's
+ * thread. None of the real-time contexts waits for it: a pass that finds
+ * the lock taken skips the motor, and the holder covers it.
+ */
+int motorPhaseTryLock(Motor *motor) {
+    return !atomic_flag_test_and_set_explicit(&motor->phaseLock, memory_order_acquire);
+}
+
+/**
+ * @brief Release the phase lock
+ * @details A trip that could not take the lock leaves offPending set. It is
+ * checked again after the release, so a trip arriving between the check
+ * and the release is not left for the next holder.
+ */
+void motorPhaseUnlock(Motor *motor) {
+    do {
+        if (atomic_exchange(&motor->offPending, 0)) motorEmergencyOff(motor);
+        atomic_flag_clear_explicit(&motor->phaseLock, memory_order_release);
+    } while (atomic_load(&motor->offPending) && motorPhaseTryLock(motor));
+}
+
+/**
+ * @brief Take the phase lock on the API caller's thread
+ * @details Only used where no control loop thread runs, so the wait is at
+ * most one edge handler or service thread pass.
+ */
+static void lockPhases(Motor *motor) {
+    while (!motorPhaseTryLock(motor)) sched_yield();
+}
+
+/**
+ * @brief Check whether a service thread drives the phase outputs
+ * @details Sensorless and FOC motors are commutated by their own threads;
+ * the control tick and the API only update their duty cycle.
+ */
+static int phasesDrivenByService(const Motor *motor) {
+    return motor->config.commutationMode == COMMUTATION_SENSORLESS ||
+           motor->config.commutationMode == COMMUTATION_FOC;
+}
+
+/**
+ * @brief Hall state whose 6-step pattern to drive
+ * @param motor Motor instance
+ * @param hallState Validated Hall code from motorSampleHall()
+ * @param nowNs Sample timestamp
+ * @return hallState, or the next state once phase advance has crossed the sector boundary
+ */
+static uint8_t driveState(const Motor *motor, uint8_t hallState, uint64_t nowNs) {
+    if (motor->config.phaseAdvance == 0) return hallState;
+    const SpeedEstimator *est = &motor->speedEstimator;
+    uint16_t advance = rotorAngleAdvance(motor->config.phaseAdvance, speedEstimatorGetRpm(est),
+                                         MOTOR_SPEED_LIMIT(motor));
+    return rotorAngleDriveState(est, motor->hallValidator.direction, motor->config.hallAngles,
+                                advance, nowNs);
+}
+
+static void commutate(Motor *motor, int edge);
+
+/**
+ * @brief Hall sensor edge handler
+ * @param slot Pool slot of the motor whose Hall input changed
+ * @details An edge arriving while the control tick holds the phase lock is
+ * commutated by that tick, which samples the sensors itself.
+ */
+static void hallEdge(int slot) {
+    Motor *motor = &motorPool[slot];
+    if (motor->inUse && motorPhaseTryLock(motor)) {
+        if (motor->inUse) commutate(motor, 1);
+        motorPhaseUnlock(motor);
+    }
+    // A rotor turned while stopped is tracked at the full loop rate
+    controlLoopWake();
+}
+
+/*
+ * wiringPiISR callbacks take no argument, so each pool slot gets its own
+ * trampoline into hallEdge().
+ */
+static void hallEdgeISR0(void) { hallEdge(0); }
+static void hallEdgeISR1(void) { hallEdge(1); }
+static void hallEdgeISR2(void) { hallEdge(2); }
+static void hallEdgeISR3(void) { hallEdge(3); }
+
+static void (*const hallEdgeISRs[])(void) = {
+    hallEdgeISR0, hallEdgeISR1, hallEdgeISR2, hallEdgeISR3
+};
+
+_Static_assert(sizeof(hallEdgeISRs) / sizeof(hallEdgeISRs[0]) >= MOTOR_MAX_INSTANCES,
+               "one Hall edge trampoline required per motor slot");
+
+/**
+ * @brief Register edge handlers on all Hall sensor pins of a motor
  * @return 0 on success, -1 on failure
- * @note Performs self-test of all subsystems
+ */
+static int registerHallInterrupts(Motor *motor) {
+    if (motor->hallIsrRegistered) return 0;
+
+    void (*isr)(void) = hallEdgeISRs[motor->index];
+    for (int i = 0; i < 3; i++) {
+        if (wiringPiISR(motor->config.hallPins[i], INT_EDGE_BOTH, isr) < 0) {
+            printf("Hall sensor interrupt registration failed\n");
+            return -1;
+        }
+    }
+    motor->hallIsrRegistered = 1;
+    return 0;
+}
+
+/** @brief Gate pin of a phase: enable input (3PWM) or low-side input (6PWM) */
+static int gatePin(const Motor *motor, int phase) {
+    return motor->config.bridge == BRIDGE_3PWM ? motor->config.enablePins[phase] :
+                                                 motor->config.lowSidePins[phase];
+}
+
+/**
+ * @brief Write the same value to all three phases
+ * @details Always reaches the backend, so it also resynchronizes the applied
+ * state after the outputs were driven outside the 6-step path. Bridges
+ * with low-side control are left floating.
+ */
+static void writeAllPhases(Motor *motor, int value) {
+    const PwmBackend *pwm = motor->config.pwm;
+    for (int i = 0; i < 3; i++) {
+        pwm->write(motor->config.phasePins[i], value);
+        motor->commutation.applied[i] = value;
+        if (motor->config.bridge != BRIDGE_HIGH_SIDE && !phasesDrivenByService(motor)) {
+            digitalWrite(gatePin(motor, i), LOW);
+            motor->commutation.appliedGate[i] = LOW;
+        }
+    }
+}
+
+/**
+ * @brief Stop PWM generation on the phases of a stopped motor
+ * @details softPwm threads exit and hardware channels are disabled, so an
+ * idle motor costs no CPU time. Service-driven motors keep their outputs,
+ * which their threads own. Caller holds the phase lock.
+ */
+static void suspendOutputs(Motor *motor) {
+    const PwmBackend *pwm = motor->config.pwm;
+    if (motor->pwmSuspended || pwm->suspend == NULL || phasesDrivenByService(motor)) return;
+    for (int i = 0; i < 3; i++) {
+        pwm->suspend(motor->config.phasePins[i]);
+        motor->commutation.applied[i] = 0;
+    }
+    motor->pwmSuspended = 1;
+}
+
+/**
+ * @brief Restart PWM generation suspended by suspendOutputs()
+ * @return 0 on success, -1 if a phase could not be restarted
+ */
+static int resumeOutputs(Motor *motor) {
+    if (!motor->pwmSuspended) return 0;
+    const PwmBackend *pwm = motor->config.pwm;
+    for (int i = 0; i < 3; i++) {
+        if (pwm->resume(motor->config.phasePins[i], motor->config.pwmRange) != 0) {
+            printf("PWM backend '%s' failed to resume pin %d\n", pwm->name, motor->config.phasePins[i]);
+            return -1;
+        }
+    }
+    motor->pwmSuspended = 0;
+    return 0;
+}
+
+/**
+ * @brief Write one phase output unless it already carries the value
+ * @note Caller holds the phase lock
+ */
+static void writePhase(Motor *motor, int phase, uint16_t value) {
+    if (motor->commutation.applied[phase] == value) return;
+    motor->commutation.applied[phase] = value;
+    motor->config.pwm->write(motor->config.phasePins[phase], value);
+}
+
+/** @brief Set one gate pin unless it already has the level */
+static void writeGate(Motor *motor, int phase, int8_t level) {
+    if (motor->commutation.appliedGate[phase] == level) return;
+    motor->commutation.appliedGate[phase] = level;
+    digitalWrite(gatePin(motor, phase), level);
+}
+
+/**
+ * @brief Switch the bridge legs to new high-side values and gate levels
+ * @details Legs are switched off before any is switched on, with the
+ * configured dead time in between, so no change overlaps an outgoing and
+ * an incoming switch. Unchanged pins are not written.
+ */
+static void switchBridge(Motor *motor, const uint16_t outputs[3], const int8_t gate[3]) {
+    CommutationCache *cache = &motor->commutation;
+    int switchingOn = 0;
+    for (int k = 0; k < 3; k++) {
+        if (outputs[k] < cache->applied[k]) writePhase(motor, k, outputs[k]);
+        if (!gate[k]) writeGate(motor, k, LOW);
+        switchingOn |= outputs[k] != cache->applied[k] || gate[k] != cache->appliedGate[k];
+    }
+
+    if (switchingOn && motor->config.deadTimeNs > 0) {
+        uint64_t start = timingNow();
+        while (timingElapsedNs(start, timingNow()) < motor->config.deadTimeNs) {
+            // Busy wait: far shorter than a scheduler tick
+        }
+    }
+
+    for (int k = 0; k < 3; k++) {
+        writePhase(motor, k, outputs[k]);
+        writeGate(motor, k, gate[k]);
+    }
+}
+
+/**
+ * @brief Apply one commutation state to the power stage
+ * @param motor Motor instance
+ * @param hallState Hall state selecting the bridgeTable entry
+ * @param running 0 to float every leg
+ * @param outputs High-side PWM value per phase
+ */
+static void driveBridge(Motor *motor, uint8_t hallState, int running, const uint16_t outputs[3]) {
+    if (motor->config.bridge == BRIDGE_HIGH_SIDE) {
+        writePhase(motor, 0, outputs[0]);
+        writePhase(motor, 1, outputs[1]);
+        writePhase(motor, 2, outputs[2]);
+        return;
+    }
+
+    const uint8_t *drive = bridgeTable[running ? hallState & 7 : 0];
+    int is6PWM = motor->config.bridge == BRIDGE_6PWM;
+    int8_t gate[3];
+    for (int k = 0; k < 3; k++) {
+        gate[k] = (int8_t) (is6PWM ? drive[k] == PHASE_LOW : drive[k] != PHASE_OFF);
+    }
+    switchBridge(motor, outputs, gate);
+}
+
+/**
+ * @brief Short the windings through the low sides
+ * @details High sides off, then every low side on: low-side inputs of a
+ * 6PWM bridge, or enabled legs at zero duty on a 3PWM bridge.
+ */
+static void shortBrake(Motor *motor) {
+    static const uint16_t off[3] = { 0, 0, 0 };
+    static const int8_t low[3] = { HIGH, HIGH, HIGH };
+    switchBridge(motor, off, low);
+}
+
+/**
+ * @brief Per-phase outputs for a Hall state at the given duty
+ * @details Rebuilds the 8-entry table only when the duty changed.
+ * MOTOR_FIXED_CONFIG builds fill just the requested entry from the packed
+ * pattern instead.
+ */
+static const uint16_t *commutationOutputs(Motor *motor, uint8_t hallState, uint16_t duty) {
+    CommutationCache *cache = &motor->commutation;
+#if MOTOR_FIXED_CONFIG
+    uint32_t packed = motorHot.driveTable[motor->index] ? BRIDGE_PWM_BITS : COMMUTATION_PWM_BITS;
+    uint32_t pattern = packed >> (3 * (hallState & 7));
+    uint16_t *outputs = cache->outputs[hallState & 7];
+    for (int phase = 0; phase < 3; phase++) {
+        outputs[phase] = duty & (uint16_t) -((pattern >> phase) & 1);
+    }
+    return outputs;
+#else
+    if (!cache->tableValid || cache->tableDuty != duty) {
+        const uint8_t (*table)[3] = motorDriveTables[motorHot.driveTable[motor->index]];
+        for (int state = 0; state < 8; state++) {
+            for (int phase = 0; phase < 3; phase++) {
+                cache->outputs[state][phase] = table[state][phase] == PHASE_PWM ? duty : 0;
+            }
+        }
+        cache->tableDuty = duty;
+        cache->tableValid = 1;
+    }
+    return cache->outputs[hallState & 7];
+#endif
+}
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ * @note Uses the backends selected with motorSetPwmBackend()/motorSetHallBackend()
+ */
+void motorDefaultConfig(MotorConfig *config) {
+    // Pins, limits, gains and sensor calibration default like a calibration file
+    MotorCalibration cal;
+    calibrationDefaults(&cal);
+    calibrationApply(&cal, config);
+
+    config->commutationMode = DEFAULT_COMMUTATION_MODE;
+    config->pwm = defaultPwm;
+    config->hall = defaultHall;
+    config->adcChannels[0] = BEMF_A_ADC_CHANNEL;
+    config->adcChannels[1] = BEMF_B_ADC_CHANNEL;
+    config->adcChannels[2] = BEMF_C_ADC_CHANNEL;
+    config->currentChannels[0] = CURRENT_A_ADC_CHANNEL;
+    config->currentChannels[1] = CURRENT_B_ADC_CHANNEL;
+    config->adc = defaultAdc;
+    config->busCurrentChannel = BUS_CURRENT_ADC_CHANNEL;
+    config->brakeDecel = BRAKE_DECEL_RPM_PER_S;
+    config->busVoltageChannel = BUS_VOLTAGE_ADC_CHANNEL;
+    config->busVoltageLimitMv = BUS_VOLTAGE_LIMIT_MV;
+}
+
+/**
+ * @brief Create and initialize a motor instance
+ * @param config Hardware and tuning configuration
+ * @return Motor handle, or NULL on failure or if the pool is exhausted
+ * @note The motor starts stopped
  * @warning Requires root privileges for GPIO access
  */
-int motorInit(void) {
-    // Initialize wiringPi library
-    if (wiringPiSetup() == -1) {
-        printf("WiringPi initialization failed\n");
-        return -1;
+Motor *motorCreate(const MotorConfig *config) {
+    if (config == NULL || config->pwm == NULL || config->hall == NULL ||
+        config->maxRpm == 0 || config->pwmRange == 0) {
+        return NULL;
+    }
+    if (MOTOR_FIXED_CONFIG && (config->pwmRange != PWM_RANGE || config->maxRpm != MOTOR_MAX_RPM)) {
+        printf("This build is fixed to PWM range %d and %d RPM\n", PWM_RANGE, MOTOR_MAX_RPM);
+        return NULL;
+    }
+    int sensorless = config->commutationMode == COMMUTATION_SENSORLESS;
+    int foc = config->commutationMode == COMMUTATION_FOC;
+    if (foc && (config->adc == NULL || config->bridge == BRIDGE_6PWM)) {
+        printf("FOC requires an ADC backend for current sensing and a high-side or 3PWM bridge\n");
+        return NULL;
+    }
+    const int *gatePins = config->bridge == BRIDGE_3PWM ? config->enablePins : config->lowSidePins;
+    if (config->bridge != BRIDGE_HIGH_SIDE && (gatePins[0] < 0 || gatePins[1] < 0 || gatePins[2] < 0)) {
+        printf("Bridge mode %d requires %s pins for all phases\n", config->bridge,
+               config->bridge == BRIDGE_3PWM ? "enable" : "low-side");
+        return NULL;
+    }
+    if (config->phaseAdvance > ROTOR_ANGLE_DEG(ROTOR_PHASE_ADVANCE_MAX_DEG)) {
+        printf("Phase advance above %d degrees\n", ROTOR_PHASE_ADVANCE_MAX_DEG);
+        return NULL;
+    }
+    if (config->rampAccel == 0 || config->brakeDecel == 0) {
+        printf("Ramp acceleration and brake deceleration must be at least 1 RPM/s\n");
+        return NULL;
+    }
+    if (config->hallDebounceNs > HALL_DEBOUNCE_MAX_NS) {
+        printf("Hall debounce window above %d ns\n", HALL_DEBOUNCE_MAX_NS);
+        return NULL;
+    }
+    if ((config->busCurrentChannel >= 0 || config->busVoltageChannel >= 0) && config->adc == NULL) {
+        printf("Bus current and voltage sensing require an ADC backend\n");
+        return NULL;
+    }
+    if (sensorless && (config->adc == NULL || config->enablePins[0] < 0 ||
+                       config->enablePins[1] < 0 || config->enablePins[2] < 0)) {
+        printf("Sensorless commutation requires an ADC backend and phase enable pins\n");
+        return NULL;
+    }
+
+    Motor *motor = NULL;
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        if (!motorPool[i].inUse) {
+            motor = &motorPool[i];
+            break;
+        }
+    }
+    if (motor == NULL) {
+        printf("No free motor slots (MOTOR_MAX_INSTANCES = %d)\n", MOTOR_MAX_INSTANCES);
+        return NULL;
     }
-    // Setup PWM pins for motor phases
-    pinMode(PHASE_A_PIN, PWM_OUTPUT);
-    pinMode(PHASE_B_PIN, PWM_OUTPUT);
-    pinMode(PHASE_C_PIN, PWM_OUTPUT);
 
-    // Initialize software PWM on motor phase pins
-    softPwmCreate(PHASE_A_PIN, 0, PWM_RANGE);
-    softPwmCreate(PHASE_B_PIN, 0, PWM_RANGE);
-    softPwmCreate(PHASE_C_PIN, 0, PWM_RANGE);
+    // Before any edge handler or service thread reads the timing clock
+    timingInit();
+
+    // Initialize wiringPi library with BCM GPIO numbering
+    if (!wiringPiReady) {
+        if (wiringPiSetupGpio() == -1) {
+            printf("WiringPi initialization failed\n");
+            return NULL;
+        }
+        wiringPiReady = 1;
+    }
+
+    // Edge handlers survive a destroyed slot; reuse them if the pins match
+    uint8_t hallIsrRegistered = motor->hallIsrRegistered &&
+        memcmp(motor->config.hallPins, config->hallPins, sizeof(config->hallPins)) == 0;
+    uint8_t faultIsrRegistered = motor->faultIsrRegistered && motor->config.faultPin == config->faultPin;
+    memset(motor, 0, sizeof(*motor));
+    motor->config = *config;
+    motor->index = (uint8_t) (motor - motorPool);
+    motor->hallIsrRegistered = hallIsrRegistered;
+    motor->faultIsrRegistered = faultIsrRegistered;
+    for (int i = 0; i < 3; i++) {
+        motor->commutation.applied[i] = -1;
+        motor->commutation.appliedGate[i] = -1;
+    }
+
+    // Claim the motor phase pins from the PWM backend
+    const PwmBackend *pwm = motor->config.pwm;
+    for (int i = 0; i < 3; i++) {
+        if (pwm->setup(motor->config.phasePins[i], motor->config.pwmRange) != 0) {
+            printf("PWM backend '%s' initialization failed\n", pwm->name);
+            while (--i >= 0) pwm->release(motor->config.phasePins[i]);
+            return NULL;
+        }
+    }
+
+    if (sensorless) {
+        // Phase drivers start disabled; the service thread enables them per step
+        for (int i = 0; i < 3; i++) {
+            pinMode(motor->config.enablePins[i], OUTPUT);
+            digitalWrite(motor->config.enablePins[i], LOW);
+        }
+    } else if (motor->config.bridge != BRIDGE_HIGH_SIDE) {
+        // Every leg starts floating
+        for (int i = 0; i < 3; i++) {
+            pinMode(gatePin(motor, i), OUTPUT);
+            digitalWrite(gatePin(motor, i), LOW);
+            motor->commutation.appliedGate[i] = LOW;
+        }
+    }
+    if (sensorless || foc || motor->config.busCurrentChannel >= 0 || motor->config.busVoltageChannel >= 0) {
+        if (motor->config.adc->setup() != 0) {
+            printf("ADC backend '%s' initialization failed\n", motor->config.adc->name);
+            for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+            return NULL;
+        }
+    }
 
     // Setup hall sensor pins as inputs with pull-up resistors
-    pinMode(HALL_A_PIN, INPUT);
-    pinMode(HALL_B_PIN, INPUT);
-    pinMode(HALL_C_PIN, INPUT);
-    pullUpDnControl(HALL_A_PIN, PUD_UP);
-    pullUpDnControl(HALL_B_PIN, PUD_UP);
-    pullUpDnControl(HALL_C_PIN, PUD_UP);
+    const int *hallPins = motor->config.hallPins;
+    for (int i = 0; i < 3 && !sensorless; i++) {
+        pinMode(hallPins[i], INPUT);
+        pullUpDnControl(hallPins[i], PUD_UP);
+    }
+
+    // Prefer the selected Hall backend, fall back to digitalRead()
+    if (!sensorless && motor->config.hall->setup(hallPins[0], hallPins[1], hallPins[2]) != 0) {
+        if (motor->config.hall != &digitalReadHallBackend) {
+            printf("Hall backend '%s' unavailable, using '%s'\n",
+                   motor->config.hall->name, digitalReadHallBackend.name);
+            motor->config.hall = &digitalReadHallBackend;
+        }
+        if (motor->config.hall->setup(hallPins[0], hallPins[1], hallPins[2]) != 0) {
+            for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+            return NULL;
+        }
+    }
+
+    hallValidatorInit(&motor->hallValidator, motor->config.hallDebounceNs);
+    speedEstimatorInit(&motor->speedEstimator, motor->config.numPoles, SPEED_ZERO_TIMEOUT_NS);
+    speedRampInit(&motor->speedRamp, motor->config.rampAccel, motor->config.rampJerk);
+    motorEventsInit(&motor->events);
+
+    int slot = motor->index;
+    motorHot.active[slot] = 0;
+    motorHot.kp[slot] = motor->config.kp;
+    motorHot.ki[slot] = motor->config.ki;
+    motorHot.integrator[slot] = 0;
+    motorHot.outMax[slot] = motor->config.pwmRange;
+    motorHot.duty[slot] = 0;
+    motorHot.driveTable[slot] = motor->config.bridge != BRIDGE_HIGH_SIDE;
 
     // Set initial state of the motor to stopped
-    motorStop();
-    return 0;
+    writeAllPhases(motor, 0);
+
+    // Commutate on Hall edges instead of waiting for the next API call
+    if (motor->config.commutationMode == COMMUTATION_INTERRUPT && registerHallInterrupts(motor) != 0) {
+        for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+        return NULL;
+    }
+
+    // Arm the overcurrent trip before anything can energize the phases
+    if (protectionAttach(motor) != 0) {
+        for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+        return NULL;
+    }
+
+    // Back-EMF sampling and commutation run on the sensorless service thread
+    if (sensorless && sensorlessAttach(motor) != 0) {
+        for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+        return NULL;
+    }
+
+    // The current loop runs on the FOC service thread
+    if (foc && focAttach(motor) != 0) {
+        for (int i = 0; i < 3; i++) pwm->release(motor->config.phasePins[i]);
+        return NULL;
+    }
+    motor->inUse = 1;
+    return motor;
 }
 
+static void applyStop(Motor *motor);
+static void stopViaLoop(Motor *motor);
+
 /**
- * @brief Set motor speed with safety constraints
- * @param rpm Desired speed (0-MOTOR_MAX_RPM)
- * @note Implements soft ramping for speed changes
- * @warning Speed changes are rate-limited
+ * @brief Stop a motor, release its pins and return its slot to the pool
+ * @param motor Motor handle
+ * @note Hall edge handlers cannot be removed in WiringPi; they become no-ops
+ * @note While the control loop runs, the stop is applied by the loop thread
+ *       and this call waits until it has been
  */
-void motorSetSpeed(uint16_t rpm) {
+void motorDestroy(Motor *motor) {
+    if (motor == NULL || !motor->inUse) return;
+
+    if (controlLoopIsRunning()) {
+        // The loop owns the outputs: queue the stop and wait until it is applied
+        stopViaLoop(motor);
+    } else {
+        lockPhases(motor);
+        applyStop(motor);
+        motorPhaseUnlock(motor);
+    }
+    // Every context re-checks inUse under the lock before touching the motor
+    lockPhases(motor);
+    motor->inUse = 0;
+    motorPhaseUnlock(motor);
+    motorEventsClose(&motor->events);
+    if (motor->config.commutationMode == COMMUTATION_SENSORLESS) sensorlessDetach(motor);
+    if (motor->config.commutationMode == COMMUTATION_FOC) focDetach(motor);
+    for (int i = 0; i < 3; i++) motor->config.pwm->release(motor->config.phasePins[i]);
+    if (motor == defaultMotor) defaultMotor = NULL;
+}
+
+/**
+ * @brief Get the motor created by motorInit()
+ * @return Default motor handle, or NULL before motorInit()
+ */
+Motor *motorGetDefault(void) {
+    return defaultMotor;
+}
+
+/**
+ * @brief Check whether motorControlTick() is being run periodically
+ * @return 1 if the control loop thread or the application drives the tick
+ */
+static int closedLoopActive(void) {
+    return externalTick || controlLoopIsRunning();
+}
+
+/**
+ * @brief Declare that the application calls motorControlTick() itself
+ * @param enabled 1 if motorControlTick() is driven externally, 0 otherwise
+ */
+void motorSetExternalTick(int enabled) {
+    externalTick = enabled ? 1 : 0;
+}
+
+/**
+ * @brief End braking and give the ramp its limits back
+ * @note Leaves the run flag alone; callers start, stop or keep driving
+ */
+static void endBraking(Motor *motor) {
+    if (motor->brake == BRAKE_REGEN) {
+        motor->speedRamp.maxAccel = motor->savedRampAccel;
+        motor->speedRamp.jerk = motor->savedRampJerk;
+    }
+    motor->brake = BRAKE_COAST;
+}
+
+/**
+ * @brief Publish whether the profile has reached the target
+ * @details Read by motorInstanceIsRamping() on the caller's thread. Caller
+ * holds the phase lock.
+ */
+static void publishRamping(Motor *motor) {
+    uint16_t target = atomic_load_explicit(&motor->targetSpeed, memory_order_relaxed);
+    uint8_t ramping = motor->speedRamp.target != target || !speedRampIsSettled(&motor->speedRamp);
+    atomic_store_explicit(&motor->ramping, ramping, memory_order_release);
+}
+
+/**
+ * @brief Apply a speed change to a motor instance
+ * @details With the control loop running only the target changes and the
+ * loop ramps towards it; otherwise the open-loop duty is applied directly.
+ * Caller holds the phase lock.
+ */
+static void applySetSpeed(Motor *motor, uint16_t rpm) {
+    endBraking(motor);
+
     // Limit the speed to the maximum allowed RPM
-    if (rpm > MOTOR_MAX_RPM) {
-        rpm = MOTOR_MAX_RPM;
+    if (rpm > MOTOR_SPEED_LIMIT(motor)) {
+        rpm = MOTOR_SPEED_LIMIT(motor);
     }
     
-    currentSpeed = rpm;
-    // Calculate the PWM duty cycle based on the desired speed
-    pwmDutyCycle = (rpm * PWM_RANGE) / MOTOR_MAX_RPM;
+    atomic_store_explicit(&motor->targetSpeed, rpm, memory_order_relaxed);
+
+    // The control loop ramps towards the new target on its own
+    if (closedLoopActive()) {
+        publishRamping(motor);
+        return;
+    }
+
+    // Without a control loop, apply the open-loop duty directly
+    speedRampReset(&motor->speedRamp, rpm);
+    publishRamping(motor);
+    motorHot.duty[motor->index] = openLoopDuty(motor, rpm);
     
     // Update commutation if the motor is running
-    if (isRunning) {
-        updateCommutation();
+    if (motor->isRunning) {
+        motorInstanceUpdateCommutation(motor);
     }
 }
 
+/** @brief Enable commutation of a motor instance (phase lock held) */
+static void applyStart(Motor *motor) {
+    // A latched fault must be acknowledged first
+    if (motor->fault != MOTOR_FAULT_NONE) return;
+    endBraking(motor);
+    if (resumeOutputs(motor) != 0) return;
+    motor->isRunning = 1;
+    if (!closedLoopActive()) {
+        uint16_t target = atomic_load_explicit(&motor->targetSpeed, memory_order_relaxed);
+        motorHot.duty[motor->index] = openLoopDuty(motor, target);
+    }
+    // Update commutation to start the motor
+    motorInstanceUpdateCommutation(motor);
+}
+
+/** @brief De-energize all phases of a motor instance (phase lock held) */
+static void applyStop(Motor *motor) {
+    motor->isRunning = 0;
+    endBraking(motor);
+    // Set PWM duty cycle to 0 for all phases to stop the motor
+    writeAllPhases(motor, 0);
+    suspendOutputs(motor);
+}
+
+/**
+ * @brief Stop a motor and de-energize its outputs immediately
+ * @param motor Motor instance (phase lock held)
+ */
+void motorEmergencyOff(Motor *motor) {
+    motor->isRunning = 0;
+    endBraking(motor);
+    writeAllPhases(motor, 0);
+}
+
+/** @brief Start a gain identification experiment on a motor instance (phase lock held) */
+static void applyAutotune(Motor *motor, uint16_t baseRpm, uint16_t stepRpm) {
+    if (autotuneActive(&motor->autotune) || motor->fault != MOTOR_FAULT_NONE) return;
+    int slot = motor->index;
+    motor->autotune.savedKp = motorHot.kp[slot];
+    motor->autotune.savedKi = motorHot.ki[slot];
+    autotuneBegin(&motor->autotune, baseRpm, stepRpm, motor->config.pwmRange,
+                  motor->config.maxRpm, motorClockNs());
+    // Zero gains leave the open-loop feedforward as the duty
+    motorHot.kp[slot] = 0;
+    motorHot.ki[slot] = 0;
+    motorHot.integrator[slot] = 0;
+    applyStart(motor);
+}
+
+/**
+ * @brief Check whether a motor can brake in a mode
+ * @return 1 if the bridge has low-side control and the control tick drives the phases
+ */
+static int brakeSupported(const Motor *motor, BrakeMode mode) {
+    if (mode == BRAKE_COAST) return 1;
+    return (mode == BRAKE_SHORT || mode == BRAKE_REGEN) &&
+           motor->config.bridge != BRIDGE_HIGH_SIDE && !phasesDrivenByService(motor);
+}
+
+/**
+ * @brief Begin braking a motor instance to standstill
+ * @details A motor that is not being driven has no regulator to take the
+ * profile down and goes straight to the short brake. Modes the motor cannot
+ * brake in (e.g. received over the network) stop it instead. Caller holds
+ * the phase lock.
+ */
+static void applyBrake(Motor *motor, BrakeMode mode) {
+    if (!brakeSupported(motor, mode) || mode == BRAKE_COAST || motor->fault != MOTOR_FAULT_NONE) {
+        applyStop(motor);
+        return;
+    }
+    motor->scheduledPending = 0;
+    if (mode == BRAKE_REGEN && motor->isRunning) {
+        if (motor->brake != BRAKE_REGEN) {
+            motor->savedRampAccel = motor->speedRamp.maxAccel;
+            motor->savedRampJerk = motor->speedRamp.jerk;
+        }
+        motor->brake = BRAKE_REGEN;
+        atomic_store_explicit(&motor->targetSpeed, 0, memory_order_relaxed);
+        publishRamping(motor);
+        return;
+    }
+
+    endBraking(motor);
+    motor->isRunning = 0;
+    // The low sides are switched with the phases at zero duty
+    if (resumeOutputs(motor) == 0) motor->brake = BRAKE_SHORT;
+}
+
+/**
+ * @brief Execute a motor command
+ * @details Runs on the control loop thread while it is active, otherwise on
+ * the caller's thread. Caller holds the phase lock of the command's motor.
+ */
+static void applyCommand(const MotorCommand *command) {
+    if (command->motor >= MOTOR_MAX_INSTANCES) return;
+    Motor *motor = &motorPool[command->motor];
+    if (!motor->inUse) return;
+
+    switch (command->type) {
+        case MOTOR_CMD_SET_SPEED:
+            motor->scheduledPending = 0;
+            applySetSpeed(motor, (uint16_t) (command->arg0 < 0 ? 0 :
+                                             command->arg0 > UINT16_MAX ? UINT16_MAX : command->arg0));
+            break;
+        case MOTOR_CMD_START:
+            applyStart(motor);
+            break;
+        case MOTOR_CMD_STOP:
+            motor->scheduledPending = 0;
+            applyStop(motor);
+            break;
+        case MOTOR_CMD_SET_GAINS:
+            motorHot.kp[motor->index] = command->arg0;
+            motorHot.ki[motor->index] = command->arg1;
+            break;
+        case MOTOR_CMD_SET_RAMP:
+            // A zero acceleration (e.g. from the network) leaves the limits as they are
+            if (speedRampSetLimits(&motor->speedRamp, (uint32_t) command->arg0, (uint32_t) command->arg1) != 0) {
+                break;
+            }
+            if (motor->brake == BRAKE_REGEN) {
+                // Takes effect once braking ends
+                motor->savedRampAccel = motor->speedRamp.maxAccel;
+                motor->savedRampJerk = motor->speedRamp.jerk;
+            }
+            break;
+        case MOTOR_CMD_AUTOTUNE:
+            applyAutotune(motor, (uint16_t) command->arg0, (uint16_t) command->arg1);
+            break;
+        case MOTOR_CMD_SET_SPEED_AT:
+            motor->scheduledSpeed = (uint16_t) (command->arg0 < 0 ? 0 :
+                                                command->arg0 > UINT16_MAX ? UINT16_MAX : command->arg0);
+            motor->scheduledTick = (uint32_t) command->arg1;
+            motor->scheduledPending = 1;
+            break;
+        case MOTOR_CMD_BRAKE:
+            applyBrake(motor, (BrakeMode) command->arg0);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Hand a command to the control loop, or execute it if none runs
+ * @return 0 on success, -1 if the command queue is full
+ * @note A stop is never dropped: if the queue is full the run flag is
+ *       cleared directly and the next tick de-energizes the phases
+ */
+static int submitCommand(Motor *motor, MotorCommandType type, int32_t arg0, int32_t arg1) {
+    MotorCommand command = {
+        .type = (uint8_t) type,
+        .motor = motor->index,
+        .flags = 0,
+        .arg0 = arg0,
+        .arg1 = arg1,
+    };
+
+    if (!controlLoopIsRunning()) {
+        lockPhases(motor);
+        applyCommand(&command);
+        motorPhaseUnlock(motor);
+        return 0;
+    }
+    // Counted until the loop applies it, see motorInstanceIsRamping()
+    int speedChange = type == MOTOR_CMD_SET_SPEED;
+    if (speedChange) atomic_fetch_add_explicit(&motor->speedRequests, 1, memory_order_release);
+    if (commandQueuePush(&apiQueue, &command) == 0) {
+        controlLoopWake();
+        return 0;
+    }
+    if (speedChange) atomic_fetch_sub_explicit(&motor->speedRequests, 1, memory_order_release);
+
+    if (type == MOTOR_CMD_STOP) {
+        motor->isRunning = 0;
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Stop a motor through the running control loop and wait for it
+ * @details Commands for a motor are applied in order and popped only once
+ * applied, so the stop has taken effect when the API queue is empty.
+ */
+static void stopViaLoop(Motor *motor) {
+    submitCommand(motor, MOTOR_CMD_STOP, 0, 0);
+    while (controlLoopIsRunning() && !commandQueueIsEmpty(&apiQueue)) {
+        controlLoopWake();
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Attach an additional command queue drained by the control loop
+ * @param queue Initialized queue owned by a single producer thread
+ * @return 0 on success, -1 if MOTOR_MAX_COMMAND_QUEUES are already attached
+ * @note Queues cannot be detached; keep them alive for the process lifetime
+ */
+int motorAttachCommandQueue(CommandQueue *queue) {
+    int count = atomic_load_explicit(&commandQueueCount, memory_order_relaxed);
+    if (queue == NULL || count >= MOTOR_MAX_COMMAND_QUEUES) return -1;
+
+    commandQueues[count] = queue;
+    atomic_store_explicit(&commandQueueCount, count + 1, memory_order_release);
+    return 0;
+}
+
+/**
+ * @brief Get the pool index of a motor instance
+ * @param motor Motor handle
+ * @return Index used in MotorCommand::motor
+ */
+int motorInstanceGetIndex(const Motor *motor) {
+    return motor->index;
+}
+
+/**
+ * @brief Set the speed of a motor instance
+ * @param motor Motor handle
+ * @param rpm Desired speed (0-maxRpm)
+ * @return 0 on success, -1 if the command queue is full
+ * @see motorSetSpeed()
+ */
+int motorInstanceSetSpeed(Motor *motor, uint16_t rpm) {
+    if (rpm > MOTOR_SPEED_LIMIT(motor)) {
+        rpm = MOTOR_SPEED_LIMIT(motor);
+    }
+    // Reported by motorInstanceGetTargetSpeed() until the loop applies it
+    atomic_store_explicit(&motor->requestedSpeed, rpm, memory_order_relaxed);
+    return submitCommand(motor, MOTOR_CMD_SET_SPEED, rpm, 0);
+}
+
+/**
+ * @brief Set the speed of a motor instance on a given control tick
+ * @param motor Motor handle
+ * @param rpm Desired speed (0-maxRpm)
+ * @param tickIndex Tick on which the new target takes effect
+ * @return 0 on success, -1 if the command queue is full
+ */
+int motorInstanceSetSpeedAt(Motor *motor, uint16_t rpm, uint64_t tickIndex) {
+    return submitCommand(motor, MOTOR_CMD_SET_SPEED_AT, rpm, (int32_t) (uint32_t) tickIndex);
+}
+
+/**
+ * @brief Start a motor instance
+ * @param motor Motor handle
+ * @return 0 on success, -1 if a fault is latched or the command queue is full
+ * @see motorStart()
+ */
+int motorInstanceStart(Motor *motor) {
+    if (motor->fault != MOTOR_FAULT_NONE) return -1;
+    return submitCommand(motor, MOTOR_CMD_START, 0, 0);
+}
+
+/**
+ * @brief Stop a motor instance
+ * @param motor Motor handle
+ * @return 0 (a stop is never dropped)
+ * @see motorStop()
+ */
+int motorInstanceStop(Motor *motor) {
+    return submitCommand(motor, MOTOR_CMD_STOP, 0, 0);
+}
+
+/**
+ * @brief Get the measured speed of a motor instance
+ * @param motor Motor handle
+ * @return Measured speed in RPM
+ */
+uint16_t motorInstanceGetSpeed(const Motor *motor) {
+    return speedEstimatorGetRpm(&motor->speedEstimator);
+}
+
+/**
+ * @brief Check whether a speed change of the API caller is still queued
+ * @details The caller's thread is the only writer of speedRequests and the
+ * control tick the only writer of speedRequestsApplied.
+ */
+static int speedRequestPending(const Motor *motor) {
+    return atomic_load_explicit(&motor->speedRequests, memory_order_acquire) !=
+           atomic_load_explicit(&motor->speedRequestsApplied, memory_order_acquire);
+}
+
+/**
+ * @brief Get the requested speed of a motor instance
+ * @param motor Motor handle
+ * @return Last speed passed to motorInstanceSetSpeed() while it is queued,
+ *         otherwise the target the control loop applied last (RPM)
+ */
+uint16_t motorInstanceGetTargetSpeed(const Motor *motor) {
+    if (speedRequestPending(motor)) {
+        return atomic_load_explicit(&motor->requestedSpeed, memory_order_relaxed);
+    }
+    return atomic_load_explicit(&motor->targetSpeed, memory_order_relaxed);
+}
+
+/**
+ * @brief Get the ramp profile speed of a motor instance
+ * @param motor Motor handle
+ * @return Profile speed in RPM
+ */
+uint16_t motorInstanceGetRampSpeed(const Motor *motor) {
+    return (uint16_t) speedRampGetSpeed(&motor->speedRamp);
+}
+
+/**
+ * @brief Check whether a motor instance is still ramping
+ * @param motor Motor handle
+ * @return 1 while ramping, 0 once the target is reached
+ */
+int motorInstanceIsRamping(const Motor *motor) {
+    return speedRequestPending(motor) || atomic_load_explicit(&motor->ramping, memory_order_acquire);
+}
+
+/**
+ * @brief Set the speed regulator gains of a motor instance
+ * @param motor Motor handle
+ * @param kp Proportional gain, Q16.16 duty counts per RPM
+ * @param ki Integral gain, Q16.16 duty counts per RPM per control tick
+ * @return 0 on success, -1 if the command queue is full
+ */
+int motorInstanceSetSpeedGains(Motor *motor, int32_t kp, int32_t ki) {
+    return submitCommand(motor, MOTOR_CMD_SET_GAINS, kp, ki);
+}
+
+/**
+ * @brief Set the speed ramp limits of a motor instance
+ * @param motor Motor handle
+ * @param accelRpmPerSec Acceleration limit in RPM/s, at least 1
+ * @param jerkRpmPerSec2 Jerk limit in RPM/s^2, 0 for a trapezoidal profile
+ * @return 0 on success, -1 if accelRpmPerSec is 0 or the command queue is full
+ */
+int motorInstanceSetRampLimits(Motor *motor, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2) {
+    // A zero limit would hold the profile where it is
+    if (accelRpmPerSec == 0) return -1;
+    return submitCommand(motor, MOTOR_CMD_SET_RAMP, (int32_t) accelRpmPerSec, (int32_t) jerkRpmPerSec2);
+}
+
+/**
+ * @brief Identify the gains of a motor instance
+ * @param motor Motor handle (COMMUTATION_POLLED, INTERRUPT or FOC)
+ * @return 0 if the experiment was queued, -1 if the motor cannot be tuned,
+ *         no control tick runs or the command queue is full
+ * @see Autotune.h
+ */
+int motorInstanceAutotune(Motor *motor) {
+    if (motor->config.commutationMode == COMMUTATION_SENSORLESS) {
+        printf("Autotune needs Hall feedback from standstill\n");
+        return -1;
+    }
+    if (!closedLoopActive()) {
+        printf("Autotune requires the control loop\n");
+        return -1;
+    }
+    uint16_t maxRpm = motor->config.maxRpm;
+    return submitCommand(motor, MOTOR_CMD_AUTOTUNE, maxRpm * AUTOTUNE_BASE_PCT / 100,
+                         maxRpm * AUTOTUNE_STEP_PCT / 100);
+}
+
+/**
+ * @brief Brake a motor instance to standstill
+ * @param motor Motor handle
+ * @param mode Braking mode
+ * @return 0 if braking was queued, -1 if the mode is not supported by the
+ *         motor's bridge or commutation, no control tick runs or the
+ *         command queue is full
+ * @see Brake.h
+ */
+int motorInstanceBrake(Motor *motor, BrakeMode mode) {
+    if (mode == BRAKE_COAST) return motorInstanceStop(motor);
+    if (!brakeSupported(motor, mode)) {
+        printf("Braking requires a bridge with low-side control and Hall commutation\n");
+        return -1;
+    }
+    if (!closedLoopActive()) {
+        printf("Braking requires the control loop\n");
+        return -1;
+    }
+    return submitCommand(motor, MOTOR_CMD_BRAKE, mode, 0);
+}
+
+/**
+ * @brief Check whether a motor instance is braking
+ * @param motor Motor handle
+ * @return Active BrakeMode, BRAKE_COAST once stopped or while driving
+ */
+BrakeMode motorInstanceGetBrakeMode(const Motor *motor) {
+    return (BrakeMode) motor->brake;
+}
+
+/**
+ * @brief Sample the Hall sensors and drive the matching phase pattern
+ * @param motor Motor instance (phase lock held)
+ * @param edge 1 when called from the Hall edge handler, see hallValidatorEdge()
+ */
+static void commutate(Motor *motor, int edge) {
+    // Sensorless and FOC motors are commutated by their service thread only
+    if (phasesDrivenByService(motor)) return;
+
+    uint64_t start = timingNow();
+
+    // Read hall sensor states
+    uint8_t previousState = motor->speedEstimator.lastHallState;
+    uint64_t nowNs = motorClockNs();
+    uint8_t hallState = motorSampleHall(motor, nowNs, edge);
+
+    if (!motor->isRunning) return;
+    hallState = driveState(motor, hallState, nowNs);
+
+    // Look up the outputs for the current hall sensor state
+    const uint16_t *outputs = commutationOutputs(motor, hallState, motorHot.duty[motor->index]);
+
+    // Apply them, touching only the phases that change
+    driveBridge(motor, hallState, 1, outputs);
+
+    uint32_t elapsedNs = timingElapsedNs(start, timingNow());
+    timingRecord(TIMING_COMMUTATION, elapsedNs);
+    if (motor->speedEstimator.lastHallState != previousState) {
+        timingRecord(TIMING_EDGE_TO_PWM, elapsedNs);
+    }
+}
+
+/**
+ * @brief Update phase commutation of a motor instance
+ * @param motor Motor handle
+ * @see updateCommutation()
+ */
+void motorInstanceUpdateCommutation(Motor *motor) {
+    commutate(motor, 0);
+}
+
+/**
+ * @brief Sample the Hall sensors of a motor through its validator
+ * @param motor Motor instance (phase lock held)
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param edge 1 for a read from the Hall edge handler, 0 for periodic samples
+ * @return Validated Hall code, also fed to the speed estimator
+ * @details Never waits for the debounce window: an edge handler read is
+ * accepted at once, a periodic sample still awaiting the window is decided
+ * by the next Hall edge or control tick, and the estimator gets the edge
+ * time the validator entered the sector with.
+ */
+uint8_t motorSampleHall(Motor *motor, uint64_t nowNs, int edge) {
+    const int *hallPins = motor->config.hallPins;
+    const HallBackend *hall = motor->config.hall;
+    HallValidator *validator = &motor->hallValidator;
+    uint32_t sectorNs = speedEstimatorGetSectorPeriodNs(&motor->speedEstimator);
+
+    uint8_t raw = hall->read(hallPins[0], hallPins[1], hallPins[2]);
+    uint8_t hallState = edge ? hallValidatorEdge(validator, raw, nowNs, sectorNs) :
+                               hallValidatorSample(validator, raw, nowNs, sectorNs);
+
+    // A single bad sample is ridden through; a persistent one stops the motor
+    if (hallValidatorLost(validator) && motor->isRunning) {
+        protectionTripLocked(motor, MOTOR_FAULT_HALL);
+    }
+    speedEstimatorSample(&motor->speedEstimator, hallState, validator->lastEdgeNs);
+    return hallState;
+}
+
+/**
+ * @brief Initialize motor control hardware
+ * @return 0 on success, -1 on failure
+ * @note Performs self-test of all subsystems
+ * @warning Requires root privileges for GPIO access
+ */
+int motorInit(void) {
+    return motorInitWithMode(DEFAULT_COMMUTATION_MODE);
+}
+
+/**
+ * @brief Initialize motor control hardware with a specific commutation mode
+ * @param mode COMMUTATION_POLLED or COMMUTATION_INTERRUPT
+ * @return 0 on success, -1 on failure
+ * @note In interrupt mode, edge handlers are registered on all three Hall pins
+ * @note Pins, limits and gains come from CALIBRATION_PATH when that file
+ *       exists; an invalid file fails initialization (see MotorCalibration.h)
+ * @warning Requires root privileges for GPIO access
+ */
+int motorInitWithMode(CommutationMode mode) {
+    if (defaultMotor != NULL) return 0;
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = mode;
+
+    // A calibration file replaces the compile-time pins, limits and gains
+    if (calibrationPath != NULL) {
+        const MotorCalibration *cal;
+        int status = calibrationMap(calibrationPath, &cal);
+        if (status < 0) return -1;
+        if (status == 0) {
+            calibrationApply(cal, &config);
+            calibrationUnmap(cal);
+        }
+    }
+    defaultMotor = motorCreate(&config);
+    return defaultMotor != NULL ? 0 : -1;
+}
+
+/**
+ * @brief Get the active commutation mode
+ * @return Mode selected at initialization
+ */
+CommutationMode motorGetCommutationMode(void) {
+    return defaultMotor != NULL ? defaultMotor->config.commutationMode : DEFAULT_COMMUTATION_MODE;
+}
+
+/**
+ * @brief Select the PWM backend driving the phase pins
+ * @param backend Backend to use (e.g. &softPwmBackend, &sysfsPwmBackend)
+ * @return 0 on success, -1 if backend is NULL or the pins are already claimed
+ * @note Must be called before motorInit()
+ */
+int motorSetPwmBackend(const PwmBackend *backend) {
+    if (backend == NULL || defaultMotor != NULL) return -1;
+    defaultPwm = backend;
+    return 0;
+}
+
+/**
+ * @brief Select the calibration file loaded by motorInit()
+ * @param path File path, or NULL to load none
+ * @return 0 on success, -1 if the default motor already exists
+ * @note Must be called before motorInit()
+ */
+int motorSetCalibrationPath(const char *path) {
+    if (defaultMotor != NULL) return -1;
+    calibrationPath = path;
+    return 0;
+}
+
+/**
+ * @brief Select the backend sampling the Hall sensors
+ * @param backend Backend to use (e.g. &gpiomemHallBackend, &digitalReadHallBackend)
+ * @return 0 on success, -1 if backend is NULL
+ * @note Must be called before motorInit()
+ */
+int motorSetHallBackend(const HallBackend *backend) {
+    if (backend == NULL || defaultMotor != NULL) return -1;
+    defaultHall = backend;
+    return 0;
+}
+
+/**
+ * @brief Set the speed regulator gains
+ * @param kp Proportional gain, Q16.16 duty counts per RPM
+ * @param ki Integral gain, Q16.16 duty counts per RPM per control tick
+ */
+void motorSetSpeedGains(int32_t kp, int32_t ki) {
+    if (defaultMotor) motorInstanceSetSpeedGains(defaultMotor, kp, ki);
+}
+
+/**
+ * @brief Set the speed ramp limits
+ * @param accelRpmPerSec Acceleration limit in RPM/s, at least 1 (0 is ignored)
+ * @param jerkRpmPerSec2 Jerk limit in RPM/s^2, 0 for a trapezoidal profile
+ */
+void motorSetRampLimits(uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2) {
+    if (defaultMotor) motorInstanceSetRampLimits(defaultMotor, accelRpmPerSec, jerkRpmPerSec2);
+}
+
+/**
+ * @brief Set motor speed with safety constraints
+ * @param rpm Desired speed (0-MOTOR_MAX_RPM)
+ * @note Implements soft ramping for speed changes: while the control loop
+ *       runs, returns immediately and the loop follows a jerk-limited profile
+ * @warning Speed changes are rate-limited (see motorSetRampLimits())
+ */
+void motorSetSpeed(uint16_t rpm) {
+    if (defaultMotor) motorInstanceSetSpeed(defaultMotor, rpm);
+}
+
+/**
+ * @brief Set motor speed on a given control tick
+ * @param rpm Desired speed (0-MOTOR_MAX_RPM)
+ * @param tickIndex Tick on which the new target takes effect
+ * @see motorInstanceSetSpeedAt()
+ */
+void motorSetSpeedAt(uint16_t rpm, uint64_t tickIndex) {
+    if (defaultMotor) motorInstanceSetSpeedAt(defaultMotor, rpm, tickIndex);
+}
+
 /**
  * @brief Stop the motor
  * @details Immediately stops motor by de-energizing all phases
  */
 void motorStop(void) {
-    isRunning = 0;
-    // Set PWM duty cycle to 0 for all phases to stop the motor
-    softPwmWrite(PHASE_A_PIN, 0);
-    softPwmWrite(PHASE_B_PIN, 0);
-    softPwmWrite(PHASE_C_PIN, 0);
+    if (defaultMotor) motorInstanceStop(defaultMotor);
 }
 
 /**
@@ -170,38 +1360,356 @@ void motorStop(void) {
  * @details Enables commutation and applies current speed setting
  */
 void motorStart(void) {
-    isRunning = 1;
-    // Update commutation to start the motor
-    updateCommutation();
+    if (defaultMotor) motorInstanceStart(defaultMotor);
+}
+
+/**
+ * @brief Brake the default motor to standstill
+ * @param mode Braking mode
+ * @return 0 if braking was queued, -1 otherwise
+ * @see motorInstanceBrake()
+ */
+int motorBrake(BrakeMode mode) {
+    return defaultMotor ? motorInstanceBrake(defaultMotor, mode) : -1;
+}
+
+/**
+ * @brief Check whether the default motor is braking
+ * @return Active BrakeMode, BRAKE_COAST before motorInit()
+ */
+BrakeMode motorGetBrakeMode(void) {
+    return defaultMotor ? motorInstanceGetBrakeMode(defaultMotor) : BRAKE_COAST;
 }
 
 /**
  * @brief Get current motor speed
- * @return Current speed in RPM
+ * @return Measured speed in RPM, derived from Hall edge timing
  */
 uint16_t motorGetSpeed(void) {
-    return currentSpeed;
+    return defaultMotor ? motorInstanceGetSpeed(defaultMotor) : 0;
+}
+
+/**
+ * @brief Get the requested motor speed
+ * @return Last speed passed to motorSetSpeed() in RPM
+ */
+uint16_t motorGetTargetSpeed(void) {
+    return defaultMotor ? motorInstanceGetTargetSpeed(defaultMotor) : 0;
+}
+
+/**
+ * @brief Get the speed the ramp generator is currently commanding
+ * @return Profile speed in RPM
+ */
+uint16_t motorGetRampSpeed(void) {
+    return defaultMotor ? motorInstanceGetRampSpeed(defaultMotor) : 0;
+}
+
+/**
+ * @brief Check whether a speed change is still being ramped
+ * @return 1 while the profile has not reached motorGetTargetSpeed(), 0 otherwise
+ */
+int motorIsRamping(void) {
+    return defaultMotor ? motorInstanceIsRamping(defaultMotor) : 0;
 }
 
 /**
  * @brief Update motor phase commutation
  * @details Reads Hall sensors and applies appropriate phase pattern
- * @note Only operates when motor is running (isRunning == 1)
+ * @note Only drives the phases when motor is running (isRunning == 1); Hall
+ *       edges are still timestamped while stopped so coasting speed is tracked
+ * @note In COMMUTATION_INTERRUPT mode this also runs from the Hall edge handlers
  */
 void updateCommutation(void) {
-    if (!isRunning) return;
+    if (defaultMotor) motorInstanceUpdateCommutation(defaultMotor);
+}
 
-    // Read hall sensor states
-    uint8_t hallState = 0;
-    hallState |= digitalRead(HALL_A_PIN) << 2;
-    hallState |= digitalRead(HALL_B_PIN) << 1;
-    hallState |= digitalRead(HALL_C_PIN);
+/**
+ * @brief Advance the gain identification experiment of a motor
+ * @param motor Motor instance (phase lock held)
+ * @param nowNs Tick timestamp
+ * @param measured Measured speed (RPM)
+ * @return Setpoint for this tick
+ * @details Installs the identified gains once the experiment completes and
+ * restores the previous ones if it fails or the motor stops.
+ */
+static uint16_t autotuneTick(Motor *motor, uint64_t nowNs, uint16_t measured) {
+    Autotuner *tuner = &motor->autotune;
+    int slot = motor->index;
+    uint16_t setpoint = measured;
+    if (!motor->isRunning) {
+        printf("Autotune aborted: motor stopped\n");
+        tuner->state = AUTOTUNE_FAILED;
+    } else {
+        setpoint = autotuneUpdate(tuner, nowNs, measured);
+    }
 
-    // Get the commutation pattern for the current hall sensor state
-    const uint8_t* pattern = commutationTable[hallState];
-    
-    // Apply the commutation pattern to the motor phases
-    softPwmWrite(PHASE_A_PIN, pattern[0] ? pwmDutyCycle : 0);
-    softPwmWrite(PHASE_B_PIN, pattern[1] ? pwmDutyCycle : 0);
-    softPwmWrite(PHASE_C_PIN, pattern[2] ? pwmDutyCycle : 0);
-}
\ No newline at end of file
+    if (tuner->state == AUTOTUNE_DONE) {
+        motorHot.kp[slot] = tuner->result.kp;
+        motorHot.ki[slot] = tuner->result.ki;
+    } else if (tuner->state == AUTOTUNE_FAILED) {
+        motorHot.kp[slot] = tuner->savedKp;
+        motorHot.ki[slot] = tuner->savedKi;
+    }
+    if (!autotuneActive(tuner)) setpoint = measured;
+
+    // The ramp takes over from wherever the experiment leaves the speed
+    speedRampReset(&motor->speedRamp, setpoint);
+    return setpoint;
+}
+
+/**
+ * @brief Advance braking of a motor
+ * @param motor Motor instance (phase lock held)
+ * @param measured Measured speed (RPM)
+ * @details Sets this tick's regenerative deceleration from the bus voltage
+ * and hands over to the short brake once the profile is down or the bus
+ * is full; releases the short brake at standstill.
+ */
+static void brakeTick(Motor *motor, uint16_t measured) {
+    if (motor->brake == BRAKE_REGEN) {
+        uint32_t decel = motor->config.brakeDecel;
+        if (motor->config.busVoltageChannel >= 0) {
+            int raw = motor->config.adc->read(motor->config.busVoltageChannel);
+            if (raw >= 0) {
+                decel = brakeRegenDecel(decel, raw * BUS_VOLTAGE_MV_PER_LSB,
+                                        motor->config.busVoltageLimitMv);
+            }
+        }
+        // A bus that stays near its limit would hold the rotor at speed
+        if (decel < motor->config.brakeDecel / 4 || speedRampGetSpeed(&motor->speedRamp) == 0) {
+            endBraking(motor);
+            motor->isRunning = 0;
+            motor->brake = BRAKE_SHORT;
+        } else {
+            speedRampSetLimits(&motor->speedRamp, decel, 0);
+        }
+    }
+    if (motor->brake == BRAKE_SHORT && measured == 0) {
+        motor->brake = BRAKE_COAST;
+        motorEventsRaise(&motor->events, MOTOR_EVENT_STOPPED);
+    }
+}
+
+/**
+ * @brief Gather one motor's inputs into the hot state
+ * @param motor Motor instance
+ * @param nowNs Tick timestamp
+ * @param dtNs Time since the previous tick
+ * @return 1 if a new Hall edge was detected, 0 otherwise
+ * @details Samples the Hall sensors, updates the speed estimate and advances
+ * the setpoint ramp. Caller holds the phase lock.
+ */
+static int gatherMotor(Motor *motor, uint64_t nowNs, uint32_t dtNs) {
+    int slot = motor->index;
+    int sensorless = motor->config.commutationMode == COMMUTATION_SENSORLESS;
+
+    // Bus current is checked before the regulator may raise the duty
+    if (motor->config.busCurrentChannel >= 0 && motor->isRunning) {
+        int raw = motor->config.adc->read(motor->config.busCurrentChannel);
+        if (raw >= 0) protectionCheckCurrent(motor, raw * BUS_CURRENT_MA_PER_LSB);
+    }
+
+    uint8_t previousState = motor->speedEstimator.lastHallState;
+    uint8_t hallState;
+    if (sensorless) {
+        hallState = sensorlessHallState(motor);
+        speedEstimatorSample(&motor->speedEstimator, hallState, nowNs);
+    } else {
+        hallState = motorSampleHall(motor, nowNs, 0);
+    }
+    speedEstimatorUpdate(&motor->speedEstimator, nowNs);
+    uint16_t measured = speedEstimatorGetRpm(&motor->speedEstimator);
+    if (motor->brake != BRAKE_COAST) brakeTick(motor, measured);
+
+    // While stopped, track the coasting speed so a restart ramps from there
+    uint16_t setpoint;
+    uint16_t target = atomic_load_explicit(&motor->targetSpeed, memory_order_relaxed);
+    if (autotuneActive(&motor->autotune)) {
+        setpoint = autotuneTick(motor, nowNs, measured);
+    } else if (motor->isRunning) {
+        speedRampSetTarget(&motor->speedRamp, target);
+        setpoint = (uint16_t) speedRampUpdate(&motor->speedRamp, dtNs);
+    } else {
+        speedRampReset(&motor->speedRamp, measured);
+        setpoint = measured;
+    }
+    publishRamping(motor);
+
+    // Sensorless steps carry their own timing; Hall sectors may be driven early
+    motorEventsCheckSpeed(&motor->events, motor->isRunning,
+                          atomic_load_explicit(&motor->ramping, memory_order_relaxed), target, measured);
+
+    motorHot.hallState[slot] = sensorless ? hallState : driveState(motor, hallState, nowNs);
+    // Open-loop sensorless startup sets its own duty; regulate once running
+    int regulated = !sensorless || motor->sensorless.state == SENSORLESS_RUN;
+    motorHot.active[slot] = motor->isRunning && regulated ? -1 : 0;
+    motorHot.setpoint[slot] = setpoint;
+    motorHot.measured[slot] = measured;
+    motorHot.feedforward[slot] = openLoopDuty(motor, setpoint);
+    motorHot.sectorPeriodNs[slot] = speedEstimatorGetSectorPeriodNs(&motor->speedEstimator);
+    return motor->speedEstimator.lastHallState != previousState;
+}
+
+/**
+ * @brief Run one control loop iteration for every motor instance
+ * @details Called by the control loop thread at CONTROL_LOOP_RATE_HZ.
+ * Drains the command queues, then gathers every motor's Hall state, speed
+ * estimate and ramp setpoint into the structure-of-arrays hot state, runs the PI regulator and commutation
+ * as single batched passes over all slots, then writes the phase outputs
+ * and records one telemetry sample per motor.
+ * Running every tick also catches any edge the interrupt path may have
+ * missed.
+ *
+ * The tick never waits for a phase lock. A motor whose lock is held by an
+ * edge handler or service thread is skipped for this tick: its outputs are
+ * left as the holder wrote them, and its commands stay queued (with every
+ * command behind them in the same queue, so each queue keeps its order).
+ */
+void motorControlTick(void) {
+    uint64_t now = motorClockNs();
+    uint64_t dt = lastTickNs ? now - lastTickNs : 0;
+    uint32_t dtNs = dt > MAX_TICK_INTERVAL_NS ? MAX_TICK_INTERVAL_NS : (uint32_t) dt;
+    lastTickNs = now;
+    uint64_t tickStart = timingNow();
+    uint8_t edgeSeen[MOTOR_MAX_INSTANCES];
+    uint8_t locked[MOTOR_MAX_INSTANCES];
+    uint32_t tick = (uint32_t) atomic_fetch_add_explicit(&tickIndex, 1, memory_order_relaxed);
+
+    // Held from here until the motor's outputs are written
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        Motor *motor = &motorPool[i];
+        locked[i] = motor->inUse && motorPhaseTryLock(motor);
+        if (locked[i] && !motor->inUse) {
+            motorPhaseUnlock(motor);
+            locked[i] = 0;
+        }
+    }
+
+    // Apply everything the application queued since the last tick
+    int queueCount = atomic_load_explicit(&commandQueueCount, memory_order_acquire);
+    for (int q = 0; q < queueCount; q++) {
+        MotorCommand command;
+        while (commandQueuePeek(commandQueues[q], &command)) {
+            int slot = command.motor;
+            if (slot < MOTOR_MAX_INSTANCES && motorPool[slot].inUse && !locked[slot]) break;
+            applyCommand(&command);
+            commandQueuePop(commandQueues[q], &command);
+            if (q == 0 && command.type == MOTOR_CMD_SET_SPEED && slot < MOTOR_MAX_INSTANCES) {
+                atomic_fetch_add_explicit(&motorPool[slot].speedRequestsApplied, 1, memory_order_release);
+            }
+        }
+    }
+
+    int quiet = 1;
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        Motor *motor = &motorPool[i];
+        if (!locked[i]) {
+            motorHot.active[i] = 0;
+            quiet &= !motor->inUse;
+            continue;
+        }
+        // Scheduled changes are due once the tick index reaches theirs (modulo 2^32)
+        if (motor->scheduledPending && (int32_t) (tick - motor->scheduledTick) >= 0) {
+            motor->scheduledPending = 0;
+            applySetSpeed(motor, motor->scheduledSpeed);
+        }
+        edgeSeen[i] = (uint8_t) gatherMotor(motor, now, dtNs);
+        quiet &= !motor->isRunning && !motor->brake && !motor->scheduledPending &&
+                 !hallValidatorPending(&motor->hallValidator) &&
+                 !autotuneActive(&motor->autotune) && motorHot.measured[i] == 0 && !edgeSeen[i];
+    }
+    atomic_store_explicit(&tickQuiet, quiet, memory_order_relaxed);
+
+    motorBankRegulate(&motorHot, MOTOR_MAX_INSTANCES);
+    motorBankCommutate(&motorHot, MOTOR_MAX_INSTANCES);
+
+    // Flag samples that follow a tick which missed its deadline
+    uint8_t overrun = 0;
+    if (telemetryIsOpen()) {
+        ControlLoopStats stats;
+        controlLoopGetStats(&stats);
+        overrun = stats.overruns != lastOverruns;
+        lastOverruns = stats.overruns;
+    }
+
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        Motor *motor = &motorPool[i];
+        if (!locked[i]) continue;
+
+        // Re-check: a stop issued during the pass must not be overwritten
+        uint16_t mask = motor->isRunning ? 0xFFFF : 0;
+        int serviced = phasesDrivenByService(motor);
+        if (!serviced && motor->brake == BRAKE_SHORT) {
+            shortBrake(motor);
+        } else if (!serviced) {
+            uint16_t outputs[3] = { motorHot.phaseDuty[0][i] & mask,
+                                    motorHot.phaseDuty[1][i] & mask,
+                                    motorHot.phaseDuty[2][i] & mask };
+            driveBridge(motor, motorHot.hallState[i], mask != 0, outputs);
+        }
+        // Also catches motors stopped by a trip or by a stop that bypassed the queue
+        if (!mask && !motor->brake) suspendOutputs(motor);
+        motorPhaseUnlock(motor);
+
+        // Polled edges are only seen here; measure them up to the write
+        if (edgeSeen[i] && mask && !serviced) {
+            timingRecord(TIMING_EDGE_TO_PWM, timingElapsedNs(tickStart, timingNow()));
+        }
+
+        // FOC outputs come from the current loop rather than the commutation pass
+        int foc = motor->config.commutationMode == COMMUTATION_FOC;
+        uint16_t duty[3];
+        for (int k = 0; k < 3; k++) duty[k] = foc ? motor->foc.duty[k] : motorHot.phaseDuty[k][i];
+        // The sensed state, not the advanced one the phases were driven with
+        uint8_t hallState = motor->speedEstimator.lastHallState;
+        uint16_t faults = 0;
+        if (motor->hallValidator.badRun > 0) faults |= TELEMETRY_FAULT_HALL_INVALID;
+        if (motor->fault == MOTOR_FAULT_OVERCURRENT_PIN || motor->fault == MOTOR_FAULT_OVERCURRENT_ADC) {
+            faults |= TELEMETRY_FAULT_OVERCURRENT;
+        }
+        if (motor->fault == MOTOR_FAULT_HALL) faults |= TELEMETRY_FAULT_HALL_LOST;
+        TelemetrySample sample = {
+            .timestampNs = now,
+            .duty = { duty[0] & mask, duty[1] & mask, duty[2] & mask },
+            .rpm = (uint16_t) motorHot.measured[i],
+            .setpoint = (uint16_t) motorHot.setpoint[i],
+            .faults = faults,
+            .motor = (uint8_t) i,
+            .hallState = hallState,
+            .overrun = overrun,
+        };
+        telemetryPush(&sample);
+    }
+    if (telemetryIsOpen()) motorEventsTelemetryPushed(now);
+}
+
+/**
+ * @brief Set the index of the next control tick
+ * @param index Index motorControlTick() runs as; it counts up by one per tick
+ */
+void motorControlSetTickIndex(uint64_t index) {
+    atomic_store_explicit(&tickIndex, index, memory_order_relaxed);
+}
+
+/**
+ * @brief Get the index of the next control tick
+ * @return Tick index, see motorInstanceSetSpeedAt()
+ */
+uint64_t motorControlGetTickIndex(void) {
+    return atomic_load_explicit(&tickIndex, memory_order_relaxed);
+}
+
+/**
+ * @brief Check whether the control loop has nothing to do
+ * @return 1 if the last tick found every motor stopped, not braking and at standstill,
+ *         with no autotune or scheduled speed change pending, and no command is queued
+ */
+int motorControlIsIdle(void) {
+    if (!atomic_load_explicit(&tickQuiet, memory_order_relaxed)) return 0;
+    int queueCount = atomic_load_explicit(&commandQueueCount, memory_order_acquire);
+    for (int q = 0; q < queueCount; q++) {
+        if (!commandQueueIsEmpty(commandQueues[q])) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file MotorEvents.c
+ * @brief Event file descriptors for event-loop integration
+ *
+ * Each descriptor is an eventfd whose counter only says "look at the
+ * pending bits". Raising an event sets its bit first and writes the
+ * counter only if the bit was clear, so repeated raises cost one atomic
+ * operation. Taking events drains the counter before clearing the bits:
+ * an event raised in between sets its bit again and re-signals, so no
+ * wakeup is lost, at worst one read finds no bits.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "MotorEvents.h"
+#include "MotorInternal.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+
+static atomic_int telemetryFd = -1;           ///< Telemetry-available eventfd, -1 until requested
+static uint64_t lastTelemetrySignalNs = 0;    ///< Control loop only
+
+/** @brief Create a non-blocking eventfd, or return the one already published */
+static int ensureFd(atomic_int *slot) {
+    int fd = atomic_load_explicit(slot, memory_order_acquire);
+    if (fd >= 0) return fd;
+
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        printf("Failed to create event descriptor\n");
+        return -1;
+    }
+    int expected = -1;
+    if (!atomic_compare_exchange_strong(slot, &expected, fd)) {
+        close(fd);
+        return expected;
+    }
+    return fd;
+}
+
+static void signalFd(const atomic_int *slot) {
+    int fd = atomic_load_explicit(slot, memory_order_acquire);
+    if (fd < 0) return;
+    uint64_t one = 1;
+    // Non-blocking; the counter cannot realistically overflow
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void) written;
+}
+
+/** @brief Reset a descriptor to not readable */
+static void drainFd(const atomic_int *slot) {
+    int fd = atomic_load_explicit(slot, memory_order_acquire);
+    if (fd < 0) return;
+    uint64_t count;
+    ssize_t got = read(fd, &count, sizeof(count));  // EAGAIN: nothing pending
+    (void) got;
+}
+
+/**
+ * @brief Initialize the event state of a new motor
+ * @param events Event state
+ */
+void motorEventsInit(MotorEventState *events) {
+    atomic_init(&events->fd, -1);
+    atomic_init(&events->pending, 0);
+    events->armedTarget = 0;
+    events->armed = 1;
+}
+
+/**
+ * @brief Close the descriptor of a destroyed motor
+ * @param events Event state
+ */
+void motorEventsClose(MotorEventState *events) {
+    int fd = atomic_exchange(&events->fd, -1);
+    if (fd >= 0) close(fd);
+}
+
+/**
+ * @brief Raise events on a motor
+ * @param events Event state
+ * @param bits MOTOR_EVENT_* bits
+ */
+void motorEventsRaise(MotorEventState *events, uint32_t bits) {
+    uint32_t previous = atomic_fetch_or_explicit(&events->pending, bits, memory_order_release);
+    if ((previous & bits) != bits) signalFd(&events->fd);
+}
+
+/**
+ * @brief Raise MOTOR_EVENT_SPEED_REACHED once per target
+ * @param events Event state
+ * @param running Motor is energized
+ * @param ramping Setpoint still moving towards the target
+ * @param target Requested speed
+ * @param measured Measured speed
+ * @details A new target, or stopping, rearms the event.
+ */
+void motorEventsCheckSpeed(MotorEventState *events, int running, int ramping,
+                           uint16_t target, uint16_t measured) {
+    if (!running || target != events->armedTarget) {
+        events->armedTarget = target;
+        events->armed = 1;
+    }
+    if (!running || !events->armed || ramping) return;
+    if (abs((int) measured - (int) target) > MOTOR_EVENT_SPEED_TOLERANCE_RPM) return;
+
+    events->armed = 0;
+    motorEventsRaise(events, MOTOR_EVENT_SPEED_REACHED);
+}
+
+/**
+ * @brief Note telemetry samples pushed this tick
+ * @param nowNs Tick timestamp
+ */
+void motorEventsTelemetryPushed(uint64_t nowNs) {
+    if (atomic_load_explicit(&telemetryFd, memory_order_relaxed) < 0) return;
+    if (nowNs - lastTelemetrySignalNs < MOTOR_EVENT_TELEMETRY_MS * NSEC_PER_MSEC) return;
+    lastTelemetrySignalNs = nowNs;
+    signalFd(&telemetryFd);
+}
+
+/**
+ * @brief Get the event descriptor of a motor instance
+ * @param motor Motor handle
+ * @return Readable-when-pending eventfd, or -1 on failure
+ */
+int motorInstanceEventFd(Motor *motor) {
+    int fd = ensureFd(&motor->events.fd);
+    // Events raised before the descriptor existed must still wake the caller
+    if (fd >= 0 && atomic_load(&motor->events.pending) != 0) signalFd(&motor->events.fd);
+    return fd;
+}
+
+/**
+ * @brief Take the pending events of a motor instance
+ * @param motor Motor handle
+ * @return MOTOR_EVENT_* bits raised since the last call, 0 if none
+ */
+uint32_t motorInstanceTakeEvents(Motor *motor) {
+    drainFd(&motor->events.fd);
+    return atomic_exchange_explicit(&motor->events.pending, 0, memory_order_acquire);
+}
+
+/**
+ * @brief Get a status snapshot of a motor instance
+ * @param motor Motor handle
+ * @param status Receives the snapshot
+ */
+void motorInstanceGetStatus(const Motor *motor, MotorStatus *status) {
+    status->running = motor->isRunning;
+    status->ramping = (uint8_t) motorInstanceIsRamping(motor);
+    status->fault = (MotorFault) motor->fault;
+    status->targetRpm = motorInstanceGetTargetSpeed(motor);
+    status->setpointRpm = (uint16_t) speedRampGetSpeed(&motor->speedRamp);
+    status->measuredRpm = speedEstimatorGetRpm(&motor->speedEstimator);
+    status->events = atomic_load_explicit(&motor->events.pending, memory_order_relaxed);
+}
+
+/**
+ * @brief Get the telemetry-available descriptor
+ * @return eventfd readable once samples were pushed, or -1 on failure
+ */
+int motorTelemetryEventFd(void) {
+    return ensureFd(&telemetryFd);
+}
+
+/**
+ * @brief Drain the telemetry-available descriptor
+ * @return 1 if samples were signalled since the last call, 0 otherwise
+ */
+int motorTakeTelemetryEvent(void) {
+    int fd = atomic_load_explicit(&telemetryFd, memory_order_acquire);
+    uint64_t count;
+    return fd >= 0 && read(fd, &count, sizeof(count)) == sizeof(count);
+}
+
+/**
+ * @brief Get the event descriptor of the default motor
+ * @return eventfd, or -1 before motorInit()
+ */
+int motorEventFd(void) {
+    Motor *motor = motorGetDefault();
+    return motor != NULL ? motorInstanceEventFd(motor) : -1;
+}
+
+/**
+ * @brief Take the pending events of the default motor
+ * @return MOTOR_EVENT_* bits, 0 before motorInit()
+ */
+uint32_t motorTakeEvents(void) {
+    Motor *motor = motorGetDefault();
+    return motor != NULL ? motorInstanceTakeEvents(motor) : 0;
+}
+
+/**
+ * @brief Get a status snapshot of the default motor
+ * @param status Receives the snapshot
+ * @return 0 on success, -1 before motorInit()
+ */
+int motorGetStatus(MotorStatus *status) {
+    Motor *motor = motorGetDefault();
+    if (motor == NULL) return -1;
+    motorInstanceGetStatus(motor, status);
+    return 0;
+}
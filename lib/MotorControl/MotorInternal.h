@@ -0,0 +1,223 @@
+/**
+ * @file MotorInternal.h
+ * @brief Motor instance layout shared by the library sources
+ *
+ * Not part of the public interface; applications use the opaque Motor
+ * handle declared in MotorControl.h.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOTOR_INTERNAL_H
+#define MOTOR_INTERNAL_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "MotorControl.h"
+#include "SpeedEstimator.h"
+#include "SpeedRamp.h"
+#include "Sensorless.h"
+#include "Foc.h"
+#include "Protection.h"
+#include "HallValidator.h"
+#include "Autotune.h"
+#include "Brake.h"
+#include "RotorAngle.h"
+#include "MotorEvents.h"
+
+/**
+ * @brief Per-phase bridge state in a commutation table entry
+ * @details commutationTable only uses PHASE_OFF/PHASE_PWM, bridgeTable all three
+ */
+typedef enum {
+    PHASE_OFF = 0,   ///< Leg floating (both switches off)
+    PHASE_PWM = 1,   ///< High side switched with the duty cycle
+    PHASE_LOW = 2    ///< Low side on
+} PhaseDrive;
+
+/**
+ * @brief PWM phases of every commutationTable state, packed
+ * @details Bit 3 * hallState + phase is set when the phase switches PWM, so
+ * the pattern of a state is (bits >> 3 * hallState) & 7
+ */
+#define COMMUTATION_PWM_BITS 006543210U
+
+/** @brief PWM phases of every bridgeTable state, packed like COMMUTATION_PWM_BITS */
+#define BRIDGE_PWM_BITS 004142210U
+
+/*
+ * Duty full scale and speed limit of a motor. MOTOR_FIXED_CONFIG builds
+ * substitute the compile-time values, so divisions by them become constant
+ * multiplies.
+ */
+#if MOTOR_FIXED_CONFIG
+#define MOTOR_PWM_RANGE(motor) ((void) (motor), PWM_RANGE)
+#define MOTOR_SPEED_LIMIT(motor) ((void) (motor), MOTOR_MAX_RPM)
+#else
+#define MOTOR_PWM_RANGE(motor) ((motor)->config.pwmRange)
+#define MOTOR_SPEED_LIMIT(motor) ((motor)->config.maxRpm)
+#endif
+
+/**
+ * @brief Final phase outputs of the 6-step path and what was last written
+ * @details The table holds commutationTable applied to one duty cycle and is
+ * rebuilt only when the duty changes, so commutation is a single indexed
+ * load. Phase writes are skipped when the pin already carries the value.
+ */
+typedef struct {
+    uint16_t outputs[8][3];           ///< Per-phase output for each Hall state at tableDuty
+    uint16_t tableDuty;               ///< Duty the table was built for
+    uint8_t tableValid;               ///< Table has been built
+    int32_t applied[3];               ///< Last value written per phase, -1 if unknown
+    int8_t appliedGate[3];            ///< Last enable/low-side level per phase, -1 if unknown
+} CommutationCache;
+
+/**
+ * @brief Motor instance state
+ * @note Fields shared with the edge handlers are volatile for ISR safety.
+ * Control state (target, ramp, brake, hot state) is written only under the
+ * phase lock; the API caller's thread reads it through the atomic fields.
+ */
+struct Motor {
+    MotorConfig config;               ///< Hardware and tuning configuration
+    uint8_t index;                    ///< Slot in motorPool
+    volatile uint8_t inUse;           ///< Slot is allocated (cleared under the phase lock)
+    atomic_flag phaseLock;            ///< Held while the outputs or control state change (motorPhaseTryLock())
+    atomic_uchar offPending;          ///< A trip found the phase lock taken; its holder stops the motor
+    uint8_t hallIsrRegistered;        ///< Edge handlers installed (cannot be removed)
+    uint8_t faultIsrRegistered;       ///< Fault input handler installed (cannot be removed)
+    volatile uint8_t fault;           ///< Latched MotorFault
+    uint32_t tripMask;                ///< Bank 0 outputs cleared by an overcurrent trip
+    volatile uint32_t *tripRegs;      ///< GPIO registers for the trip, NULL if unmapped
+    _Atomic uint16_t targetSpeed;     ///< Speed the ramp heads for (RPM), written under the phase lock
+    _Atomic uint16_t requestedSpeed;  ///< Last speed passed to motorInstanceSetSpeed()
+    atomic_uint speedRequests;        ///< Speed changes queued by the API caller (written by it only)
+    atomic_uint speedRequestsApplied; ///< Speed changes from the API queue applied (written by the tick only)
+    _Atomic uint8_t ramping;          ///< The profile has not reached targetSpeed
+    uint32_t scheduledTick;           ///< Tick index (low 32 bits) of the pending speed change
+    uint16_t scheduledSpeed;          ///< Pending speed change (RPM)
+    uint8_t scheduledPending;         ///< A MOTOR_CMD_SET_SPEED_AT awaits its tick
+    volatile uint8_t isRunning;       ///< Motor operational state
+    uint8_t pwmSuspended;             ///< Phase PWM suspended while stopped (PwmBackend::suspend)
+    uint8_t brake;                    ///< Active BrakeMode
+    int64_t savedRampAccel;           ///< SpeedRamp::maxAccel to restore after regenerative braking
+    int64_t savedRampJerk;            ///< SpeedRamp::jerk to restore after regenerative braking
+    HallValidator hallValidator;      ///< Hall sequence check ahead of the estimator
+    SpeedEstimator speedEstimator;    ///< Measured rotor speed from Hall edges
+    SpeedRamp speedRamp;              ///< Setpoint profile followed by the regulator
+    Autotuner autotune;               ///< Gain identification experiment
+    MotorEventState events;           ///< Event descriptor and pending bits
+    CommutationCache commutation;     ///< Duty table and applied outputs (6-step path)
+    SensorlessEngine sensorless;      ///< Back-EMF commutation state (COMMUTATION_SENSORLESS)
+    FocController foc;                ///< Current loop state (COMMUTATION_FOC)
+};
+
+/**
+ * @brief Per-tick hot state of all motors, stored as structure-of-arrays
+ * @details Indexed by Motor::index. The control tick gathers each motor's
+ * inputs into these arrays, then runs regulation and commutation as single
+ * branch-free passes over every slot (see MotorBank.c). Masks are 0 or -1
+ * so selects reduce to AND operations.
+ */
+typedef struct {
+    /* Inputs gathered each tick */
+    uint8_t hallState[MOTOR_MAX_INSTANCES];     ///< Hall state to commutate, phase advance applied
+    int32_t active[MOTOR_MAX_INSTANCES];        ///< -1 if allocated and running, else 0
+    int32_t setpoint[MOTOR_MAX_INSTANCES];      ///< Ramp profile speed (RPM)
+    int32_t measured[MOTOR_MAX_INSTANCES];      ///< Estimated speed (RPM)
+    int32_t feedforward[MOTOR_MAX_INSTANCES];   ///< Open-loop duty for the setpoint
+    uint32_t sectorPeriodNs[MOTOR_MAX_INSTANCES]; ///< Averaged Hall sector period
+    uint8_t driveTable[MOTOR_MAX_INSTANCES];    ///< Index into motorDriveTables
+
+    /* Speed regulator */
+    int32_t kp[MOTOR_MAX_INSTANCES];            ///< Proportional gain, Q16.16
+    int32_t ki[MOTOR_MAX_INSTANCES];            ///< Integral gain per tick, Q16.16
+    int64_t integrator[MOTOR_MAX_INSTANCES];    ///< Integral term, Q16.16 duty counts (±outMax << 16)
+    int32_t outMax[MOTOR_MAX_INSTANCES];        ///< Duty clamp (pwmRange)
+
+    /* Outputs */
+    uint16_t duty[MOTOR_MAX_INSTANCES];         ///< Active PWM duty cycle
+    uint16_t phaseDuty[3][MOTOR_MAX_INSTANCES]; ///< Per-phase output after commutation
+} MotorHotState;
+
+/** @brief Contiguous pool of motor instances serviced by the control loop */
+extern Motor motorPool[MOTOR_MAX_INSTANCES];
+
+/** @brief Hot state of every pool slot */
+extern MotorHotState motorHot;
+
+/** @brief 6-step commutation table, indexed by Hall state ({A, B, C}, 1 = PWM) */
+extern const uint8_t commutationTable[8][3];
+
+/** @brief Two-phase 6-step table with low-side states, indexed by Hall state (PhaseDrive) */
+extern const uint8_t bridgeTable[8][3];
+
+/** @brief Tables selected by MotorHotState::driveTable: commutationTable, bridgeTable */
+extern const uint8_t (*const motorDriveTables[2])[3];
+
+/**
+ * @brief Map the GPIO register block
+ * @return Register block, or NULL if GPIOMEM_DEVICE is unavailable or the
+ *         SoC does not have the BCM2835 register layout (see MotorSoc.h)
+ * @note Mapped once and shared with the overcurrent trip path
+ */
+volatile uint32_t *gpiomemRegisters(void);
+
+/**
+ * @brief Take the phase lock of a motor if it is free
+ * @param motor Motor instance
+ * @return 1 if taken, 0 if another context holds it
+ * @details Never waits: the control tick, the edge handlers and the service
+ * threads skip the motor for one pass instead of blocking on each other.
+ */
+int motorPhaseTryLock(Motor *motor);
+
+/**
+ * @brief Release the phase lock
+ * @param motor Motor instance
+ * @details Completes a stop that a trip left pending while the lock was held.
+ */
+void motorPhaseUnlock(Motor *motor);
+
+/**
+ * @brief Sample the Hall sensors of a motor through its validator
+ * @param motor Motor instance (phase lock held)
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @param edge 1 for a read from the Hall edge handler, 0 for periodic samples
+ * @return Validated Hall code, also fed to the speed estimator
+ * @note Latches MOTOR_FAULT_HALL on a running motor once the sensors are lost
+ */
+uint8_t motorSampleHall(Motor *motor, uint64_t nowNs, int edge);
+
+/**
+ * @brief Advanced rotor angle of a motor
+ * @param motor Motor instance
+ * @param nowNs Current time from motorClockNs()
+ * @return 16-bit electrical angle including phase advance
+ */
+uint16_t motorRotorAngle(const Motor *motor, uint64_t nowNs);
+
+/**
+ * @brief Stop a motor and de-energize its outputs immediately
+ * @param motor Motor instance (phase lock held)
+ * @note Used by the protection trip path
+ */
+void motorEmergencyOff(Motor *motor);
+
+/**
+ * @brief Run the PI speed regulator for every slot
+ * @param hot Hot state; reads setpoint/measured/feedforward/active, writes duty
+ * @param count Number of slots to process
+ */
+void motorBankRegulate(MotorHotState *hot, int count);
+
+/**
+ * @brief Compute per-phase outputs for every slot from Hall state and duty
+ * @param hot Hot state; reads hallState/duty/active, writes phaseDuty
+ * @param count Number of slots to process
+ */
+void motorBankCommutate(MotorHotState *hot, int count);
+
+#endif // MOTOR_INTERNAL_H
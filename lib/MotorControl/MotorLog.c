@@ -0,0 +1,488 @@
+/**
+ * @file MotorLog.c
+ * @brief Compressed, seekable on-disk format for telemetry samples
+ *
+ * Column order in a data block: motor, timestamp, rpm, setpoint, duty A/B/C,
+ * faults, Hall state, overrun. The payload starts with the byte size of
+ * each column, followed by the columns back to back. Motor, Hall state and
+ * overrun are plain varints; the others are zigzag varints of the change
+ * since the same motor's previous sample in the block, starting from zero
+ * (timestamps: the change of the interval, starting from the block's first
+ * timestamp). Blocks decode independently, so a corrupt block loses only
+ * its own samples.
+ *
+ * Has no WiringPi dependency; the host decoder links it directly.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "MotorLog.h"
+#include "MotorCrc.h"
+
+/** @brief Column numbers */
+enum {
+    COLUMN_MOTOR = 0,
+    COLUMN_TIME,
+    COLUMN_RPM,
+    COLUMN_SETPOINT,
+    COLUMN_DUTY,          // three columns, one per phase
+    COLUMN_FAULTS = COLUMN_DUTY + 3,
+    COLUMN_HALL,
+    COLUMN_OVERRUN
+};
+
+_Static_assert(COLUMN_OVERRUN + 1 == MOTOR_LOG_COLUMN_COUNT, "column table out of sync");
+
+/** @brief Column size table at the start of a data payload */
+#define COLUMN_TABLE_SIZE (MOTOR_LOG_COLUMN_COUNT * (int) sizeof(uint32_t))
+
+/** @brief Blocks per index group: the data blocks and their index block */
+#define GROUP_SPAN (MOTOR_LOG_INDEX_INTERVAL + 1)
+
+static uint32_t putVarint(uint8_t *p, uint64_t value) {
+    uint32_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t) value;
+    return n;
+}
+
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+/**
+ * @brief Column being decoded
+ */
+typedef struct {
+    const uint8_t *p;        ///< Next byte
+    const uint8_t *end;      ///< End of the column
+} ColumnCursor;
+
+/** @return 0 on success, -1 if the column ends inside the varint */
+static int getVarint(ColumnCursor *column, uint64_t *value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && column->p < column->end; shift += 7) {
+        uint8_t byte = *column->p++;
+        result |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void putColumn(MotorLogEncoder *encoder, int column, uint64_t value) {
+    uint32_t n = putVarint(encoder->columns[column] + encoder->columnSize[column], value);
+    encoder->columnSize[column] += n;
+    encoder->payloadSize += n;
+}
+
+static void putDelta(MotorLogEncoder *encoder, int column, uint16_t value, uint16_t previous) {
+    putColumn(encoder, column, zigzag((int64_t) value - previous));
+}
+
+static void sealBlock(uint8_t *block, MotorLogBlockKind kind, uint32_t sequence, uint32_t count,
+                      uint64_t firstNs, uint64_t lastNs, uint32_t payloadSize, uint32_t lost) {
+    MotorLogBlockHeader header = {
+        .magic = MOTOR_LOG_MAGIC,
+        .version = MOTOR_LOG_VERSION,
+        .kind = (uint16_t) kind,
+        .sequence = sequence,
+        .count = count,
+        .firstNs = firstNs,
+        .lastNs = lastNs,
+        .payloadSize = payloadSize,
+        .lost = lost,
+        .crc = motorCrc32(block + sizeof(MotorLogBlockHeader), payloadSize),
+        .reserved = 0,
+    };
+    memcpy(block, &header, sizeof(header));
+    // Zero the tail so stale buffer contents never reach the disk
+    memset(block + sizeof(header) + payloadSize, 0,
+           MOTOR_LOG_BLOCK_SIZE - sizeof(header) - payloadSize);
+}
+
+static void resetBlock(MotorLogEncoder *encoder) {
+    memset(encoder->columnSize, 0, sizeof(encoder->columnSize));
+    memset(encoder->motors, 0, sizeof(encoder->motors));
+    encoder->payloadSize = COLUMN_TABLE_SIZE;
+    encoder->count = 0;
+}
+
+/** @brief Submit the index block once a group of data blocks is complete */
+static void submitIndex(MotorLogEncoder *encoder) {
+    uint8_t *block = encoder->sink.acquire(encoder->sink.context);
+    if (block == NULL) return;  // seek falls back to the data block headers of this group
+
+    uint32_t payloadSize = encoder->indexCount * (uint32_t) sizeof(MotorLogIndexEntry);
+    memcpy(block + sizeof(MotorLogBlockHeader), encoder->index, payloadSize);
+    sealBlock(block, MOTOR_LOG_BLOCK_INDEX, encoder->sequence, encoder->indexCount,
+              encoder->index[0].firstNs, encoder->index[encoder->indexCount - 1].lastNs,
+              payloadSize, 0);
+    encoder->sink.submit(encoder->sink.context, block, encoder->sequence);
+    encoder->blocks++;
+}
+
+/**
+ * @brief Initialize an encoder and submit the file block
+ * @param encoder Encoder to initialize
+ * @param sink Block destination
+ * @param startMonotonicNs motorClockNs() at the start of logging
+ * @param startRealtimeNs CLOCK_REALTIME at the same instant
+ * @return 0 on success, -1 on allocation failure or if the sink has no buffer
+ */
+int motorLogEncoderInit(MotorLogEncoder *encoder, const MotorLogSink *sink,
+                        uint64_t startMonotonicNs, uint64_t startRealtimeNs) {
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->sink = *sink;
+    for (int c = 0; c < MOTOR_LOG_COLUMN_COUNT; c++) {
+        encoder->columns[c] = malloc(MOTOR_LOG_PAYLOAD_SIZE);
+        if (encoder->columns[c] == NULL) {
+            printf("Failed to allocate log encoder\n");
+            motorLogEncoderFree(encoder);
+            return -1;
+        }
+    }
+    resetBlock(encoder);
+
+    uint8_t *block = sink->acquire(sink->context);
+    if (block == NULL) {
+        motorLogEncoderFree(encoder);
+        return -1;
+    }
+    MotorLogFileInfo info = {
+        .startMonotonicNs = startMonotonicNs,
+        .startRealtimeNs = startRealtimeNs,
+        .blockSize = MOTOR_LOG_BLOCK_SIZE,
+        .indexInterval = MOTOR_LOG_INDEX_INTERVAL,
+        .columns = MOTOR_LOG_COLUMN_COUNT,
+        .reserved = 0,
+    };
+    memcpy(block + sizeof(MotorLogBlockHeader), &info, sizeof(info));
+    sealBlock(block, MOTOR_LOG_BLOCK_FILE, 0, 0, startMonotonicNs, startMonotonicNs, sizeof(info), 0);
+    sink->submit(sink->context, block, 0);
+    encoder->sequence = 1;
+    encoder->blocks = 1;
+    return 0;
+}
+
+/**
+ * @brief Release the scratch buffers of an encoder
+ * @param encoder Encoder
+ */
+void motorLogEncoderFree(MotorLogEncoder *encoder) {
+    for (int c = 0; c < MOTOR_LOG_COLUMN_COUNT; c++) {
+        free(encoder->columns[c]);
+        encoder->columns[c] = NULL;
+    }
+}
+
+/**
+ * @brief Submit the open block, even if it is not full
+ * @param encoder Encoder
+ */
+void motorLogEncoderFlush(MotorLogEncoder *encoder) {
+    if (encoder->count == 0) return;
+
+    uint8_t *block = encoder->sink.acquire(encoder->sink.context);
+    if (block == NULL) {
+        // No buffer: the samples are gone, but the block number stays free
+        encoder->lost += encoder->count;
+        encoder->samples -= encoder->count;
+        encoder->droppedBlocks++;
+        resetBlock(encoder);
+        return;
+    }
+
+    uint8_t *p = block + sizeof(MotorLogBlockHeader);
+    memcpy(p, encoder->columnSize, COLUMN_TABLE_SIZE);
+    p += COLUMN_TABLE_SIZE;
+    for (int c = 0; c < MOTOR_LOG_COLUMN_COUNT; c++) {
+        memcpy(p, encoder->columns[c], encoder->columnSize[c]);
+        p += encoder->columnSize[c];
+    }
+    sealBlock(block, MOTOR_LOG_BLOCK_DATA, encoder->sequence, encoder->count,
+              encoder->firstNs, encoder->lastNs, encoder->payloadSize, encoder->lost);
+    encoder->sink.submit(encoder->sink.context, block, encoder->sequence);
+    encoder->blocks++;
+
+    MotorLogIndexEntry *entry = &encoder->index[encoder->indexCount++];
+    entry->firstNs = encoder->firstNs;
+    entry->lastNs = encoder->lastNs;
+    entry->block = encoder->sequence;
+    entry->count = encoder->count;
+    encoder->sequence++;
+    encoder->lost = 0;
+    resetBlock(encoder);
+
+    // Index blocks keep their fixed positions even if their buffer is dropped
+    if (encoder->indexCount == MOTOR_LOG_INDEX_INTERVAL) {
+        submitIndex(encoder);
+        encoder->sequence++;
+        encoder->indexCount = 0;
+    }
+}
+
+/**
+ * @brief Append a sample
+ * @param encoder Encoder
+ * @param sample Sample to store; submits the block first if it is full
+ */
+void motorLogEncoderAdd(MotorLogEncoder *encoder, const TelemetrySample *sample) {
+    if (encoder->payloadSize + MOTOR_LOG_MAX_SAMPLE_SIZE > MOTOR_LOG_PAYLOAD_SIZE) {
+        motorLogEncoderFlush(encoder);
+    }
+    if (encoder->count == 0) encoder->firstNs = sample->timestampNs;
+
+    MotorLogDeltaState *state = &encoder->motors[sample->motor];
+    const TelemetrySample *previous = &state->previous;
+    uint64_t previousNs = previous->timestampNs != 0 ? previous->timestampNs : encoder->firstNs;
+    int64_t deltaNs = (int64_t) (sample->timestampNs - previousNs);
+
+    putColumn(encoder, COLUMN_MOTOR, sample->motor);
+    putColumn(encoder, COLUMN_TIME, zigzag(deltaNs - state->previousDeltaNs));
+    putDelta(encoder, COLUMN_RPM, sample->rpm, previous->rpm);
+    putDelta(encoder, COLUMN_SETPOINT, sample->setpoint, previous->setpoint);
+    for (int c = 0; c < 3; c++) {
+        putDelta(encoder, COLUMN_DUTY + c, sample->duty[c], previous->duty[c]);
+    }
+    putDelta(encoder, COLUMN_FAULTS, sample->faults, previous->faults);
+    putColumn(encoder, COLUMN_HALL, sample->hallState);
+    putColumn(encoder, COLUMN_OVERRUN, sample->overrun);
+
+    state->previous = *sample;
+    state->previousDeltaNs = deltaNs;
+    if (encoder->count == 0 || sample->timestampNs > encoder->lastNs) {
+        encoder->lastNs = sample->timestampNs;
+    }
+    encoder->count++;
+    encoder->samples++;
+}
+
+/**
+ * @brief Record samples that never reached the encoder
+ * @param encoder Encoder
+ * @param samples Number of samples lost (reported in the next data block)
+ */
+void motorLogEncoderLost(MotorLogEncoder *encoder, uint32_t samples) {
+    encoder->lost += samples;
+}
+
+/**
+ * @brief Check a block header and payload CRC
+ * @param block Block of MOTOR_LOG_BLOCK_SIZE bytes
+ * @param header Receives the header
+ * @return 0 if valid, -1 otherwise
+ */
+int motorLogCheckBlock(const uint8_t *block, MotorLogBlockHeader *header) {
+    memcpy(header, block, sizeof(*header));
+    if (header->magic != MOTOR_LOG_MAGIC || header->version != MOTOR_LOG_VERSION ||
+        header->payloadSize > MOTOR_LOG_PAYLOAD_SIZE) {
+        return -1;
+    }
+    return motorCrc32(block + sizeof(*header), header->payloadSize) == header->crc ? 0 : -1;
+}
+
+/** @return 0 on success, -1 on a truncated column */
+static int getDelta(ColumnCursor *column, uint16_t *value) {
+    uint64_t raw;
+    if (getVarint(column, &raw) != 0) return -1;
+    *value = (uint16_t) (*value + unzigzag(raw));
+    return 0;
+}
+
+/**
+ * @brief Decode a data block
+ * @param block Block of MOTOR_LOG_BLOCK_SIZE bytes
+ * @param samples Receives the samples
+ * @param max Capacity of samples
+ * @return Number of samples, or -1 if the block is not a valid data block
+ *         or holds more than max samples
+ */
+int motorLogDecodeBlock(const uint8_t *block, TelemetrySample *samples, uint32_t max) {
+    MotorLogBlockHeader header;
+    if (motorLogCheckBlock(block, &header) != 0 || header.kind != MOTOR_LOG_BLOCK_DATA ||
+        header.count > max || header.payloadSize < COLUMN_TABLE_SIZE) {
+        return -1;
+    }
+
+    const uint8_t *payload = block + sizeof(header);
+    uint32_t sizes[MOTOR_LOG_COLUMN_COUNT];
+    memcpy(sizes, payload, sizeof(sizes));
+    ColumnCursor columns[MOTOR_LOG_COLUMN_COUNT];
+    const uint8_t *p = payload + COLUMN_TABLE_SIZE;
+    const uint8_t *end = payload + header.payloadSize;
+    for (int c = 0; c < MOTOR_LOG_COLUMN_COUNT; c++) {
+        if (sizes[c] > (size_t) (end - p)) return -1;
+        columns[c].p = p;
+        columns[c].end = p + sizes[c];
+        p += sizes[c];
+    }
+
+    MotorLogDeltaState motors[256];
+    memset(motors, 0, sizeof(motors));
+    for (uint32_t i = 0; i < header.count; i++) {
+        uint64_t motor, deltaOfDelta, hall, overrun;
+        if (getVarint(&columns[COLUMN_MOTOR], &motor) != 0 || motor > UINT8_MAX ||
+            getVarint(&columns[COLUMN_TIME], &deltaOfDelta) != 0) {
+            return -1;
+        }
+        MotorLogDeltaState *state = &motors[motor];
+        TelemetrySample *sample = &state->previous;
+        uint64_t previousNs = sample->timestampNs != 0 ? sample->timestampNs : header.firstNs;
+        state->previousDeltaNs += unzigzag(deltaOfDelta);
+        sample->timestampNs = previousNs + (uint64_t) state->previousDeltaNs;
+        sample->motor = (uint8_t) motor;
+
+        int bad = getDelta(&columns[COLUMN_RPM], &sample->rpm) |
+                  getDelta(&columns[COLUMN_SETPOINT], &sample->setpoint) |
+                  getDelta(&columns[COLUMN_DUTY], &sample->duty[0]) |
+                  getDelta(&columns[COLUMN_DUTY + 1], &sample->duty[1]) |
+                  getDelta(&columns[COLUMN_DUTY + 2], &sample->duty[2]) |
+                  getDelta(&columns[COLUMN_FAULTS], &sample->faults) |
+                  getVarint(&columns[COLUMN_HALL], &hall) |
+                  getVarint(&columns[COLUMN_OVERRUN], &overrun);
+        if (bad) return -1;
+        sample->hallState = (uint8_t) hall;
+        sample->overrun = (uint8_t) overrun;
+        samples[i] = *sample;
+    }
+    return (int) header.count;
+}
+
+/**
+ * @brief Open a log file and read its file block
+ * @param reader Reader to initialize
+ * @param path Log file
+ * @return 0 on success, -1 on failure
+ */
+int motorLogReaderOpen(MotorLogReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (reader->fd < 0) {
+        printf("Failed to open log %s\n", path);
+        return -1;
+    }
+    struct stat st;
+    reader->block = malloc(MOTOR_LOG_BLOCK_SIZE);
+    if (reader->block == NULL || fstat(reader->fd, &st) != 0) {
+        motorLogReaderClose(reader);
+        return -1;
+    }
+    reader->blocks = (uint32_t) (st.st_size / MOTOR_LOG_BLOCK_SIZE);
+
+    MotorLogBlockHeader header;
+    if (motorLogReaderRead(reader, 0, &header) != 0 || header.kind != MOTOR_LOG_BLOCK_FILE ||
+        header.payloadSize != sizeof(MotorLogFileInfo)) {
+        printf("%s is not a motor log\n", path);
+        motorLogReaderClose(reader);
+        return -1;
+    }
+    memcpy(&reader->info, reader->block + sizeof(header), sizeof(reader->info));
+    if (reader->info.blockSize != MOTOR_LOG_BLOCK_SIZE ||
+        reader->info.indexInterval != MOTOR_LOG_INDEX_INTERVAL ||
+        reader->info.columns != MOTOR_LOG_COLUMN_COUNT) {
+        printf("%s uses an unsupported layout\n", path);
+        motorLogReaderClose(reader);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read and check one block
+ * @param reader Reader
+ * @param block Block number
+ * @param header Receives the header
+ * @return 0 if the block is valid, -1 if it is missing or corrupt
+ */
+int motorLogReaderRead(MotorLogReader *reader, uint32_t block, MotorLogBlockHeader *header) {
+    if (block >= reader->blocks) return -1;
+    ssize_t got = pread(reader->fd, reader->block, MOTOR_LOG_BLOCK_SIZE,
+                        (off_t) block * MOTOR_LOG_BLOCK_SIZE);
+    if (got != MOTOR_LOG_BLOCK_SIZE) return -1;
+    if (motorLogCheckBlock(reader->block, header) != 0 || header->sequence != block) return -1;
+    return 0;
+}
+
+/** @brief First valid data block in [first, last) whose samples reach timeNs, or last */
+static uint32_t scanBlocks(MotorLogReader *reader, uint32_t first, uint32_t last, uint64_t timeNs) {
+    for (uint32_t b = first; b < last; b++) {
+        MotorLogBlockHeader header;
+        if (motorLogReaderRead(reader, b, &header) == 0 && header.kind == MOTOR_LOG_BLOCK_DATA &&
+            header.lastNs >= timeNs) {
+            return b;
+        }
+    }
+    return last;
+}
+
+/** @brief Block number of the index block of a group */
+static uint32_t indexBlock(uint32_t group) {
+    return 1 + group * GROUP_SPAN + MOTOR_LOG_INDEX_INTERVAL;
+}
+
+/**
+ * @brief Find the first data block extending to or past a time
+ * @param reader Reader
+ * @param timeNs Sample timestamp (motorClockNs() timebase)
+ * @return Block number, or reader->blocks if no sample is that late
+ */
+uint32_t motorLogReaderSeek(MotorLogReader *reader, uint64_t timeNs) {
+    uint32_t groups = reader->blocks > 0 ? (reader->blocks - 1) / GROUP_SPAN : 0;
+
+    // First complete group whose index reaches timeNs; a missing index counts as earlier
+    uint32_t lo = 0, hi = groups;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        MotorLogBlockHeader header;
+        if (motorLogReaderRead(reader, indexBlock(mid), &header) == 0 &&
+            header.kind == MOTOR_LOG_BLOCK_INDEX && header.lastNs >= timeNs) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    uint32_t first = 1 + lo * GROUP_SPAN;
+    if (lo == groups) return scanBlocks(reader, first, reader->blocks, timeNs);
+
+    MotorLogBlockHeader header;
+    if (motorLogReaderRead(reader, indexBlock(lo), &header) == 0 &&
+        header.kind == MOTOR_LOG_BLOCK_INDEX) {
+        const uint8_t *entries = reader->block + sizeof(header);
+        for (uint32_t i = 0; i < header.count && i < MOTOR_LOG_INDEX_INTERVAL; i++) {
+            MotorLogIndexEntry entry;
+            memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+            if (entry.lastNs >= timeNs) return entry.block;
+        }
+    }
+    return scanBlocks(reader, first, reader->blocks, timeNs);
+}
+
+/**
+ * @brief Close a reader
+ * @param reader Reader
+ */
+void motorLogReaderClose(MotorLogReader *reader) {
+    if (reader->fd >= 0) close(reader->fd);
+    free(reader->block);
+    reader->fd = -1;
+    reader->block = NULL;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file MotorLogger.c
+ * @brief Background recorder of every telemetry sample to a MotorLog file
+ *
+ * Buffers move between a free stack and a FIFO of filled blocks under one
+ * mutex; neither thread holds it during encoding or I/O. The writer uses
+ * pwrite() at the block's own offset, so blocks may reach the disk in any
+ * order and a dropped buffer leaves no gap to patch up.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include "MotorLogger.h"
+#include "MotorClock.h"
+#include "MotorEvents.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+
+/**
+ * @brief Filled block waiting for the writer
+ */
+typedef struct {
+    uint8_t *block;            ///< Buffer from the pool
+    uint32_t sequence;         ///< Block number
+} PendingBlock;
+
+static pthread_t encoderThread;              ///< Follows the ring
+static pthread_t writerThread;               ///< Writes blocks
+static atomic_int loggerRunning = 0;         ///< Threads are alive
+static atomic_int encoderStopRequested = 0;  ///< Ask the encoder to finish
+static MotorLoggerConfig loggerConfig;       ///< Active configuration
+static int logFd = -1;                       ///< Log file
+static uint8_t direct = 0;                   ///< logFd was opened with O_DIRECT
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t poolSignal = PTHREAD_COND_INITIALIZER;
+static uint8_t *pool = NULL;                          ///< MOTOR_LOGGER_BUFFERS aligned blocks
+static uint8_t *freeBlocks[MOTOR_LOGGER_BUFFERS];     ///< Free stack
+static int freeCount = 0;
+static PendingBlock pending[MOTOR_LOGGER_BUFFERS];    ///< FIFO of filled blocks
+static int pendingHead = 0;
+static int pendingCount = 0;
+static int writerDone = 0;                            ///< Encoder submitted its last block
+
+static MotorLogEncoder encoder;              ///< Encoder thread only
+static TelemetryReader reader;               ///< Encoder thread only
+static atomic_ullong lostSamples;
+static atomic_ullong writeErrors;
+static atomic_ullong blocksWritten;
+
+static uint64_t clockNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static uint8_t *acquireBlock(void *context) {
+    (void) context;
+    pthread_mutex_lock(&poolLock);
+    uint8_t *block = freeCount > 0 ? freeBlocks[--freeCount] : NULL;
+    pthread_mutex_unlock(&poolLock);
+    return block;
+}
+
+static void submitBlock(void *context, uint8_t *block, uint32_t sequence) {
+    (void) context;
+    pthread_mutex_lock(&poolLock);
+    pending[(pendingHead + pendingCount) % MOTOR_LOGGER_BUFFERS] =
+        (PendingBlock) { .block = block, .sequence = sequence };
+    pendingCount++;
+    pthread_cond_signal(&poolSignal);
+    pthread_mutex_unlock(&poolLock);
+}
+
+static void *writerMain(void *arg) {
+    (void) arg;
+    pthread_mutex_lock(&poolLock);
+    for (;;) {
+        while (pendingCount == 0 && !writerDone) pthread_cond_wait(&poolSignal, &poolLock);
+        if (pendingCount == 0) break;
+        PendingBlock next = pending[pendingHead];
+        pendingHead = (pendingHead + 1) % MOTOR_LOGGER_BUFFERS;
+        pendingCount--;
+        pthread_mutex_unlock(&poolLock);
+
+        ssize_t written = pwrite(logFd, next.block, MOTOR_LOG_BLOCK_SIZE,
+                                 (off_t) next.sequence * MOTOR_LOG_BLOCK_SIZE);
+        if (written == MOTOR_LOG_BLOCK_SIZE) {
+            atomic_fetch_add_explicit(&blocksWritten, 1, memory_order_relaxed);
+        } else if (atomic_fetch_add_explicit(&writeErrors, 1, memory_order_relaxed) == 0) {
+            printf("Failed to write log block %u\n", next.sequence);
+        }
+
+        pthread_mutex_lock(&poolLock);
+        freeBlocks[freeCount++] = next.block;
+    }
+    pthread_mutex_unlock(&poolLock);
+    return NULL;
+}
+
+/** @brief Move every sample pushed so far into the encoder */
+static void drainRing(void) {
+    uint32_t lostBefore = reader.lost;
+    TelemetrySample sample;
+    while (telemetryReaderNext(&reader, &sample)) {
+        motorLogEncoderAdd(&encoder, &sample);
+    }
+    uint32_t lost = reader.lost - lostBefore;
+    if (lost > 0) {
+        motorLogEncoderLost(&encoder, lost);
+        atomic_fetch_add_explicit(&lostSamples, lost, memory_order_relaxed);
+    }
+}
+
+static void *encoderMain(void *arg) {
+    (void) arg;
+    int telemetryFd = motorTelemetryEventFd();
+    uint64_t blockStartNs = clockNs(CLOCK_MONOTONIC);
+    uint64_t blocksBefore = encoder.blocks;
+
+    while (!atomic_load_explicit(&encoderStopRequested, memory_order_relaxed)) {
+        struct pollfd pfd = { .fd = telemetryFd, .events = POLLIN };  // ignored if -1
+        poll(&pfd, 1, MOTOR_EVENT_TELEMETRY_MS);
+        if (pfd.revents & POLLIN) motorTakeTelemetryEvent();
+        drainRing();
+
+        uint64_t nowNs = clockNs(CLOCK_MONOTONIC);
+        if (encoder.blocks != blocksBefore) {
+            blockStartNs = nowNs;  // a full block went out; the open one is fresh
+            blocksBefore = encoder.blocks;
+        } else if (encoder.count > 0 && nowNs - blockStartNs >= loggerConfig.flushMs * NSEC_PER_MSEC) {
+            motorLogEncoderFlush(&encoder);
+            blockStartNs = nowNs;
+            blocksBefore = encoder.blocks;
+        }
+    }
+
+    drainRing();
+    motorLogEncoderFlush(&encoder);
+    pthread_mutex_lock(&poolLock);
+    writerDone = 1;
+    pthread_cond_signal(&poolSignal);
+    pthread_mutex_unlock(&poolLock);
+    return NULL;
+}
+
+/**
+ * @brief Create the log file, writing with O_DIRECT where supported
+ * @return File descriptor, or -1 on failure
+ */
+static int createLog(const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+    direct = fd >= 0;
+    if (fd < 0 && errno == EINVAL) {
+        // tmpfs and some FUSE file systems refuse O_DIRECT; block-sized writes still apply
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+    if (fd < 0) printf("Failed to create log %s\n", path);
+    return fd;
+}
+
+static void releaseResources(void) {
+    if (logFd >= 0) close(logFd);
+    logFd = -1;
+    free(pool);
+    pool = NULL;
+}
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ * @param path Log file
+ */
+void motorLoggerDefaultConfig(MotorLoggerConfig *config, const char *path) {
+    config->path = path;
+    config->telemetryName = NULL;
+    config->flushMs = MOTOR_LOGGER_FLUSH_MS;
+}
+
+/**
+ * @brief Create the log file and start recording
+ * @param config Logger configuration
+ * @return 0 on success, -1 on failure or if already recording
+ */
+int motorLoggerStart(const MotorLoggerConfig *config) {
+    if (atomic_load(&loggerRunning) || config == NULL || config->path == NULL) return -1;
+    loggerConfig = *config;
+
+    if (telemetryReaderOpen(&reader, loggerConfig.telemetryName) != 0) return -1;
+    pool = aligned_alloc(MOTOR_LOG_ALIGN, (size_t) MOTOR_LOGGER_BUFFERS * MOTOR_LOG_BLOCK_SIZE);
+    logFd = pool != NULL ? createLog(loggerConfig.path) : -1;
+    if (logFd < 0) {
+        releaseResources();
+        telemetryReaderClose(&reader);
+        return -1;
+    }
+
+    for (int i = 0; i < MOTOR_LOGGER_BUFFERS; i++) {
+        freeBlocks[i] = pool + (size_t) i * MOTOR_LOG_BLOCK_SIZE;
+    }
+    freeCount = MOTOR_LOGGER_BUFFERS;
+    pendingHead = 0;
+    pendingCount = 0;
+    writerDone = 0;
+    atomic_store(&lostSamples, 0);
+    atomic_store(&writeErrors, 0);
+    atomic_store(&blocksWritten, 0);
+    atomic_store(&encoderStopRequested, 0);
+
+    const MotorLogSink sink = { .acquire = acquireBlock, .submit = submitBlock, .context = NULL };
+    if (motorLogEncoderInit(&encoder, &sink, motorClockNs(), clockNs(CLOCK_REALTIME)) != 0) {
+        releaseResources();
+        telemetryReaderClose(&reader);
+        return -1;
+    }
+
+    if (pthread_create(&writerThread, NULL, writerMain, NULL) != 0) {
+        printf("Failed to create log writer thread\n");
+        motorLogEncoderFree(&encoder);
+        releaseResources();
+        telemetryReaderClose(&reader);
+        return -1;
+    }
+    if (pthread_create(&encoderThread, NULL, encoderMain, NULL) != 0) {
+        printf("Failed to create log encoder thread\n");
+        pthread_mutex_lock(&poolLock);
+        writerDone = 1;
+        pthread_cond_signal(&poolSignal);
+        pthread_mutex_unlock(&poolLock);
+        pthread_join(writerThread, NULL);
+        motorLogEncoderFree(&encoder);
+        releaseResources();
+        telemetryReaderClose(&reader);
+        return -1;
+    }
+    atomic_store(&loggerRunning, 1);
+    return 0;
+}
+
+/**
+ * @brief Record the samples already pushed, write everything and close the file
+ */
+void motorLoggerStop(void) {
+    if (!atomic_load(&loggerRunning)) return;
+
+    atomic_store(&encoderStopRequested, 1);
+    pthread_join(encoderThread, NULL);
+    pthread_join(writerThread, NULL);
+    if (fdatasync(logFd) != 0) printf("Failed to sync log %s\n", loggerConfig.path);
+
+    motorLogEncoderFree(&encoder);
+    telemetryReaderClose(&reader);
+    releaseResources();
+    atomic_store(&loggerRunning, 0);
+}
+
+/**
+ * @brief Get a snapshot of the logger counters
+ * @param stats Destination for the snapshot
+ * @note Sample and block counts of the encoder are exact once stopped
+ */
+void motorLoggerGetStats(MotorLoggerStats *stats) {
+    stats->samples = encoder.samples;
+    stats->droppedBlocks = encoder.droppedBlocks;
+    stats->lostSamples = atomic_load_explicit(&lostSamples, memory_order_relaxed);
+    stats->blocks = atomic_load_explicit(&blocksWritten, memory_order_relaxed);
+    stats->writeErrors = atomic_load_explicit(&writeErrors, memory_order_relaxed);
+    stats->direct = direct;
+}
@@ -0,0 +1,517 @@
+/**
+ * @file MotorServer.c
+ * @brief UDP command and telemetry server with a batched binary protocol
+ *
+ * One non-blocking socket serves every client. The thread sleeps in poll()
+ * on the socket and the telemetry-available descriptor, with a timeout of
+ * MOTOR_EVENT_TELEMETRY_MS so it also notices a stop request and expired
+ * subscribers. Commands are pushed onto a queue owned by this thread; the
+ * queue is attached to the control loop once and reused across restarts,
+ * since attached queues cannot be detached.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "MotorServer.h"
+#include "MotorControl.h"
+#include "MotorEvents.h"
+#include "ControlLoop.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+
+/**
+ * @brief Telemetry subscriber
+ */
+typedef struct {
+    struct sockaddr_in addr;   ///< Destination of telemetry datagrams
+    uint64_t lastSeenNs;       ///< Last datagram received from it
+    uint8_t active;            ///< Slot in use
+} Subscriber;
+
+/**
+ * @brief Counters written by the server thread
+ */
+typedef struct {
+    atomic_ullong packets;
+    atomic_ullong badPackets;
+    atomic_ullong commands;
+    atomic_ullong rejected;
+    atomic_ullong telemetryPackets;
+    atomic_ullong samples;
+    atomic_ullong lostSamples;
+} ServerCounters;
+
+static pthread_t serverThread;                 ///< Server thread handle
+static atomic_int serverRunning = 0;           ///< Thread is alive
+static atomic_int serverStopRequested = 0;     ///< Ask the thread to exit
+static int serverSocket = -1;                  ///< Bound UDP socket
+static uint16_t serverPort = 0;                ///< Bound port
+static MotorServerConfig serverConfig;         ///< Active configuration
+
+static CommandQueue serverQueue;               ///< Producer: server thread only
+static int serverQueueAttached = 0;            ///< Attached to the control loop
+
+static Subscriber subscribers[MOTOR_SERVER_MAX_SUBSCRIBERS]; ///< Server thread only
+static TelemetryReader telemetryReader;        ///< Server thread only
+static int telemetryReaderReady = 0;           ///< telemetryReader is mapped
+static ServerCounters counters;
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t) v);
+    put16(p + 2, (uint16_t) (v >> 16));
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+    put32(p, (uint32_t) v);
+    put32(p + 4, (uint32_t) (v >> 32));
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+static uint64_t get64(const uint8_t *p) {
+    return get32(p) | ((uint64_t) get32(p + 4) << 32);
+}
+
+static uint64_t monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * @brief Encode a header-only datagram (subscribe, acknowledgement)
+ * @param buf Destination buffer of at least MOTOR_NET_HEADER_SIZE bytes
+ * @param type MotorNetType
+ * @param count Header count field
+ * @param seq Sequence number
+ * @return MOTOR_NET_HEADER_SIZE
+ */
+size_t motorNetEncodeHeader(uint8_t *buf, MotorNetType type, uint16_t count, uint32_t seq) {
+    put32(buf, MOTOR_NET_MAGIC);
+    buf[4] = MOTOR_NET_VERSION;
+    buf[5] = (uint8_t) type;
+    put16(buf + 6, count);
+    put32(buf + 8, seq);
+    return MOTOR_NET_HEADER_SIZE;
+}
+
+/**
+ * @brief Encode a command datagram
+ * @param buf Destination buffer
+ * @param size Buffer size
+ * @param seq Sequence number echoed by the acknowledgement
+ * @param commands Commands to send
+ * @param count Number of commands (at most MOTOR_NET_MAX_COMMANDS)
+ * @return Datagram length, or 0 if it does not fit
+ */
+size_t motorNetEncodeCommands(uint8_t *buf, size_t size, uint32_t seq,
+                              const MotorCommand *commands, uint16_t count) {
+    size_t len = MOTOR_NET_HEADER_SIZE + (size_t) count * MOTOR_NET_COMMAND_SIZE;
+    if (count > MOTOR_NET_MAX_COMMANDS || len > size) return 0;
+
+    motorNetEncodeHeader(buf, MOTOR_NET_COMMANDS, count, seq);
+    uint8_t *p = buf + MOTOR_NET_HEADER_SIZE;
+    for (uint16_t i = 0; i < count; i++, p += MOTOR_NET_COMMAND_SIZE) {
+        p[0] = commands[i].type;
+        p[1] = commands[i].motor;
+        put16(p + 2, commands[i].flags);
+        put32(p + 4, (uint32_t) commands[i].arg0);
+        put32(p + 8, (uint32_t) commands[i].arg1);
+    }
+    return len;
+}
+
+/**
+ * @brief Decode and check a datagram header
+ * @param buf Datagram
+ * @param len Datagram length
+ * @param header Receives the header
+ * @return 0 if magic, version and length match the type, -1 otherwise
+ */
+int motorNetDecodeHeader(const uint8_t *buf, size_t len, MotorNetHeader *header) {
+    if (len < MOTOR_NET_HEADER_SIZE || len > MOTOR_NET_MAX_PACKET) return -1;
+    header->magic = get32(buf);
+    header->version = buf[4];
+    header->type = buf[5];
+    header->count = get16(buf + 6);
+    header->seq = get32(buf + 8);
+    if (header->magic != MOTOR_NET_MAGIC || header->version != MOTOR_NET_VERSION) return -1;
+
+    size_t expected;
+    switch (header->type) {
+        case MOTOR_NET_COMMANDS:
+            expected = MOTOR_NET_HEADER_SIZE + (size_t) header->count * MOTOR_NET_COMMAND_SIZE;
+            break;
+        case MOTOR_NET_TELEMETRY:
+            expected = MOTOR_NET_HEADER_SIZE + MOTOR_NET_TELEMETRY_PREFIX_SIZE +
+                       (size_t) header->count * MOTOR_NET_SAMPLE_SIZE;
+            break;
+        case MOTOR_NET_ACK:
+        case MOTOR_NET_SUBSCRIBE:
+            expected = MOTOR_NET_HEADER_SIZE;
+            break;
+        default:
+            return -1;
+    }
+    return len == expected ? 0 : -1;
+}
+
+/**
+ * @brief Decode the commands of a MOTOR_NET_COMMANDS datagram
+ * @param buf Datagram checked by motorNetDecodeHeader()
+ * @param index Command index (below the header count)
+ * @param command Receives the command
+ */
+void motorNetDecodeCommand(const uint8_t *buf, uint16_t index, MotorCommand *command) {
+    const uint8_t *p = buf + MOTOR_NET_HEADER_SIZE + (size_t) index * MOTOR_NET_COMMAND_SIZE;
+    command->type = p[0];
+    command->motor = p[1];
+    command->flags = get16(p + 2);
+    command->arg0 = (int32_t) get32(p + 4);
+    command->arg1 = (int32_t) get32(p + 8);
+}
+
+/**
+ * @brief Decode the samples of a MOTOR_NET_TELEMETRY datagram
+ * @param buf Datagram checked by motorNetDecodeHeader()
+ * @param samples Receives the samples (header count entries)
+ * @param lost Receives the server's lost sample counter, may be NULL
+ * @return Number of samples decoded
+ */
+int motorNetDecodeTelemetry(const uint8_t *buf, TelemetrySample *samples, uint32_t *lost) {
+    uint16_t count = get16(buf + 6);
+    uint64_t baseNs = get64(buf + MOTOR_NET_HEADER_SIZE);
+    if (lost != NULL) *lost = get32(buf + MOTOR_NET_HEADER_SIZE + 8);
+
+    const uint8_t *p = buf + MOTOR_NET_HEADER_SIZE + MOTOR_NET_TELEMETRY_PREFIX_SIZE;
+    for (uint16_t i = 0; i < count; i++, p += MOTOR_NET_SAMPLE_SIZE) {
+        TelemetrySample *sample = &samples[i];
+        memset(sample, 0, sizeof(*sample));
+        sample->timestampNs = baseNs + (uint64_t) get16(p) * 1000ULL;
+        sample->motor = p[2];
+        sample->hallState = p[3] & 0x07;
+        sample->overrun = (p[3] >> 7) & 1;
+        sample->faults = get16(p + 4);
+        sample->rpm = get16(p + 6);
+        sample->setpoint = get16(p + 8);
+        for (int c = 0; c < 3; c++) sample->duty[c] = get16(p + 10 + 2 * c);
+    }
+    return count;
+}
+
+/**
+ * @brief Telemetry datagram being filled
+ */
+typedef struct {
+    uint8_t buf[MOTOR_NET_MAX_PACKET];
+    uint16_t count;
+    uint64_t baseNs;
+    uint32_t seq;
+} TelemetryPacket;
+
+static void sendToSubscribers(const uint8_t *buf, size_t len) {
+    for (int i = 0; i < MOTOR_SERVER_MAX_SUBSCRIBERS; i++) {
+        if (!subscribers[i].active) continue;
+        if (sendto(serverSocket, buf, len, 0, (const struct sockaddr *) &subscribers[i].addr,
+                   sizeof(subscribers[i].addr)) == (ssize_t) len) {
+            atomic_fetch_add_explicit(&counters.telemetryPackets, 1, memory_order_relaxed);
+        }
+    }
+}
+
+static void flushTelemetry(TelemetryPacket *packet) {
+    if (packet->count == 0) return;
+    motorNetEncodeHeader(packet->buf, MOTOR_NET_TELEMETRY, packet->count, packet->seq++);
+    put64(packet->buf + MOTOR_NET_HEADER_SIZE, packet->baseNs);
+    put32(packet->buf + MOTOR_NET_HEADER_SIZE + 8, telemetryReader.lost);
+    sendToSubscribers(packet->buf, MOTOR_NET_HEADER_SIZE + MOTOR_NET_TELEMETRY_PREFIX_SIZE +
+                                   (size_t) packet->count * MOTOR_NET_SAMPLE_SIZE);
+    packet->count = 0;
+}
+
+static void appendSample(TelemetryPacket *packet, const TelemetrySample *sample) {
+    // Offsets are 16-bit microseconds; start a new datagram before they wrap
+    if (packet->count > 0 && sample->timestampNs - packet->baseNs > UINT16_MAX * 1000ULL) {
+        flushTelemetry(packet);
+    }
+    if (packet->count == 0) packet->baseNs = sample->timestampNs;
+
+    uint8_t *p = packet->buf + MOTOR_NET_HEADER_SIZE + MOTOR_NET_TELEMETRY_PREFIX_SIZE +
+                 (size_t) packet->count * MOTOR_NET_SAMPLE_SIZE;
+    put16(p, (uint16_t) ((sample->timestampNs - packet->baseNs) / 1000ULL));
+    p[2] = sample->motor;
+    p[3] = (uint8_t) ((sample->hallState & 0x07) | (sample->overrun ? 0x80 : 0));
+    put16(p + 4, sample->faults);
+    put16(p + 6, sample->rpm);
+    put16(p + 8, sample->setpoint);
+    for (int c = 0; c < 3; c++) put16(p + 10 + 2 * c, sample->duty[c]);
+
+    if (++packet->count == MOTOR_NET_MAX_SAMPLES) flushTelemetry(packet);
+}
+
+static int haveSubscribers(void) {
+    for (int i = 0; i < MOTOR_SERVER_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].active) return 1;
+    }
+    return 0;
+}
+
+/** @brief Forward every sample pushed since the last call, in full datagrams */
+static void streamTelemetry(TelemetryPacket *packet) {
+    if (!telemetryReaderReady) return;
+
+    // Keep reading without subscribers so a new one starts with fresh samples
+    int streaming = haveSubscribers();
+    uint32_t lostBefore = telemetryReader.lost;
+    TelemetrySample sample;
+    while (telemetryReaderNext(&telemetryReader, &sample)) {
+        atomic_fetch_add_explicit(&counters.samples, 1, memory_order_relaxed);
+        if (streaming) appendSample(packet, &sample);
+    }
+    atomic_fetch_add_explicit(&counters.lostSamples, telemetryReader.lost - lostBefore,
+                              memory_order_relaxed);
+    flushTelemetry(packet);
+}
+
+static Subscriber *findSubscriber(const struct sockaddr_in *addr) {
+    for (int i = 0; i < MOTOR_SERVER_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].active && subscribers[i].addr.sin_addr.s_addr == addr->sin_addr.s_addr &&
+            subscribers[i].addr.sin_port == addr->sin_port) {
+            return &subscribers[i];
+        }
+    }
+    return NULL;
+}
+
+static void subscribe(const struct sockaddr_in *addr, int enable, uint64_t nowNs) {
+    Subscriber *subscriber = findSubscriber(addr);
+    if (!enable) {
+        if (subscriber != NULL) subscriber->active = 0;
+        return;
+    }
+    for (int i = 0; subscriber == NULL && i < MOTOR_SERVER_MAX_SUBSCRIBERS; i++) {
+        if (!subscribers[i].active) subscriber = &subscribers[i];
+    }
+    if (subscriber == NULL) {
+        printf("Telemetry subscriber table full\n");
+        return;
+    }
+    subscriber->addr = *addr;
+    subscriber->lastSeenNs = nowNs;
+    subscriber->active = 1;
+
+    // The ring may have been created after the server started
+    if (!telemetryReaderReady &&
+        telemetryReaderOpen(&telemetryReader, serverConfig.telemetryName) == 0) {
+        telemetryReaderReady = 1;
+    }
+}
+
+static void expireSubscribers(uint64_t nowNs) {
+    for (int i = 0; i < MOTOR_SERVER_MAX_SUBSCRIBERS; i++) {
+        if (subscribers[i].active &&
+            nowNs - subscribers[i].lastSeenNs > MOTOR_SERVER_SUBSCRIBER_TIMEOUT_MS * NSEC_PER_MSEC) {
+            subscribers[i].active = 0;
+        }
+    }
+}
+
+/** @brief Queue the commands of a datagram and acknowledge how many fit */
+static void handleCommands(const uint8_t *buf, const MotorNetHeader *header,
+                           const struct sockaddr_in *from) {
+    uint16_t accepted = 0;
+    for (uint16_t i = 0; i < header->count; i++) {
+        MotorCommand command;
+        motorNetDecodeCommand(buf, i, &command);
+        if (commandQueuePush(&serverQueue, &command) != 0) break;
+        accepted++;
+    }
+    if (accepted > 0) controlLoopWake();
+    atomic_fetch_add_explicit(&counters.commands, accepted, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters.rejected, header->count - accepted, memory_order_relaxed);
+
+    uint8_t ack[MOTOR_NET_HEADER_SIZE];
+    motorNetEncodeHeader(ack, MOTOR_NET_ACK, accepted, header->seq);
+    sendto(serverSocket, ack, sizeof(ack), 0, (const struct sockaddr *) from, sizeof(*from));
+}
+
+static void receiveAll(uint64_t nowNs) {
+    static uint8_t buf[MOTOR_NET_MAX_PACKET];
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t len = recvfrom(serverSocket, buf, sizeof(buf), MSG_TRUNC,
+                               (struct sockaddr *) &from, &fromLen);
+        if (len < 0) return;  // EAGAIN: drained
+        atomic_fetch_add_explicit(&counters.packets, 1, memory_order_relaxed);
+
+        MotorNetHeader header;
+        if (fromLen != sizeof(from) || motorNetDecodeHeader(buf, (size_t) len, &header) != 0) {
+            atomic_fetch_add_explicit(&counters.badPackets, 1, memory_order_relaxed);
+            continue;
+        }
+        Subscriber *subscriber = findSubscriber(&from);
+        if (subscriber != NULL) subscriber->lastSeenNs = nowNs;
+
+        switch (header.type) {
+            case MOTOR_NET_COMMANDS:
+                handleCommands(buf, &header, &from);
+                break;
+            case MOTOR_NET_SUBSCRIBE:
+                subscribe(&from, header.count != 0, nowNs);
+                break;
+            default:
+                atomic_fetch_add_explicit(&counters.badPackets, 1, memory_order_relaxed);
+                break;
+        }
+    }
+}
+
+static void *serverThreadMain(void *arg) {
+    (void) arg;
+    static TelemetryPacket packet;
+    packet.count = 0;
+
+    int telemetryFd = motorTelemetryEventFd();
+    while (!atomic_load_explicit(&serverStopRequested, memory_order_relaxed)) {
+        struct pollfd fds[2] = {
+            { .fd = serverSocket, .events = POLLIN },
+            { .fd = telemetryFd, .events = POLLIN },  // ignored by poll() if -1
+        };
+        poll(fds, 2, MOTOR_EVENT_TELEMETRY_MS);
+
+        uint64_t nowNs = monotonicNs();
+        if (fds[0].revents & POLLIN) receiveAll(nowNs);
+        if (fds[1].revents & POLLIN) motorTakeTelemetryEvent();
+        expireSubscribers(nowNs);
+        streamTelemetry(&packet);
+    }
+
+    if (telemetryReaderReady) {
+        telemetryReaderClose(&telemetryReader);
+        telemetryReaderReady = 0;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Fill a configuration with the compile-time defaults
+ * @param config Configuration to initialize
+ */
+void motorServerDefaultConfig(MotorServerConfig *config) {
+    config->port = MOTOR_SERVER_PORT;
+    config->telemetryName = NULL;
+}
+
+/**
+ * @brief Bind the socket and start the server thread
+ * @param config Server configuration, or NULL for defaults
+ * @return 0 on success, -1 on failure or if already running
+ */
+int motorServerStart(const MotorServerConfig *config) {
+    if (atomic_load(&serverRunning)) return -1;
+    if (config != NULL) {
+        serverConfig = *config;
+    } else {
+        motorServerDefaultConfig(&serverConfig);
+    }
+
+    if (!serverQueueAttached) {
+        commandQueueInit(&serverQueue);
+        if (motorAttachCommandQueue(&serverQueue) != 0) {
+            printf("No command queue left for the network server\n");
+            return -1;
+        }
+        serverQueueAttached = 1;
+    }
+
+    serverSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (serverSocket < 0) {
+        printf("Failed to create server socket\n");
+        return -1;
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(serverConfig.port);
+    socklen_t addrLen = sizeof(addr);
+    if (bind(serverSocket, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+        getsockname(serverSocket, (struct sockaddr *) &addr, &addrLen) != 0) {
+        printf("Failed to bind UDP port %u\n", serverConfig.port);
+        close(serverSocket);
+        serverSocket = -1;
+        return -1;
+    }
+    serverPort = ntohs(addr.sin_port);
+
+    memset(subscribers, 0, sizeof(subscribers));
+    atomic_store(&serverStopRequested, 0);
+    if (pthread_create(&serverThread, NULL, serverThreadMain, NULL) != 0) {
+        printf("Failed to create server thread\n");
+        close(serverSocket);
+        serverSocket = -1;
+        serverPort = 0;
+        return -1;
+    }
+    atomic_store(&serverRunning, 1);
+    return 0;
+}
+
+/**
+ * @brief Stop the server thread and close the socket
+ */
+void motorServerStop(void) {
+    if (!atomic_load(&serverRunning)) return;
+
+    atomic_store(&serverStopRequested, 1);
+    pthread_join(serverThread, NULL);
+    close(serverSocket);
+    serverSocket = -1;
+    serverPort = 0;
+    atomic_store(&serverRunning, 0);
+}
+
+/**
+ * @brief Get the bound UDP port
+ * @return Port number, or 0 if the server is not running
+ */
+uint16_t motorServerGetPort(void) {
+    return atomic_load(&serverRunning) ? serverPort : 0;
+}
+
+/**
+ * @brief Get a snapshot of the server counters
+ * @param stats Destination for the snapshot
+ */
+void motorServerGetStats(MotorServerStats *stats) {
+    stats->packets = atomic_load_explicit(&counters.packets, memory_order_relaxed);
+    stats->badPackets = atomic_load_explicit(&counters.badPackets, memory_order_relaxed);
+    stats->commands = atomic_load_explicit(&counters.commands, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&counters.rejected, memory_order_relaxed);
+    stats->telemetryPackets = atomic_load_explicit(&counters.telemetryPackets, memory_order_relaxed);
+    stats->samples = atomic_load_explicit(&counters.samples, memory_order_relaxed);
+    stats->lostSamples = atomic_load_explicit(&counters.lostSamples, memory_order_relaxed);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file MotorSoc.c
+ * @brief Identification of the SoC the library runs on
+ *
+ * The compatible list is read once and kept; it cannot change while the
+ * process runs.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "MotorSoc.h"
+
+static char compatibleList[256];  ///< NUL-separated compatible strings
+static int compatibleSize = -1;   ///< Bytes in compatibleList, 0 if unreadable, -1 before the first read
+
+/** @brief SoCs whose GPIO block matches the BCM2835 register layout */
+static const char *const bcm2835GpioSocs[] = {
+    "brcm,bcm2835", "brcm,bcm2836", "brcm,bcm2837", "brcm,bcm2711",
+};
+
+static void readCompatible(void) {
+    if (compatibleSize >= 0) return;
+    compatibleSize = 0;
+    FILE *file = fopen(MOTOR_SOC_COMPATIBLE_PATH, "rb");
+    if (file == NULL) return;
+    size_t size = fread(compatibleList, 1, sizeof(compatibleList) - 1, file);
+    fclose(file);
+    compatibleList[size] = '\0';
+    compatibleSize = (int) size;
+}
+
+/**
+ * @brief Check whether the board lists a device tree compatible string
+ * @param compatible Compatible string, e.g. "brcm,bcm2712"
+ * @return 1 if listed, 0 if not, -1 if the list cannot be read
+ */
+int motorSocIs(const char *compatible) {
+    readCompatible();
+    if (compatibleSize == 0) return -1;
+    for (int i = 0; i < compatibleSize; i += (int) strlen(&compatibleList[i]) + 1) {
+        if (strcmp(&compatibleList[i], compatible) == 0) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether the SoC has the BCM2835-style GPIO register block
+ * @return 1 on BCM2835/6/7 and BCM2711, 0 on any other SoC (e.g. BCM2712
+ *         with RP1), -1 if the SoC cannot be identified
+ */
+int motorSocHasBcm2835Gpio(void) {
+    for (size_t i = 0; i < sizeof(bcm2835GpioSocs) / sizeof(bcm2835GpioSocs[0]); i++) {
+        int listed = motorSocIs(bcm2835GpioSocs[i]);
+        if (listed != 0) return listed;
+    }
+    return 0;
+}
+
+/**
+ * @brief Name the SoC for error messages
+ * @return Last device tree compatible string (the SoC), "unknown" if none
+ */
+const char *motorSocName(void) {
+    readCompatible();
+    const char *name = "unknown";
+    for (int i = 0; i < compatibleSize; i += (int) strlen(&compatibleList[i]) + 1) {
+        if (compatibleList[i] != '\0') name = &compatibleList[i];
+    }
+    return name;
+}
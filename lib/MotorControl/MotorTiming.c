@@ -0,0 +1,223 @@
+/**
+ * @file MotorTiming.c
+ * @brief Control path timing instrumentation implementation
+ *
+ * Bucket index for a value v: values below 8 map directly; larger values
+ * use the position of the top bit as the exponent and the next three bits
+ * as the sub-bucket. Counters are updated with relaxed atomic adds, which
+ * is all that is needed for statistics written from several threads.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "MotorTiming.h"
+
+#define TIMING_SUB_BITS 3
+#define TIMING_SUB_COUNT (1u << TIMING_SUB_BITS)
+
+/** @brief Busy-wait used to calibrate the cycle counter */
+#define TIMING_CALIBRATION_NS 10000000ULL  // 10ms
+
+/**
+ * @brief Live histogram, written concurrently
+ */
+typedef struct {
+    atomic_ullong count;
+    atomic_ullong sumNs;
+    atomic_uint minNs;
+    atomic_uint maxNs;
+    atomic_uint buckets[TIMING_HISTOGRAM_BUCKETS];
+} LiveHistogram;
+
+static LiveHistogram histograms[TIMING_CHANNEL_COUNT];
+static atomic_ullong deadlineMisses;
+
+static uint64_t rawClockNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+#if defined(MOTOR_TIMING_PMU) && defined(__aarch64__)
+
+static _Atomic uint64_t nsPerCycleQ32 = 0;  ///< Calibrated cycle period, Q32.32, written once
+
+static inline uint64_t readCycles(void) {
+    uint64_t cycles;
+    __asm__ volatile("isb; mrs %0, pmccntr_el0" : "=r"(cycles));
+    return cycles;
+}
+
+/**
+ * @brief Measure the cycle counter frequency against CLOCK_MONOTONIC_RAW
+ * @details Busy-waits TIMING_CALIBRATION_NS once; later calls return at once.
+ */
+void timingInit(void) {
+    if (atomic_load_explicit(&nsPerCycleQ32, memory_order_acquire) != 0) return;
+    uint64_t startNs = rawClockNs();
+    uint64_t startCycles = readCycles();
+    uint64_t elapsedNs;
+    do {
+        elapsedNs = rawClockNs() - startNs;
+    } while (elapsedNs < TIMING_CALIBRATION_NS);
+    uint64_t cycles = readCycles() - startCycles;
+    atomic_store_explicit(&nsPerCycleQ32, cycles ? (elapsedNs << 32) / cycles : 1ULL << 32,
+                          memory_order_release);
+}
+
+uint64_t timingNow(void) {
+    return readCycles();
+}
+
+uint32_t timingElapsedNs(uint64_t start, uint64_t end) {
+    uint64_t scale = atomic_load_explicit(&nsPerCycleQ32, memory_order_acquire);
+    if (scale == 0) return 0;  // timingInit() has not run
+    uint64_t cycles = end - start;
+    // Guard the Q32 product against overflow for very long intervals
+    if (cycles > (UINT64_MAX / scale)) return UINT32_MAX;
+    uint64_t ns = (cycles * scale) >> 32;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t) ns;
+}
+
+#define TIMING_CYCLE_COUNTER 1
+
+#else
+
+void timingInit(void) {
+}
+
+uint64_t timingNow(void) {
+    return rawClockNs();
+}
+
+uint32_t timingElapsedNs(uint64_t start, uint64_t end) {
+    uint64_t ns = end - start;
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t) ns;
+}
+
+#define TIMING_CYCLE_COUNTER 0
+
+#endif
+
+static unsigned bucketIndex(uint32_t ns) {
+    if (ns < TIMING_SUB_COUNT) return ns;
+
+    unsigned exponent = 31u - (unsigned) __builtin_clz(ns);
+    unsigned sub = (ns >> (exponent - TIMING_SUB_BITS)) & (TIMING_SUB_COUNT - 1u);
+    return (exponent - TIMING_SUB_BITS + 1u) * TIMING_SUB_COUNT + sub;
+}
+
+static uint32_t bucketUpperBound(unsigned index) {
+    if (index < TIMING_SUB_COUNT) return index;
+
+    unsigned exponent = index / TIMING_SUB_COUNT + TIMING_SUB_BITS - 1u;
+    unsigned sub = index % TIMING_SUB_COUNT;
+    uint64_t lower = (uint64_t) (TIMING_SUB_COUNT + sub) << (exponent - TIMING_SUB_BITS);
+    uint64_t upper = lower + (1ULL << (exponent - TIMING_SUB_BITS)) - 1u;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t) upper;
+}
+
+/**
+ * @brief Add a sample to a channel histogram
+ * @param channel Channel to record into
+ * @param ns Interval in nanoseconds
+ */
+void timingRecord(TimingChannel channel, uint32_t ns) {
+    LiveHistogram *hist = &histograms[channel];
+
+    atomic_fetch_add_explicit(&hist->buckets[bucketIndex(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sumNs, ns, memory_order_relaxed);
+
+    // min is stored inverted so an all-zero histogram needs no initialization
+    unsigned inverted = ~ns;
+    unsigned seen = atomic_load_explicit(&hist->minNs, memory_order_relaxed);
+    while (inverted > seen &&
+           !atomic_compare_exchange_weak_explicit(&hist->minNs, &seen, inverted,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    seen = atomic_load_explicit(&hist->maxNs, memory_order_relaxed);
+    while (ns > seen &&
+           !atomic_compare_exchange_weak_explicit(&hist->maxNs, &seen, ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    atomic_fetch_add_explicit(&hist->count, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Count a control tick that missed its deadline
+ */
+void timingRecordDeadlineMiss(void) {
+    atomic_fetch_add_explicit(&deadlineMisses, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Take a snapshot of the timing statistics
+ * @param stats Destination for the snapshot
+ */
+void motorGetTimingStats(MotorTimingStats *stats) {
+    for (int c = 0; c < TIMING_CHANNEL_COUNT; c++) {
+        LiveHistogram *live = &histograms[c];
+        TimingHistogram *hist = &stats->channel[c];
+
+        hist->count = atomic_load_explicit(&live->count, memory_order_relaxed);
+        hist->sumNs = atomic_load_explicit(&live->sumNs, memory_order_relaxed);
+        hist->minNs = hist->count ? ~atomic_load_explicit(&live->minNs, memory_order_relaxed) : 0;
+        hist->maxNs = atomic_load_explicit(&live->maxNs, memory_order_relaxed);
+        for (int b = 0; b < TIMING_HISTOGRAM_BUCKETS; b++) {
+            hist->buckets[b] = atomic_load_explicit(&live->buckets[b], memory_order_relaxed);
+        }
+    }
+    stats->deadlineMisses = atomic_load_explicit(&deadlineMisses, memory_order_relaxed);
+    stats->cycleCounter = TIMING_CYCLE_COUNTER;
+}
+
+/**
+ * @brief Clear all histograms and counters
+ * @note Samples recorded concurrently with the reset may be partially kept
+ */
+void motorResetTimingStats(void) {
+    for (int c = 0; c < TIMING_CHANNEL_COUNT; c++) {
+        LiveHistogram *live = &histograms[c];
+
+        atomic_store_explicit(&live->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&live->sumNs, 0, memory_order_relaxed);
+        atomic_store_explicit(&live->minNs, 0, memory_order_relaxed);
+        atomic_store_explicit(&live->maxNs, 0, memory_order_relaxed);
+        for (int b = 0; b < TIMING_HISTOGRAM_BUCKETS; b++) {
+            atomic_store_explicit(&live->buckets[b], 0, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&deadlineMisses, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Estimate a percentile from a histogram
+ * @param hist Histogram snapshot
+ * @param percentile Percentile in the range 0-100
+ * @return Upper bound of the bucket holding the percentile, in ns
+ */
+uint32_t timingHistogramPercentile(const TimingHistogram *hist, double percentile) {
+    uint64_t total = 0;
+    for (int b = 0; b < TIMING_HISTOGRAM_BUCKETS; b++) total += hist->buckets[b];
+    if (total == 0) return 0;
+
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+    uint64_t rank = (uint64_t) (percentile / 100.0 * (double) total + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int b = 0; b < TIMING_HISTOGRAM_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = bucketUpperBound((unsigned) b);
+            return upper < hist->maxNs ? upper : hist->maxNs;
+        }
+    }
+    return hist->maxNs;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file Protection.c
+ * @brief Overcurrent protection implementation
+ *
+ * The trip path runs in this order:
+ * 1. one GPCLR0 store drops every bank 0 output of the motor
+ * 2. phase and gate pins outside bank 0 are cleared with digitalWrite(),
+ *    and so is every pin where the register block is not mapped: no
+ *    /dev/gpiomem, or a SoC without the BCM2835 layout (RP1 on the Pi 5)
+ * 3. the fault is latched and isRunning cleared, so no commutation path
+ *    energizes the bridge again
+ * 4. the regular stop runs under the phase lock and resets the PWM backend;
+ *    if the lock is taken, its holder runs the stop when releasing it
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <wiringPi.h>
+#include "MotorInternal.h"
+#include "MotorTiming.h"
+#include "Protection.h"
+
+/** @brief GPCLR0 (output clear, GPIO0-31) word offset in the register block */
+#define GPCLR0 (0x28 / 4)
+
+/** @brief Bank 0 pins as a register mask, 0 for pins outside bank 0 */
+static uint32_t bank0Bit(int pin) {
+    return pin >= 0 && pin < 32 ? 1u << pin : 0u;
+}
+
+/** @brief Enable or low-side pins of the motor, NULL if it has none */
+static const int *tripGatePins(const Motor *motor) {
+    if (motor->config.commutationMode == COMMUTATION_SENSORLESS ||
+        motor->config.bridge == BRIDGE_3PWM) {
+        return motor->config.enablePins;
+    }
+    return motor->config.bridge == BRIDGE_6PWM ? motor->config.lowSidePins : NULL;
+}
+
+/** @brief Drive a pin low unless the GPCLR0 store already cleared it */
+static void clearPin(const Motor *motor, int pin) {
+    if (pin >= 0 && (motor->tripRegs == NULL || bank0Bit(pin) == 0)) digitalWrite(pin, LOW);
+}
+
+/** @brief Drop every output of the motor without taking the phase lock */
+static void clearOutputs(const Motor *motor) {
+    if (motor->tripRegs != NULL) motor->tripRegs[GPCLR0] = motor->tripMask;
+
+    const int *gates = tripGatePins(motor);
+    for (int i = 0; i < 3; i++) {
+        clearPin(motor, motor->config.phasePins[i]);
+        if (gates != NULL) clearPin(motor, gates[i]);
+    }
+}
+
+static void trip(Motor *motor, MotorFault fault, int locked) {
+    uint64_t start = timingNow();
+    clearOutputs(motor);
+    timingRecord(TIMING_FAULT_TRIP, timingElapsedNs(start, timingNow()));
+
+    if (motor->fault == MOTOR_FAULT_NONE) motor->fault = (uint8_t) fault;
+    motor->isRunning = 0;
+    motorEventsRaise(&motor->events, MOTOR_EVENT_FAULT);
+
+    if (locked) {
+        motorEmergencyOff(motor);
+        return;
+    }
+    // Never waits for the lock: whoever holds it finishes the stop on release
+    atomic_store(&motor->offPending, 1);
+    if (motorPhaseTryLock(motor)) motorPhaseUnlock(motor);
+}
+
+/**
+ * @brief Trip a motor: clear its outputs, latch the fault and stop it
+ * @param motor Motor handle
+ * @param fault Fault code to latch
+ */
+void protectionTrip(Motor *motor, MotorFault fault) {
+    trip(motor, fault, 0);
+}
+
+/**
+ * @brief Trip from a context that already holds the phase lock
+ * @param motor Motor handle
+ * @param fault Fault code to latch
+ */
+void protectionTripLocked(Motor *motor, MotorFault fault) {
+    trip(motor, fault, 1);
+}
+
+/**
+ * @brief Check a current against the motor's limit and trip if exceeded
+ * @param motor Motor handle (phase lock held)
+ * @param currentMa Measured current magnitude
+ * @return 1 if the motor tripped, 0 otherwise
+ */
+int protectionCheckCurrent(Motor *motor, int32_t currentMa) {
+    uint32_t limit = motor->config.currentLimitMa;
+    if (limit == 0 || currentMa < 0 || (uint32_t) currentMa <= limit) return 0;
+    protectionTripLocked(motor, MOTOR_FAULT_OVERCURRENT_ADC);
+    return 1;
+}
+
+/**
+ * @brief Fault input edge handler
+ * @param slot Pool slot of the motor whose fault input fell
+ */
+static void faultEdge(int slot) {
+    Motor *motor = &motorPool[slot];
+    if (motor->inUse) protectionTrip(motor, MOTOR_FAULT_OVERCURRENT_PIN);
+}
+
+static void faultEdgeISR0(void) { faultEdge(0); }
+static void faultEdgeISR1(void) { faultEdge(1); }
+static void faultEdgeISR2(void) { faultEdge(2); }
+static void faultEdgeISR3(void) { faultEdge(3); }
+
+static void (*const faultEdgeISRs[])(void) = {
+    faultEdgeISR0, faultEdgeISR1, faultEdgeISR2, faultEdgeISR3
+};
+
+_Static_assert(sizeof(faultEdgeISRs) / sizeof(faultEdgeISRs[0]) >= MOTOR_MAX_INSTANCES,
+               "one fault edge trampoline required per motor slot");
+
+/**
+ * @brief Prepare the trip path of a motor
+ * @param motor Motor whose pins are configured
+ * @return 0 on success, -1 if the fault input cannot be registered
+ */
+int protectionAttach(Motor *motor) {
+    const MotorConfig *config = &motor->config;
+    int adcCheck = config->currentLimitMa > 0 &&
+        (config->busCurrentChannel >= 0 || config->commutationMode == COMMUTATION_FOC);
+    if (config->faultPin < 0 && !adcCheck) return 0;
+
+    // Everything this motor drives, cleared in one store on a trip
+    uint32_t mask = bank0Bit(config->phasePins[0]) | bank0Bit(config->phasePins[1]) |
+                    bank0Bit(config->phasePins[2]);
+    const int *gates = tripGatePins(motor);
+    if (gates != NULL) mask |= bank0Bit(gates[0]) | bank0Bit(gates[1]) | bank0Bit(gates[2]);
+    motor->tripMask = mask;
+    motor->tripRegs = gpiomemRegisters();
+    if (motor->tripRegs == NULL) {
+        printf("Overcurrent trip falls back to digitalWrite() without a %s mapping\n", GPIOMEM_DEVICE);
+    }
+
+    if (config->faultPin < 0) return 0;
+    pinMode(config->faultPin, INPUT);
+    pullUpDnControl(config->faultPin, PUD_UP);
+    if (!motor->faultIsrRegistered) {
+        if (wiringPiISR(config->faultPin, INT_EDGE_FALLING, faultEdgeISRs[motor->index]) < 0) {
+            printf("Fault input interrupt registration failed\n");
+            return -1;
+        }
+        motor->faultIsrRegistered = 1;
+    }
+
+    // A fault already present at startup latches right away
+    if (digitalRead(config->faultPin) == LOW) motor->fault = MOTOR_FAULT_OVERCURRENT_PIN;
+    return 0;
+}
+
+/**
+ * @brief Get the latched fault of a motor instance
+ * @param motor Motor handle
+ * @return First fault since the last motorInstanceClearFault()
+ */
+MotorFault motorInstanceGetFault(const Motor *motor) {
+    return (MotorFault) motor->fault;
+}
+
+/**
+ * @brief Acknowledge the latched fault of a motor instance
+ * @param motor Motor handle
+ * @return 0 on success, -1 while the fault input is still asserted
+ */
+int motorInstanceClearFault(Motor *motor) {
+    if (motor->config.faultPin >= 0 && digitalRead(motor->config.faultPin) == LOW) return -1;
+    motor->fault = MOTOR_FAULT_NONE;
+    return 0;
+}
+
+/**
+ * @brief Get the latched fault of the default motor
+ * @return Fault code, MOTOR_FAULT_NONE before motorInit()
+ */
+MotorFault motorGetFault(void) {
+    Motor *motor = motorGetDefault();
+    return motor != NULL ? motorInstanceGetFault(motor) : MOTOR_FAULT_NONE;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file PwmBackend.c
+ * @brief PWM output backend implementations
+ *
+ * softPwmBackend wraps WiringPi softPwm. sysfsPwmBackend drives the BCM PWM
+ * peripheral through the kernel PWM class: the period is programmed once to
+ * PWM_FREQUENCY and each write only updates duty_cycle through a file
+ * descriptor kept open for the lifetime of the pin, so the waveform itself
+ * is generated entirely in hardware.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <wiringPi.h>
+#include <softPwm.h>
+#include "MotorControl.h"
+#include "PwmBackend.h"
+#include "MotorSoc.h"
+
+/* ---------------------------------------------------------------------------
+ * WiringPi softPwm backend
+ * ------------------------------------------------------------------------- */
+
+static int softPwmSetup(int pin, int range) {
+    pinMode(pin, PWM_OUTPUT);
+    return softPwmCreate(pin, 0, range) == 0 ? 0 : -1;
+}
+
+static void softPwmRelease(int pin) {
+    softPwmWrite(pin, 0);
+    softPwmStop(pin);
+}
+
+/** @brief End the pin's thread; softPwmStop() leaves the pin low */
+static void softPwmSuspend(int pin) {
+    softPwmStop(pin);
+}
+
+static int softPwmResume(int pin, int range) {
+    return softPwmCreate(pin, 0, range) == 0 ? 0 : -1;
+}
+
+const PwmBackend softPwmBackend = {
+    .name = "softpwm",
+    .setup = softPwmSetup,
+    .write = softPwmWrite,
+    .release = softPwmRelease,
+    .suspend = softPwmSuspend,
+    .resume = softPwmResume,
+};
+
+/* ---------------------------------------------------------------------------
+ * Kernel PWM class (hardware) backend
+ * ------------------------------------------------------------------------- */
+
+/** @brief PWM period in nanoseconds */
+#define SYSFS_PERIOD_NS (1000000000UL / PWM_FREQUENCY)
+
+/** @brief Attempts to wait for udev to create a freshly exported channel */
+#define SYSFS_EXPORT_RETRIES 100
+
+/** @brief GPIO to PWM channel routing entry */
+typedef struct {
+    int pin;          ///< GPIO number routed to this channel
+    int channel;      ///< PWM channel index on PWM_SYSFS_CHIP
+} SysfsChannelMap;
+
+/** @brief Per-channel state, indexed like sysfsChannelMap */
+typedef struct {
+    int channel;      ///< PWM channel index on PWM_SYSFS_CHIP
+    int claimed;      ///< Channel has been set up
+    int dutyFd;       ///< Open duty_cycle attribute (valid when claimed)
+    int range;        ///< Duty cycle range requested at setup
+    int lastValue;    ///< Last value written, to skip redundant syscalls
+} SysfsChannel;
+
+static const SysfsChannelMap sysfsChannelMap[] = PWM_SYSFS_CHANNEL_MAP;
+
+#define SYSFS_CHANNEL_COUNT ((int) (sizeof(sysfsChannelMap) / sizeof(sysfsChannelMap[0])))
+
+static SysfsChannel sysfsChannels[SYSFS_CHANNEL_COUNT];
+
+/**
+ * @brief Write a string to a sysfs attribute
+ * @return 0 on success, -1 on failure
+ */
+static int sysfsWriteAttr(const char *path, const char *value) {
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return -1;
+
+    int len = (int) strlen(value);
+    int ok = write(fd, value, len) == len;
+    close(fd);
+    return ok ? 0 : -1;
+}
+
+static SysfsChannel *sysfsFindChannel(int pin) {
+    for (int i = 0; i < SYSFS_CHANNEL_COUNT; i++) {
+        if (sysfsChannelMap[i].pin == pin) return &sysfsChannels[i];
+    }
+    return NULL;
+}
+
+static void sysfsWrite(int pin, int value);
+
+static int sysfsSetup(int pin, int range) {
+#ifdef PWM_SYSFS_CHANNEL_MAP_SOC
+    // Another SoC routes these pins to other channels, or to none
+    if (motorSocIs(PWM_SYSFS_CHANNEL_MAP_SOC) == 0) {
+        printf("PWM_SYSFS_CHANNEL_MAP is for %s, not %s\n", PWM_SYSFS_CHANNEL_MAP_SOC, motorSocName());
+        return -1;
+    }
+#endif
+    SysfsChannel *ch = sysfsFindChannel(pin);
+    if (ch == NULL) {
+        printf("GPIO%d has no hardware PWM channel\n", pin);
+        return -1;
+    }
+    if (ch->claimed || range <= 0) return -1;
+    ch->channel = sysfsChannelMap[ch - sysfsChannels].channel;
+
+    // Pins routed to the same channel would silently share one duty cycle
+    for (int i = 0; i < SYSFS_CHANNEL_COUNT; i++) {
+        if (sysfsChannels[i].claimed && sysfsChannels[i].channel == ch->channel) {
+            printf("GPIO%d shares PWM channel %d with GPIO%d\n", pin, ch->channel, sysfsChannelMap[i].pin);
+            return -1;
+        }
+    }
+
+    char path[96];
+    char value[24];
+
+    // Export the channel; EBUSY just means it is already exported
+    snprintf(value, sizeof(value), "%d", ch->channel);
+    sysfsWriteAttr(PWM_SYSFS_CHIP "/export", value);
+
+    // The attributes appear asynchronously and may not be writable yet
+    snprintf(path, sizeof(path), PWM_SYSFS_CHIP "/pwm%d/period", ch->channel);
+    snprintf(value, sizeof(value), "%lu", SYSFS_PERIOD_NS);
+    int retries = SYSFS_EXPORT_RETRIES;
+    while (sysfsWriteAttr(path, value) != 0) {
+        if (--retries == 0) {
+            printf("Failed to configure PWM channel %d\n", ch->channel);
+            return -1;
+        }
+        usleep(1000);
+    }
+
+    snprintf(path, sizeof(path), PWM_SYSFS_CHIP "/pwm%d/duty_cycle", ch->channel);
+    ch->dutyFd = open(path, O_WRONLY);
+    if (ch->dutyFd < 0) {
+        printf("Failed to open %s\n", path);
+        return -1;
+    }
+    ch->range = range;
+    ch->lastValue = -1;
+    ch->claimed = 1;
+    sysfsWrite(pin, 0);
+
+    snprintf(path, sizeof(path), PWM_SYSFS_CHIP "/pwm%d/enable", ch->channel);
+    if (sysfsWriteAttr(path, "1") != 0) {
+        printf("Failed to enable PWM channel %d\n", ch->channel);
+        close(ch->dutyFd);
+        ch->claimed = 0;
+        return -1;
+    }
+    return 0;
+}
+
+static void sysfsWrite(int pin, int value) {
+    SysfsChannel *ch = sysfsFindChannel(pin);
+    if (ch == NULL || !ch->claimed || value == ch->lastValue) return;
+
+    // Scale 0-range onto the period in nanoseconds
+    uint64_t dutyNs = ((uint64_t) value * SYSFS_PERIOD_NS) / (uint64_t) ch->range;
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%llu", (unsigned long long) dutyNs);
+    if (pwrite(ch->dutyFd, buf, len, 0) == len) {
+        ch->lastValue = value;
+    }
+}
+
+static void sysfsRelease(int pin) {
+    SysfsChannel *ch = sysfsFindChannel(pin);
+    if (ch == NULL || !ch->claimed) return;
+
+    char path[96];
+    sysfsWrite(pin, 0);
+    snprintf(path, sizeof(path), PWM_SYSFS_CHIP "/pwm%d/enable", ch->channel);
+    sysfsWriteAttr(path, "0");
+    close(ch->dutyFd);
+    ch->claimed = 0;
+}
+
+/**
+ * @brief Enable or disable a claimed channel, keeping it exported and open
+ * @return 0 on success, -1 on failure
+ */
+static int sysfsEnable(int pin, const char *enable) {
+    SysfsChannel *ch = sysfsFindChannel(pin);
+    if (ch == NULL || !ch->claimed) return -1;
+
+    char path[96];
+    snprintf(path, sizeof(path), PWM_SYSFS_CHIP "/pwm%d/enable", ch->channel);
+    return sysfsWriteAttr(path, enable);
+}
+
+static void sysfsSuspend(int pin) {
+    sysfsWrite(pin, 0);
+    sysfsEnable(pin, "0");
+}
+
+static int sysfsResume(int pin, int range) {
+    (void) range;  // Still programmed from setup
+    sysfsWrite(pin, 0);
+    return sysfsEnable(pin, "1");
+}
+
+const PwmBackend sysfsPwmBackend = {
+    .name = "sysfs",
+    .setup = sysfsSetup,
+    .write = sysfsWrite,
+    .release = sysfsRelease,
+    .suspend = sysfsSuspend,
+    .resume = sysfsResume,
+};
@@ -0,0 +1,118 @@
+/**
+ * @file RotorAngle.c
+ * @brief Sub-sector rotor angle from Hall edges, with phase advance
+ *
+ * Sectors are indexed by their position in the forward Hall sequence
+ * 1-3-2-6-4-5; sector k spans angles[k] to angles[k + 1]. Forward rotation
+ * enters a sector at its start, reverse rotation at its end.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include "RotorAngle.h"
+#include "MotorClock.h"
+#include "MotorInternal.h"
+
+/** @brief Forward sequence position of each Hall code, -1 for invalid codes */
+static const int8_t sequencePosition[8] = { -1, 0, 2, 1, 4, 5, 3, -1 };
+
+/** @brief Hall code at each forward sequence position */
+static const uint8_t sequenceCode[6] = { 1, 3, 2, 6, 4, 5 };
+
+/**
+ * @brief Rotor travel into the current sector
+ * @param span Sector width
+ * @return Angle covered since the last edge, span once the next edge is due;
+ *         -1 while stationary
+ */
+static int32_t travel(const SpeedEstimator *est, uint16_t span, uint64_t nowNs) {
+    uint32_t period = speedEstimatorGetSectorPeriodNs(est);
+    if (period == 0 || speedEstimatorGetRpm(est) == 0) return -1;
+    // An edge sampled by a handler after nowNs was read may lie past it
+    uint64_t elapsed = nowNs > est->lastEdgeNs ? nowNs - est->lastEdgeNs : 0;
+    if (elapsed >= period) return span;
+    return (int32_t) (elapsed * span / period);
+}
+
+/**
+ * @brief Rotor angle interpolated within the current Hall sector
+ * @param est Speed estimator fed with the motor's Hall edges
+ * @param direction Direction of travel: 1 forward, -1 reverse, 0 unknown (forward)
+ * @param angles Start angle of each forward sector (Hall codes 1, 3, 2, 6, 4, 5)
+ * @param nowNs Current time from motorClockNs()
+ * @return 16-bit electrical angle; the sector centre while stationary
+ */
+uint16_t rotorAngleInterpolate(const SpeedEstimator *est, int8_t direction,
+                               const uint16_t angles[6], uint64_t nowNs) {
+    int sector = sequencePosition[est->lastHallState & 7];
+    if (sector < 0) sector = 0;
+    uint16_t start = angles[sector];
+    uint16_t end = angles[(sector + 1) % 6];
+    uint16_t span = (uint16_t) (end - start);
+
+    int32_t covered = travel(est, span, nowNs);
+    if (covered < 0) return (uint16_t) (start + span / 2);
+    return direction < 0 ? (uint16_t) (end - covered) : (uint16_t) (start + covered);
+}
+
+/**
+ * @brief Phase advance for a speed
+ * @param phaseAdvance Advance at maxRpm (16-bit angle)
+ * @param rpm Measured speed
+ * @param maxRpm Speed limit of the motor
+ * @return Advance angle, proportional to speed and capped at phaseAdvance
+ */
+uint16_t rotorAngleAdvance(uint16_t phaseAdvance, uint16_t rpm, uint16_t maxRpm) {
+    if (phaseAdvance == 0 || maxRpm == 0) return 0;
+    if (rpm >= maxRpm) return phaseAdvance;
+    return (uint16_t) ((uint32_t) phaseAdvance * rpm / maxRpm);
+}
+
+/**
+ * @brief Hall code whose 6-step pattern to drive with phase advance
+ * @param est Speed estimator fed with the motor's Hall edges
+ * @param direction Direction of travel: 1 forward, -1 reverse, 0 unknown (forward)
+ * @param angles Start angle of each forward sector
+ * @param advance Advance angle from rotorAngleAdvance()
+ * @param nowNs Current time from motorClockNs()
+ * @return The sensed Hall code, or the next one in the direction of travel
+ *         once the advanced angle has left the current sector
+ */
+uint8_t rotorAngleDriveState(const SpeedEstimator *est, int8_t direction,
+                             const uint16_t angles[6], uint16_t advance, uint64_t nowNs) {
+    uint8_t hallState = est->lastHallState;
+    int sector = sequencePosition[hallState & 7];
+    if (advance == 0 || sector < 0) return hallState;
+
+    uint16_t span = (uint16_t) (angles[(sector + 1) % 6] - angles[sector]);
+    int32_t covered = travel(est, span, nowNs);
+    if (covered < 0 || covered + advance < span) return hallState;
+    int step = direction < 0 ? 5 : 1;
+    return sequenceCode[(sector + step) % 6];
+}
+
+/**
+ * @brief Advanced rotor angle of a motor
+ * @param motor Motor instance
+ * @param nowNs Current time from motorClockNs()
+ * @return 16-bit electrical angle including phase advance
+ */
+uint16_t motorRotorAngle(const Motor *motor, uint64_t nowNs) {
+    const SpeedEstimator *est = &motor->speedEstimator;
+    int8_t direction = motor->hallValidator.direction;
+    uint16_t angle = rotorAngleInterpolate(est, direction, motor->config.hallAngles, nowNs);
+    uint16_t advance = rotorAngleAdvance(motor->config.phaseAdvance, speedEstimatorGetRpm(est),
+                                         MOTOR_SPEED_LIMIT(motor));
+    return direction < 0 ? (uint16_t) (angle - advance) : (uint16_t) (angle + advance);
+}
+
+/**
+ * @brief Get the advanced rotor angle of a motor instance
+ * @param motor Motor handle (Hall commutation or FOC)
+ * @return 16-bit electrical angle including phase advance
+ */
+uint16_t motorInstanceGetRotorAngle(const Motor *motor) {
+    return motorRotorAngle(motor, motorClockNs());
+}
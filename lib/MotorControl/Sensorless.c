@@ -0,0 +1,333 @@
+/**
+ * @file Sensorless.c
+ * @brief Sensorless back-EMF zero-crossing commutation implementation
+ *
+ * The service thread wakes on absolute CLOCK_MONOTONIC deadlines at
+ * SENSORLESS_SAMPLE_HZ. Each wake it takes every sensorless motor's phase
+ * lock, reads the floating and driven terminals, advances the state
+ * machine and, when the scheduled commutation time has passed, switches to
+ * the next step. The sample period is therefore also the commutation timer
+ * resolution.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <wiringPi.h>
+#include "MotorInternal.h"
+#include "MotorClock.h"
+#include "Sensorless.h"
+
+#define NSEC_PER_SEC 1000000000LL
+
+/** @brief Converts RPM to a 60° electrical step period: 60e9 / (6 * polePairs * rpm) */
+#define RPM_STEP_NS 10000000000ULL
+
+/**
+ * @brief One 6-step commutation state
+ */
+typedef struct {
+    uint8_t high;       ///< Phase driven with the PWM duty
+    uint8_t low;        ///< Phase held low
+    uint8_t floating;   ///< Phase left open and sampled
+    int8_t slope;       ///< Expected back-EMF direction on the floating phase
+} SensorlessStep;
+
+static const SensorlessStep steps[6] = {
+    {0, 1, 2, -1},  // A+ B-, C falling
+    {0, 2, 1,  1},  // A+ C-, B rising
+    {1, 2, 0, -1},  // B+ C-, A falling
+    {1, 0, 2,  1},  // B+ A-, C rising
+    {2, 0, 1, -1},  // C+ A-, B falling
+    {2, 1, 0,  1},  // C+ B-, A rising
+};
+
+/** @brief Virtual Hall code per step, in forward Hall order */
+static const uint8_t stepHallState[6] = { 1, 3, 2, 6, 4, 5 };
+
+static pthread_t serviceThread;              ///< Sampling/commutation thread
+static atomic_int serviceRunning = 0;        ///< Thread is alive
+static atomic_int serviceStopRequested = 0;  ///< Ask the thread to exit
+static int attachedMotors = 0;               ///< Sensorless motors in the pool
+
+static uint32_t stepPeriodForRpm(const Motor *motor, uint32_t rpm) {
+    uint32_t polePairs = motor->config.numPoles / 2;
+    if (rpm == 0 || polePairs == 0) return UINT32_MAX;
+    uint64_t period = RPM_STEP_NS / ((uint64_t) rpm * polePairs);
+    return period > UINT32_MAX ? UINT32_MAX : (uint32_t) period;
+}
+
+/** @brief Open-loop duty for the ramp: offset plus voltage proportional to speed */
+static uint16_t rampDuty(const Motor *motor, uint32_t rpm) {
+    uint32_t range = MOTOR_PWM_RANGE(motor);
+    uint32_t duty = range * SENSORLESS_ALIGN_DUTY_PCT / 100u + (range * rpm) / MOTOR_SPEED_LIMIT(motor);
+    return (uint16_t) (duty > range ? range : duty);
+}
+
+/**
+ * @brief Drive the phases for one commutation step
+ * @details Also feeds the virtual Hall code to the speed estimator
+ */
+static void applyStep(Motor *motor, uint8_t step, uint16_t duty, uint64_t nowNs) {
+    const SensorlessStep *s = &steps[step];
+    const int *phasePins = motor->config.phasePins;
+    const int *enablePins = motor->config.enablePins;
+    const PwmBackend *pwm = motor->config.pwm;
+
+    // Open the floating phase before the others switch
+    digitalWrite(enablePins[s->floating], LOW);
+    pwm->write(phasePins[s->floating], 0);
+    pwm->write(phasePins[s->low], 0);
+    pwm->write(phasePins[s->high], duty);
+    digitalWrite(enablePins[s->low], HIGH);
+    digitalWrite(enablePins[s->high], HIGH);
+
+    SensorlessEngine *engine = &motor->sensorless;
+    engine->step = step;
+    engine->lastSign = 0;
+    engine->zcSeen = 0;
+    engine->lastCommutationNs = nowNs;
+    engine->nextCommutationNs = 0;
+    speedEstimatorSample(&motor->speedEstimator, stepHallState[step], nowNs);
+}
+
+static void releasePhases(Motor *motor) {
+    for (int i = 0; i < 3; i++) {
+        digitalWrite(motor->config.enablePins[i], LOW);
+        motor->config.pwm->write(motor->config.phasePins[i], 0);
+    }
+    motor->sensorless.state = SENSORLESS_IDLE;
+}
+
+/**
+ * @brief Sample the floating phase and detect a zero crossing
+ * @return 1 on a crossing in the expected direction, 0 otherwise
+ */
+static int detectZeroCrossing(Motor *motor, uint64_t nowNs) {
+    SensorlessEngine *engine = &motor->sensorless;
+    const SensorlessStep *s = &steps[engine->step];
+
+    // Ignore the demagnetization transient right after commutation
+    uint64_t blankingNs = (uint64_t) engine->stepPeriodNs * SENSORLESS_BLANKING_PCT / 100u;
+    if (nowNs - engine->lastCommutationNs < blankingNs) return 0;
+
+    const AdcBackend *adc = motor->config.adc;
+    int floating = adc->read(motor->config.adcChannels[s->floating]);
+    int driven = adc->read(motor->config.adcChannels[s->high]);
+    if (floating < 0 || driven < 0) return 0;
+
+    // Virtual neutral: midway between the driven high and low terminals
+    int8_t sign = 2 * floating > driven ? 1 : -1;
+    int crossed = engine->lastSign == -s->slope && sign == s->slope;
+    engine->lastSign = sign;
+    return crossed;
+}
+
+static void serviceMotor(Motor *motor, uint64_t nowNs) {
+    SensorlessEngine *engine = &motor->sensorless;
+
+    if (!motor->isRunning) {
+        if (engine->state != SENSORLESS_IDLE) releasePhases(motor);
+        return;
+    }
+
+    switch (engine->state) {
+        case SENSORLESS_IDLE:
+            engine->state = SENSORLESS_ALIGN;
+            engine->stateStartNs = nowNs;
+            engine->confirmed = 0;
+            engine->misses = 0;
+            applyStep(motor, 0, rampDuty(motor, 0), nowNs);
+            break;
+
+        case SENSORLESS_ALIGN:
+            if (nowNs - engine->stateStartNs < (uint64_t) SENSORLESS_ALIGN_MS * 1000000ULL) break;
+            engine->state = SENSORLESS_RAMP;
+            engine->stateStartNs = nowNs;
+            engine->rampRpm = SENSORLESS_START_RPM;
+            engine->stepPeriodNs = stepPeriodForRpm(motor, engine->rampRpm);
+            applyStep(motor, 1, rampDuty(motor, engine->rampRpm), nowNs);
+            break;
+
+        case SENSORLESS_RAMP: {
+            if (detectZeroCrossing(motor, nowNs)) {
+                engine->zcSeen = 1;
+                engine->lastZeroCrossNs = nowNs;
+            }
+            uint64_t elapsed = nowNs - engine->lastCommutationNs;
+            if (elapsed < engine->stepPeriodNs) break;
+
+            engine->confirmed = engine->zcSeen ? engine->confirmed + 1 : 0;
+            if (engine->rampRpm >= SENSORLESS_HANDOVER_RPM && engine->confirmed >= SENSORLESS_CONFIRM_STEPS) {
+                engine->state = SENSORLESS_RUN;
+                engine->misses = 0;
+            } else if (engine->rampRpm < SENSORLESS_HANDOVER_RPM) {
+                engine->rampRpm += (uint32_t) (SENSORLESS_RAMP_RPM_PER_S * elapsed / 1000000000ULL);
+                engine->stepPeriodNs = stepPeriodForRpm(motor, engine->rampRpm);
+            }
+            uint16_t duty = engine->state == SENSORLESS_RUN ?
+                motorHot.duty[motor->index] : rampDuty(motor, engine->rampRpm);
+            applyStep(motor, (uint8_t) ((engine->step + 1) % 6), duty, nowNs);
+            break;
+        }
+
+        case SENSORLESS_RUN: {
+            uint16_t duty = motorHot.duty[motor->index];
+            if (engine->nextCommutationNs != 0 && nowNs >= engine->nextCommutationNs) {
+                applyStep(motor, (uint8_t) ((engine->step + 1) % 6), duty, nowNs);
+                break;
+            }
+            if (!engine->zcSeen && detectZeroCrossing(motor, nowNs)) {
+                // Track the step period from crossing to crossing
+                uint64_t sinceLast = nowNs - engine->lastZeroCrossNs;
+                if (sinceLast < 2ULL * engine->stepPeriodNs) {
+                    engine->stepPeriodNs = (uint32_t) ((engine->stepPeriodNs + sinceLast) / 2);
+                }
+                engine->lastZeroCrossNs = nowNs;
+                engine->zcSeen = 1;
+                engine->misses = 0;
+                // The crossing sits 30° electrical before the commutation point
+                engine->nextCommutationNs = nowNs + engine->stepPeriodNs / 2;
+            } else if (!engine->zcSeen && nowNs - engine->lastCommutationNs > 2ULL * engine->stepPeriodNs) {
+                // No crossing found: step blindly and restart if it keeps happening
+                if (++engine->misses >= SENSORLESS_MAX_MISSES) {
+                    releasePhases(motor);
+                    break;
+                }
+                applyStep(motor, (uint8_t) ((engine->step + 1) % 6), duty, nowNs);
+            } else {
+                // Follow the regulator between commutations
+                motor->config.pwm->write(motor->config.phasePins[steps[engine->step].high], duty);
+            }
+            break;
+        }
+    }
+}
+
+static struct timespec nsToTimespec(int64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+static int64_t monotonicNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void *sensorlessThread(void *arg) {
+    (void) arg;
+    const int64_t periodNs = NSEC_PER_SEC / SENSORLESS_SAMPLE_HZ;
+    int64_t deadline = monotonicNs() + periodNs;
+
+    while (!atomic_load_explicit(&serviceStopRequested, memory_order_relaxed)) {
+        struct timespec wake = nsToTimespec(deadline);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) != 0) {
+            // Interrupted by a signal, sleep again until the same deadline
+        }
+
+        uint64_t now = motorClockNs();
+        for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+            Motor *motor = &motorPool[i];
+            if (!motor->inUse || motor->config.commutationMode != COMMUTATION_SENSORLESS) continue;
+            // Held by the control tick: skip this period rather than wait
+            if (!motorPhaseTryLock(motor)) continue;
+            if (motor->inUse) serviceMotor(motor, now);
+            motorPhaseUnlock(motor);
+        }
+
+        // Skip missed slots rather than sampling late back to back
+        deadline += periodNs;
+        int64_t end = monotonicNs();
+        if (end > deadline) deadline += ((end - deadline) / periodNs + 1) * periodNs;
+    }
+    return NULL;
+}
+
+static int createServiceThread(int realtime) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if (realtime) {
+        struct sched_param param = { .sched_priority = SENSORLESS_PRIORITY };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+    if (SENSORLESS_CPU >= 0 && SENSORLESS_CPU < sysconf(_SC_NPROCESSORS_ONLN)) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(SENSORLESS_CPU, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+
+    int err = pthread_create(&serviceThread, &attr, sensorlessThread, NULL);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+/**
+ * @brief Start servicing a sensorless motor
+ * @param motor Motor created with COMMUTATION_SENSORLESS
+ * @return 0 on success, -1 if the service thread could not be started
+ */
+int sensorlessAttach(Motor *motor) {
+    motor->sensorless = (SensorlessEngine) { .state = SENSORLESS_IDLE };
+    releasePhases(motor);
+
+    if (!atomic_load(&serviceRunning)) {
+        atomic_store(&serviceStopRequested, 0);
+        if (createServiceThread(1) != 0) {
+            printf("SCHED_FIFO not permitted, sensorless service running without real-time priority\n");
+            if (createServiceThread(0) != 0) {
+                printf("Failed to create sensorless service thread\n");
+                return -1;
+            }
+        }
+        atomic_store(&serviceRunning, 1);
+    }
+    attachedMotors++;
+    return 0;
+}
+
+/**
+ * @brief Stop servicing a sensorless motor
+ * @param motor Motor handle
+ */
+void sensorlessDetach(Motor *motor) {
+    releasePhases(motor);
+    if (attachedMotors > 0 && --attachedMotors == 0 && atomic_load(&serviceRunning)) {
+        atomic_store(&serviceStopRequested, 1);
+        pthread_join(serviceThread, NULL);
+        atomic_store(&serviceRunning, 0);
+    }
+}
+
+/**
+ * @brief Virtual Hall code of the current commutation step
+ * @param motor Motor handle
+ * @return Hall code (1-6) following the forward Hall sequence
+ */
+uint8_t sensorlessHallState(const Motor *motor) {
+    return stepHallState[motor->sensorless.step];
+}
+
+/**
+ * @brief Get the sensorless commutation phase of a motor instance
+ * @param motor Motor handle
+ * @return Current phase, SENSORLESS_IDLE for Hall-commutated motors
+ */
+SensorlessState motorInstanceGetSensorlessState(const Motor *motor) {
+    if (motor->config.commutationMode != COMMUTATION_SENSORLESS) return SENSORLESS_IDLE;
+    return motor->sensorless.state;
+}
@@ -0,0 +1,423 @@
+/**
+ * @file SimMotor.c
+ * @brief Simulated BLDC motor plant implementation
+ *
+ * Per integration step, with phase k displaced by k * 120° electrical:
+ *   e_k   = -lambda * we * sin(theta - k * 120°)
+ *   L di_k/dt = u_k - R i_k - e_k        (u_k: terminal voltage minus star point)
+ *   T     = sum(e_k * i_k) / wm
+ *   J dwm/dt = T - B wm - Tload
+ * integrated with explicit Euler at SIM_STEP_NS, which is well inside the
+ * electrical time constant of realistic parameters. Hall edges found
+ * during a step are delivered at that step's simulated time.
+ *
+ * On bridges with low-side control a leg whose gate is off floats: its
+ * current is zero and the star point is set by the driven legs alone.
+ * With a bus capacitance the supply feeds the bus through a diode and
+ * SIM_SUPPLY_RESISTANCE, and the bridge draws sum(d_k * i_k) from it, so
+ * regenerated current charges the capacitor above the supply voltage.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stddef.h>
+#include "SimMotor.h"
+#include "MotorInternal.h"
+
+#define SIM_TWO_PI (2.0 * M_PI)
+#define SIM_SECTOR_RAD (M_PI / 3.0)
+#define SIM_SIN_120 0.86602540378443864676
+
+/** @brief Output resistance of the supply feeding the bus capacitor (ohm) */
+#define SIM_SUPPLY_RESISTANCE 0.05
+
+/** @brief Hall codes in forward rotor order */
+static const uint8_t simHallSequence[6] = { 1, 3, 2, 6, 4, 5 };
+
+/**
+ * @brief Sectors the Hall code is advanced by, so the commutation table
+ * applies a voltage vector 60-120° ahead of the rotor flux
+ */
+#define SIM_HALL_OFFSET 2
+
+struct SimMotor {
+    SimMotorParams params;    ///< Plant parameters
+    uint8_t inUse;            ///< Slot is allocated
+    uint8_t polePairs;        ///< numPoles / 2
+    uint8_t hallState;        ///< Hall code of the current rotor sector
+    int phasePins[3];         ///< GPIOs read by simPwmBackend
+    int hallPins[3];          ///< GPIOs served by simHallBackend
+    int pwmRange;             ///< Duty cycle full scale
+    int duty[3];              ///< Latest duty per phase
+    double current[3];        ///< Phase currents (A)
+    double busVoltage;        ///< Bridge supply voltage (V)
+    double theta;             ///< Rotor electrical angle (rad, 0-2pi)
+    double omega;             ///< Rotor mechanical speed (rad/s)
+    Motor *motor;             ///< Attached motor instance, or NULL
+};
+
+static SimMotor simPool[MOTOR_MAX_INSTANCES];
+static uint64_t simTimeNs = 0;
+
+/* ---------------------------------------------------------------------------
+ * Backends
+ * ------------------------------------------------------------------------- */
+
+static SimMotor *findByPhasePin(int pin, int *phase) {
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        if (!simPool[i].inUse) continue;
+        for (int p = 0; p < 3; p++) {
+            if (simPool[i].phasePins[p] == pin) {
+                *phase = p;
+                return &simPool[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+static SimMotor *findByHallPin(int pinA) {
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        if (simPool[i].inUse && simPool[i].hallPins[0] == pinA) return &simPool[i];
+    }
+    return NULL;
+}
+
+static int simPwmSetup(int pin, int range) {
+    int phase;
+    SimMotor *sim = findByPhasePin(pin, &phase);
+    if (sim == NULL || range <= 0) return -1;
+    sim->duty[phase] = 0;
+    return 0;
+}
+
+static void simPwmWrite(int pin, int value) {
+    int phase;
+    SimMotor *sim = findByPhasePin(pin, &phase);
+    if (sim != NULL) sim->duty[phase] = value;
+}
+
+static void simPwmRelease(int pin) {
+    simPwmWrite(pin, 0);
+}
+
+const PwmBackend simPwmBackend = {
+    .name = "sim",
+    .setup = simPwmSetup,
+    .write = simPwmWrite,
+    .release = simPwmRelease,
+};
+
+static int simHallSetup(int pinA, int pinB, int pinC) {
+    (void) pinB;
+    (void) pinC;
+    return findByHallPin(pinA) != NULL ? 0 : -1;
+}
+
+static uint8_t simHallRead(int pinA, int pinB, int pinC) {
+    (void) pinB;
+    (void) pinC;
+    SimMotor *sim = findByHallPin(pinA);
+    return sim != NULL ? sim->hallState : 0;
+}
+
+const HallBackend simHallBackend = {
+    .name = "sim",
+    .setup = simHallSetup,
+    .read = simHallRead,
+};
+
+/* ---------------------------------------------------------------------------
+ * Plant model
+ * ------------------------------------------------------------------------- */
+
+static uint8_t hallFromAngle(double theta) {
+    int sector = (int) (theta / SIM_SECTOR_RAD);
+    if (sector > 5) sector = 5;
+    return simHallSequence[(sector + SIM_HALL_OFFSET) % 6];
+}
+
+/**
+ * @brief Check whether a phase leg is connected to the bus or ground
+ * @details Bridges without low-side control and service-driven motors
+ * always drive every leg. A 3PWM leg is driven while enabled, a 6PWM leg
+ * while either switch is on.
+ */
+static int legDriven(const SimMotor *sim, int phase) {
+    const Motor *motor = sim->motor;
+    if (motor == NULL || !motor->inUse || motor->config.bridge == BRIDGE_HIGH_SIDE ||
+        motor->config.commutationMode == COMMUTATION_SENSORLESS ||
+        motor->config.commutationMode == COMMUTATION_FOC) {
+        return 1;
+    }
+    int gateOn = motor->commutation.appliedGate[phase] > 0;
+    return motor->config.bridge == BRIDGE_3PWM ? gateOn : gateOn || sim->duty[phase] > 0;
+}
+
+/**
+ * @brief Advance the bus capacitor voltage
+ * @param busCurrent Current drawn by the bridge (A), negative while regenerating
+ * @details While the supply conducts the bus settles exponentially towards
+ * its loaded output voltage, which stays stable for any step; once the
+ * bus rises above the supply the diode blocks and only the bridge current
+ * moves it.
+ */
+static void stepBus(SimMotor *sim, double busCurrent, double dt) {
+    const SimMotorParams *p = &sim->params;
+    double loaded = p->supplyVoltage - busCurrent * SIM_SUPPLY_RESISTANCE;
+    double decay = exp(-dt / (SIM_SUPPLY_RESISTANCE * p->busCapacitance));
+    double bus = loaded + (sim->busVoltage - loaded) * decay;
+    if (bus > p->supplyVoltage) {
+        bus = sim->busVoltage - busCurrent * dt / p->busCapacitance;
+    }
+    sim->busVoltage = bus;
+}
+
+/**
+ * @brief Advance one motor by one integration step
+ * @return 1 if the Hall code changed, 0 otherwise
+ */
+static int simStep(SimMotor *sim, double dt) {
+    const SimMotorParams *p = &sim->params;
+    double omegaE = sim->omega * sim->polePairs;
+
+    // sin(theta - k * 120°) for the three phases
+    double s, c;
+    sincos(sim->theta, &s, &c);
+    double shape[3] = { s, -0.5 * s - SIM_SIN_120 * c, -0.5 * s + SIM_SIN_120 * c };
+
+    // Averaged terminal voltages of the driven legs
+    double v[3];
+    double emf[3];
+    int driven[3];
+    int drivenCount = 0;
+    double starSum = 0.0;
+    double voltsPerCount = sim->busVoltage / sim->pwmRange;
+    for (int k = 0; k < 3; k++) {
+        v[k] = voltsPerCount * sim->duty[k];
+        emf[k] = -p->fluxLinkage * omegaE * shape[k];
+        driven[k] = legDriven(sim, k);
+        if (driven[k]) {
+            starSum += v[k] - emf[k];
+            drivenCount++;
+        }
+    }
+
+    double dtOverL = dt / p->inductance;
+    double torque = 0.0;
+    double currentSum = 0.0;
+    double star = drivenCount > 0 ? starSum / drivenCount : 0.0;
+    for (int k = 0; k < 3; k++) {
+        if (driven[k] && drivenCount >= 2) {
+            sim->current[k] += (v[k] - star - p->resistance * sim->current[k] - emf[k]) * dtOverL;
+        } else {
+            sim->current[k] = 0.0;
+        }
+        currentSum += sim->current[k];
+    }
+    // Star connection: the phase currents sum to zero
+    double busCurrent = 0.0;
+    for (int k = 0; k < 3; k++) {
+        if (driven[k] && drivenCount >= 2) sim->current[k] -= currentSum / drivenCount;
+        torque -= sim->polePairs * p->fluxLinkage * shape[k] * sim->current[k];
+        busCurrent += (double) sim->duty[k] / sim->pwmRange * sim->current[k];
+    }
+    if (p->busCapacitance > 0.0) stepBus(sim, busCurrent, dt);
+
+    // Load and friction oppose motion; at standstill the load holds until overcome
+    double load = p->loadTorque;
+    if (sim->omega == 0.0 && fabs(torque) <= load) {
+        load = torque;
+    } else if (sim->omega < 0.0 || (sim->omega == 0.0 && torque < 0.0)) {
+        load = -load;
+    }
+    double previous = sim->omega;
+    sim->omega += (torque - p->friction * sim->omega - load) / p->inertia * dt;
+    if ((previous > 0.0 && sim->omega < 0.0) || (previous < 0.0 && sim->omega > 0.0)) {
+        sim->omega = 0.0;  // Coulomb load cannot reverse the rotor by itself
+    }
+
+    // One step moves far less than a revolution, a single wrap is enough
+    sim->theta += sim->omega * sim->polePairs * dt;
+    if (sim->theta >= SIM_TWO_PI) {
+        sim->theta -= SIM_TWO_PI;
+    } else if (sim->theta < 0.0) {
+        sim->theta += SIM_TWO_PI;
+    }
+
+    uint8_t hallState = hallFromAngle(sim->theta);
+    int edge = hallState != sim->hallState;
+    sim->hallState = hallState;
+    return edge;
+}
+
+/* ---------------------------------------------------------------------------
+ * Public interface
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Fill parameters for a small 24V motor matching MOTOR_MAX_RPM
+ * @param params Parameters to initialize
+ * @details No-load speed at full duty is roughly 20% above MOTOR_MAX_RPM.
+ */
+void simDefaultParams(SimMotorParams *params) {
+    double noLoadOmegaE = 1.2 * MOTOR_MAX_RPM * (2.0 * M_PI / 60.0) * (NUM_POLES / 2);
+
+    params->resistance = 0.5;
+    params->inductance = 0.0005;
+    params->fluxLinkage = (2.0 / 3.0) * MOTOR_VOLTAGE / noLoadOmegaE;
+    params->inertia = 0.00002;
+    params->friction = 0.000005;
+    params->loadTorque = 0.005;
+    params->supplyVoltage = MOTOR_VOLTAGE;
+    params->busCapacitance = 0.0;
+}
+
+/**
+ * @brief Create a simulated motor on the pins of a motor configuration
+ * @param params Plant parameters, or NULL for simDefaultParams()
+ * @param config Motor configuration; its pwm/hall backends are replaced
+ *               with simPwmBackend/simHallBackend
+ * @return Simulated motor, or NULL if all MOTOR_MAX_INSTANCES are in use
+ */
+SimMotor *simMotorCreate(const SimMotorParams *params, MotorConfig *config) {
+    SimMotor *sim = NULL;
+    for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+        if (!simPool[i].inUse) {
+            sim = &simPool[i];
+            break;
+        }
+    }
+    if (sim == NULL || config == NULL || config->numPoles < 2) return NULL;
+
+    *sim = (SimMotor) { 0 };
+    if (params != NULL) {
+        sim->params = *params;
+    } else {
+        simDefaultParams(&sim->params);
+    }
+    for (int i = 0; i < 3; i++) {
+        sim->phasePins[i] = config->phasePins[i];
+        sim->hallPins[i] = config->hallPins[i];
+    }
+    sim->pwmRange = config->pwmRange;
+    sim->busVoltage = sim->params.supplyVoltage;
+    sim->polePairs = config->numPoles / 2;
+    sim->hallState = hallFromAngle(0.0);
+    sim->inUse = 1;
+
+    config->pwm = &simPwmBackend;
+    config->hall = &simHallBackend;
+    return sim;
+}
+
+/**
+ * @brief Release a simulated motor
+ * @param sim Simulated motor
+ */
+void simMotorDestroy(SimMotor *sim) {
+    if (sim != NULL) sim->inUse = 0;
+}
+
+/**
+ * @brief Connect the plant to the motor instance driving it
+ * @param sim Simulated motor
+ * @param motor Motor created from the configuration passed to simMotorCreate()
+ * @note Also enables motorSetExternalTick(), as simRun() drives the tick
+ */
+void simMotorAttach(SimMotor *sim, Motor *motor) {
+    sim->motor = motor;
+    // simRun() drives the control tick, so speed changes should ramp
+    motorSetExternalTick(1);
+}
+
+/**
+ * @brief Set the load torque
+ * @param sim Simulated motor
+ * @param torque Load torque opposing motion (N m)
+ */
+void simMotorSetLoadTorque(SimMotor *sim, double torque) {
+    sim->params.loadTorque = torque;
+}
+
+/**
+ * @brief Get the simulated rotor speed
+ * @param sim Simulated motor
+ * @return Mechanical speed in RPM (negative when turning backwards)
+ */
+double simMotorGetRpm(const SimMotor *sim) {
+    return sim->omega * 60.0 / (2.0 * M_PI);
+}
+
+/**
+ * @brief Get the simulated phase current magnitude
+ * @param sim Simulated motor
+ * @return Peak of the three phase currents (A)
+ */
+double simMotorGetCurrent(const SimMotor *sim) {
+    double peak = 0.0;
+    for (int k = 0; k < 3; k++) {
+        if (fabs(sim->current[k]) > peak) peak = fabs(sim->current[k]);
+    }
+    return peak;
+}
+
+/**
+ * @brief Get the simulated bus voltage
+ * @param sim Simulated motor
+ * @return Voltage across the bus capacitor, or the supply voltage without one (V)
+ */
+double simMotorGetBusVoltage(const SimMotor *sim) {
+    return sim->busVoltage;
+}
+
+/**
+ * @brief Simulated time
+ * @return Nanoseconds of simulated time, for motorClockSetSource()
+ */
+uint64_t simClockNs(void) {
+    return simTimeNs;
+}
+
+/**
+ * @brief Advance every simulated motor
+ * @param durationNs Simulated time to advance
+ */
+void simAdvance(uint64_t durationNs) {
+    const double dt = SIM_STEP_NS * 1e-9;
+    uint64_t end = simTimeNs + durationNs;
+
+    while (simTimeNs + SIM_STEP_NS <= end) {
+        simTimeNs += SIM_STEP_NS;
+        for (int i = 0; i < MOTOR_MAX_INSTANCES; i++) {
+            SimMotor *sim = &simPool[i];
+            if (!sim->inUse || !simStep(sim, dt)) continue;
+
+            // Deliver the edge the way the Hall interrupt would
+            Motor *motor = sim->motor;
+            if (motor != NULL && motor->inUse &&
+                motor->config.commutationMode == COMMUTATION_INTERRUPT) {
+                motorInstanceUpdateCommutation(motor);
+            }
+        }
+    }
+    simTimeNs = end;
+}
+
+/**
+ * @brief Run the controller against the simulation
+ * @param durationNs Simulated time to run
+ * @param tickNs Control tick period; motorControlTick() runs after each
+ */
+void simRun(uint64_t durationNs, uint32_t tickNs) {
+    if (tickNs == 0) return;
+
+    for (uint64_t elapsed = 0; elapsed + tickNs <= durationNs; elapsed += tickNs) {
+        simAdvance(tickNs);
+        motorControlTick();
+    }
+}
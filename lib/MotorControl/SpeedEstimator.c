@@ -0,0 +1,119 @@
+/**
+ * @file SpeedEstimator.c
+ * @brief Hall edge based rotor speed measurement
+ *
+ * Speed conversion:
+ *   one electrical revolution = 6 sectors
+ *   one mechanical revolution = polePairs electrical revolutions
+ *   RPM = 60e9 / (sectorNs * 6 * polePairs) = 1e10 / (sectorNs * polePairs)
+ *
+ * A moving sum over the last SPEED_FILTER_SECTORS periods keeps the update
+ * at one add, one subtract and one division per edge.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <string.h>
+#include "SpeedEstimator.h"
+
+/** @brief 60e9 ns/min divided by 6 sectors per electrical revolution */
+#define RPM_SECTOR_NS 10000000000ULL
+
+static uint16_t clampRpm(uint64_t rpm) {
+    return rpm > UINT16_MAX ? UINT16_MAX : (uint16_t) rpm;
+}
+
+static void resetFilter(SpeedEstimator *est) {
+    est->periodSum = 0;
+    est->index = 0;
+    est->count = 0;
+    est->rpm = 0;
+}
+
+/**
+ * @brief Initialize a speed estimator
+ * @param est Estimator to initialize
+ * @param numPoles Number of motor poles (e.g. NUM_POLES)
+ * @param timeoutNs Time without edges after which speed is reported as 0
+ */
+void speedEstimatorInit(SpeedEstimator *est, uint8_t numPoles, uint32_t timeoutNs) {
+    memset(est, 0, sizeof(*est));
+    est->polePairs = numPoles >= 2 ? numPoles / 2 : 1;
+    est->timeoutNs = timeoutNs;
+}
+
+/**
+ * @brief Feed a Hall sample
+ * @param est Estimator
+ * @param hallState Packed Hall state (1-6 valid)
+ * @param nowNs Sample timestamp from motorClockNs()
+ * @details A change of state is recorded as an edge; invalid states are ignored
+ */
+void speedEstimatorSample(SpeedEstimator *est, uint8_t hallState, uint64_t nowNs) {
+    if (hallState == 0 || hallState == 7 || hallState == est->lastHallState) return;
+
+    uint8_t firstEdge = est->lastHallState == 0;
+    uint64_t elapsed = nowNs - est->lastEdgeNs;
+    est->lastHallState = hallState;
+    est->lastEdgeNs = nowNs;
+
+    // The first edge after standstill only starts the next period
+    if (firstEdge || elapsed > est->timeoutNs) {
+        resetFilter(est);
+        return;
+    }
+
+    if (est->count == SPEED_FILTER_SECTORS) {
+        est->periodSum -= est->periods[est->index];
+    } else {
+        est->count++;
+    }
+    est->periods[est->index] = (uint32_t) elapsed;
+    est->periodSum += elapsed;
+    est->index = (uint8_t) ((est->index + 1) % SPEED_FILTER_SECTORS);
+
+    est->rpm = clampRpm((RPM_SECTOR_NS * est->count) / (est->periodSum * est->polePairs));
+}
+
+/**
+ * @brief Apply the zero-speed timeout and between-edge decay
+ * @param est Estimator
+ * @param nowNs Current time from motorClockNs()
+ * @note Call periodically (e.g. every control loop tick)
+ */
+void speedEstimatorUpdate(SpeedEstimator *est, uint64_t nowNs) {
+    // An edge sampled by a handler after this tick read the clock may lie past nowNs
+    if (est->count == 0 || nowNs <= est->lastEdgeNs) return;
+
+    uint64_t elapsed = nowNs - est->lastEdgeNs;
+    if (elapsed > est->timeoutNs) {
+        resetFilter(est);
+        return;
+    }
+
+    // The rotor cannot be faster than a sector completing right now
+    if (elapsed * est->count > est->periodSum) {
+        uint16_t bound = clampRpm(RPM_SECTOR_NS / (elapsed * est->polePairs));
+        if (bound < est->rpm) est->rpm = bound;
+    }
+}
+
+/**
+ * @brief Get the latest speed estimate
+ * @param est Estimator
+ * @return Mechanical speed in RPM
+ */
+uint16_t speedEstimatorGetRpm(const SpeedEstimator *est) {
+    return est->rpm;
+}
+
+/**
+ * @brief Get the averaged electrical sector period
+ * @param est Estimator
+ * @return Average time per 60° electrical sector in ns, 0 if not rotating
+ */
+uint32_t speedEstimatorGetSectorPeriodNs(const SpeedEstimator *est) {
+    return est->count ? (uint32_t) (est->periodSum / est->count) : 0;
+}
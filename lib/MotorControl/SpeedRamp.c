@@ -0,0 +1,136 @@
+/**
+ * @file SpeedRamp.c
+ * @brief Jerk-limited speed setpoint ramp implementation
+ *
+ * With a jerk limit J and current acceleration a, ramping the acceleration
+ * out to zero still changes the speed by a^2 / (2J). Each update compares
+ * the remaining speed error against that amount to decide whether to keep
+ * building acceleration towards the limit or start easing out of it.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdlib.h>
+#include "SpeedRamp.h"
+
+#define NSEC_PER_SEC 1000000000LL
+
+static int64_t sign(int64_t v) {
+    return (v > 0) - (v < 0);
+}
+
+/** @brief Move value towards goal by at most step */
+static int64_t slew(int64_t value, int64_t goal, int64_t step) {
+    if (value < goal) return value + step < goal ? value + step : goal;
+    if (value > goal) return value - step > goal ? value - step : goal;
+    return value;
+}
+
+/**
+ * @brief Initialize a ramp at rest
+ * @param ramp Ramp to initialize
+ * @param accelRpmPerSec Acceleration limit, at least 1
+ * @param jerkRpmPerSec2 Jerk limit, 0 for a trapezoidal profile
+ */
+void speedRampInit(SpeedRamp *ramp, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2) {
+    speedRampSetLimits(ramp, accelRpmPerSec, jerkRpmPerSec2);
+    speedRampReset(ramp, 0);
+}
+
+/**
+ * @brief Change the ramp limits
+ * @param ramp Ramp
+ * @param accelRpmPerSec Acceleration limit, 1 to UINT32_MAX
+ * @param jerkRpmPerSec2 Jerk limit, 0 for a trapezoidal profile
+ * @return 0 on success, -1 if accelRpmPerSec is 0 (the limits are left unchanged)
+ */
+int speedRampSetLimits(SpeedRamp *ramp, uint32_t accelRpmPerSec, uint32_t jerkRpmPerSec2) {
+    if (accelRpmPerSec == 0) return -1;
+    ramp->maxAccel = (int64_t) accelRpmPerSec << 16;
+    ramp->jerk = (int64_t) jerkRpmPerSec2 << 16;
+    return 0;
+}
+
+/**
+ * @brief Set the speed the profile should reach
+ * @param ramp Ramp
+ * @param rpm Target speed
+ */
+void speedRampSetTarget(SpeedRamp *ramp, int32_t rpm) {
+    ramp->target = rpm;
+}
+
+/**
+ * @brief Jump the profile to a speed with zero acceleration
+ * @param ramp Ramp
+ * @param rpm Speed to continue from (also becomes the target)
+ */
+void speedRampReset(SpeedRamp *ramp, int32_t rpm) {
+    ramp->speed = (int64_t) rpm << 16;
+    ramp->accel = 0;
+    ramp->target = rpm;
+}
+
+/**
+ * @brief Advance the profile
+ * @param ramp Ramp
+ * @param dtNs Time since the previous update
+ * @return Profile speed in RPM
+ */
+int32_t speedRampUpdate(SpeedRamp *ramp, uint32_t dtNs) {
+    int64_t target = (int64_t) ramp->target << 16;
+    int64_t error = target - ramp->speed;
+    int64_t dir = sign(error);
+
+    if (dir == 0) {
+        ramp->accel = 0;
+        return ramp->target;
+    }
+
+    if (ramp->jerk == 0) {
+        ramp->accel = dir * ramp->maxAccel;
+    } else {
+        int64_t step = ramp->jerk * dtNs / NSEC_PER_SEC;
+        if (step == 0) step = 1;
+
+        // Speed still gained if the acceleration were ramped out from here
+        int64_t absAccel = llabs(ramp->accel);
+        int64_t easeTimeQ16 = (absAccel << 16) / (2 * ramp->jerk);
+        int64_t easeDelta = (absAccel * easeTimeQ16) >> 16;
+
+        if (sign(ramp->accel) == dir && llabs(error) <= easeDelta) {
+            ramp->accel = slew(ramp->accel, 0, step);
+        } else {
+            ramp->accel = slew(ramp->accel, dir * ramp->maxAccel, step);
+        }
+    }
+
+    ramp->speed += ramp->accel * dtNs / NSEC_PER_SEC;
+
+    // Land exactly on the target rather than oscillating around it
+    if (sign(target - ramp->speed) != dir) {
+        ramp->speed = target;
+        ramp->accel = 0;
+    }
+    return speedRampGetSpeed(ramp);
+}
+
+/**
+ * @brief Get the current profile speed
+ * @param ramp Ramp
+ * @return Profile speed in RPM
+ */
+int32_t speedRampGetSpeed(const SpeedRamp *ramp) {
+    return (int32_t) ((ramp->speed + 0x8000) >> 16);
+}
+
+/**
+ * @brief Check whether the profile has reached its target
+ * @param ramp Ramp
+ * @return 1 if settled at the target, 0 while ramping
+ */
+int speedRampIsSettled(const SpeedRamp *ramp) {
+    return ramp->speed == ((int64_t) ramp->target << 16) && ramp->accel == 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file Telemetry.c
+ * @brief Lock-free telemetry ring exported through shared memory
+ *
+ * The writer claims a slot by making its sequence word odd, copies the
+ * sample, then publishes it with a release store of the final even value
+ * and advances the head. Readers take a seqlock-style snapshot of the slot
+ * and accept it only if the sequence word matches the index they expect,
+ * which rejects both torn copies and slots that were already overwritten.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Telemetry.h"
+
+static TelemetryHeader *ringHeader = NULL;   ///< Mapped header (writer side)
+static TelemetrySlot *ringSlots = NULL;      ///< Mapped ring (writer side)
+static uint32_t ringMask = 0;                ///< capacity - 1
+static size_t ringMapSize = 0;               ///< Mapping length
+static char ringName[64];                    ///< Object name for shm_unlink
+
+static size_t ringSize(uint32_t capacity) {
+    return sizeof(TelemetryHeader) + (size_t) capacity * sizeof(TelemetrySlot);
+}
+
+/**
+ * @brief Create the shared memory ring and start recording
+ * @param name Shared memory object name, or NULL for TELEMETRY_SHM_NAME
+ * @param capacity Ring size in samples (power of two), or 0 for TELEMETRY_CAPACITY
+ * @return 0 on success, -1 on failure
+ */
+int telemetryOpen(const char *name, uint32_t capacity) {
+    if (ringHeader != NULL) return -1;
+    if (name == NULL) name = TELEMETRY_SHM_NAME;
+    if (capacity == 0) capacity = TELEMETRY_CAPACITY;
+    if ((capacity & (capacity - 1)) != 0) {
+        printf("Telemetry capacity %u is not a power of two\n", capacity);
+        return -1;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("Failed to create telemetry object %s\n", name);
+        return -1;
+    }
+    size_t size = ringSize(capacity);
+    if (ftruncate(fd, (off_t) size) != 0) {
+        printf("Failed to size telemetry object %s\n", name);
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("Failed to map telemetry object %s\n", name);
+        shm_unlink(name);
+        return -1;
+    }
+
+    // Fault every page in now so the control loop never does
+    memset(map, 0, size);
+    mlock(map, size);
+
+    TelemetryHeader *header = map;
+    header->magic = TELEMETRY_MAGIC;
+    header->version = TELEMETRY_VERSION;
+    header->slotSize = sizeof(TelemetrySlot);
+    header->capacity = capacity;
+    atomic_init(&header->head, 0);
+
+    snprintf(ringName, sizeof(ringName), "%s", name);
+    ringSlots = (TelemetrySlot *) ((uint8_t *) map + sizeof(TelemetryHeader));
+    ringMask = capacity - 1;
+    ringMapSize = size;
+    ringHeader = header;
+    return 0;
+}
+
+/**
+ * @brief Stop recording and remove the shared memory object
+ * @note Call with the control loop stopped
+ */
+void telemetryClose(void) {
+    if (ringHeader == NULL) return;
+
+    munmap(ringHeader, ringMapSize);
+    shm_unlink(ringName);
+    ringHeader = NULL;
+    ringSlots = NULL;
+}
+
+/**
+ * @brief Check whether telemetry is being recorded
+ * @return 1 if open, 0 otherwise
+ */
+int telemetryIsOpen(void) {
+    return ringHeader != NULL;
+}
+
+/**
+ * @brief Append a sample (control loop thread only)
+ * @param sample Sample to copy into the ring
+ * @note Never blocks; does nothing if telemetry is not open
+ */
+void telemetryPush(const TelemetrySample *sample) {
+    if (ringHeader == NULL) return;
+
+    uint32_t index = atomic_load_explicit(&ringHeader->head, memory_order_relaxed);
+    TelemetrySlot *slot = &ringSlots[index & ringMask];
+
+    atomic_store_explicit(&slot->seq, 2u * index + 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->sample = *sample;
+    atomic_store_explicit(&slot->seq, 2u * (index + 1u), memory_order_release);
+    atomic_store_explicit(&ringHeader->head, index + 1u, memory_order_release);
+}
+
+/**
+ * @brief Map an existing ring for reading
+ * @param reader Reader handle to initialize
+ * @param name Shared memory object name, or NULL for TELEMETRY_SHM_NAME
+ * @return 0 on success, -1 on failure
+ * @note The cursor starts at the newest sample; older ones are not replayed
+ */
+int telemetryReaderOpen(TelemetryReader *reader, const char *name) {
+    if (name == NULL) name = TELEMETRY_SHM_NAME;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("Telemetry object %s not found\n", name);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TelemetryHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const TelemetryHeader *header = map;
+    if (header->magic != TELEMETRY_MAGIC || header->version != TELEMETRY_VERSION ||
+        header->slotSize != sizeof(TelemetrySlot) ||
+        ringSize(header->capacity) > (size_t) st.st_size) {
+        printf("Telemetry object %s has an incompatible layout\n", name);
+        munmap(map, (size_t) st.st_size);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->slots = (const TelemetrySlot *) ((const uint8_t *) map + sizeof(TelemetryHeader));
+    reader->cursor = atomic_load_explicit(&header->head, memory_order_acquire);
+    reader->lost = 0;
+    reader->mapSize = (uint32_t) st.st_size;
+    return 0;
+}
+
+/**
+ * @brief Read the next sample
+ * @param reader Reader handle
+ * @param sample Destination for the sample
+ * @return 1 if a sample was read, 0 if none is available yet
+ */
+int telemetryReaderNext(TelemetryReader *reader, TelemetrySample *sample) {
+    const uint32_t capacity = reader->header->capacity;
+
+    for (;;) {
+        uint32_t head = atomic_load_explicit(
+            (atomic_uint *) &reader->header->head, memory_order_acquire);
+        if (head == reader->cursor) return 0;
+
+        // Lapped by the writer: jump to the oldest slot still intact
+        if (head - reader->cursor > capacity) {
+            reader->lost += head - reader->cursor - capacity;
+            reader->cursor = head - capacity;
+        }
+
+        const TelemetrySlot *slot = &reader->slots[reader->cursor & (capacity - 1)];
+        uint32_t expected = 2u * (reader->cursor + 1u);
+        uint32_t seq = atomic_load_explicit((atomic_uint *) &slot->seq, memory_order_acquire);
+        *sample = slot->sample;
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t check = atomic_load_explicit((atomic_uint *) &slot->seq, memory_order_relaxed);
+
+        if (seq == expected && check == expected) {
+            reader->cursor++;
+            return 1;
+        }
+        // Overwritten while we looked at it; re-evaluate against the new head
+        reader->lost++;
+        reader->cursor++;
+    }
+}
+
+/**
+ * @brief Unmap a reader
+ * @param reader Reader handle
+ */
+void telemetryReaderClose(TelemetryReader *reader) {
+    if (reader->header == NULL) return;
+
+    munmap((void *) reader->header, reader->mapSize);
+    reader->header = NULL;
+    reader->slots = NULL;
+}
@@ -17,7 +17,15 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <poll.h>
 #include "MotorControl.h"
+#include "ControlLoop.h"
+#include "Telemetry.h"
+#include "MotorTiming.h"
+#include "Protection.h"
+#include "MotorEvents.h"
+#include "Brake.h"
+#include "MotorServer.h"
 
 /** @brief Flag to control program execution */
 volatile uint8_t running = 1;
@@ -31,11 +39,125 @@ void signalHandler(int signum) {
     running = 0;
 }
 
+/**
+ * @brief Print the ramp setpoint and measured speed
+ */
+static void reportSpeed(void) {
+    printf("Setpoint %d RPM (measured %d RPM)\n", motorGetRampSpeed(), motorGetSpeed());
+}
+
+/**
+ * @brief Check whether the test sequence should continue
+ * @return 0 after a signal or an overcurrent trip
+ */
+static int keepRunning(void) {
+    return running && motorGetFault() == MOTOR_FAULT_NONE;
+}
+
+/**
+ * @brief Wait for the motor to reach its target, reporting progress
+ * @details Sleeps on the motor event descriptor; the poll timeout paces the
+ *          progress report. Without a descriptor poll() still times out and
+ *          the pending events are checked the same way.
+ */
+static void waitForTarget(void) {
+    struct pollfd pfd = { .fd = motorEventFd(), .events = POLLIN };
+    while (keepRunning()) {
+        reportSpeed();
+        poll(&pfd, 1, 500);  // 500ms reporting interval; EINTR on a signal
+        if (motorTakeEvents() & MOTOR_EVENT_SPEED_REACHED) break;
+    }
+}
+
+/**
+ * @brief Wait for braking to bring the motor to rest, reporting progress
+ */
+static void waitForStop(void) {
+    struct pollfd pfd = { .fd = motorEventFd(), .events = POLLIN };
+    while (keepRunning() && motorGetBrakeMode() != BRAKE_COAST) {
+        reportSpeed();
+        poll(&pfd, 1, 500);  // Woken early by MOTOR_EVENT_STOPPED
+        motorTakeEvents();
+    }
+}
+
+/**
+ * @brief Print latency percentiles for every instrumented interval
+ */
+static void reportTiming(void) {
+    static const char *const names[TIMING_CHANNEL_COUNT] = {
+        "wake latency", "tick compute", "commutation", "edge to PWM", "fault trip"
+    };
+    static MotorTimingStats stats;
+    motorGetTimingStats(&stats);
+
+    printf("Timing (%s, ns):\n", stats.cycleCounter ? "PMU cycle counter" : "CLOCK_MONOTONIC_RAW");
+    for (int c = 0; c < TIMING_CHANNEL_COUNT; c++) {
+        const TimingHistogram *hist = &stats.channel[c];
+        if (hist->count == 0) continue;
+        printf("  %-13s n=%llu min=%u p50=%u p99=%u p99.9=%u max=%u\n", names[c],
+               (unsigned long long) hist->count, hist->minNs,
+               timingHistogramPercentile(hist, 50.0),
+               timingHistogramPercentile(hist, 99.0),
+               timingHistogramPercentile(hist, 99.9),
+               hist->maxNs);
+    }
+    printf("  deadline misses: %llu\n", (unsigned long long) stats.deadlineMisses);
+}
+
+/**
+ * @brief Stop the control loop and the motor, then report
+ * @details Shared by every exit path once the control loop has started, so
+ * the timing statistics are printed however the program ends.
+ */
+static void shutdownMotor(void) {
+    controlLoopStop();
+    motorStop();
+    telemetryClose();
+    printf("Motor stopped\n");
+    if (motorGetFault() != MOTOR_FAULT_NONE) {
+        printf("Motor fault latched (code %d)\n", motorGetFault());
+    }
+    reportTiming();
+}
+
+/**
+ * @brief Serve network clients until a signal arrives
+ * @param port UDP port
+ * @return 0 on a clean shutdown, 1 if the server failed to start
+ */
+static int serveNetwork(uint16_t port) {
+    MotorServerConfig config;
+    motorServerDefaultConfig(&config);
+    config.port = port;
+    if (motorServerStart(&config) != 0) return 1;
+
+    printf("Serving motor commands on UDP port %u\n", motorServerGetPort());
+    while (running) {
+        sleep(1);
+    }
+    motorServerStop();
+    return 0;
+}
+
 /**
  * @brief Main program entry point
+ * @param argc Argument count
+ * @param argv "-p port" serves network clients instead of running the test sequence
  * @return 0 on successful execution, non-zero on error
  */
-int main(void) {
+int main(int argc, char **argv) {
+    int serverPort = -1;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:")) != -1) {
+        if (opt == 'p') {
+            serverPort = atoi(optarg);
+        } else {
+            printf("Usage: %s [-p udp-port]\n", argv[0]);
+            return 1;
+        }
+    }
+
     /* System initialization */
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
@@ -44,40 +166,51 @@ int main(void) {
     motorInit();
     printf("Motor control initialized\n");
 
+    /* Live samples for external tools; the test runs without them */
+    if (telemetryOpen(NULL, 0) != 0) {
+        printf("Telemetry unavailable\n");
+    }
+
+    /* Closed-loop servicing runs on its own real-time thread */
+    if (controlLoopStart(NULL) != 0) {
+        printf("Control loop failed to start\n");
+        return 1;
+    }
+
+    /* Remote control: the network front end drives the motors */
+    if (serverPort >= 0) {
+        int status = serveNetwork((uint16_t) serverPort);
+        shutdownMotor();
+        return status;
+    }
+
     /* TEST SEQUENCE 1: Ramp-up phase */
     printf("Starting motor ramp-up test...\n");
     motorStart();
+    motorTakeEvents();
+    motorSetSpeed(MOTOR_MAX_RPM);  // Returns at once, the control loop ramps
     
-    uint16_t speed = 0;
-    const uint16_t speedStep = 100;  // RPM increment per step
-    
-    /* Gradual speed increase loop */
-    while (running && speed < MOTOR_MAX_RPM) {
-        motorSetSpeed(speed);
-        printf("Setting speed to %d RPM\n", speed);
-        speed += speedStep;
-        usleep(500000);  // 500ms control loop interval
-    }
+    /* Report progress while the profile is followed */
+    waitForTarget();
 
     /* TEST SEQUENCE 2: Maximum speed test */
-    if (running) {
+    if (keepRunning()) {
         printf("Running at max speed for 5 seconds...\n");
-        motorSetSpeed(MOTOR_MAX_RPM);
         sleep(5);  // Sustained maximum speed test
     }
 
-    /* TEST SEQUENCE 3: Ramp-down phase */
-    printf("Ramping down...\n");
-    while (running && speed > 0) {
-        speed -= speedStep;
-        motorSetSpeed(speed);
-        printf("Setting speed to %d RPM\n", speed);
-        usleep(500000);  // Controlled deceleration interval
+    /* TEST SEQUENCE 3: Braking phase, ramping down where the bridge cannot brake */
+    if (motorBrake(BRAKE_REGEN) == 0) {
+        printf("Braking...\n");
+        waitForStop();
+    } else {
+        printf("Ramping down...\n");
+        motorSetSpeed(0);
+        waitForTarget();
     }
 
     /* System shutdown sequence */
-    motorStop();
-    printf("Motor stopped\n");
+    shutdownMotor();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * @file MockWiringPi.c
+ * @brief Mock WiringPi implementation for off-target tests and benchmarks
+ *
+ * No hardware is touched. piLock() and piUnlock() are real mutexes so the
+ * library keeps its locking behaviour under test.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <pthread.h>
+#include "wiringPi.h"
+#include "softPwm.h"
+#include "wiringPiSPI.h"
+
+#define MOCK_LOCK_KEYS 4
+
+int mockGpioLevel[MOCK_GPIO_COUNT];
+int mockGpioOutput[MOCK_GPIO_COUNT];
+void (*mockGpioIsr[MOCK_GPIO_COUNT])(void);
+unsigned char mockSpiResponse[MOCK_SPI_MAX_LEN];
+
+static pthread_mutex_t mockLocks[MOCK_LOCK_KEYS] = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int validPin(int pin) {
+    return pin >= 0 && pin < MOCK_GPIO_COUNT;
+}
+
+int wiringPiSetupGpio(void) {
+    return 0;
+}
+
+void pinMode(int pin, int mode) {
+    (void) pin;
+    (void) mode;
+}
+
+void pullUpDnControl(int pin, int pud) {
+    if (validPin(pin) && pud == PUD_UP) mockGpioLevel[pin] = HIGH;
+}
+
+int digitalRead(int pin) {
+    return validPin(pin) ? mockGpioLevel[pin] : LOW;
+}
+
+void digitalWrite(int pin, int value) {
+    if (validPin(pin)) mockGpioOutput[pin] = value;
+}
+
+int wiringPiISR(int pin, int mode, void (*function)(void)) {
+    (void) mode;
+    if (!validPin(pin)) return -1;
+    mockGpioIsr[pin] = function;
+    return 0;
+}
+
+void piLock(int key) {
+    if (key >= 0 && key < MOCK_LOCK_KEYS) pthread_mutex_lock(&mockLocks[key]);
+}
+
+void piUnlock(int key) {
+    if (key >= 0 && key < MOCK_LOCK_KEYS) pthread_mutex_unlock(&mockLocks[key]);
+}
+
+int softPwmCreate(int pin, int value, int range) {
+    if (!validPin(pin) || range <= 0) return -1;
+    mockGpioOutput[pin] = value;
+    return 0;
+}
+
+void softPwmWrite(int pin, int value) {
+    if (validPin(pin)) mockGpioOutput[pin] = value;
+}
+
+void softPwmStop(int pin) {
+    if (validPin(pin)) mockGpioOutput[pin] = 0;
+}
+
+int wiringPiSPISetup(int channel, int speed) {
+    (void) speed;
+    return channel >= 0 && channel <= 1 ? 0 : -1;
+}
+
+int wiringPiSPIDataRW(int channel, unsigned char *data, int len) {
+    (void) channel;
+    if (len < 0 || len > MOCK_SPI_MAX_LEN) return -1;
+    for (int i = 0; i < len; i++) data[i] = mockSpiResponse[i];
+    return len;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file softPwm.h
+ * @brief Mock of the WiringPi softPwm API
+ *
+ * Duty values are recorded in mockGpioOutput[] (see wiringPi.h).
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOCK_SOFTPWM_H
+#define MOCK_SOFTPWM_H
+
+int softPwmCreate(int pin, int value, int range);
+void softPwmWrite(int pin, int value);
+void softPwmStop(int pin);
+
+#endif // MOCK_SOFTPWM_H
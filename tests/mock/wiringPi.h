@@ -0,0 +1,50 @@
+/**
+ * @file wiringPi.h
+ * @brief Mock of the WiringPi GPIO API for off-target tests and benchmarks
+ *
+ * Declares the subset of WiringPi used by the motor control library. Input
+ * levels come from mockGpioLevel[], outputs are recorded in mockGpioOutput[]
+ * and edge handlers are stored in mockGpioIsr[] instead of being run on a
+ * thread, so a test can fire them itself.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOCK_WIRINGPI_H
+#define MOCK_WIRINGPI_H
+
+#define INPUT            0
+#define OUTPUT           1
+#define PWM_OUTPUT       2
+
+#define LOW              0
+#define HIGH             1
+
+#define PUD_OFF          0
+#define PUD_DOWN         1
+#define PUD_UP           2
+
+#define INT_EDGE_SETUP   0
+#define INT_EDGE_FALLING 1
+#define INT_EDGE_RISING  2
+#define INT_EDGE_BOTH    3
+
+/** @brief Number of BCM GPIOs modelled */
+#define MOCK_GPIO_COUNT 64
+
+extern int mockGpioLevel[MOCK_GPIO_COUNT];            ///< Level returned by digitalRead()
+extern int mockGpioOutput[MOCK_GPIO_COUNT];           ///< Last value written to each pin
+extern void (*mockGpioIsr[MOCK_GPIO_COUNT])(void);    ///< Handlers from wiringPiISR()
+
+int wiringPiSetupGpio(void);
+void pinMode(int pin, int mode);
+void pullUpDnControl(int pin, int pud);
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+int wiringPiISR(int pin, int mode, void (*function)(void));
+void piLock(int key);
+void piUnlock(int key);
+
+#endif // MOCK_WIRINGPI_H
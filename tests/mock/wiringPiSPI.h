@@ -0,0 +1,23 @@
+/**
+ * @file wiringPiSPI.h
+ * @brief Mock of the WiringPi SPI API
+ *
+ * Transfers return the bytes in mockSpiResponse[] (all zero by default).
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#ifndef MOCK_WIRINGPI_SPI_H
+#define MOCK_WIRINGPI_SPI_H
+
+/** @brief Largest transfer the mock answers */
+#define MOCK_SPI_MAX_LEN 16
+
+extern unsigned char mockSpiResponse[MOCK_SPI_MAX_LEN];  ///< Bytes clocked back on every transfer
+
+int wiringPiSPISetup(int channel, int speed);
+int wiringPiSPIDataRW(int channel, unsigned char *data, int len);
+
+#endif // MOCK_WIRINGPI_SPI_H
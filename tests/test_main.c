@@ -13,7 +13,32 @@
 
 #include <stdio.h>
 #include <assert.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include "MotorControl.h"
+#include "ControlLoop.h"
+#include "MotorClock.h"
+#include "SimMotor.h"
+#include "Sensorless.h"
+#include "Foc.h"
+#include "Protection.h"
+#include "HallValidator.h"
+#include "Autotune.h"
+#include "Brake.h"
+#include "MotorCalibration.h"
+#include "RotorAngle.h"
+#include "MotorEvents.h"
+#include "MotorServer.h"
+#include "MotorLog.h"
+#include "MotorLogger.h"
+#include "wiringPi.h"
 
 /** @brief Test status macros */
 #define TEST_FAILED 1
@@ -26,8 +51,11 @@
  * @return TEST_PASSED if initialization successful, TEST_FAILED otherwise
  */
 static int test_motor_initialization() {
-    int result = MotorControl_function();
-    assert(result == 1);
+    int result = motorInit();
+    assert(result == 0);
+    assert(motorGetDefault() != NULL);
+    assert(motorGetCommutationMode() == DEFAULT_COMMUTATION_MODE);
+    assert(motorGetTargetSpeed() == 0);
     return TEST_PASSED;
 }
 
@@ -38,11 +66,1572 @@ static int test_motor_initialization() {
  * @return TEST_PASSED if operation successful, TEST_FAILED otherwise
  */
 static int test_motor_operation() {
-    int result = MotorControl_function();
-    assert(result == 1);
+    motorStart();
+    motorSetSpeed(MOTOR_MAX_RPM / 2);
+    assert(motorGetTargetSpeed() == MOTOR_MAX_RPM / 2);
+
+    // Requests above the rated speed are clamped
+    motorSetSpeed(MOTOR_MAX_RPM + 1000);
+    assert(motorGetTargetSpeed() == MOTOR_MAX_RPM);
+
+    // Stopping de-energizes every phase
+    motorStop();
+    assert(mockGpioOutput[PHASE_A_PIN] == 0);
+    assert(mockGpioOutput[PHASE_B_PIN] == 0);
+    assert(mockGpioOutput[PHASE_C_PIN] == 0);
+    return TEST_PASSED;
+}
+
+/**
+ * @brief Validates closed-loop speed control against the simulated plant
+ * @test Closed Loop Simulation Test
+ * @details Ramps a simulated motor to half speed and checks that both the
+ * plant and the Hall speed estimate settle on the setpoint
+ * @return TEST_PASSED if the speed settles, TEST_FAILED otherwise
+ */
+static int test_closed_loop_simulation() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+
+    // A zero acceleration limit would never reach the target
+    int status = motorInstanceSetRampLimits(motor, 0, 0);
+    assert(status == -1);
+
+    const uint16_t target = MOTOR_MAX_RPM / 2;
+    motorInstanceStart(motor);
+    motorInstanceSetSpeed(motor, target);
+    simRun(2000000000ULL, 1000000000U / CONTROL_LOOP_RATE_HZ);  // 2 s of motor time
+
+    int failed = TEST_PASSED;
+    double simRpm = simMotorGetRpm(sim);
+    int measured = motorInstanceGetSpeed(motor);
+    if (simRpm < target - 100 || simRpm > target + 100 ||
+        measured < target - 100 || measured > target + 100) {
+        printf("Simulated motor at %.0f RPM (measured %d), expected %d\n", simRpm, measured, target);
+        failed = TEST_FAILED;
+    }
+
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+
+    MotorConfig stuck = config;
+    stuck.rampAccel = 0;
+    Motor *refused = motorCreate(&stuck);
+    assert(refused == NULL);
+
+#if !MOTOR_FIXED_CONFIG
+    // A 16-bit duty range under heavy load holds the integrator beyond int32 Q16.16
+    const uint16_t loaded = MOTOR_MAX_RPM / 10;
+    config.pwmRange = 60000;
+    config.ki *= 60000 / PWM_RANGE;
+    sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    simMotorSetLoadTorque(sim, 0.8);
+    motorInstanceStart(motor);
+    motorInstanceSetSpeed(motor, loaded);
+    simRun(2000000000ULL, 1000000000U / CONTROL_LOOP_RATE_HZ);
+    simRpm = simMotorGetRpm(sim);
+    if (simRpm < loaded - 100 || simRpm > loaded + 100) {
+        printf("Loaded motor at %.0f RPM with PWM range 60000, expected %d\n", simRpm, loaded);
+        failed = TEST_FAILED;
+    }
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+#endif
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+/**
+ * @brief Validates sensorless motor setup
+ * @test Sensorless Commutation Test
+ * @details Sensorless motors need phase enable pins, start idle with every
+ *          driver disabled and ignore Hall-driven commutation requests
+ * @return TEST_PASSED if setup behaves as expected, TEST_FAILED otherwise
+ */
+static int test_sensorless_setup() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_SENSORLESS;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 10 + i;
+        config.enablePins[i] = -1;
+    }
+    Motor *refused = motorCreate(&config);
+    assert(refused == NULL);
+
+    for (int i = 0; i < 3; i++) config.enablePins[i] = 13 + i;
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    assert(motorInstanceGetSensorlessState(motor) == SENSORLESS_IDLE);
+
+    motorInstanceUpdateCommutation(motor);
+    for (int i = 0; i < 3; i++) {
+        assert(mockGpioOutput[config.phasePins[i]] == 0);
+        assert(mockGpioOutput[config.enablePins[i]] == LOW);
+    }
+    motorDestroy(motor);
+    return TEST_PASSED;
+}
+
+/**
+ * @brief Validates the fixed-point FOC transforms and SVPWM
+ * @test FOC Math Test
+ * @details Balanced phase currents aligned with the rotor must map to a
+ *          pure d-axis current, and a zero voltage vector to 50% duty
+ * @return TEST_PASSED if the transforms are consistent, TEST_FAILED otherwise
+ */
+static int test_foc_transforms() {
+    assert(focSin(0) == 0);
+    assert(focSin(FOC_ANGLE_DEG(90)) == FOC_Q15_ONE);
+    assert(focCos(FOC_ANGLE_DEG(180)) == -FOC_Q15_ONE);
+
+    // 1A vector at 30°: ia = cos(30°), ib = cos(-90°)
+    int32_t alpha, beta, d, q;
+    focClarke(866, 0, &alpha, &beta);
+    focPark(alpha, beta, FOC_ANGLE_DEG(30), &d, &q);
+    assert(d > 995 && d < 1005);
+    assert(q > -5 && q < 5);
+
+    focInversePark(d, q, FOC_ANGLE_DEG(30), &alpha, &beta);
+    assert(alpha > 861 && alpha < 871);
+
+    uint16_t duty[3];
+    focSvpwm(0, 0, PWM_RANGE, duty);
+    assert(duty[0] == PWM_RANGE / 2 && duty[1] == PWM_RANGE / 2 && duty[2] == PWM_RANGE / 2);
+    return TEST_PASSED;
+}
+
+/**
+ * @brief Validates complementary 6-step drive through a 3PWM bridge
+ * @test Bridge Drive Test
+ * @details Hall state 1 must switch phase A, hold phase C low and float
+ *          phase B; stopping must float every leg
+ * @return TEST_PASSED if the bridge follows bridgeTable, TEST_FAILED otherwise
+ */
+static int test_bridge_drive() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    config.bridge = BRIDGE_3PWM;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+        config.enablePins[i] = 22 + i;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+
+    // Hall state 1: only sensor C high
+    mockGpioLevel[config.hallPins[0]] = LOW;
+    mockGpioLevel[config.hallPins[1]] = LOW;
+    mockGpioLevel[config.hallPins[2]] = HIGH;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    motorInstanceStart(motor);
+
+    assert(mockGpioOutput[config.phasePins[0]] > 0);
+    assert(mockGpioOutput[config.phasePins[1]] == 0);
+    assert(mockGpioOutput[config.phasePins[2]] == 0);
+    assert(mockGpioOutput[config.enablePins[0]] == HIGH);
+    assert(mockGpioOutput[config.enablePins[1]] == LOW);
+    assert(mockGpioOutput[config.enablePins[2]] == HIGH);
+
+    motorInstanceStop(motor);
+    for (int i = 0; i < 3; i++) {
+        assert(mockGpioOutput[config.phasePins[i]] == 0);
+        assert(mockGpioOutput[config.enablePins[i]] == LOW);
+    }
+    motorDestroy(motor);
+    return TEST_PASSED;
+}
+
+static int cachePwmWrites;  ///< Writes that reached cachePwmBackend
+
+static int cachePwmSetup(int pin, int range) { (void) range; mockGpioOutput[pin] = 0; return 0; }
+static void cachePwmWrite(int pin, int value) { mockGpioOutput[pin] = value; cachePwmWrites++; }
+static void cachePwmRelease(int pin) { mockGpioOutput[pin] = 0; }
+
+/** @brief PWM backend that counts the writes reaching it */
+static const PwmBackend cachePwmBackend = {
+    .name = "counting",
+    .setup = cachePwmSetup,
+    .write = cachePwmWrite,
+    .release = cachePwmRelease,
+};
+
+/**
+ * @brief Validates that commutation writes only the phases that change
+ * @test Commutation Cache Test
+ * @details Steps a polled motor through every Hall sector; each real phase
+ *          change must write exactly the phases whose output differs, and
+ *          a repeated update with nothing changed must write none
+ * @return TEST_PASSED if redundant writes are skipped, TEST_FAILED otherwise
+ */
+static int test_commutation_cache() {
+    static const uint8_t sequence[7] = { 1, 3, 2, 6, 4, 5, 1 };
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    config.pwm = &cachePwmBackend;
+    config.hallDebounceNs = 0;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+        mockGpioLevel[config.hallPins[i]] = (sequence[0] >> (2 - i)) & 1;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    int status = motorInstanceStart(motor);
+    assert(status == 0);
+
+    int failed = TEST_PASSED;
+    int total = 0;
+    for (int step = 1; step < 7; step++) {
+        int previous[3];
+        for (int i = 0; i < 3; i++) {
+            previous[i] = mockGpioOutput[config.phasePins[i]];
+            mockGpioLevel[config.hallPins[i]] = (sequence[step] >> (2 - i)) & 1;
+        }
+        cachePwmWrites = 0;
+        motorInstanceUpdateCommutation(motor);
+        int changed = 0;
+        for (int i = 0; i < 3; i++) changed += mockGpioOutput[config.phasePins[i]] != previous[i];
+        if (changed == 0 || cachePwmWrites != changed) {
+            printf("Hall state %u: %d PWM writes for %d changed phases\n", sequence[step],
+                   cachePwmWrites, changed);
+            failed = TEST_FAILED;
+        }
+        total += cachePwmWrites;
+
+        cachePwmWrites = 0;
+        motorInstanceUpdateCommutation(motor);
+        if (cachePwmWrites != 0) {
+            printf("Hall state %u: %d PWM writes with nothing changed\n", sequence[step], cachePwmWrites);
+            failed = TEST_FAILED;
+        }
+    }
+    printf("Commutation: %d PWM writes over 6 sectors\n", total);
+    motorDestroy(motor);
+    return failed;
+}
+
+/**
+ * @brief Validates the overcurrent trip from the fault input
+ * @test Overcurrent Protection Test
+ * @details A falling fault edge must float the bridge and latch the fault;
+ *          restart is refused until the input is released and cleared
+ * @return TEST_PASSED if the trip latches correctly, TEST_FAILED otherwise
+ */
+static int test_overcurrent_trip() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    config.bridge = BRIDGE_3PWM;
+    config.faultPin = 26;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+        config.enablePins[i] = 22 + i;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    assert(motorInstanceGetFault(motor) == MOTOR_FAULT_NONE);
+    assert(mockGpioIsr[config.faultPin] != NULL);
+
+    // Hall state 1 energizes phases A and C
+    mockGpioLevel[config.hallPins[0]] = LOW;
+    mockGpioLevel[config.hallPins[1]] = LOW;
+    mockGpioLevel[config.hallPins[2]] = HIGH;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    int status = motorInstanceStart(motor);
+    assert(status == 0);
+    assert(mockGpioOutput[config.enablePins[0]] == HIGH);
+
+    // Comparator fires
+    mockGpioLevel[config.faultPin] = LOW;
+    mockGpioIsr[config.faultPin]();
+    assert(motorInstanceGetFault(motor) == MOTOR_FAULT_OVERCURRENT_PIN);
+    for (int i = 0; i < 3; i++) {
+        assert(mockGpioOutput[config.phasePins[i]] == 0);
+        assert(mockGpioOutput[config.enablePins[i]] == LOW);
+    }
+    status = motorInstanceStart(motor);
+    assert(status == -1);
+    status = motorInstanceClearFault(motor);
+    assert(status == -1);
+
+    // Released and acknowledged
+    mockGpioLevel[config.faultPin] = HIGH;
+    status = motorInstanceClearFault(motor);
+    assert(status == 0);
+    status = motorInstanceStart(motor);
+    assert(status == 0);
+    motorDestroy(motor);
+    return TEST_PASSED;
+}
+
+static int tripPwmDuty[MOCK_GPIO_COUNT];  ///< Duty per pin, kept apart from mockGpioOutput[]
+
+static int tripPwmSetup(int pin, int range) { (void) range; tripPwmDuty[pin] = 0; return 0; }
+static void tripPwmWrite(int pin, int value) { tripPwmDuty[pin] = value; }
+static void tripPwmRelease(int pin) { tripPwmDuty[pin] = 0; }
+
+/** @brief PWM backend whose output never reaches the mock GPIO levels */
+static const PwmBackend tripPwmBackend = {
+    .name = "trip",
+    .setup = tripPwmSetup,
+    .write = tripPwmWrite,
+    .release = tripPwmRelease,
+};
+
+/**
+ * @brief Validates the overcurrent trip without a GPIO register mapping
+ * @test Overcurrent Fallback Test
+ * @details The mock build never maps /dev/gpiomem, as on a SoC without the
+ *          BCM2835 GPIO layout; the trip must then drive every phase pin
+ *          low with digitalWrite() itself. The PWM backend keeps its duty
+ *          apart from the pin levels, so only that fallback can clear them.
+ * @return TEST_PASSED if every phase pin is driven low, TEST_FAILED otherwise
+ */
+static int test_overcurrent_fallback() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    config.pwm = &tripPwmBackend;
+    config.faultPin = 26;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    assert(mockGpioIsr[config.faultPin] != NULL);
+    mockGpioLevel[config.hallPins[0]] = LOW;
+    mockGpioLevel[config.hallPins[1]] = LOW;
+    mockGpioLevel[config.hallPins[2]] = HIGH;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    int status = motorInstanceStart(motor);
+    assert(status == 0);
+    for (int i = 0; i < 3; i++) mockGpioOutput[config.phasePins[i]] = HIGH;
+
+    mockGpioLevel[config.faultPin] = LOW;
+    mockGpioIsr[config.faultPin]();
+    int failed = TEST_PASSED;
+    for (int i = 0; i < 3; i++) {
+        if (mockGpioOutput[config.phasePins[i]] != LOW) {
+            printf("Phase %d not driven low by the trip fallback\n", i);
+            failed = TEST_FAILED;
+        }
+    }
+    assert(motorInstanceGetFault(motor) == MOTOR_FAULT_OVERCURRENT_PIN);
+    mockGpioLevel[config.faultPin] = HIGH;
+    motorDestroy(motor);
+    return failed;
+}
+
+/**
+ * @brief Validates Hall sequence checking and ride-through
+ * @test Hall Validator Test
+ * @details Glitches, illegal jumps and invalid codes must be rejected and
+ *          counted, a due edge extrapolated, and a running motor stopped
+ *          only once the sensors stay invalid
+ * @return TEST_PASSED if all faults are handled correctly, TEST_FAILED otherwise
+ */
+static int test_hall_validator() {
+    HallValidator v;
+    hallValidatorInit(&v, 1000);
+    uint8_t code = hallValidatorSample(&v, 1, 0, 0);
+    assert(code == 1);
+
+    // A neighbour is accepted once it lasts the debounce window
+    code = hallValidatorSample(&v, 3, 10000, 0);
+    assert(code == 1);
+    assert(hallValidatorPending(&v));
+    code = hallValidatorSample(&v, 3, 11000, 0);
+    assert(code == 3);
+    code = hallValidatorSample(&v, 2, 20000, 0);
+    assert(code == 3);
+    code = hallValidatorSample(&v, 3, 20500, 0);
+    assert(code == 3);
+    assert(v.counts.glitches == 1);
+
+    // 3 -> 6 skips sector 2; 7 is no sector at all
+    code = hallValidatorSample(&v, 6, 30000, 0);
+    assert(code == 3);
+    code = hallValidatorSample(&v, 7, 31000, 0);
+    assert(code == 3);
+    assert(v.counts.illegal == 1 && v.counts.invalid == 1);
+
+    // A bad sample once the next edge is due advances the sector
+    code = hallValidatorSample(&v, 7, 100000, 50000);
+    assert(code == 2);
+    assert(v.counts.extrapolated == 1);
+    code = hallValidatorSample(&v, 2, 101000, 50000);
+    assert(code == 2);
+    assert(!hallValidatorLost(&v));
+
+    // A due edge is taken at once; an early one keeps its own timestamp once confirmed
+    code = hallValidatorSample(&v, 6, 140000, 50000);
+    assert(code == 6);
+    code = hallValidatorSample(&v, 4, 150000, 50000);
+    assert(code == 6);
+    code = hallValidatorSample(&v, 4, 152000, 50000);
+    assert(code == 4);
+    assert(v.lastEdgeNs == 150000);
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    mockGpioLevel[config.hallPins[0]] = LOW;
+    mockGpioLevel[config.hallPins[1]] = LOW;
+    mockGpioLevel[config.hallPins[2]] = HIGH;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    int status = motorInstanceStart(motor);
+    assert(status == 0);
+    int duty = mockGpioOutput[config.phasePins[0]];
+    assert(duty > 0);
+
+    // One invalid read keeps the phases as they are
+    mockGpioLevel[config.hallPins[0]] = HIGH;
+    mockGpioLevel[config.hallPins[1]] = HIGH;
+    motorInstanceUpdateCommutation(motor);
+    assert(mockGpioOutput[config.phasePins[0]] == duty);
+    assert(motorInstanceGetFault(motor) == MOTOR_FAULT_NONE);
+
+    // Persistently invalid sensors stop the motor
+    for (int i = 1; i < HALL_MAX_BAD_SAMPLES; i++) motorInstanceUpdateCommutation(motor);
+    assert(motorInstanceGetFault(motor) == MOTOR_FAULT_HALL);
+    assert(mockGpioOutput[config.phasePins[0]] == 0);
+
+    HallFaultCounts counts;
+    motorInstanceGetHallFaults(motor, &counts);
+    assert(counts.invalid >= HALL_MAX_BAD_SAMPLES);
+    motorDestroy(motor);
     return TEST_PASSED;
 }
 
+/**
+ * @brief Validates edge-driven commutation from standstill
+ * @test Hall Edge Commutation Test
+ * @details Steps the Hall inputs through a full forward sequence in
+ *          interrupt mode with no control loop, firing the edge handler of
+ *          the pin that changed; every edge must be accepted at once and
+ *          move the phase pattern, even inside the debounce window
+ * @return TEST_PASSED if every sector is commutated, TEST_FAILED otherwise
+ */
+static int test_hall_edge_commutation() {
+    static const uint8_t sequence[7] = { 1, 3, 2, 6, 4, 5, 1 };
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_INTERRUPT;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 16 + i;
+        config.hallPins[i] = 19 + i;
+    }
+    for (int i = 0; i < 3; i++) mockGpioLevel[config.hallPins[i]] = (sequence[0] >> (2 - i)) & 1;
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    assert(mockGpioIsr[config.hallPins[0]] != NULL);
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    int status = motorInstanceStart(motor);
+    assert(status == 0);
+
+    int failed = TEST_PASSED;
+    int previous[3];
+    for (int i = 0; i < 3; i++) previous[i] = mockGpioOutput[config.phasePins[i]];
+    for (int step = 1; step < 7; step++) {
+        uint8_t changed = sequence[step] ^ sequence[step - 1];
+        for (int i = 0; i < 3; i++) {
+            mockGpioLevel[config.hallPins[i]] = (sequence[step] >> (2 - i)) & 1;
+        }
+        for (int i = 0; i < 3; i++) {
+            if (changed & (4 >> i)) mockGpioIsr[config.hallPins[i]]();
+        }
+
+        int moved = 0;
+        for (int i = 0; i < 3; i++) {
+            moved |= mockGpioOutput[config.phasePins[i]] != previous[i];
+            previous[i] = mockGpioOutput[config.phasePins[i]];
+        }
+        if (!moved) {
+            printf("Hall edge to state %u did not commutate\n", sequence[step]);
+            failed = TEST_FAILED;
+        }
+    }
+
+    HallFaultCounts counts;
+    motorInstanceGetHallFaults(motor, &counts);
+    if (counts.illegal != 0 || counts.glitches != 0) {
+        printf("Clean Hall edges rejected (%u illegal, %u glitches)\n", counts.illegal, counts.glitches);
+        failed = TEST_FAILED;
+    }
+    motorDestroy(motor);
+    return failed;
+}
+
+/**
+ * @brief Validates gain identification against the simulated plant
+ * @test Autotune Simulation Test
+ * @details Runs the step experiment on a simulated motor, then checks that
+ *          the identified gains are installed and track a speed change
+ * @return TEST_PASSED if tuning completes and the speed settles, TEST_FAILED otherwise
+ */
+static int test_autotune_simulation() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    int status = motorInstanceAutotune(motor);
+    assert(status == -1);  // no tick yet
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    status = motorInstanceAutotune(motor);
+    assert(status == 0);
+    assert(motorInstanceGetAutotuneState(motor) == AUTOTUNE_SETTLE);
+    simRun((AUTOTUNE_SETTLE_MS + AUTOTUNE_STEP_MS) * 1000000ULL + tickNs, tickNs);
+
+    int failed = TEST_PASSED;
+    AutotuneResult result;
+    if (motorInstanceGetAutotuneResult(motor, &result) != 0) {
+        printf("Autotune did not complete (state %d)\n", motorInstanceGetAutotuneState(motor));
+        failed = TEST_FAILED;
+    } else {
+        printf("Autotune: K=%.3f RPM/count tau=%u us dead=%u us kp=%d ki=%d\n",
+               result.plantGainQ16 / 65536.0, result.timeConstantUs, result.deadTimeUs,
+               result.kp, result.ki);
+        assert(result.kp > 0 && result.ki > 0 && result.timeConstantUs > 0);
+
+        // The tuned loop follows a new target
+        const uint16_t target = MOTOR_MAX_RPM / 2;
+        motorInstanceSetSpeed(motor, target);
+        simRun(2000000000ULL, tickNs);
+        double simRpm = simMotorGetRpm(sim);
+        if (simRpm < target - 100 || simRpm > target + 100) {
+            printf("Tuned motor at %.0f RPM, expected %d\n", simRpm, target);
+            failed = TEST_FAILED;
+        }
+    }
+
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+/**
+ * @brief Validates the binary calibration file
+ * @test Calibration File Test
+ * @details Writes a sealed record, maps it back into a configuration, and
+ *          checks that corrupted, truncated and missing files are told apart
+ * @return TEST_PASSED if the file round-trips and bad files are rejected, TEST_FAILED otherwise
+ */
+static int test_calibration_file() {
+    const char *path = "/tmp/motor_test_calibration.bin";
+    MotorCalibration cal;
+    calibrationDefaults(&cal);
+    assert(calibrationValidate(&cal, sizeof(cal)) == 0);
+    cal.phasePins[0] = 12;
+    cal.maxRpm = 4000;
+    cal.kp = 5000;
+    cal.hallAngles[2] = 0x8000;
+    cal.currentOffsets[1] = 2010;
+    calibrationSeal(&cal);
+
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    size_t written = fwrite(&cal, sizeof(cal), 1, file);
+    assert(written == 1);
+    fclose(file);
+
+    const MotorCalibration *mapped;
+    int status = calibrationMap(path, &mapped);
+    assert(status == 0);
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    calibrationApply(mapped, &config);
+    calibrationUnmap(mapped);
+    int failed = TEST_PASSED;
+    if (config.phasePins[0] != 12 || config.maxRpm != 4000 || config.kp != 5000 ||
+        config.hallAngles[2] != 0x8000 || config.currentOffsets[1] != 2010) {
+        printf("Calibration did not round-trip\n");
+        failed = TEST_FAILED;
+    }
+
+    // A flipped payload byte fails the CRC
+    MotorCalibration corrupt = cal;
+    ((uint8_t *) &corrupt)[CALIBRATION_HEADER_SIZE + 5] ^= 0x10;
+    assert(calibrationValidate(&corrupt, sizeof(corrupt)) == -1);
+    assert(calibrationValidate(&cal, sizeof(cal) - 1) == -1);
+
+    // Truncated on disk
+    file = fopen(path, "wb");
+    assert(file != NULL);
+    written = fwrite(&cal, sizeof(cal) - 4, 1, file);
+    assert(written == 1);
+    fclose(file);
+    status = calibrationMap(path, &mapped);
+    assert(status == -1);
+
+    remove(path);
+    status = calibrationMap(path, &mapped);
+    assert(status == 1);
+    return failed;
+}
+
+/**
+ * @brief Validates the duty scaling and 6-step patterns of the build variant
+ * @test Fixed Configuration Test
+ * @details Every Hall state must drive the commutationTable phases at the
+ *          open-loop duty. A motor with half the PWM range runs at half the
+ *          duty, unless the build is fixed to PWM_RANGE and refuses it
+ * @return TEST_PASSED if outputs match the variant, TEST_FAILED otherwise
+ */
+static int test_fixed_config() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.commutationMode = COMMUTATION_POLLED;
+    // One sample per state: each must commutate without waiting for a confirming one
+    config.hallDebounceNs = 0;
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = 10 + i;
+        config.hallPins[i] = 13 + i;
+    }
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    motorInstanceStart(motor);
+
+    // Phase k switches PWM when bit k of the state is set in commutationTable
+    const uint16_t duty = PWM_RANGE / 2;
+    // Walk the forward Hall sequence so the validator accepts every step
+    const uint8_t phases[8] = { 0, 1, 2, 3, 4, 5, 6, 0 };
+    const uint8_t sequence[6] = { 1, 3, 2, 6, 4, 5 };
+    int failed = TEST_PASSED;
+    for (int step = 0; step < 6; step++) {
+        uint8_t state = sequence[step];
+        for (int i = 0; i < 3; i++) mockGpioLevel[config.hallPins[i]] = (state >> (2 - i)) & 1;
+        motorInstanceUpdateCommutation(motor);
+        for (int k = 0; k < 3; k++) {
+            int expected = (phases[state] >> k) & 1 ? duty : 0;
+            if (mockGpioOutput[config.phasePins[k]] != expected) {
+                printf("Hall state %d phase %d: %d, expected %d\n", state, k,
+                       mockGpioOutput[config.phasePins[k]], expected);
+                failed = TEST_FAILED;
+            }
+        }
+    }
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+
+    config.pwmRange = PWM_RANGE / 2;
+    motor = motorCreate(&config);
+#if MOTOR_FIXED_CONFIG
+    assert(motor == NULL);
+#else
+    assert(motor != NULL);
+    mockGpioLevel[config.hallPins[0]] = LOW;
+    mockGpioLevel[config.hallPins[1]] = LOW;
+    mockGpioLevel[config.hallPins[2]] = HIGH;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    motorInstanceStart(motor);
+    assert(mockGpioOutput[config.phasePins[0]] == PWM_RANGE / 4);
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+#endif
+    for (int i = 0; i < 3; i++) mockGpioLevel[config.hallPins[i]] = HIGH;
+    return failed;
+}
+
+/** @brief Compare 16-bit angles, allowing for interpolation rounding */
+static int angleNear(uint16_t angle, uint16_t expected) {
+    int16_t error = (int16_t) (angle - expected);
+    return error >= -2 && error <= 2;
+}
+
+/**
+ * @brief Validates sub-sector rotor angle interpolation and phase advance
+ * @test Rotor Angle Test
+ * @details Feeds Hall edges one millisecond apart and checks the angle
+ *          within a sector in both directions, the speed-proportional
+ *          advance and the early switch to the next 6-step state
+ * @return TEST_PASSED if every angle matches, TEST_FAILED otherwise
+ */
+static int test_rotor_angle() {
+    uint16_t angles[6];
+    for (int k = 0; k < 6; k++) angles[k] = ROTOR_ANGLE_DEG(60 * k);
+    const uint64_t ms = 1000000ULL;
+
+    // Forward edges 1-3-2: sector 2 spans 120..180 degrees
+    SpeedEstimator est;
+    speedEstimatorInit(&est, NUM_POLES, SPEED_ZERO_TIMEOUT_NS);
+    speedEstimatorSample(&est, 1, 1 * ms);
+    speedEstimatorSample(&est, 3, 2 * ms);
+    speedEstimatorSample(&est, 2, 3 * ms);
+    assert(speedEstimatorGetSectorPeriodNs(&est) == ms);
+
+    int failed = TEST_PASSED;
+    uint16_t forward = rotorAngleInterpolate(&est, 1, angles, 3 * ms + ms / 4);
+    uint16_t reverse = rotorAngleInterpolate(&est, -1, angles, 3 * ms + ms / 4);
+    uint16_t late = rotorAngleInterpolate(&est, 1, angles, 5 * ms);
+    if (!angleNear(forward, ROTOR_ANGLE_DEG(135)) || !angleNear(reverse, ROTOR_ANGLE_DEG(165)) ||
+        !angleNear(late, ROTOR_ANGLE_DEG(180))) {
+        printf("Interpolated %u/%u/%u, expected %u/%u/%u\n", forward, reverse, late,
+               ROTOR_ANGLE_DEG(135), ROTOR_ANGLE_DEG(165), ROTOR_ANGLE_DEG(180));
+        failed = TEST_FAILED;
+    }
+
+    // Advance grows with speed up to the configured angle
+    uint16_t full = ROTOR_ANGLE_DEG(20);
+    assert(rotorAngleAdvance(full, 0, MOTOR_MAX_RPM) == 0);
+    assert(rotorAngleAdvance(full, MOTOR_MAX_RPM / 2, MOTOR_MAX_RPM) == full / 2);
+    assert(rotorAngleAdvance(full, MOTOR_MAX_RPM, MOTOR_MAX_RPM) == full);
+
+    // 30 + 20 degrees stays in the sector, 45 + 20 drives the next one
+    assert(rotorAngleDriveState(&est, 1, angles, full, 3 * ms + ms / 2) == 2);
+    assert(rotorAngleDriveState(&est, 1, angles, full, 3 * ms + 3 * ms / 4) == 6);
+    assert(rotorAngleDriveState(&est, -1, angles, full, 3 * ms + 3 * ms / 4) == 3);
+    assert(rotorAngleDriveState(&est, 1, angles, 0, 5 * ms) == 2);
+
+    // An edge stamped after the sample time counts as just entered
+    assert(angleNear(rotorAngleInterpolate(&est, 1, angles, 3 * ms - HALL_DEBOUNCE_NS), ROTOR_ANGLE_DEG(120)));
+    assert(rotorAngleDriveState(&est, 1, angles, full, 3 * ms - HALL_DEBOUNCE_NS) == 2);
+
+    // Stationary: the sector centre, no early switch
+    speedEstimatorUpdate(&est, 3 * ms + SPEED_ZERO_TIMEOUT_NS + 1);
+    assert(angleNear(rotorAngleInterpolate(&est, 1, angles, 200 * ms), ROTOR_ANGLE_DEG(150)));
+    assert(rotorAngleDriveState(&est, 1, angles, full, 200 * ms) == 2);
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    config.phaseAdvance = ROTOR_ANGLE_DEG(ROTOR_PHASE_ADVANCE_MAX_DEG + 1);
+    Motor *refused = motorCreate(&config);
+    assert(refused == NULL);
+    return failed;
+}
+
+/**
+ * @brief Validates the motor event descriptor
+ * @test Motor Events Test
+ * @details Runs a simulated motor to a target and trips a fault, checking
+ *          that the descriptor becomes readable once per event and that the
+ *          status snapshot reflects the motor state
+ * @return TEST_PASSED if each event is signalled and taken once, TEST_FAILED otherwise
+ */
+static int test_motor_events() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+
+    int fd = motorInstanceEventFd(motor);
+    assert(fd >= 0);
+    assert(motorInstanceEventFd(motor) == fd);
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    assert(poll(&pfd, 1, 0) == 0);
+
+    int failed = TEST_PASSED;
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    const uint16_t target = MOTOR_MAX_RPM / 2;
+    motorInstanceStart(motor);
+    motorInstanceSetSpeed(motor, target);
+    simRun(3000000000ULL, tickNs);
+
+    MotorStatus status;
+    motorInstanceGetStatus(motor, &status);
+    if (poll(&pfd, 1, 0) != 1 || !(status.events & MOTOR_EVENT_SPEED_REACHED)) {
+        printf("Speed reached not signalled (%u RPM, events 0x%x)\n", status.measuredRpm,
+               status.events);
+        failed = TEST_FAILED;
+    }
+    assert(status.running && !status.ramping && status.targetRpm == target);
+    uint32_t events = motorInstanceTakeEvents(motor);
+    assert(events == MOTOR_EVENT_SPEED_REACHED);
+    events = motorInstanceTakeEvents(motor);
+    assert(events == 0);
+    assert(poll(&pfd, 1, 0) == 0);
+
+    // Holding the target does not signal again
+    simRun(100000000ULL, tickNs);
+    assert(poll(&pfd, 1, 0) == 0);
+
+    protectionTrip(motor, MOTOR_FAULT_OVERCURRENT_PIN);
+    assert(poll(&pfd, 1, 0) == 1);
+    events = motorInstanceTakeEvents(motor);
+    assert(events == MOTOR_EVENT_FAULT);
+    motorInstanceGetStatus(motor, &status);
+    assert(!status.running && status.fault == MOTOR_FAULT_OVERCURRENT_PIN && status.events == 0);
+
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+/**
+ * @brief Receive one datagram of a given type
+ * @return Datagram length, or 0 on timeout
+ */
+static size_t receiveNet(int sock, uint8_t *buf, MotorNetType type, MotorNetHeader *header) {
+    struct pollfd pfd = { .fd = sock, .events = POLLIN };
+    while (poll(&pfd, 1, 1000) == 1) {
+        ssize_t len = recv(sock, buf, MOTOR_NET_MAX_PACKET, 0);
+        if (len > 0 && motorNetDecodeHeader(buf, (size_t) len, header) == 0 && header->type == type) {
+            return (size_t) len;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Validates the network command and telemetry server
+ * @test Network Server Test
+ * @details Sends a batch of commands for a simulated motor over loopback
+ *          UDP, checks the acknowledgement and that the control loop applies
+ *          them, then follows the streamed telemetry
+ * @return TEST_PASSED if commands and telemetry round-trip, TEST_FAILED otherwise
+ */
+static int test_network_server() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+
+    const char *ring = "/motor_test_server";
+    int telemetry = telemetryOpen(ring, 1024) == 0;
+    MotorServerConfig serverConfig;
+    motorServerDefaultConfig(&serverConfig);
+    serverConfig.port = 0;
+    serverConfig.telemetryName = ring;
+    int started = motorServerStart(&serverConfig);
+    assert(started == 0);
+    started = motorServerStart(&serverConfig);
+    assert(started == -1);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    assert(sock >= 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(motorServerGetPort());
+    int connected = connect(sock, (struct sockaddr *) &addr, sizeof(addr));
+    assert(connected == 0);
+
+    static uint8_t buf[MOTOR_NET_MAX_PACKET];
+    MotorNetHeader header;
+    ssize_t sent = send(sock, "junk", 4, 0);
+    assert(sent == 4);
+    size_t len = motorNetEncodeHeader(buf, MOTOR_NET_SUBSCRIBE, 1, 0);
+    sent = send(sock, buf, len, 0);
+    assert(sent == (ssize_t) len);
+
+    const uint16_t target = MOTOR_MAX_RPM / 2;
+    const uint8_t index = (uint8_t) motorInstanceGetIndex(motor);
+    const MotorCommand commands[2] = {
+        { .type = MOTOR_CMD_START, .motor = index },
+        { .type = MOTOR_CMD_SET_SPEED, .motor = index, .arg0 = target },
+    };
+    len = motorNetEncodeCommands(buf, sizeof(buf), 42, commands, 2);
+    assert(len == MOTOR_NET_HEADER_SIZE + 2 * MOTOR_NET_COMMAND_SIZE);
+    sent = send(sock, buf, len, 0);
+    assert(sent == (ssize_t) len);
+
+    int failed = TEST_PASSED;
+    if (receiveNet(sock, buf, MOTOR_NET_ACK, &header) == 0 || header.seq != 42 || header.count != 2) {
+        printf("Commands not acknowledged\n");
+        failed = TEST_FAILED;
+    }
+
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    simRun(200000000ULL, tickNs);
+    MotorStatus status;
+    motorInstanceGetStatus(motor, &status);
+    if (!status.running || status.targetRpm != target) {
+        printf("Network commands not applied (running %d, target %u)\n", status.running,
+               status.targetRpm);
+        failed = TEST_FAILED;
+    }
+
+    if (telemetry) {
+        static TelemetrySample samples[MOTOR_NET_MAX_SAMPLES];
+        int found = 0;
+        while (!found && receiveNet(sock, buf, MOTOR_NET_TELEMETRY, &header) != 0) {
+            int count = motorNetDecodeTelemetry(buf, samples, NULL);
+            assert(count > 0 && count <= MOTOR_NET_MAX_SAMPLES);
+            for (int i = 0; i < count; i++) {
+                if (samples[i].motor == index && samples[i].setpoint > 0) found = 1;
+            }
+        }
+        if (!found) {
+            printf("No telemetry streamed for motor %u\n", index);
+            failed = TEST_FAILED;
+        }
+    } else {
+        printf("Shared memory unavailable, telemetry streaming not tested\n");
+    }
+
+    MotorServerStats stats;
+    motorServerGetStats(&stats);
+    assert(stats.badPackets >= 1 && stats.commands >= 2);
+
+    close(sock);
+    motorServerStop();
+    assert(motorServerGetPort() == 0);
+    if (telemetry) telemetryClose();
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+/**
+ * @brief Validates tick synchronization and scheduled setpoints
+ * @test Tick Sync Test
+ * @details Checks the sync pulse phase error and index arithmetic, then
+ *          schedules speed changes on tick indices, including across the
+ *          32-bit wrap of the scheduled index
+ * @return TEST_PASSED if changes apply exactly on their tick, TEST_FAILED otherwise
+ */
+static int test_tick_sync() {
+    const int64_t period = 1000000000 / CONTROL_LOOP_RATE_HZ;
+    int64_t ticks;
+    assert(controlSyncPhaseError(10 * period + 1000, 10 * period, period, &ticks) == 1000 && ticks == 0);
+    assert(controlSyncPhaseError(7 * period + 200, 10 * period, period, &ticks) == 200 && ticks == -3);
+    assert(controlSyncPhaseError(11 * period - 1000, 10 * period, period, &ticks) == -1000 && ticks == 1);
+    assert(controlSyncPhaseError(10 * period + period / 2, 10 * period, period, NULL) == period / 2);
+
+    // A pulse every second marks the whole second nearest the wall clock
+    assert(controlSyncPulseIndex(10000400000ULL, (uint32_t) period, CONTROL_LOOP_RATE_HZ) ==
+           10ULL * CONTROL_LOOP_RATE_HZ);
+    assert(controlSyncPulseIndex(9999600000ULL, (uint32_t) period, CONTROL_LOOP_RATE_HZ) ==
+           10ULL * CONTROL_LOOP_RATE_HZ);
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+    motorInstanceStart(motor);
+
+    const uint32_t tickNs = (uint32_t) period;
+    int failed = TEST_PASSED;
+    const uint64_t bases[2] = { 1000, 0xFFFFFFFCULL };  // the second crosses 2^32
+    for (int b = 0; b < 2; b++) {
+        const uint16_t target = (uint16_t) (1000 + 500 * b);
+        motorControlSetTickIndex(bases[b]);
+        motorInstanceSetSpeedAt(motor, target, bases[b] + 10);
+        simRun(10ULL * tickNs, tickNs);  // ticks base .. base + 9
+        assert(motorControlGetTickIndex() == bases[b] + 10);
+        if (motorInstanceGetTargetSpeed(motor) == target) {
+            printf("Scheduled speed applied before tick %llu\n", (unsigned long long) bases[b] + 10);
+            failed = TEST_FAILED;
+        }
+        simRun(tickNs, tickNs);
+        if (motorInstanceGetTargetSpeed(motor) != target) {
+            printf("Scheduled speed not applied on tick %llu\n", (unsigned long long) bases[b] + 10);
+            failed = TEST_FAILED;
+        }
+    }
+
+    // An immediate change cancels the pending one; a past tick applies at once
+    motorInstanceSetSpeedAt(motor, 2000, motorControlGetTickIndex() + 5);
+    motorInstanceSetSpeed(motor, 800);
+    simRun(10ULL * tickNs, tickNs);
+    assert(motorInstanceGetTargetSpeed(motor) == 800);
+    motorInstanceSetSpeedAt(motor, 900, motorControlGetTickIndex() - 3);
+    simRun(tickNs, tickNs);
+    assert(motorInstanceGetTargetSpeed(motor) == 900);
+
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+/** @brief Log sink writing each block synchronously to the file descriptor in context */
+static uint8_t *testLogAcquire(void *context) {
+    (void) context;
+    static uint8_t block[MOTOR_LOG_BLOCK_SIZE];
+    return block;
+}
+
+static void testLogSubmit(void *context, uint8_t *block, uint32_t sequence) {
+    int fd = *(const int *) context;
+    ssize_t written = pwrite(fd, block, MOTOR_LOG_BLOCK_SIZE, (off_t) sequence * MOTOR_LOG_BLOCK_SIZE);
+    assert(written == MOTOR_LOG_BLOCK_SIZE);
+}
+
+/** @brief Synthetic sample n of two motors ticking at CONTROL_LOOP_RATE_HZ */
+static void testLogSample(uint32_t n, TelemetrySample *sample) {
+    memset(sample, 0, sizeof(*sample));
+    uint32_t tick = n / 2;
+    sample->motor = (uint8_t) (n % 2);
+    sample->timestampNs = 5000000000ULL + (uint64_t) tick * (1000000000U / CONTROL_LOOP_RATE_HZ) +
+                          (tick % 7) * 1000;  // wake-up jitter
+    sample->rpm = (uint16_t) (tick % 3000 + (tick * 2654435761U >> 28));
+    sample->setpoint = (uint16_t) (tick % 3000);
+    for (int c = 0; c < 3; c++) sample->duty[c] = (uint16_t) ((tick + c * 100) % 1024);
+    sample->hallState = (uint8_t) (tick % 6 + 1);
+    sample->faults = tick % 5000 == 0 ? TELEMETRY_FAULT_HALL_INVALID : 0;
+    sample->overrun = tick % 997 == 0;
+}
+
+/**
+ * @brief Validates the compressed log format
+ * @test Log Format Test
+ * @details Encodes synthetic samples of two motors into a file spanning
+ *          several index groups, decodes every block back, seeks by time
+ *          through the index and the unindexed tail, and checks that a
+ *          corrupted block is rejected
+ * @return TEST_PASSED if samples round-trip losslessly and seeks land on the right block, TEST_FAILED otherwise
+ */
+static int test_motor_log() {
+    const char *path = "/tmp/motor_test_log.mlog";
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    const MotorLogSink sink = { .acquire = testLogAcquire, .submit = testLogSubmit, .context = &fd };
+    static MotorLogEncoder encoder;
+    int status = motorLogEncoderInit(&encoder, &sink, 5000000000ULL, 1700000000000000000ULL);
+    assert(status == 0);
+
+    const uint32_t total = 1200000;  // 10 minutes of two motors
+    TelemetrySample sample;
+    for (uint32_t n = 0; n < total; n++) {
+        testLogSample(n, &sample);
+        motorLogEncoderAdd(&encoder, &sample);
+    }
+    motorLogEncoderFlush(&encoder);
+    motorLogEncoderFree(&encoder);
+    assert(encoder.samples == total && encoder.droppedBlocks == 0);
+    close(fd);
+
+    MotorLogReader reader;
+    status = motorLogReaderOpen(&reader, path);
+    assert(status == 0);
+    assert(reader.info.startRealtimeNs == 1700000000000000000ULL);
+    int failed = TEST_PASSED;
+    printf("Log: %u samples in %u blocks (%.1f bytes/sample)\n", total, reader.blocks,
+           (double) reader.blocks * MOTOR_LOG_BLOCK_SIZE / total);
+    if (reader.blocks < 2 * (MOTOR_LOG_INDEX_INTERVAL + 1)) {
+        printf("Log too small to exercise the index (%u blocks)\n", reader.blocks);
+        failed = TEST_FAILED;
+    }
+
+    static TelemetrySample decoded[MOTOR_LOG_PAYLOAD_SIZE / MOTOR_LOG_COLUMN_COUNT];
+    uint32_t n = 0;
+    for (uint32_t b = 1; b < reader.blocks && failed == TEST_PASSED; b++) {
+        MotorLogBlockHeader header;
+        status = motorLogReaderRead(&reader, b, &header);
+        assert(status == 0);
+        assert(header.kind == ((b % (MOTOR_LOG_INDEX_INTERVAL + 1)) == 0 ?
+                               MOTOR_LOG_BLOCK_INDEX : MOTOR_LOG_BLOCK_DATA));
+        if (header.kind != MOTOR_LOG_BLOCK_DATA) continue;
+        int count = motorLogDecodeBlock(reader.block, decoded, sizeof(decoded) / sizeof(decoded[0]));
+        assert(count > 0 && (uint32_t) count == header.count);
+        for (int i = 0; i < count; i++, n++) {
+            testLogSample(n, &sample);
+            if (memcmp(&sample, &decoded[i], sizeof(sample)) != 0) {
+                printf("Log sample %u differs after decoding\n", n);
+                failed = TEST_FAILED;
+                break;
+            }
+        }
+    }
+    assert(failed == TEST_FAILED || n == total);
+
+    // Seek into an indexed group and into the unindexed tail
+    const uint32_t targets[2] = { total / 4, total - 100 };
+    for (int t = 0; t < 2; t++) {
+        testLogSample(targets[t], &sample);
+        uint32_t b = motorLogReaderSeek(&reader, sample.timestampNs);
+        MotorLogBlockHeader header;
+        assert(b < reader.blocks);
+        status = motorLogReaderRead(&reader, b, &header);
+        assert(status == 0);
+        if (header.firstNs > sample.timestampNs || header.lastNs < sample.timestampNs) {
+            printf("Seek to sample %u landed on block %u\n", targets[t], b);
+            failed = TEST_FAILED;
+        }
+    }
+    uint32_t end = motorLogReaderSeek(&reader, UINT64_MAX);
+    assert(end == reader.blocks);
+    motorLogReaderClose(&reader);
+
+    // A flipped bit is caught by the block CRC
+    fd = open(path, O_RDWR);
+    uint8_t byte;
+    ssize_t bytes = pread(fd, &byte, 1, MOTOR_LOG_BLOCK_SIZE + 200);
+    assert(bytes == 1);
+    byte ^= 0x10;
+    bytes = pwrite(fd, &byte, 1, MOTOR_LOG_BLOCK_SIZE + 200);
+    assert(bytes == 1);
+    close(fd);
+    status = motorLogReaderOpen(&reader, path);
+    assert(status == 0);
+    MotorLogBlockHeader header;
+    status = motorLogReaderRead(&reader, 1, &header);
+    assert(status == -1);
+    status = motorLogReaderRead(&reader, 2, &header);
+    assert(status == 0);
+    motorLogReaderClose(&reader);
+    unlink(path);
+    return failed;
+}
+
+/**
+ * @brief Validates the background logger
+ * @test Logger Test
+ * @details Records a simulated motor through the telemetry ring and checks
+ *          that the file holds every sample pushed, in order
+ * @return TEST_PASSED if the log matches the ring, TEST_FAILED otherwise
+ */
+static int test_motor_logger() {
+    const char *ring = "/motor_test_logger";
+    if (telemetryOpen(ring, 16384) != 0) {
+        printf("Shared memory unavailable, logger not tested\n");
+        return TEST_PASSED;
+    }
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+
+    const char *path = "/tmp/motor_test_logger.mlog";
+    MotorLoggerConfig loggerConfig;
+    motorLoggerDefaultConfig(&loggerConfig, path);
+    loggerConfig.telemetryName = ring;
+    int started = motorLoggerStart(&loggerConfig);
+    assert(started == 0);
+    started = motorLoggerStart(&loggerConfig);
+    assert(started == -1);
+
+    // Fewer samples than the ring holds, so none can be lost however late the encoder runs
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    const uint32_t ticks = 3000;
+    motorInstanceStart(motor);
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    simRun((uint64_t) ticks * tickNs, tickNs);
+    motorLoggerStop();
+
+    MotorLoggerStats stats;
+    motorLoggerGetStats(&stats);
+    // Every motor still registered pushes a sample per tick
+    int failed = TEST_PASSED;
+    if (stats.samples == 0 || stats.samples % ticks != 0 || stats.lostSamples != 0 ||
+        stats.writeErrors != 0) {
+        printf("Logger stored %llu samples over %u ticks (%llu lost, %llu write errors)\n",
+               (unsigned long long) stats.samples, ticks, (unsigned long long) stats.lostSamples,
+               (unsigned long long) stats.writeErrors);
+        failed = TEST_FAILED;
+    }
+
+    MotorLogReader reader;
+    int status = motorLogReaderOpen(&reader, path);
+    assert(status == 0);
+    static TelemetrySample decoded[MOTOR_LOG_PAYLOAD_SIZE / MOTOR_LOG_COLUMN_COUNT];
+    uint64_t previousNs[256] = { 0 };
+    uint64_t n = 0;
+    for (uint32_t b = 1; b < reader.blocks; b++) {
+        MotorLogBlockHeader header;
+        status = motorLogReaderRead(&reader, b, &header);
+        assert(status == 0);
+        int count = motorLogDecodeBlock(reader.block, decoded, sizeof(decoded) / sizeof(decoded[0]));
+        assert(count >= 0);
+        for (int i = 0; i < count; i++, n++) {
+            uint64_t *previous = &previousNs[decoded[i].motor];
+            if (*previous != 0 && decoded[i].timestampNs != *previous + tickNs) {
+                printf("Log sample %llu of motor %u is out of sequence\n", (unsigned long long) n,
+                       decoded[i].motor);
+                failed = TEST_FAILED;
+            }
+            *previous = decoded[i].timestampNs;
+        }
+    }
+    if (n != stats.samples) {
+        printf("Log file holds %llu of %llu samples\n", (unsigned long long) n,
+               (unsigned long long) stats.samples);
+        failed = TEST_FAILED;
+    }
+    motorLogReaderClose(&reader);
+    unlink(path);
+
+    motorInstanceStop(motor);
+    motorDestroy(motor);
+    simMotorDestroy(sim);
+    telemetryClose();
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
+static atomic_int idleSuspends;  ///< Pins suspended through idlePwmBackend
+static atomic_int idleResumes;   ///< Pins resumed through idlePwmBackend
+
+static int idlePwmSetup(int pin, int range) { return simPwmBackend.setup(pin, range); }
+static void idlePwmWrite(int pin, int value) { simPwmBackend.write(pin, value); }
+static void idlePwmRelease(int pin) { simPwmBackend.release(pin); }
+static void idlePwmSuspend(int pin) { (void) pin; atomic_fetch_add(&idleSuspends, 1); }
+static int idlePwmResume(int pin, int range) {
+    (void) pin;
+    (void) range;
+    atomic_fetch_add(&idleResumes, 1);
+    return 0;
+}
+
+/** @brief Simulator PWM that counts suspend and resume calls */
+static const PwmBackend idlePwmBackend = {
+    .name = "sim-idle",
+    .setup = idlePwmSetup,
+    .write = idlePwmWrite,
+    .release = idlePwmRelease,
+    .suspend = idlePwmSuspend,
+    .resume = idlePwmResume,
+};
+
+/** @brief Wait up to timeoutMs for the loop to report the idle state */
+static int waitLoopIdle(uint8_t idle, int timeoutMs) {
+    ControlLoopStats stats;
+    for (int waited = 0; waited < timeoutMs; waited++) {
+        controlLoopGetStats(&stats);
+        if (stats.idle == idle) return 1;
+        usleep(1000);
+    }
+    return 0;
+}
+
+/**
+ * @brief Validates idle detection, PWM suspension and the idle loop rate
+ * @test Idle Mode Test
+ * @details Drives a simulated motor through start, stop and coast-down,
+ *          checking when the control tick reports idle and when the phase
+ *          PWM is suspended and resumed, then runs the control loop thread
+ *          and checks that it parks while idle and returns to full rate
+ *          when a command arrives
+ * @return TEST_PASSED if the loop idles only at standstill and wakes on commands, TEST_FAILED otherwise
+ */
+static int test_idle_loop() {
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+    }
+    SimMotor *sim = simMotorCreate(NULL, &config);
+    assert(sim != NULL);
+    config.pwm = &idlePwmBackend;
+    atomic_store(&idleSuspends, 0);
+    atomic_store(&idleResumes, 0);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(sim, motor);
+    motorClockSetSource(simClockNs);
+    motorSetExternalTick(1);
+
+    // Other motors left by earlier tests must be at rest for the loop to idle
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    int failed = TEST_PASSED;
+    simRun(10ULL * tickNs, tickNs);
+    if (!motorControlIsIdle() || atomic_load(&idleSuspends) != 3) {
+        printf("Stopped motor not idle (%d pins suspended)\n", atomic_load(&idleSuspends));
+        failed = TEST_FAILED;
+    }
+
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 2);
+    motorInstanceStart(motor);
+    assert(atomic_load(&idleResumes) == 3);
+    simRun(500000000ULL, tickNs);
+    assert(!motorControlIsIdle());
+
+    // Outputs are suspended on stop, but the loop stays busy while the rotor coasts
+    motorInstanceStop(motor);
+    assert(atomic_load(&idleSuspends) == 6);
+    simRun(10ULL * tickNs, tickNs);
+    if (motorControlIsIdle()) {
+        printf("Coasting motor reported idle\n");
+        failed = TEST_FAILED;
+    }
+    for (int i = 0; i < 100 && !motorControlIsIdle(); i++) simRun(100000000ULL, tickNs);
+    if (!motorControlIsIdle()) {
+        printf("Motor never came to rest (%u RPM)\n", motorInstanceGetSpeed(motor));
+        failed = TEST_FAILED;
+    }
+
+    // A scheduled change keeps the ticks coming until it is due or cancelled
+    motorInstanceSetSpeedAt(motor, 1000, motorControlGetTickIndex() + 1000000);
+    simRun(tickNs, tickNs);
+    assert(!motorControlIsIdle());
+    motorInstanceSetSpeed(motor, 0);
+    simRun(tickNs, tickNs);
+    assert(motorControlIsIdle());
+
+    // The real loop thread parks once idle and resumes when a command arrives
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    ControlLoopConfig loopConfig;
+    controlLoopDefaultConfig(&loopConfig);
+    loopConfig.cpu = -1;
+    loopConfig.idleRateHz = 0;
+    loopConfig.idleDelayMs = 20;
+    int started = controlLoopStart(&loopConfig);
+    assert(started == 0);
+    ControlLoopStats before, after;
+    if (waitLoopIdle(1, 2000)) {
+        controlLoopGetStats(&before);
+        usleep(100000);
+        controlLoopGetStats(&after);
+        if (after.ticks != before.ticks) {
+            printf("Parked loop ran %llu ticks\n", (unsigned long long) (after.ticks - before.ticks));
+            failed = TEST_FAILED;
+        }
+
+        // The request is reported before the loop thread has applied it
+        motorInstanceSetSpeed(motor, MOTOR_MAX_RPM / 4);
+        if (!motorInstanceIsRamping(motor) || motorInstanceGetTargetSpeed(motor) != MOTOR_MAX_RPM / 4) {
+            printf("Queued speed change not reported\n");
+            failed = TEST_FAILED;
+        }
+        motorInstanceStart(motor);
+        if (!waitLoopIdle(0, 1000)) {
+            printf("Command did not wake the loop\n");
+            failed = TEST_FAILED;
+        }
+        usleep(50000);
+        controlLoopGetStats(&after);
+        if (after.wakeups < 1 || after.idle || after.ticks - before.ticks < 20 ||
+            atomic_load(&idleResumes) != 6) {
+            printf("Loop not back at full rate (%llu ticks, %llu wakeups)\n",
+                   (unsigned long long) (after.ticks - before.ticks), (unsigned long long) after.wakeups);
+            failed = TEST_FAILED;
+        }
+
+        motorInstanceStop(motor);
+        int idleAgain = waitLoopIdle(1, 5000);
+        controlLoopGetStats(&after);
+        if (!idleAgain || after.idlePeriods < 2 || atomic_load(&idleSuspends) != 9) {
+            printf("Loop did not idle again after the stop\n");
+            failed = TEST_FAILED;
+        }
+    } else {
+        printf("Control loop never went idle\n");
+        failed = TEST_FAILED;
+    }
+
+    // Destroying under the running loop hands the stop to the loop thread
+    motorInstanceStart(motor);
+    motorDestroy(motor);
+    Motor *again = motorCreate(&config);
+    if (again != motor) {
+        printf("Slot not released by motorDestroy() under the running loop\n");
+        failed = TEST_FAILED;
+    }
+    controlLoopStop();  // Must end the idle wait
+
+    motorDestroy(again);
+    simMotorDestroy(sim);
+    return failed;
+}
+
+static SimMotor *busSim;  ///< Plant whose bus busAdcBackend samples
+
+static int busAdcSetup(void) { return 0; }
+static int busAdcRead(int channel) {
+    (void) channel;
+    return (int) (simMotorGetBusVoltage(busSim) * 1000.0 / BUS_VOLTAGE_MV_PER_LSB);
+}
+
+/** @brief Bus voltage divider on the simulated bus */
+static const AdcBackend busAdcBackend = {
+    .name = "sim-bus",
+    .setup = busAdcSetup,
+    .read = busAdcRead,
+    .fullScale = 1023,
+};
+
+/**
+ * @brief Run a simulated motor up to speed, then stop it in a braking mode
+ * @param motor Motor driving sim
+ * @param sim Simulated motor
+ * @param mode Braking mode
+ * @param peakBus Highest bus voltage seen while stopping (V)
+ * @return Time from the brake command until the rotor is at rest and released (ns), 0 on timeout
+ */
+static uint64_t brakeToStop(Motor *motor, SimMotor *sim, BrakeMode mode, double *peakBus) {
+    const uint32_t tickNs = 1000000000U / CONTROL_LOOP_RATE_HZ;
+    motorInstanceSetSpeed(motor, MOTOR_MAX_RPM * 3 / 4);
+    motorInstanceStart(motor);
+    simRun(2000000000ULL, tickNs);
+    motorInstanceTakeEvents(motor);
+
+    uint64_t start = simClockNs();
+    int status = motorInstanceBrake(motor, mode);
+    assert(status == 0);
+    *peakBus = simMotorGetBusVoltage(sim);
+    while (simClockNs() - start < 10000000000ULL) {
+        simRun(tickNs, tickNs);
+        if (simMotorGetBusVoltage(sim) > *peakBus) *peakBus = simMotorGetBusVoltage(sim);
+        if (simMotorGetRpm(sim) == 0.0 && motorInstanceGetBrakeMode(motor) == BRAKE_COAST) {
+            return simClockNs() - start;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Validates short-circuit and regenerative braking
+ * @test Braking Test
+ * @details Stops a simulated motor on a 3PWM bridge by coasting, by short
+ *          brake and by regenerative braking into a bus capacitor, and
+ *          checks the stop times, the bus voltage limit and the release
+ *          at standstill
+ * @return TEST_PASSED if both braking modes stop far faster than coasting within the bus limit, TEST_FAILED otherwise
+ */
+static int test_motor_brake() {
+    // Deceleration folds back linearly over the band below the limit
+    assert(brakeRegenDecel(1000, 20000, 27600) == 1000);
+    assert(brakeRegenDecel(1000, 27600 - BRAKE_VOLTAGE_BAND_MV / 2, 27600) == 500);
+    assert(brakeRegenDecel(1000, 28000, 27600) == 0);
+
+    // A high-side-only bridge has no low sides to brake with
+    int status = motorInstanceBrake(motorGetDefault(), BRAKE_SHORT);
+    assert(status == -1);
+
+    MotorConfig config;
+    motorDefaultConfig(&config);
+    const int pins[6] = { 4, 5, 6, 7, 8, 9 };
+    for (int i = 0; i < 3; i++) {
+        config.phasePins[i] = pins[i];
+        config.hallPins[i] = pins[3 + i];
+        config.enablePins[i] = 26 + i;
+    }
+    config.bridge = BRIDGE_3PWM;
+    config.busVoltageChannel = 0;
+    config.adc = &busAdcBackend;
+    SimMotorParams params;
+    simDefaultParams(&params);
+    params.busCapacitance = 0.01;
+    busSim = simMotorCreate(&params, &config);
+    assert(busSim != NULL);
+    Motor *motor = motorCreate(&config);
+    assert(motor != NULL);
+    simMotorAttach(busSim, motor);
+    motorClockSetSource(simClockNs);
+
+    int failed = TEST_PASSED;
+    double coastBus, shortBus, regenBus;
+    uint64_t coastNs = brakeToStop(motor, busSim, BRAKE_COAST, &coastBus);
+    uint64_t shortNs = brakeToStop(motor, busSim, BRAKE_SHORT, &shortBus);
+    uint32_t shortEvents = motorInstanceTakeEvents(motor);
+    uint64_t regenNs = brakeToStop(motor, busSim, BRAKE_REGEN, &regenBus);
+    uint32_t regenEvents = motorInstanceTakeEvents(motor);
+    printf("Stop from %d RPM: coast %.0f ms, short %.0f ms, regen %.0f ms (bus peak %.2f V)\n",
+           MOTOR_MAX_RPM * 3 / 4, coastNs / 1e6, shortNs / 1e6, regenNs / 1e6, regenBus);
+
+    if (coastNs == 0 || shortNs == 0 || regenNs == 0 ||
+        shortNs * 3 > coastNs || regenNs * 3 > coastNs) {
+        printf("Braking not faster than coasting\n");
+        failed = TEST_FAILED;
+    }
+    if (regenBus < MOTOR_VOLTAGE + 0.5 || regenBus > config.busVoltageLimitMv / 1000.0 + 0.5 ||
+        shortBus > MOTOR_VOLTAGE + 0.1) {
+        printf("Bus at %.2f V after regenerative braking, %.2f V after short brake\n", regenBus, shortBus);
+        failed = TEST_FAILED;
+    }
+    if (!(shortEvents & MOTOR_EVENT_STOPPED) || !(regenEvents & MOTOR_EVENT_STOPPED)) {
+        printf("Stop events missing\n");
+        failed = TEST_FAILED;
+    }
+
+    // At rest every leg floats again
+    for (int i = 0; i < 3; i++) assert(mockGpioOutput[config.enablePins[i]] == LOW);
+    assert(motorInstanceGetSpeed(motor) == 0);
+
+    motorDestroy(motor);
+    simMotorDestroy(busSim);
+    motorSetExternalTick(0);
+    motorClockSetSource(NULL);
+    return failed;
+}
+
 /**
  * @brief Test suite entry point
  * @return 0 if all tests pass, 1 if any test fails
@@ -57,6 +1646,26 @@ int main() {
     printf("=== Motor Control Test Suite ===\n");
     failed_tests += test_motor_initialization();
     failed_tests += test_motor_operation();
+    failed_tests += test_closed_loop_simulation();
+    failed_tests += test_sensorless_setup();
+    failed_tests += test_foc_transforms();
+    failed_tests += test_bridge_drive();
+    failed_tests += test_commutation_cache();
+    failed_tests += test_overcurrent_trip();
+    failed_tests += test_overcurrent_fallback();
+    failed_tests += test_hall_validator();
+    failed_tests += test_hall_edge_commutation();
+    failed_tests += test_autotune_simulation();
+    failed_tests += test_calibration_file();
+    failed_tests += test_fixed_config();
+    failed_tests += test_rotor_angle();
+    failed_tests += test_motor_events();
+    failed_tests += test_network_server();
+    failed_tests += test_tick_sync();
+    failed_tests += test_motor_log();
+    failed_tests += test_motor_logger();
+    failed_tests += test_idle_loop();
+    failed_tests += test_motor_brake();
 
     /* Report Test Results */
     if (failed_tests == 0) {
@@ -0,0 +1,277 @@
+/**
+ * @file motor_calibrate.c
+ * @brief Host tool compiling calibration text into the binary file
+ *
+ * Usage:
+ *   motor_calibrate -o calibration.bin variant.txt [gains.txt ...]
+ *   motor_calibrate -d calibration.bin
+ *
+ * Input is "key = value" lines; arrays take space-separated values and
+ * '#' starts a comment. Keys not given keep the compile-time defaults, and
+ * later files override earlier ones, so the output of autotuneSaveGains()
+ * can be appended to a variant description. -d prints a binary file back
+ * in the same format.
+ *
+ * Keys: phase_pins, hall_pins, low_side_pins, enable_pins, fault_pin,
+ * max_rpm, pwm_range, num_poles, bridge, dead_time_ns, hall_debounce_ns,
+ * current_limit_ma, speed_kp_q16, speed_ki_q16, ramp_accel, ramp_jerk,
+ * hall_angles_deg (start of each forward sector, Hall codes 1 3 2 6 4 5),
+ * current_offsets (ADC counts at 0 A per phase, -1 for mid-scale),
+ * phase_advance_deg (rotor angle advance at max_rpm)
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include "MotorCalibration.h"
+
+#define LINE_MAX_LEN 256
+
+/** @brief Storage of one field */
+typedef enum {
+    FIELD_I16,
+    FIELD_U16,
+    FIELD_U8,
+    FIELD_I32,
+    FIELD_U32,
+    FIELD_ANGLE      ///< uint16_t angle, written in degrees
+} FieldKind;
+
+typedef struct {
+    const char *key;
+    size_t offset;
+    uint8_t count;
+    FieldKind kind;
+} Field;
+
+#define FIELD(key, member, count, kind) { key, offsetof(MotorCalibration, member), count, kind }
+
+static size_t fieldSize(FieldKind kind) {
+    return kind == FIELD_U8 ? 1 : kind == FIELD_I32 || kind == FIELD_U32 ? 4 : 2;
+}
+
+static const Field fields[] = {
+    FIELD("phase_pins", phasePins, 3, FIELD_I16),
+    FIELD("hall_pins", hallPins, 3, FIELD_I16),
+    FIELD("low_side_pins", lowSidePins, 3, FIELD_I16),
+    FIELD("enable_pins", enablePins, 3, FIELD_I16),
+    FIELD("fault_pin", faultPin, 1, FIELD_I16),
+    FIELD("max_rpm", maxRpm, 1, FIELD_U16),
+    FIELD("pwm_range", pwmRange, 1, FIELD_U16),
+    FIELD("num_poles", numPoles, 1, FIELD_U8),
+    FIELD("bridge", bridge, 1, FIELD_U8),
+    FIELD("dead_time_ns", deadTimeNs, 1, FIELD_U32),
+    FIELD("hall_debounce_ns", hallDebounceNs, 1, FIELD_U32),
+    FIELD("current_limit_ma", currentLimitMa, 1, FIELD_U32),
+    FIELD("speed_kp_q16", kp, 1, FIELD_I32),
+    FIELD("speed_ki_q16", ki, 1, FIELD_I32),
+    FIELD("ramp_accel", rampAccel, 1, FIELD_U32),
+    FIELD("ramp_jerk", rampJerk, 1, FIELD_U32),
+    FIELD("hall_angles_deg", hallAngles, 6, FIELD_ANGLE),
+    FIELD("current_offsets", currentOffsets, 2, FIELD_I16),
+    FIELD("phase_advance_deg", phaseAdvance, 1, FIELD_ANGLE),
+};
+
+#define FIELD_COUNT (sizeof(fields) / sizeof(fields[0]))
+
+/** @brief Store one value, rejecting anything the field cannot hold */
+static int storeValue(MotorCalibration *cal, const Field *field, int index, long value) {
+    uint8_t *base = (uint8_t *) cal + field->offset + index * fieldSize(field->kind);
+    switch (field->kind) {
+        case FIELD_I16: {
+            if (value < INT16_MIN || value > INT16_MAX) return -1;
+            int16_t v = (int16_t) value;
+            memcpy(base, &v, sizeof(v));
+            return 0;
+        }
+        case FIELD_U16: {
+            if (value < 0 || value > UINT16_MAX) return -1;
+            uint16_t v = (uint16_t) value;
+            memcpy(base, &v, sizeof(v));
+            return 0;
+        }
+        case FIELD_U8:
+            if (value < 0 || value > UINT8_MAX) return -1;
+            *base = (uint8_t) value;
+            return 0;
+        case FIELD_I32: {
+            if (value < INT32_MIN || value > INT32_MAX) return -1;
+            int32_t v = (int32_t) value;
+            memcpy(base, &v, sizeof(v));
+            return 0;
+        }
+        case FIELD_U32: {
+            if (value < 0 || value > (long) UINT32_MAX) return -1;
+            uint32_t v = (uint32_t) value;
+            memcpy(base, &v, sizeof(v));
+            return 0;
+        }
+        case FIELD_ANGLE: {
+            if (value < 0 || value >= 360) return -1;
+            uint16_t v = (uint16_t) (value * 65536 / 360);
+            memcpy(base, &v, sizeof(v));
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static long loadValue(const MotorCalibration *cal, const Field *field, int index) {
+    const uint8_t *base = (const uint8_t *) cal + field->offset + index * fieldSize(field->kind);
+    int16_t i16;
+    uint16_t u16;
+    int32_t i32;
+    uint32_t u32;
+    switch (field->kind) {
+        case FIELD_I16: memcpy(&i16, base, sizeof(i16)); return i16;
+        case FIELD_U16: memcpy(&u16, base, sizeof(u16)); return u16;
+        case FIELD_U8: return *base;
+        case FIELD_I32: memcpy(&i32, base, sizeof(i32)); return i32;
+        case FIELD_U32: memcpy(&u32, base, sizeof(u32)); return (long) u32;
+        case FIELD_ANGLE: memcpy(&u16, base, sizeof(u16)); return ((long) u16 * 360 + 32768) / 65536 % 360;
+    }
+    return 0;
+}
+
+static char *trim(char *text) {
+    while (*text == ' ' || *text == '\t') text++;
+    char *end = text + strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return text;
+}
+
+/** @brief Parse one "key = values" line */
+static int parseLine(MotorCalibration *cal, char *line, const char *path, int lineNo) {
+    char *comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    line = trim(line);
+    if (*line == '\0') return 0;
+
+    char *equals = strchr(line, '=');
+    if (equals == NULL) {
+        fprintf(stderr, "%s:%d: expected key = value\n", path, lineNo);
+        return -1;
+    }
+    *equals = '\0';
+    const char *key = trim(line);
+    const Field *field = NULL;
+    for (size_t f = 0; f < FIELD_COUNT; f++) {
+        if (strcmp(fields[f].key, key) == 0) field = &fields[f];
+    }
+    if (field == NULL) {
+        fprintf(stderr, "%s:%d: unknown key '%s'\n", path, lineNo, key);
+        return -1;
+    }
+
+    char *cursor = equals + 1;
+    for (int i = 0; i < field->count; i++) {
+        char *end;
+        long value = strtol(cursor, &end, 0);
+        if (end == cursor || storeValue(cal, field, i, value) != 0) {
+            fprintf(stderr, "%s:%d: '%s' needs %d value(s) in range\n", path, lineNo, key, field->count);
+            return -1;
+        }
+        cursor = end;
+    }
+    if (*trim(cursor) != '\0') {
+        fprintf(stderr, "%s:%d: too many values for '%s'\n", path, lineNo, key);
+        return -1;
+    }
+    return 0;
+}
+
+static int parseFile(MotorCalibration *cal, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+    char line[LINE_MAX_LEN];
+    int lineNo = 0;
+    int status = 0;
+    while (status == 0 && fgets(line, sizeof(line), file) != NULL) {
+        status = parseLine(cal, line, path, ++lineNo);
+    }
+    fclose(file);
+    return status;
+}
+
+/** @brief Write the record next to the target, then rename it into place */
+static int writeFile(const MotorCalibration *cal, const char *path) {
+    char temp[PATH_MAX];
+    if (snprintf(temp, sizeof(temp), "%s.tmp", path) >= (int) sizeof(temp)) return -1;
+    FILE *file = fopen(temp, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write %s\n", temp);
+        return -1;
+    }
+    int failed = fwrite(cal, sizeof(*cal), 1, file) != 1;
+    failed |= fclose(file) != 0;
+    if (failed || rename(temp, path) != 0) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        unlink(temp);
+        return -1;
+    }
+    return 0;
+}
+
+static int dumpFile(const char *path) {
+    const MotorCalibration *cal;
+    if (calibrationMap(path, &cal) != 0) {
+        fprintf(stderr, "%s is not a valid calibration file\n", path);
+        return 1;
+    }
+    printf("# %s, layout version %d\n", path, cal->version);
+    for (size_t f = 0; f < FIELD_COUNT; f++) {
+        printf("%s =", fields[f].key);
+        for (int i = 0; i < fields[f].count; i++) printf(" %ld", loadValue(cal, &fields[f], i));
+        printf("\n");
+    }
+    calibrationUnmap(cal);
+    return 0;
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: motor_calibrate -o output.bin input.txt [input.txt ...]\n"
+                    "       motor_calibrate -d calibration.bin\n");
+}
+
+int main(int argc, char **argv) {
+    const char *output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "o:d:")) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            case 'd':
+                return dumpFile(optarg);
+            default:
+                usage();
+                return 2;
+        }
+    }
+    if (output == NULL || optind == argc) {
+        usage();
+        return 2;
+    }
+
+    MotorCalibration cal;
+    calibrationDefaults(&cal);
+    for (int i = optind; i < argc; i++) {
+        if (parseFile(&cal, argv[i]) != 0) return 1;
+    }
+    if (cal.maxRpm == 0 || cal.pwmRange == 0 || cal.numPoles < 2 || cal.bridge > BRIDGE_6PWM) {
+        fprintf(stderr, "max_rpm, pwm_range, num_poles or bridge out of range\n");
+        return 1;
+    }
+    calibrationSeal(&cal);
+    return writeFile(&cal, output) == 0 ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file motor_logdecode.c
+ * @brief Host tool converting a MotorLog file to CSV
+ *
+ * Usage:
+ *   motor_logdecode [-s start_s] [-e end_s] [-m motor] [-i] motor.log > motor.csv
+ *
+ * Times are seconds since logging started. -s seeks through the index
+ * blocks, so extracting a window near the end of an hours-long log reads
+ * only a handful of blocks. -m keeps one motor. -i prints one line per
+ * block instead of the samples (number, kind, time range, count, lost).
+ *
+ * Columns: time_s, timestamp_ns (motorClockNs()), unix_ns (derived from the
+ * clock origins in the file block), motor, hall, rpm, setpoint, duty_a,
+ * duty_b, duty_c, faults, overrun. A comment line reports samples the
+ * logger lost before a block; corrupt blocks are reported and skipped.
+ *
+ * @version 1.1
+ * @date 2025-02-01
+ * @license MIT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "MotorLog.h"
+
+/** @brief Upper bound of samples in one data block */
+#define MAX_BLOCK_SAMPLES (MOTOR_LOG_PAYLOAD_SIZE / MOTOR_LOG_COLUMN_COUNT)
+
+static void usage(void) {
+    fprintf(stderr, "usage: motor_logdecode [-s start_s] [-e end_s] [-m motor] [-i] motor.log\n");
+}
+
+static const char *kindName(uint16_t kind) {
+    switch (kind) {
+        case MOTOR_LOG_BLOCK_FILE: return "file";
+        case MOTOR_LOG_BLOCK_DATA: return "data";
+        case MOTOR_LOG_BLOCK_INDEX: return "index";
+        default: return "?";
+    }
+}
+
+/** @brief Print one line per block */
+static int listBlocks(MotorLogReader *reader) {
+    const double origin = (double) reader->info.startMonotonicNs;
+    for (uint32_t b = 0; b < reader->blocks; b++) {
+        MotorLogBlockHeader header;
+        if (motorLogReaderRead(reader, b, &header) != 0) {
+            printf("%u invalid\n", b);
+            continue;
+        }
+        printf("%u %s %.6f %.6f count=%u lost=%u bytes=%u\n", b, kindName(header.kind),
+               (header.firstNs - origin) / 1e9, (header.lastNs - origin) / 1e9,
+               header.count, header.lost, header.payloadSize);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    double start = 0.0, end = -1.0;
+    int motor = -1, list = 0, opt;
+    while ((opt = getopt(argc, argv, "s:e:m:i")) != -1) {
+        switch (opt) {
+            case 's':
+                start = atof(optarg);
+                break;
+            case 'e':
+                end = atof(optarg);
+                break;
+            case 'm':
+                motor = atoi(optarg);
+                break;
+            case 'i':
+                list = 1;
+                break;
+            default:
+                usage();
+                return 2;
+        }
+    }
+    if (optind + 1 != argc) {
+        usage();
+        return 2;
+    }
+
+    MotorLogReader reader;
+    if (motorLogReaderOpen(&reader, argv[optind]) != 0) return 1;
+    if (list) {
+        listBlocks(&reader);
+        motorLogReaderClose(&reader);
+        return 0;
+    }
+
+    static TelemetrySample samples[MAX_BLOCK_SAMPLES];
+    const uint64_t origin = reader.info.startMonotonicNs;
+    const int64_t toUnix = (int64_t) (reader.info.startRealtimeNs - origin);
+    const uint64_t startNs = origin + (uint64_t) (start > 0 ? start * 1e9 : 0);
+    const uint64_t endNs = end >= 0 ? origin + (uint64_t) (end * 1e9) : UINT64_MAX;
+
+    printf("time_s,timestamp_ns,unix_ns,motor,hall,rpm,setpoint,duty_a,duty_b,duty_c,faults,overrun\n");
+    for (uint32_t b = motorLogReaderSeek(&reader, startNs); b < reader.blocks; b++) {
+        MotorLogBlockHeader header;
+        if (motorLogReaderRead(&reader, b, &header) != 0) {
+            fprintf(stderr, "Skipping invalid block %u\n", b);
+            continue;
+        }
+        if (header.kind != MOTOR_LOG_BLOCK_DATA) continue;
+        if (header.firstNs > endNs) break;
+
+        int count = motorLogDecodeBlock(reader.block, samples, MAX_BLOCK_SAMPLES);
+        if (count < 0) {
+            fprintf(stderr, "Skipping undecodable block %u\n", b);
+            continue;
+        }
+        if (header.lost > 0) printf("# %u samples lost\n", header.lost);
+        for (int i = 0; i < count; i++) {
+            const TelemetrySample *s = &samples[i];
+            if (s->timestampNs < startNs || s->timestampNs > endNs) continue;
+            if (motor >= 0 && s->motor != motor) continue;
+            printf("%.6f,%llu,%lld,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+                   (double) (s->timestampNs - origin) / 1e9, (unsigned long long) s->timestampNs,
+                   (long long) s->timestampNs + toUnix, s->motor, s->hallState, s->rpm,
+                   s->setpoint, s->duty[0], s->duty[1], s->duty[2], s->faults, s->overrun);
+        }
+    }
+    motorLogReaderClose(&reader);
+    return 0;
+}